@@ -0,0 +1,344 @@
+#!/usr/bin/env python3
+"""Generate fixed-offset C pack/unpack routines from esp32-canboard.dbc.
+
+Usage: python3 dbc/dbc2c.py [dbc] [header_out] [source_out]
+
+Produces a header with one struct plus static inline pack/unpack functions per
+message (raw integer signal values, no branches, one store per byte) and a
+source file with a schema table (names, scaling, units) for generic decoding
+on the host. Only little-endian (Intel, @1) signals are supported. Multiplexed
+messages (one M signal, m<n> pages) get one layout per page, selected by the
+multiplexor field.
+"""
+
+import os
+import re
+import sys
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+DEFAULT_DBC = os.path.join(ROOT, "dbc", "esp32-canboard.dbc")
+DEFAULT_HEADER = os.path.join(ROOT, "main", "inc", "can_signals.h")
+DEFAULT_SOURCE = os.path.join(ROOT, "main", "src", "can_signals.c")
+
+INDEPENDENT_SIG_MSG = 0xC0000000
+
+BO_RE = re.compile(r"^BO_\s+(\d+)\s+(\w+)\s*:\s*(\d+)\s+(\w+)")
+SG_RE = re.compile(
+    r"^\s*SG_\s+(\w+)\s*(M|m\d+)?\s*:\s*(\d+)\|(\d+)@([01])([+-])\s*"
+    r"\(([^,]+),([^)]+)\)\s*\[([^|]*)\|([^\]]*)\]\s*\"([^\"]*)\""
+)
+
+
+class Signal:
+    def __init__(self, name, mux, start, length, order, sign, factor, offset, unit):
+        self.name = name
+        self.mux = mux
+        self.start = int(start)
+        self.length = int(length)
+        self.little_endian = order == "1"
+        self.signed = sign == "-"
+        self.factor = float(factor)
+        self.offset = float(offset)
+        self.unit = unit
+
+    @property
+    def is_multiplexor(self):
+        return self.mux == "M"
+
+    @property
+    def mux_value(self):
+        """Multiplexor value the signal is present for, None if it is always present."""
+        return int(self.mux[1:]) if self.mux and self.mux != "M" else None
+
+    @property
+    def ctype(self):
+        for bits in (8, 16, 32):
+            if self.length <= bits:
+                return ("int%d_t" if self.signed else "uint%d_t") % bits
+        raise ValueError("signal %s is wider than 32 bits" % self.name)
+
+    def byte_parts(self):
+        """Yields (byte, mask, shift) where shift is value-bit index of the byte's bit 0."""
+        end = self.start + self.length
+        for byte in range(self.start // 8, (end - 1) // 8 + 1):
+            lo = max(self.start, byte * 8) - byte * 8
+            hi = min(end, byte * 8 + 8) - byte * 8
+            mask = ((1 << (hi - lo)) - 1) << lo
+            yield byte, mask, byte * 8 - self.start
+
+
+class Message:
+    def __init__(self, ident, name, dlc):
+        self.id = int(ident)
+        self.name = name
+        self.dlc = int(dlc)
+        self.signals = []
+
+    @property
+    def multiplexor(self):
+        return next((sig for sig in self.signals if sig.is_multiplexor), None)
+
+    @property
+    def mux_values(self):
+        return sorted({sig.mux_value for sig in self.signals if sig.mux_value is not None})
+
+    def page(self, mux_value):
+        """Signals present when the multiplexor reads mux_value (None: only those always present)."""
+        return [sig for sig in self.signals if sig.mux_value is None or sig.mux_value == mux_value]
+
+
+def parse(path):
+    messages = []
+    current = None
+    with open(path, encoding="ascii") as f:
+        for line in f:
+            m = BO_RE.match(line)
+            if m:
+                current = Message(m.group(1), m.group(2), m.group(3))
+                if current.id != INDEPENDENT_SIG_MSG:
+                    messages.append(current)
+                continue
+            m = SG_RE.match(line)
+            if m and current is not None:
+                sig = Signal(m.group(1), m.group(2), m.group(3), m.group(4), m.group(5), m.group(6),
+                             m.group(7), m.group(8), m.group(11))
+                if not sig.little_endian:
+                    raise ValueError("%s.%s: big-endian signals are not supported" % (current.name, sig.name))
+                if sig.start + sig.length > current.dlc * 8 and current.id != INDEPENDENT_SIG_MSG:
+                    raise ValueError("%s.%s does not fit in %d bytes" % (current.name, sig.name, current.dlc))
+                current.signals.append(sig)
+            elif not line.strip():
+                current = None
+    messages.sort(key=lambda msg: msg.id)
+    return messages
+
+
+def shift_expr(expr, shift):
+    if shift > 0:
+        return "(%s >> %d)" % (expr, shift)
+    if shift < 0:
+        return "(%s << %d)" % (expr, -shift)
+    return expr
+
+
+def gen_pack_bytes(msg, signals, indent):
+    out = []
+    for byte in range(msg.dlc):
+        terms = []
+        for sig in signals:
+            for b, mask, shift in sig.byte_parts():
+                if b == byte:
+                    terms.append("(%s & 0x%02Xu)" % (shift_expr("(uint32_t)m->%s" % sig.name, shift), mask))
+        out.append("%sdata[%d] = (uint8_t)(%s);" % (indent, byte, " | ".join(terms) if terms else "0u"))
+    return out
+
+
+def gen_pack(msg):
+    out = ["static inline void %s_pack(const %s_t *m, uint8_t *data) {" % (msg.name, msg.name)]
+    mux = msg.multiplexor
+    if mux is None:
+        out += gen_pack_bytes(msg, msg.signals, "    ")
+    else:
+        # One branch-free layout per page; an unknown page only carries the always-present signals
+        out.append("    switch (m->%s) {" % mux.name)
+        for value in msg.mux_values:
+            out.append("        case %d:" % value)
+            out += gen_pack_bytes(msg, msg.page(value), "            ")
+            out.append("            break;")
+        out.append("        default:")
+        out += gen_pack_bytes(msg, msg.page(None), "            ")
+        out.append("            break;")
+        out.append("    }")
+    out.append("}")
+    return out
+
+
+def gen_unpack_signal(sig, indent):
+    terms = [shift_expr("(uint32_t)(data[%d] & 0x%02Xu)" % (b, mask), -shift) for b, mask, shift in sig.byte_parts()]
+    raw = " | ".join(terms)
+    if sig.signed and sig.length < 32:
+        raw = "(int32_t)((%s) << %d) >> %d" % (raw, 32 - sig.length, 32 - sig.length)
+    return "%sm->%s = (%s)(%s);" % (indent, sig.name, sig.ctype, raw)
+
+
+def gen_unpack(msg):
+    out = ["static inline void %s_unpack(%s_t *m, const uint8_t *data) {" % (msg.name, msg.name)]
+    mux = msg.multiplexor
+    for sig in msg.page(None):
+        out.append(gen_unpack_signal(sig, "    "))
+    if mux is not None:
+        # Signals of other pages are left untouched
+        out.append("    switch (m->%s) {" % mux.name)
+        for value in msg.mux_values:
+            out.append("        case %d:" % value)
+            out += [gen_unpack_signal(sig, "            ") for sig in msg.signals if sig.mux_value == value]
+            out.append("            break;")
+        out.append("        default:")
+        out.append("            break;")
+        out.append("    }")
+    out.append("}")
+    return out
+
+
+def macro_name(msg):
+    return re.sub(r"(?<=[a-z0-9])(?=[A-Z])", "_", msg.name).upper()
+
+
+def gen_header(messages, dbc_name):
+    out = [
+        "// Generated by dbc/dbc2c.py from %s - do not edit." % dbc_name,
+        "#pragma once",
+        "",
+        "#include <stdbool.h>",
+        "#include <stddef.h>",
+        "#include <stdint.h>",
+        "",
+    ]
+    for msg in messages:
+        out.append("#define %s_ID 0x%03Xu" % (macro_name(msg), msg.id))
+        out.append("#define %s_DLC %d" % (macro_name(msg), msg.dlc))
+    out += [
+        "",
+        "typedef struct {",
+        "    const char *name;",
+        "    uint16_t start;",
+        "    uint8_t length;",
+        "    bool is_signed;",
+        "    float factor;",
+        "    float offset;",
+        "    const char *unit;",
+        "    int8_t mux;             // Multiplexor value the signal is present for, -1 if always present",
+        "} can_signal_def_t;",
+        "",
+        "typedef struct {",
+        "    uint32_t id;",
+        "    const char *name;",
+        "    uint8_t dlc;",
+        "    uint8_t signal_count;",
+        "    const can_signal_def_t *signals;",
+        "    int8_t mux_signal;      // Index of the multiplexor signal, -1 if the message is not multiplexed",
+        "} can_message_schema_t;",
+        "",
+        "extern const can_message_schema_t can_schema[];",
+        "extern const size_t can_schema_count;",
+        "",
+        "const can_message_schema_t *canSchemaFind(uint32_t id);",
+        "int32_t canSignalRaw(const can_signal_def_t *sig, const uint8_t *data);",
+        "float canSignalPhysical(const can_signal_def_t *sig, const uint8_t *data);",
+        "bool canSignalPresent(const can_message_schema_t *msg, const can_signal_def_t *sig, const uint8_t *data);",
+    ]
+    for msg in messages:
+        out += ["", "typedef struct {"]
+        for sig in msg.signals:
+            unit = " %s" % sig.unit if sig.unit else ""
+            page = " (multiplexor)" if sig.is_multiplexor else (", page %d" % sig.mux_value if sig.mux_value is not None else "")
+            out.append("    %s %s; // %d bit, x%g%s%s" % (sig.ctype, sig.name, sig.length, sig.factor, unit, page))
+        out += ["} %s_t;" % msg.name, ""]
+        out += gen_pack(msg)
+        out.append("")
+        out += gen_unpack(msg)
+    out.append("")
+    return "\n".join(out)
+
+
+def c_float(value):
+    text = repr(float(value))
+    return text + "f" if ("." in text or "e" in text) else text + ".0f"
+
+
+def gen_source(messages, dbc_name):
+    out = [
+        "// Generated by dbc/dbc2c.py from %s - do not edit." % dbc_name,
+        "#include <stddef.h>",
+        "#include <stdint.h>",
+        "",
+        '#include "inc/can_signals.h"',
+        "",
+    ]
+    for msg in messages:
+        out.append("static const can_signal_def_t %s_signals[] = {" % msg.name)
+        for sig in msg.signals:
+            out.append('    { "%s", %d, %d, %s, %s, %s, "%s", %d },' % (
+                sig.name, sig.start, sig.length, "true" if sig.signed else "false",
+                c_float(sig.factor), c_float(sig.offset), sig.unit, -1 if sig.mux_value is None else sig.mux_value))
+        out += ["};", ""]
+    out.append("const can_message_schema_t can_schema[] = {")
+    for msg in messages:
+        mux = msg.signals.index(msg.multiplexor) if msg.multiplexor else -1
+        out.append('    { 0x%03X, "%s", %d, %d, %s_signals, %d },' % (msg.id, msg.name, msg.dlc, len(msg.signals), msg.name, mux))
+    out += [
+        "};",
+        "",
+        "const size_t can_schema_count = sizeof(can_schema) / sizeof(can_schema[0]);",
+        "",
+        "/**",
+        " * @brief Finds the schema for a message identifier (binary search, table is sorted by ID).",
+        " *",
+        " * @param id The CAN identifier",
+        " * @return The message schema, or NULL if the ID is not in the DBC",
+        " */",
+        "const can_message_schema_t *canSchemaFind(uint32_t id) {",
+        "    size_t lo = 0, hi = can_schema_count;",
+        "    while (lo < hi) {",
+        "        size_t mid = (lo + hi) / 2;",
+        "        if (can_schema[mid].id == id) return &can_schema[mid];",
+        "        if (can_schema[mid].id < id) lo = mid + 1; else hi = mid;",
+        "    }",
+        "    return NULL;",
+        "}",
+        "",
+        "/**",
+        " * @brief Extracts the raw value of a little-endian signal from a data field.",
+        " *",
+        " * Generic counterpart to the generated *_unpack functions, used where the",
+        " * message is only known at runtime (log converters, host decoders).",
+        " */",
+        "int32_t canSignalRaw(const can_signal_def_t *sig, const uint8_t *data) {",
+        "    uint32_t raw = 0;",
+        "    for (uint8_t i = 0; i < sig->length; i++) {",
+        "        uint16_t bit = sig->start + i;",
+        "        raw |= (uint32_t)((data[bit / 8] >> (bit % 8)) & 1u) << i;",
+        "    }",
+        "    if (sig->is_signed && sig->length < 32 && (raw & (1u << (sig->length - 1)))) {",
+        "        raw |= ~0u << sig->length;",
+        "    }",
+        "    return (int32_t)raw;",
+        "}",
+        "",
+        "/**",
+        " * @brief Extracts a signal and applies its DBC factor and offset.",
+        " */",
+        "float canSignalPhysical(const can_signal_def_t *sig, const uint8_t *data) {",
+        "    int32_t raw = canSignalRaw(sig, data);",
+        "    float value = sig->is_signed ? (float)raw : (float)(uint32_t)raw;",
+        "    return value * sig->factor + sig->offset;",
+        "}",
+        "",
+        "/**",
+        " * @brief Returns true if a signal is carried by this frame, i.e. it is not",
+        " *        multiplexed or the frame's multiplexor selects its page.",
+        " */",
+        "bool canSignalPresent(const can_message_schema_t *msg, const can_signal_def_t *sig, const uint8_t *data) {",
+        "    if (sig->mux < 0 || msg->mux_signal < 0) return true;",
+        "    return canSignalRaw(&msg->signals[msg->mux_signal], data) == sig->mux;",
+        "}",
+        "",
+    ]
+    return "\n".join(out)
+
+
+def main():
+    dbc = sys.argv[1] if len(sys.argv) > 1 else DEFAULT_DBC
+    header = sys.argv[2] if len(sys.argv) > 2 else DEFAULT_HEADER
+    source = sys.argv[3] if len(sys.argv) > 3 else DEFAULT_SOURCE
+    messages = parse(dbc)
+    name = os.path.basename(dbc)
+    with open(header, "w", encoding="ascii", newline="\n") as f:
+        f.write(gen_header(messages, name))
+    with open(source, "w", encoding="ascii", newline="\n") as f:
+        f.write(gen_source(messages, name))
+    print("Generated %d messages -> %s, %s" % (len(messages), header, source))
+
+
+if __name__ == "__main__":
+    main()
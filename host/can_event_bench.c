@@ -0,0 +1,233 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "esp_err.h"
+#include "inc/can_sched.h"
+#include "inc/can_signals.h"
+#include "inc/channels.h"
+
+/**
+ * @brief Compares the polling and event-driven CAN transmit designs on a virtual clock.
+ *
+ * Sweeps are published every SWEEP_US, as the ADC task does at 20 kHz over
+ * ten channels. Inputs 1 and 4 step between two levels at irregular times
+ * and every channel carries noise inside its deadband; change marking runs
+ * through the real channel pipeline and frames through the real scheduler
+ * and message table. The polling design runs the scheduler on every
+ * FreeRTOS tick. The event-driven design wakes when a sweep changes a
+ * channel or when its next frame is due, as canTransmit() does with
+ * CONFIG_CANBOARD_CAN_TX_EVENT_DRIVEN. Reports transmit task wakeups per
+ * second, frame rate and bus load, and the latency from each step to the
+ * first 0x620 (input 1 voltage) and 0x623 (charge cooler inlet pressure)
+ * frame that shows it.
+ *
+ * Exits non-zero if the event-driven design misses a step, leaves a message
+ * without a frame for longer than its period, or is not faster than polling.
+ *
+ * Usage: can_event_bench [seconds] [steps per second]
+ */
+
+#define SWEEP_US 2500              // 10 channels x 5 samples at 20 kHz
+#define TICK_US (CAN_SCHED_TICK_MS * 1000u)
+#define FILTER_DELAY_US 1500       // A 5-deep median at 2 kHz per channel follows a step on its third sample
+#define STEP_CHANNEL_A 0           // Input 1, in 0x620 and 0x623
+#define STEP_CHANNEL_B 3           // Input 4, in 0x621 and 0x624
+#define STEP_LOW_MV 1500
+#define STEP_HIGH_MV 3500
+#define BASE_MV 2500
+#define NOISE_MV 8                 // Peak noise after filtering, inside PRESSURE_DEADBAND_MV
+#define BITRATE 500000
+#define MAX_STEPS 4096
+
+typedef struct {
+    const char *name;
+    uint32_t id;
+    uint64_t latency_us[MAX_STEPS];
+    size_t steps;
+    size_t missed;
+    bool pending;
+} latency_track_t;
+
+typedef struct {
+    bool event;
+    uint64_t now_us;
+    uint64_t wakeups;
+    uint64_t frames;
+    uint64_t bits;
+    uint64_t last_frame_us[CAN_SCHED_MAX_MESSAGES];
+    uint32_t max_gap_us[CAN_SCHED_MAX_MESSAGES];
+    bool step_high;
+    uint64_t step_us;
+    uint16_t pressure_mid;     // 0x623 charge cooler inlet pressure at the step midpoint
+    latency_track_t voltage;
+    latency_track_t pressure;
+} bench_t;
+
+static uint32_t rng;
+static uint32_t xorshift(void) {
+    rng ^= rng << 13;
+    rng ^= rng >> 17;
+    rng ^= rng << 5;
+    return rng;
+}
+
+static int caliIdentity(void *ctx, int channel, int raw) { return raw; }
+
+static void trackLatency(bench_t *b, latency_track_t *t, bool crossed) {
+    if (!t->pending || !crossed) return;
+    if (t->steps < MAX_STEPS) t->latency_us[t->steps++] = b->now_us - b->step_us;
+    t->pending = false;
+}
+
+/**
+ * @brief Transmit hook: the bus always accepts, frames are timed and decoded on the spot.
+ */
+static esp_err_t benchTransmit(void *ctx, const can_frame_t *frame) {
+    bench_t *b = ctx;
+    b->frames++;
+    b->bits += canFrameBits(frame->dlc, false);
+
+    for (size_t i = 0; i < can_messages_count; i++) {
+        if (can_messages[i].id != frame->id) continue;
+        if (b->last_frame_us[i] != 0 && b->now_us - b->last_frame_us[i] > b->max_gap_us[i]) {
+            b->max_gap_us[i] = (uint32_t)(b->now_us - b->last_frame_us[i]);
+        }
+        b->last_frame_us[i] = b->now_us;
+    }
+
+    uint16_t mid_mv = (STEP_LOW_MV + STEP_HIGH_MV) / 2;
+    if (frame->id == ANALOG_VOLTAGE_1_ID) {
+        analogVoltage_1_t m;
+        analogVoltage_1_unpack(&m, frame->data);
+        trackLatency(b, &b->voltage, (m.input1_voltage >= mid_mv) == b->step_high);
+    } else if (frame->id == SENSOR_VALUES_1_ID) {
+        sensorValues_1_t m;
+        sensorValues_1_unpack(&m, frame->data);
+        trackLatency(b, &b->pressure, (m.chargeCoolerInletPressure >= b->pressure_mid) == b->step_high);
+    }
+    return ESP_OK;
+}
+
+/**
+ * @brief Builds the next sweep: filtered step levels plus noise, converted and change-marked.
+ *
+ * @return Bit mask of the channels that moved past their deadband
+ */
+static uint32_t publishSweep(bench_t *b, channel_pipeline_t *pipeline, sensor_values_t *values) {
+    bool settled = b->step_us != 0 && b->now_us - b->step_us >= FILTER_DELAY_US;
+    bool high = settled ? b->step_high : !b->step_high;
+    for (int ch = 0; ch < SNAPSHOT_NUM_CHANNELS; ch++) {
+        int mv = (ch == STEP_CHANNEL_A || ch == STEP_CHANNEL_B) ? (high ? STEP_HIGH_MV : STEP_LOW_MV) : BASE_MV;
+        values->filtered_mv[ch] = (uint16_t)(mv + (int)(xorshift() % (2 * NOISE_MV + 1)) - NOISE_MV);
+    }
+    channelsConvert(pipeline, values);
+    values->timestamp_us = b->now_us;
+    values->sweep++;
+    return channelsMarkChanges(pipeline, values);
+}
+
+static void runDesign(bench_t *b, bool event, double seconds, double steps_per_s) {
+    static channel_pipeline_t pipeline;
+    static can_sched_t sched;
+    sensor_values_t values = { .valid = SNAPSHOT_ALL_CHANNELS };
+
+    memset(b, 0, sizeof(*b));
+    b->event = event;
+    b->voltage = (latency_track_t){ .name = "input 1 voltage", .id = ANALOG_VOLTAGE_1_ID };
+    b->pressure = (latency_track_t){ .name = "cc inlet pressure", .id = SENSOR_VALUES_1_ID };
+    const channel_desc_t *d = &channel_table[STEP_CHANNEL_A];
+    b->pressure_mid = getSensorPressure((STEP_LOW_MV + STEP_HIGH_MV) / 2, d->linear.v_min_mv, d->linear.v_max_mv,
+                                       d->linear.out_min, d->linear.out_max);
+
+    rng = 0x9E3779B9u; // Both designs see the same steps and noise
+    ESP_ERROR_CHECK(channelsInit(&pipeline, channel_table, SNAPSHOT_NUM_CHANNELS, caliIdentity, NULL));
+    ESP_ERROR_CHECK(canSchedInit(&sched, can_messages, can_messages_count, 0, benchTransmit, b));
+    canSchedSetOnChange(&sched, event);
+
+    const uint64_t end_us = (uint64_t)(seconds * 1e6);
+    const uint64_t step_period_us = (uint64_t)(1e6 / steps_per_s);
+    uint64_t next_sweep = SWEEP_US, next_step = step_period_us / 2, wake_at = 0;
+    bool notified = false;
+
+    for (b->now_us = 0; b->now_us < end_us; b->now_us++) {
+        uint64_t now = b->now_us;
+        if (now == next_step) {
+            for (latency_track_t *t = &b->voltage; t <= &b->pressure; t++) t->missed += t->pending;
+            b->step_high = !b->step_high;
+            b->step_us = now;
+            b->voltage.pending = b->pressure.pending = true;
+            next_step += step_period_us - step_period_us / 8 + xorshift() % (step_period_us / 4);
+        }
+        if (now == next_sweep) {
+            notified |= publishSweep(b, &pipeline, &values) != 0;
+            next_sweep += SWEEP_US;
+        }
+
+        uint32_t now_ms = (uint32_t)(now / TICK_US) * CAN_SCHED_TICK_MS; // The tick count, as the task sees it
+        if (!event) {
+            if (now % TICK_US != 0) continue;
+            b->wakeups++;
+            canSchedRun(&sched, now_ms, &values);
+        } else if (notified || now == wake_at) {
+            b->wakeups++;
+            notified = false;
+            uint32_t next_in = canSchedRun(&sched, now_ms, &values);
+            uint64_t ticks = (next_in + CAN_SCHED_TICK_MS - 1) / CAN_SCHED_TICK_MS;
+            wake_at = (now / TICK_US + (ticks ? ticks : 1)) * TICK_US;
+        }
+    }
+}
+
+static int compareU64(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+static double reportLatency(latency_track_t *t) {
+    qsort(t->latency_us, t->steps, sizeof(t->latency_us[0]), compareU64);
+    double sum = 0;
+    for (size_t i = 0; i < t->steps; i++) sum += (double)t->latency_us[i];
+    double avg = t->steps ? sum / t->steps / 1e3 : 0;
+    double p99 = t->steps ? t->latency_us[(t->steps * 99) / 100] / 1e3 : 0;
+    double max = t->steps ? t->latency_us[t->steps - 1] / 1e3 : 0;
+    printf("    0x%03X %-17s %4zu steps, %zu missed, latency avg %5.2f p99 %5.2f max %5.2f ms\n", (unsigned)t->id, t->name,
+           t->steps, t->missed, avg, p99, max);
+    return p99;
+}
+
+int main(int argc, char **argv) {
+    double seconds = (argc > 1) ? atof(argv[1]) : 60.0;
+    double steps_per_s = (argc > 2) ? atof(argv[2]) : 4.0;
+    if (seconds <= 0.0 || steps_per_s <= 0.0 || steps_per_s > 100.0) {
+        fprintf(stderr, "usage: %s [seconds] [steps per second, up to 100]\n", argv[0]);
+        return 1;
+    }
+
+    static bench_t designs[2];
+    double p99[2][2];
+    int failures = 0;
+    for (int e = 0; e < 2; e++) {
+        bench_t *b = &designs[e];
+        runDesign(b, e == 1, seconds, steps_per_s);
+        printf("%s: %.0f transmit wakeups/s (+%u ADC sweeps/s), %.0f frames/s, bus load %.1f%%\n",
+               e ? "event-driven" : "polling", b->wakeups / seconds, 1000000u / SWEEP_US, b->frames / seconds,
+               100.0 * b->bits / (seconds * BITRATE));
+        p99[e][0] = reportLatency(&b->voltage);
+        p99[e][1] = reportLatency(&b->pressure);
+        for (size_t i = 0; i < can_messages_count; i++) {
+            bool late = b->max_gap_us[i] > can_messages[i].period_ms * 1000u;
+            printf("    0x%03X max gap %6.2f ms (period %u ms)%s\n", (unsigned)can_messages[i].id, b->max_gap_us[i] / 1e3,
+                   can_messages[i].period_ms, late ? "  LATE" : "");
+            failures += late;
+        }
+    }
+
+    const bench_t *ev = &designs[1];
+    bool missed = ev->voltage.missed || ev->pressure.missed || ev->voltage.steps == 0 || ev->pressure.steps == 0;
+    bool faster = p99[1][0] < p99[0][0] && p99[1][1] < p99[0][1];
+    failures += missed + !faster;
+    printf("result wakeups_polling=%.0f wakeups_event=%.0f p99_polling_ms=%.2f p99_event_ms=%.2f%s\n",
+           designs[0].wakeups / seconds, ev->wakeups / seconds, p99[0][0], p99[1][0], failures ? "  MISMATCH" : "");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,203 @@
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "esp_err.h"
+#include "inc/can_sched.h"
+#include "inc/can_signals.h"
+#include "inc/can_tx.h"
+#include "inc/inputs.h"
+#include "flash_file.h"
+#include "sim.h"
+
+/**
+ * @brief Runs the whole firmware against a faulty TWAI bus and measures how it recovers.
+ *
+ * app_main() runs on the ESP-IDF shims as in firmware_sim, with every input
+ * held steady so the board sends only its scheduled frames. The harness then
+ * injects faults through the shim's TWAI controller:
+ *  - two bus-offs, after which the supervisor must recover and restart the
+ *    controller with no power cycle;
+ *  - a disconnected bus (nothing acknowledges) for DISCONNECT_MS, during
+ *    which input 1 steps twice. On reconnection the stale frames that were
+ *    stuck in the driver go out, then the newest value must follow.
+ *
+ * For each fault it reports the time until frames flow again and how many
+ * scheduled frames never reached the bus, and for the disconnection how
+ * many stale ANALOG_VOLTAGE_1 frames came out of the backlog. A plain FIFO
+ * in front of the driver would replay up to the whole 64-frame TX queue.
+ * Exits non-zero if a fault is not recovered from, the backlog holds more
+ * than the driver's in-flight limit, the newest value does not follow it,
+ * or (with CONFIG_CANBOARD_DIAG) a system load frame flags a task with less
+ * than LOAD_STACK_MARGIN of its stack never used: the fault paths are the
+ * deepest the supervisor goes.
+ *
+ * Usage: can_fault_sim [speed] [log level 0-5]
+ */
+
+#define RUN_MS 4000
+#define BUS_OFF_1_MS 1000
+#define BUS_OFF_2_MS 1500
+#define DISCONNECT_MS 500
+#define DISCONNECT_AT_MS 2000
+#define STEP_CHANNEL 0
+#define LEVEL_BEFORE_RAW 1000
+#define LEVEL_DURING_RAW 2000   // Set while disconnected, superseded before reconnection
+#define LEVEL_NEWEST_RAW 3000
+#define LOSS_WINDOW_MS 200      // Scheduled frames are counted from the fault to this long after it clears
+#define RECOVERY_LIMIT_MS 50
+#define MAX_FRAMES (1 << 16)
+
+typedef struct {
+    uint64_t ns;
+    uint32_t id;
+    uint16_t input1_mv;
+} frame_rec_t;
+
+static struct {
+    pthread_mutex_t lock;
+    frame_rec_t frames[MAX_FRAMES];
+    size_t count;
+    uint8_t low_stack;          // lowStackTasks of every system load frame, ORed
+} bus = { .lock = PTHREAD_MUTEX_INITIALIZER };
+
+static void onTransmit(void *ctx, const twai_message_t *msg) {
+    pthread_mutex_lock(&bus.lock);
+    if (bus.count < MAX_FRAMES) {
+        frame_rec_t *r = &bus.frames[bus.count++];
+        *r = (frame_rec_t){ .ns = simNowNs(), .id = msg->identifier };
+        if (msg->identifier == ANALOG_VOLTAGE_1_ID) {
+            analogVoltage_1_t m;
+            analogVoltage_1_unpack(&m, msg->data);
+            r->input1_mv = m.input1_voltage;
+        } else if (msg->identifier == SYSTEM_LOAD_ID) {
+            systemLoad_t m;
+            systemLoad_unpack(&m, msg->data);
+            bus.low_stack |= m.lowStackTasks;
+        }
+    }
+    pthread_mutex_unlock(&bus.lock);
+}
+
+/**
+ * @brief Index of the first frame sent at or after `ns`, or bus.count.
+ */
+static size_t firstFrameFrom(uint64_t ns) {
+    size_t i = 0;
+    while (i < bus.count && bus.frames[i].ns < ns) i++;
+    return i;
+}
+
+/**
+ * @brief Scheduled frames missing between `from_ns` and `to_ns`, summed over the message table.
+ */
+static uint32_t framesLost(uint64_t from_ns, uint64_t to_ns) {
+    uint32_t lost = 0;
+    for (size_t m = 0; m < can_messages_count; m++) {
+        uint32_t expected = (uint32_t)((to_ns - from_ns) / (can_messages[m].period_ms * 1000000ull));
+        uint32_t seen = 0;
+        for (size_t i = firstFrameFrom(from_ns); i < bus.count && bus.frames[i].ns < to_ns; i++) {
+            seen += bus.frames[i].id == can_messages[m].id;
+        }
+        if (seen < expected) lost += expected - seen;
+    }
+    return lost;
+}
+
+static void sleepUntilMs(uint32_t ms) { simSleepUntilNs(ms * 1000000ull); }
+
+extern void app_main(void);
+
+int main(int argc, char **argv) {
+    double speed = (argc > 1) ? strtod(argv[1], NULL) : 10.0;
+    int level = (argc > 2) ? atoi(argv[2]) : ESP_LOG_WARN;
+    if (speed <= 0.0) {
+        fprintf(stderr, "usage: %s [speed] [log level 0-5]\n", argv[0]);
+        return 1;
+    }
+
+    simLogLevel((esp_log_level_t)level);
+    synthetic_adc_t *src = simAdcSource();
+    for (int ch = 0; ch < ADC_STREAM_NUM_CHANNELS; ch++) src->amplitude[ch] = 0;
+    src->level[STEP_CHANNEL] = LEVEL_BEFORE_RAW;
+
+    static flash_file_t ff;
+    ESP_ERROR_CHECK(flashFileOpen(&ff, NULL, 16 * CAN_LOG_SEGMENT_BYTES));
+    simFlashAttach("canlog", &ff);
+    simTwaiSetTxSink(onTransmit, NULL);
+
+    simInit(speed);
+    app_main();
+
+    const uint32_t bus_offs[] = { BUS_OFF_1_MS, BUS_OFF_2_MS };
+    for (size_t i = 0; i < sizeof(bus_offs) / sizeof(bus_offs[0]); i++) {
+        sleepUntilMs(bus_offs[i]);
+        simTwaiBusOff();
+    }
+    sleepUntilMs(DISCONNECT_AT_MS);
+    simTwaiSetConnected(false);
+    sleepUntilMs(DISCONNECT_AT_MS + DISCONNECT_MS / 4);
+    simAdcSetLevel(STEP_CHANNEL, LEVEL_DURING_RAW);
+    sleepUntilMs(DISCONNECT_AT_MS + DISCONNECT_MS / 2);
+    simAdcSetLevel(STEP_CHANNEL, LEVEL_NEWEST_RAW);
+    sleepUntilMs(DISCONNECT_AT_MS + DISCONNECT_MS);
+    uint64_t reconnect_ns = simNowNs();
+    simTwaiSetConnected(true);
+    sleepUntilMs(RUN_MS);
+
+    pthread_mutex_lock(&bus.lock);
+    int failures = 0;
+    printf("tx: %zu frames in %u ms\n", bus.count, RUN_MS);
+
+    for (size_t i = 0; i < sizeof(bus_offs) / sizeof(bus_offs[0]); i++) {
+        uint64_t off_ns = bus_offs[i] * 1000000ull;
+        size_t next = firstFrameFrom(off_ns);
+        double recovery_ms = (next < bus.count) ? (bus.frames[next].ns - off_ns) / 1e6 : -1.0;
+        uint32_t lost = framesLost(off_ns, off_ns + LOSS_WINDOW_MS * 1000000ull);
+        bool ok = recovery_ms >= 0 && recovery_ms <= RECOVERY_LIMIT_MS;
+        printf("bus-off %zu at %u ms: frames again after %.2f ms, %u scheduled frames lost%s\n", i + 1,
+               (unsigned)bus_offs[i], recovery_ms, (unsigned)lost, ok ? "" : "  MISMATCH");
+        failures += !ok;
+    }
+
+    // The backlog is what went out in the reconnection burst, before the first frame the firmware queued afterwards
+    size_t first = firstFrameFrom(reconnect_ns), backlog = 0, stale = 0;
+    while (first + backlog < bus.count && bus.frames[first + backlog].ns == bus.frames[first].ns) backlog++;
+    uint16_t newest_mv = 0, during_mv = 0;
+    double fresh_ms = -1.0;
+    for (size_t i = first; i < bus.count; i++) {
+        const frame_rec_t *r = &bus.frames[i];
+        if (r->id != ANALOG_VOLTAGE_1_ID) continue;
+        if (i < first + backlog) {
+            stale++;
+            if (r->input1_mv > during_mv) during_mv = r->input1_mv;
+        } else if (fresh_ms < 0) {
+            newest_mv = r->input1_mv;
+            fresh_ms = (r->ns - reconnect_ns) / 1e6;
+        }
+    }
+    uint64_t disconnect_ns = DISCONNECT_AT_MS * 1000000ull;
+    uint32_t lost = framesLost(disconnect_ns, reconnect_ns + LOSS_WINDOW_MS * 1000000ull);
+    bool newest_ok = fresh_ms >= 0 && newest_mv > during_mv;
+    bool backlog_ok = backlog <= CAN_TX_INFLIGHT_ACTIVE;
+    printf("disconnected %u ms: %zu backlog frames on reconnection (%zu of 0x%03X, limit %d; plain FIFO up to 64)%s\n",
+           (unsigned)DISCONNECT_MS, backlog, stale, ANALOG_VOLTAGE_1_ID, CAN_TX_INFLIGHT_ACTIVE, backlog_ok ? "" : "  MISMATCH");
+    printf("  newest input 1 (%u mV) on the bus %.2f ms after reconnection, %u scheduled frames lost%s\n",
+           newest_mv, fresh_ms, (unsigned)lost, newest_ok ? "" : "  MISMATCH");
+    failures += !backlog_ok + !newest_ok;
+    if (bus.low_stack != 0) {
+        printf("tasks under LOAD_STACK_MARGIN stack free: 0x%02X  MISMATCH\n", bus.low_stack);
+        failures++;
+    }
+
+    printf("result bus_off_recovery_ms=%.2f reconnect_fresh_ms=%.2f backlog=%zu%s\n",
+           (firstFrameFrom(BUS_OFF_1_MS * 1000000ull) < bus.count)
+               ? (bus.frames[firstFrameFrom(BUS_OFF_1_MS * 1000000ull)].ns - BUS_OFF_1_MS * 1000000ull) / 1e6 : -1.0,
+           fresh_ms, backlog, failures ? "  MISMATCH" : "");
+    pthread_mutex_unlock(&bus.lock);
+
+    // Firmware tasks never return, so leave without joining them
+    fflush(stdout);
+    _Exit(failures ? 1 : 0);
+}
@@ -0,0 +1,232 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "esp_err.h"
+#include "inc/can_log.h"
+#include "flash_file.h"
+#include "synthetic_adc.h"
+
+/**
+ * @brief Logs a saturated 500 kbit/s bus into a flash stand-in and reads it back.
+ *
+ * Frames with random IDs and DLCs are generated back to back at 500 kbit/s
+ * without stuff bits, the highest frame rate the bus can carry. They are
+ * appended with the board's flush policy while the flash time model tracks
+ * how long each write and erase would keep the logger task busy; the
+ * largest backlog this produces is compared with the receive queue that
+ * buffers frames on the board. The log is then read back and checked
+ * record for record, and a series of simulated power cuts checks that a
+ * remount keeps every block written before the cut and carries on appending.
+ *
+ * Usage: can_log_bench [bus seconds] [flash KiB] [image.bin]
+ */
+
+#define BUS_BITRATE 500000
+#define RX_QUEUE_LEN ((BUS_BITRATE / 47 * 96 + 999) / 1000) // CAN_LOG_QUEUE_LEN in main/inc/can.h at BUS_BITRATE
+#define POWER_CUTS 200
+
+static uint32_t xorshift32(uint32_t *state) {
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return *state = x;
+}
+
+static void makeFrame(uint32_t *rng, uint64_t *now_us, can_log_record_t *rec) {
+    memset(rec, 0, sizeof(*rec));
+    uint32_t r = xorshift32(rng);
+    rec->dlc = r % 9;
+    if ((r >> 4) % 16 == 0) {
+        rec->flags = CAN_LOG_FLAG_EXTENDED;
+        rec->id = xorshift32(rng) & 0x1FFFFFFF;
+    } else {
+        rec->id = (r >> 8) & 0x7FF;
+    }
+    for (int i = 0; i < rec->dlc; i++) rec->data[i] = (uint8_t)xorshift32(rng);
+
+    // SOF to CRC delimiter, ACK, EOF and interframe space with no stuff bits
+    uint32_t bits = ((rec->flags & CAN_LOG_FLAG_EXTENDED) ? 67 : 47) + 8u * rec->dlc;
+    *now_us += (bits * 1000000ull + BUS_BITRATE - 1) / BUS_BITRATE;
+    rec->timestamp_us = *now_us;
+}
+
+static bool sameRecord(const can_log_record_t *a, const can_log_record_t *b) {
+    return a->timestamp_us == b->timestamp_us && a->id == b->id && a->dlc == b->dlc && a->flags == b->flags &&
+           memcmp(a->data, b->data, a->dlc) == 0;
+}
+
+/**
+ * @brief Writes frames[start..start+count) until the flash fails.
+ *
+ * @return The number of leading frames that sit in blocks whose write completed
+ */
+static size_t writeFrames(can_log_t *log, const can_log_record_t *frames, size_t start, size_t count) {
+    size_t durable = start;
+    for (size_t i = start; i < start + count; i++) {
+        uint32_t blocks = log->stats.blocks;
+        if (canLogAppend(log, &frames[i]) != ESP_OK) break;
+        if (canLogFlushDue(log, frames[i].timestamp_us) && canLogFlush(log) != ESP_OK) break;
+        if (log->stats.blocks != blocks) durable = i + 1 - log->block_records;
+    }
+    return durable;
+}
+
+/**
+ * @brief Checks that the log holds frames[0..n) for some n >= `min_count`, then nothing else.
+ */
+static bool readPrefix(const can_log_flash_t *flash, const can_log_record_t *frames, size_t total, size_t min_count, size_t *out_count) {
+    can_log_reader_t reader;
+    can_log_record_t rec;
+    size_t n = 0;
+    if (canLogReaderOpen(&reader, flash) != ESP_OK) return min_count == 0;
+    while (canLogReaderNext(&reader, &rec) == ESP_OK) {
+        if (n >= total || !sameRecord(&rec, &frames[n])) return false;
+        n++;
+    }
+    *out_count = n;
+    return n >= min_count;
+}
+
+static int powerCutTest(uint32_t seed) {
+    enum { CUT_FLASH = 4 * CAN_LOG_SEGMENT_BYTES, CUT_FRAMES = 12000 };
+    can_log_record_t *frames = malloc(CUT_FRAMES * sizeof(*frames));
+    uint32_t rng = seed;
+    uint64_t now = 0;
+    for (size_t i = 0; i < CUT_FRAMES; i++) makeFrame(&rng, &now, &frames[i]);
+
+    int failures = 0;
+    for (int cut = 0; cut < POWER_CUTS; cut++) {
+        flash_file_t ff;
+        can_log_flash_t flash;
+        can_log_t log;
+        flashFileOpen(&ff, NULL, CUT_FLASH);
+        flashFileHal(&ff, &flash);
+
+        // First boot, cut somewhere within the ~70 kB it writes
+        ff.cut_after = xorshift32(&rng) % 70000;
+        size_t half = CUT_FRAMES / 2, durable = 0;
+        if (canLogMount(&log, &flash) == ESP_OK) durable = writeFrames(&log, frames, 0, half);
+
+        // Power returns: the surviving prefix must include every completed block
+        ff.cut_after = -1;
+        size_t kept = 0;
+        bool ok = canLogMount(&log, &flash) == ESP_OK && readPrefix(&flash, frames, half, durable, &kept);
+
+        // Appending after the remount continues the same log
+        if (ok) {
+            can_log_record_t *resumed = malloc(CUT_FRAMES * sizeof(*resumed));
+            memcpy(resumed, frames, kept * sizeof(*resumed));
+            memcpy(&resumed[kept], &frames[half], (CUT_FRAMES - half) * sizeof(*resumed));
+            size_t total = kept + (CUT_FRAMES - half), got = 0;
+            writeFrames(&log, resumed, kept, CUT_FRAMES - half);
+            ok = canLogFlush(&log) == ESP_OK && readPrefix(&flash, resumed, total, total, &got) && ff.violations == 0;
+            free(resumed);
+        }
+        if (!ok) failures++;
+        flashFileClose(&ff);
+    }
+    free(frames);
+    return failures;
+}
+
+int main(int argc, char **argv) {
+    double bus_seconds = (argc > 1) ? atof(argv[1]) : 60.0;
+    uint32_t flash_kib = (argc > 2) ? (uint32_t)strtoul(argv[2], NULL, 10) : 2048;
+    const char *image = (argc > 3) ? argv[3] : NULL;
+
+    flash_file_t ff;
+    can_log_flash_t flash;
+    esp_err_t err = flashFileOpen(&ff, NULL, flash_kib * 1024);
+    if (err != ESP_OK) {
+        printf("flashFileOpen failed: %s\n", esp_err_to_name(err));
+        return 1;
+    }
+    flashFileHal(&ff, &flash);
+
+    static can_log_t log;
+    ESP_ERROR_CHECK(canLogMount(&log, &flash));
+
+    // Generate the whole capture up front so timing covers only the logger
+    size_t capacity = (size_t)(bus_seconds * BUS_BITRATE / 47) + 1, count = 0;
+    can_log_record_t *frames = malloc(capacity * sizeof(*frames));
+    uint64_t *done_us = malloc(capacity * sizeof(*done_us));
+    uint32_t rng = 0x2545F491;
+    uint64_t now = 0, end = (uint64_t)(bus_seconds * 1e6);
+    while (count < capacity) {
+        makeFrame(&rng, &now, &frames[count]);
+        if (now > end) break;
+        count++;
+    }
+
+    // Frames are handled in arrival order; a flush keeps the logger busy for the modeled flash time
+    uint64_t busy_until = 0, flash_us = 0, t0 = hostMonotonicNs();
+    size_t oldest = 0, max_backlog = 0;
+    for (size_t i = 0; i < count; i++) {
+        uint64_t arrive = frames[i].timestamp_us;
+        uint64_t start = arrive > busy_until ? arrive : busy_until;
+        uint64_t before = ff.model_us;
+        canLogAppend(&log, &frames[i]);
+        bool idle = (i + 1 == count || frames[i + 1].timestamp_us > start + (ff.model_us - before));
+        if (idle && canLogFlushDue(&log, start)) canLogFlush(&log); // The logger task only flushes by age once the queue is drained
+        busy_until = start + (ff.model_us - before);
+        flash_us += ff.model_us - before;
+        done_us[i] = busy_until;
+
+        while (oldest < i && done_us[oldest] <= arrive) oldest++;
+        if (i - oldest > max_backlog) max_backlog = i - oldest;
+    }
+    canLogFlush(&log);
+    double host_ns = (double)(hostMonotonicNs() - t0) / count;
+
+    // Read back: the log holds the newest frames, ending exactly at the last one
+    can_log_reader_t reader;
+    can_log_record_t rec;
+    size_t read = 0, first = count, mismatches = 0;
+    if (canLogReaderOpen(&reader, &flash) == ESP_OK) {
+        while (canLogReaderNext(&reader, &rec) == ESP_OK) {
+            if (read == 0) {
+                for (first = 0; first < count && frames[first].timestamp_us != rec.timestamp_us; first++) {}
+            }
+            if (first + read >= count || !sameRecord(&rec, &frames[first + read])) mismatches++;
+            read++;
+        }
+    }
+    bool tail_ok = (mismatches == 0 && first + read == count);
+
+    uint32_t min_erase = UINT32_MAX, max_erase = 0;
+    for (uint32_t s = 0; s < ff.size / FLASH_FILE_SECTOR_BYTES; s++) {
+        if (ff.sector_erases[s] < min_erase) min_erase = ff.sector_erases[s];
+        if (ff.sector_erases[s] > max_erase) max_erase = ff.sector_erases[s];
+    }
+
+    printf("bus: %zu frames in %.1f s (%.0f frames/s at 500 kbit/s, no stuff bits)\n", count, bus_seconds, count / bus_seconds);
+    printf("log: %.2f bytes/frame on flash, %u blocks, %u segments, %u sector erases (per sector %u..%u), %u write errors, %u NOR violations\n",
+           (double)log.stats.bytes / count, log.stats.blocks, log.stats.segments, log.stats.sectors_erased, min_erase, max_erase,
+           log.stats.write_errors, ff.violations);
+    printf("host: %.1f ns/frame to encode and write\n", host_ns);
+    printf("target model: flash busy %.1f%% of bus time, worst backlog %zu frames (queue %d) -> %s\n",
+           100.0 * flash_us / (bus_seconds * 1e6), max_backlog, RX_QUEUE_LEN, max_backlog < RX_QUEUE_LEN ? "no drops" : "DROPS");
+    printf("read back: %zu frames (newest %.1f s of the capture), %s\n", read,
+           read ? (frames[count - 1].timestamp_us - frames[first].timestamp_us) / 1e6 : 0.0, tail_ok ? "identical" : "MISMATCH");
+
+    int cut_failures = powerCutTest(rng);
+    printf("power cuts: %d/%d remounts lost a completed block or failed to resume\n", cut_failures, POWER_CUTS);
+
+    if (image != NULL) {
+        FILE *f = fopen(image, "wb");
+        if (f == NULL || fwrite(ff.mem, 1, ff.size, f) != ff.size) {
+            perror(image);
+            return 1;
+        }
+        fclose(f);
+        printf("image written to %s\n", image);
+    }
+
+    uint32_t violations = ff.violations;
+    free(frames);
+    free(done_us);
+    flashFileClose(&ff);
+    return (tail_ok && cut_failures == 0 && violations == 0) ? 0 : 1;
+}
@@ -0,0 +1,96 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "esp_err.h"
+#include "inc/can_log.h"
+#include "inc/can_signals.h"
+#include "flash_file.h"
+
+/**
+ * @brief Converts a CAN log flash image to CSV or Vector ASC.
+ *
+ * The image is a raw dump of the `canlog` partition (for example from
+ * `esptool.py read_flash`) or one written by can_log_bench. CSV rows carry
+ * the timestamp in seconds since boot, the frame and, for IDs in the DBC,
+ * the message name. ASC output uses timestamps relative to the first frame
+ * so it opens directly in CANalyzer, SavvyCAN or python-can.
+ *
+ * Usage: can_log_dump image.bin [--asc]
+ */
+
+static void printCsv(const can_log_record_t *rec) {
+    const can_message_schema_t *schema = (rec->flags & CAN_LOG_FLAG_EXTENDED) ? NULL : canSchemaFind(rec->id);
+    printf("%.6f,0x%03X,%d,%d,%u,", rec->timestamp_us / 1e6, (unsigned)rec->id, (rec->flags & CAN_LOG_FLAG_EXTENDED) != 0,
+           (rec->flags & CAN_LOG_FLAG_RTR) != 0, rec->dlc);
+    for (int i = 0; i < rec->dlc; i++) printf("%02X", rec->data[i]);
+    printf(",%s\n", schema ? schema->name : "");
+}
+
+static void printAsc(const can_log_record_t *rec, uint64_t start_us) {
+    char id[16];
+    snprintf(id, sizeof(id), (rec->flags & CAN_LOG_FLAG_EXTENDED) ? "%Xx" : "%X", (unsigned)rec->id);
+    printf("%11.6f 1  %-15s Rx   %c %u", (rec->timestamp_us - start_us) / 1e6, id, (rec->flags & CAN_LOG_FLAG_RTR) ? 'r' : 'd', rec->dlc);
+    if (!(rec->flags & CAN_LOG_FLAG_RTR)) {
+        for (int i = 0; i < rec->dlc; i++) printf(" %02X", rec->data[i]);
+    }
+    printf("\n");
+}
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s image.bin [--asc]\n", argv[0]);
+        return 1;
+    }
+    bool asc = (argc > 2 && strcmp(argv[2], "--asc") == 0);
+
+    // Work on a copy in memory so the image is never modified
+    FILE *f = fopen(argv[1], "rb");
+    if (f == NULL) {
+        perror(argv[1]);
+        return 1;
+    }
+    fseek(f, 0, SEEK_END);
+    uint32_t size = (uint32_t)ftell(f);
+    fseek(f, 0, SEEK_SET);
+
+    flash_file_t ff;
+    can_log_flash_t flash;
+    esp_err_t err = flashFileOpen(&ff, NULL, size);
+    if (err == ESP_OK && fread(ff.mem, 1, size, f) != size) err = ESP_FAIL;
+    fclose(f);
+    if (err != ESP_OK) {
+        fprintf(stderr, "%s: cannot load image: %s\n", argv[1], esp_err_to_name(err));
+        return 1;
+    }
+    flashFileHal(&ff, &flash);
+
+    static can_log_reader_t reader;
+    err = canLogReaderOpen(&reader, &flash);
+    if (err != ESP_OK) {
+        fprintf(stderr, "%s: no CAN log found: %s\n", argv[1], esp_err_to_name(err));
+        flashFileClose(&ff);
+        return 1;
+    }
+
+    can_log_record_t rec;
+    uint64_t start_us = 0, count = 0;
+    if (asc) {
+        printf("date Thu Jan 1 12:00:00.000 am 1970\nbase hex  timestamps absolute\ninternal events logged\n");
+        printf("Begin Triggerblock Thu Jan 1 12:00:00.000 am 1970\n");
+    } else {
+        printf("time_s,id,extended,rtr,dlc,data,message\n");
+    }
+    while ((err = canLogReaderNext(&reader, &rec)) == ESP_OK) {
+        if (count++ == 0) {
+            start_us = rec.timestamp_us;
+            if (asc) printf("%11.6f Start of measurement\n", 0.0);
+        }
+        if (asc) printAsc(&rec, start_us); else printCsv(&rec);
+    }
+    if (asc) printf("End TriggerBlock\n");
+
+    fprintf(stderr, "%llu frames%s\n", (unsigned long long)count, (err == ESP_ERR_NOT_FOUND) ? "" : ", stopped on a corrupt block");
+    flashFileClose(&ff);
+    return (err == ESP_ERR_NOT_FOUND) ? 0 : 1;
+}
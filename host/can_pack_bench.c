@@ -0,0 +1,184 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "inc/can_sched.h"
+#include "inc/can_signals.h"
+#include "synthetic_adc.h"
+
+/**
+ * @brief Round-trips and times the DBC-generated CAN packers and reports bus load.
+ *
+ * Packs random sweeps through both firmware message tables (16-bit and
+ * packed), decodes every frame with the generic schema decoder and checks
+ * each signal present in the frame against the value the packer was given,
+ * after the packed encoding's scaling and saturation. Multiplexed frames
+ * must also survive the generated unpack and pack unchanged, and every page
+ * must turn up. Then reports the cost of packing a frame with the generated
+ * code and of decoding it with the generic decoder, and the bus load of
+ * each table at 250 kbit/s, 500 kbit/s and 1 Mbit/s.
+ *
+ * Exits non-zero on a mismatch or if the packed table loads the bus more
+ * than the 16-bit one.
+ *
+ * Usage: can_pack_bench [iterations]
+ */
+
+static uint32_t rng = 0xC0FFEEu;
+static uint32_t xorshift(void) {
+    rng ^= rng << 13;
+    rng ^= rng >> 17;
+    rng ^= rng << 5;
+    return rng;
+}
+
+static void randomValues(sensor_values_t *v) {
+    for (int i = 0; i < SNAPSHOT_NUM_CHANNELS; i++) v->filtered_mv[i] = (uint16_t)xorshift();
+    for (int i = SENSOR_SLOT_CC_INLET_PRESSURE; i <= SENSOR_SLOT_TURBO_OIL_PRESSURE; i++) v->outputs[i] = (uint16_t)xorshift();
+    for (int i = SENSOR_SLOT_CC_WATER_TEMP; i <= SENSOR_SLOT_CC_INLET_TEMP; i++) v->outputs[i] = (int8_t)xorshift() * 10;
+    v->cpu_temperature = (int8_t)xorshift();
+    for (int i = 0; i < SNAPSHOT_NUM_CAPTURE; i++) {
+        v->capture_freq[i] = xorshift() >> 9;   // Both sides of the 22-bit field
+        v->capture_duty[i] = (uint16_t)(xorshift() % 1001);
+    }
+}
+
+// Packed fields: `step` snapshot units per bit, rounded, saturating at `max`
+static int32_t scaled(int32_t value, int32_t step, int32_t max) {
+    int32_t raw = value <= 0 ? 0 : (value + step / 2) / step;
+    return raw > max ? max : raw;
+}
+
+// Expected raw value of each signal, in DBC order per message
+static int32_t expected(const sensor_values_t *v, uint32_t id, int sig) {
+    switch (id) {
+        case ANALOG_VOLTAGE_1_ID: return sig == 0 ? v->cpu_temperature : v->filtered_mv[sig - 1];
+        case ANALOG_VOLTAGE_2_ID: return v->filtered_mv[3 + sig];
+        case ANALOG_VOLTAGE_3_ID: return v->filtered_mv[7 + sig];
+        case SENSOR_VALUES_1_ID: {
+            static const sensor_slot_t slots[] = { SENSOR_SLOT_CC_WATER_TEMP, SENSOR_SLOT_AIR_TEMP, SENSOR_SLOT_CC_INLET_TEMP,
+                                                   SENSOR_SLOT_CC_INLET_PRESSURE, SENSOR_SLOT_EXHAUST_BACK_PRESSURE };
+            return sig < 3 ? v->outputs[slots[sig]] / 10 : v->outputs[slots[sig]];
+        }
+        case SENSOR_VALUES_2_ID: return v->outputs[SENSOR_SLOT_CRANK_CASE_PRESSURE + sig];
+        case PACKED_VOLTAGES_ID: return sig == 11 ? v->cpu_temperature : scaled(v->filtered_mv[sig - 1], 2, 0xFFF);
+        case PACKED_SENSORS_ID: {
+            static const sensor_slot_t temps[] = { SENSOR_SLOT_CC_WATER_TEMP, SENSOR_SLOT_AIR_TEMP, SENSOR_SLOT_CC_INLET_TEMP };
+            switch (sig) {
+                case 3: return scaled(v->outputs[SENSOR_SLOT_CC_INLET_PRESSURE], 10, 0xFFF);
+                case 4: return scaled(v->outputs[SENSOR_SLOT_CRANK_CASE_PRESSURE], 10, 0xFFF);
+                case 5: return scaled(v->outputs[SENSOR_SLOT_EXHAUST_BACK_PRESSURE], 50, 0xFF);
+                case 6: return scaled(v->outputs[SENSOR_SLOT_TURBO_OIL_PRESSURE], 5, 0xFF);
+                default: return v->outputs[temps[sig]] / 10;
+            }
+        }
+        case CAPTURE_VALUES_ID: return sig % 2 ? v->capture_duty[sig / 2] : scaled((int32_t)v->capture_freq[sig / 2], 1, 0x3FFFFF);
+        default: return 0;
+    }
+}
+
+/**
+ * @brief Packs `n` random sweeps through a message table and checks every decoded signal.
+ *
+ * @return Number of mismatching signals, or -1 if a message is missing from the schema
+ */
+static int roundTrip(const can_message_def_t *table, size_t count, uint32_t n, uint32_t *pages_seen) {
+    sensor_values_t v = {0};
+    can_pack_state_t state[CAN_SCHED_MAX_MESSAGES] = {0};
+    uint8_t data[8];
+    int mismatches = 0;
+
+    for (uint32_t i = 0; i < n; i++) {
+        randomValues(&v);
+        for (size_t m = 0; m < count; m++) {
+            // Carry instrumentation windows and task load, not the sweep
+            if (table[m].id == DIAGNOSTICS_ID || table[m].id == TASK_LOAD_ID || table[m].id == SYSTEM_LOAD_ID) continue;
+            table[m].pack(&v, data, &state[m]);
+            const can_message_schema_t *schema = canSchemaFind(table[m].id);
+            if (schema == NULL) {
+                printf("0x%03X missing from DBC schema\n", table[m].id);
+                return -1;
+            }
+            for (int s = 0; s < schema->signal_count; s++) {
+                const can_signal_def_t *sig = &schema->signals[s];
+                if (s == schema->mux_signal || !canSignalPresent(schema, sig, data)) continue;
+                int32_t raw = canSignalRaw(sig, data);
+                if (raw != expected(&v, schema->id, s)) {
+                    if (mismatches++ < 10) printf("mismatch %s.%s: %d != %d\n", schema->name, sig->name, raw, expected(&v, schema->id, s));
+                }
+            }
+            if (table[m].id == PACKED_VOLTAGES_ID) {
+                packedVoltages_t msg;
+                uint8_t again[8];
+                packedVoltages_unpack(&msg, data);
+                packedVoltages_pack(&msg, again);
+                *pages_seen |= 1u << msg.voltagePage;
+                if (msg.voltagePage > 2 || memcmp(data, again, sizeof(again)) != 0) {
+                    if (mismatches++ < 10) printf("mismatch packedVoltages page %u does not repack\n", msg.voltagePage);
+                }
+            }
+        }
+    }
+    return mismatches;
+}
+
+static void reportBusLoad(const char *name, const can_message_def_t *table, size_t count, can_bus_load_t *at_500k) {
+    static const uint32_t bitrates[] = { 250000, 500000, 1000000 };
+    can_bus_load_t load = canSchedBusLoad(table, count, bitrates[0]);
+    printf("  %-7s %zu messages, %4u frames/s (%4u):", name, count, (unsigned)load.frames_per_s, (unsigned)load.peak_frames_per_s);
+    for (size_t i = 0; i < sizeof(bitrates) / sizeof(bitrates[0]); i++) {
+        load = canSchedBusLoad(table, count, bitrates[i]);
+        printf("  %4u k %5.1f%% (%5.1f%%)", (unsigned)(bitrates[i] / 1000), load.load * 100.0, load.peak_load * 100.0);
+        if (bitrates[i] == 500000) *at_500k = load;
+    }
+    printf("\n");
+}
+
+int main(int argc, char **argv) {
+    uint32_t iterations = (argc > 1) ? (uint32_t)strtoul(argv[1], NULL, 10) : 1000000;
+    sensor_values_t v = {0};
+    can_pack_state_t state[CAN_SCHED_MAX_MESSAGES] = {0};
+    uint8_t data[8];
+    uint32_t pages = 0;
+
+    int wide = roundTrip(can_messages_wide, can_messages_wide_count, 10000, &pages);
+    int packed = roundTrip(can_messages_packed, can_messages_packed_count, 10000, &pages);
+    if (wide < 0 || packed < 0) return 1;
+    uint32_t mismatches = (uint32_t)(wide + packed) + (pages != 0x7u);
+    printf("round-trip 16-bit: %s (%d mismatches)\n", wide ? "FAIL" : "ok", wide);
+    printf("round-trip packed: %s (%d mismatches, pages seen 0x%x)\n", packed || pages != 0x7u ? "FAIL" : "ok", packed, pages);
+
+    uint32_t sink = 0;
+    uint64_t t0 = hostMonotonicNs();
+    for (uint32_t n = 0; n < iterations; n++) {
+        v.filtered_mv[0] = (uint16_t)n;
+        for (size_t m = 0; m < can_messages_count; m++) {
+            can_messages[m].pack(&v, data, &state[m]);
+            sink += data[n & 7];
+        }
+    }
+    uint64_t pack_ns = hostMonotonicNs() - t0;
+
+    float fsink = 0;
+    t0 = hostMonotonicNs();
+    for (uint32_t n = 0; n < iterations; n++) {
+        data[0] = (uint8_t)n;
+        const can_message_schema_t *schema = &can_schema[n % can_schema_count];
+        for (int s = 0; s < schema->signal_count; s++) fsink += canSignalPhysical(&schema->signals[s], data);
+    }
+    uint64_t decode_ns = hostMonotonicNs() - t0;
+
+    printf("pack (generated):  %.2f ns/frame\n", (double)pack_ns / ((double)iterations * can_messages_count));
+    printf("decode (generic):  %.2f ns/frame\n", (double)decode_ns / iterations);
+    printf("sink: %u %.1f\n", sink, fsink);
+
+    // Bus load at nominal periods, and in brackets with every on-change message at its minimum interval
+    can_bus_load_t wide_load, packed_load;
+    printf("bus load at nominal periods (peak on change in brackets):\n");
+    reportBusLoad("16-bit", can_messages_wide, can_messages_wide_count, &wide_load);
+    reportBusLoad("packed", can_messages_packed, can_messages_packed_count, &packed_load);
+    bool lighter = packed_load.bits_per_s <= wide_load.bits_per_s && packed_load.peak_bits_per_s <= wide_load.peak_bits_per_s;
+    printf("result load_16bit_500k=%.1f%% load_packed_500k=%.1f%%%s\n", wide_load.load * 100.0, packed_load.load * 100.0,
+           (mismatches || !lighter) ? "  MISMATCH" : "");
+    return (mismatches || !lighter) ? 1 : 0;
+}
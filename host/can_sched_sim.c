@@ -0,0 +1,148 @@
+#include <math.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "esp_err.h"
+#include "inc/can_sched.h"
+
+/**
+ * @brief Runs the CAN scheduler against a virtual clock and a modelled bus.
+ *
+ * The scheduler task wakes every CAN_SCHED_TICK_MS with a random wake-up
+ * delay, queues frames into a TWAI-like FIFO, and a 500 kbit/s bus drains
+ * that FIFO using worst-case stuffed frame lengths. Optional foreign traffic
+ * at higher priority competes for the bus. Reports per-ID achieved rate,
+ * inter-frame jitter on the wire and overall bus load.
+ *
+ * Up to NOMINAL_FOREIGN_LOAD foreign load every message must reach its
+ * nominal rate to within RATE_TOLERANCE (or one frame over the run) with
+ * nothing dropped; an ID that misses is marked MISMATCH and the exit code
+ * is 1. Heavier foreign load is only reported.
+ *
+ * Usage: can_sched_sim [seconds] [foreign_load_percent] [max_wake_jitter_us]
+ */
+
+#define BITRATE 500000
+#define TX_QUEUE_LEN 64
+#define MAX_SAMPLES 200000
+#define NOMINAL_FOREIGN_LOAD 0.5
+#define RATE_TOLERANCE 0.01
+
+typedef struct {
+    can_frame_t frames[TX_QUEUE_LEN];
+    int head, count;
+} tx_queue_t;
+
+typedef struct {
+    uint32_t id;
+    uint64_t last_us;
+    uint64_t sent;
+    double sum, sum_sq;
+    double max_dev;
+    uint32_t period_ms;
+} id_stats_t;
+
+static uint32_t rng = 0x9E3779B9u;
+static uint32_t xorshift(void) {
+    rng ^= rng << 13;
+    rng ^= rng >> 17;
+    rng ^= rng << 5;
+    return rng;
+}
+
+static esp_err_t simQueue(void *ctx, const can_frame_t *frame) {
+    tx_queue_t *q = ctx;
+    if (q->count == TX_QUEUE_LEN) return ESP_ERR_TIMEOUT;
+    q->frames[(q->head + q->count) % TX_QUEUE_LEN] = *frame;
+    q->count++;
+    return ESP_OK;
+}
+
+int main(int argc, char **argv) {
+    double seconds = (argc > 1) ? atof(argv[1]) : 10.0;
+    double foreign_load = (argc > 2) ? atof(argv[2]) / 100.0 : 0.0;
+    if (foreign_load > 0.99) foreign_load = 0.99;
+    uint32_t max_jitter_us = (argc > 3) ? (uint32_t)strtoul(argv[3], NULL, 10) : 500;
+
+    tx_queue_t queue = {0};
+    can_sched_t sched;
+    sensor_values_t values = { .valid = SNAPSHOT_ALL_CHANNELS };
+    ESP_ERROR_CHECK(canSchedInit(&sched, can_messages, can_messages_count, 0, simQueue, &queue));
+
+    id_stats_t stats[CAN_SCHED_MAX_MESSAGES] = {0};
+    for (size_t i = 0; i < can_messages_count; i++) {
+        stats[i].id = can_messages[i].id;
+        stats[i].period_ms = can_messages[i].period_ms;
+    }
+
+    const uint64_t end_us = (uint64_t)(seconds * 1e6);
+    const uint64_t tick_us = CAN_SCHED_TICK_MS * 1000ull;
+    const double foreign_bits = canFrameBits(8, false);
+    uint64_t next_tick_us = 0, wake_us = 0;
+    uint64_t bus_free_us = 0, busy_us = 0, foreign_us = 0;
+
+    for (uint64_t now = 0; now < end_us; now++) {
+        if (now == next_tick_us) wake_us = now + (max_jitter_us ? xorshift() % max_jitter_us : 0);
+        if (now == wake_us) {
+            values.sweep++;
+            canSchedRun(&sched, (uint32_t)(next_tick_us / 1000), &values);
+            next_tick_us += tick_us;
+        }
+
+        // Foreign higher-priority traffic arrives as a Poisson process and wins arbitration
+        if (foreign_load > 0.0 && now >= bus_free_us) {
+            uint64_t dur = (uint64_t)(foreign_bits * 1e6 / BITRATE);
+            double p = foreign_load / ((1.0 - foreign_load) * (double)dur);
+            if ((xorshift() / 4294967296.0) < p) {
+                bus_free_us = now + dur;
+                foreign_us += dur;
+            }
+        }
+
+        if (now >= bus_free_us && queue.count > 0) {
+            can_frame_t *f = &queue.frames[queue.head];
+            uint64_t dur = (uint64_t)(canFrameBits(f->dlc, false) * 1e6 / BITRATE + 0.5);
+            for (size_t i = 0; i < can_messages_count; i++) {
+                id_stats_t *s = &stats[i];
+                if (s->id != f->id) continue;
+                if (s->sent > 0) {
+                    double dt = (double)(now - s->last_us) / 1000.0;
+                    double dev = fabs(dt - s->period_ms);
+                    s->sum += dev;
+                    s->sum_sq += dev * dev;
+                    if (dev > s->max_dev) s->max_dev = dev;
+                }
+                s->last_us = now;
+                s->sent++;
+            }
+            queue.head = (queue.head + 1) % TX_QUEUE_LEN;
+            queue.count--;
+            bus_free_us = now + dur;
+            busy_us += dur;
+        }
+    }
+
+    printf("simulated: %.1f s @ %d bit/s, foreign load %.0f%%, wake jitter <= %u us\n",
+           seconds, BITRATE, foreign_load * 100.0, max_jitter_us);
+    printf("%-6s %8s %10s %10s %12s %12s %8s\n", "id", "period", "target Hz", "actual Hz", "jitter avg", "jitter max", "dropped");
+    bool nominal = foreign_load <= NOMINAL_FOREIGN_LOAD;
+    uint32_t failures = 0, dropped = 0;
+    for (size_t i = 0; i < can_messages_count; i++) {
+        id_stats_t *s = &stats[i];
+        double n = s->sent > 1 ? (double)(s->sent - 1) : 1.0;
+        double expected = seconds * 1000.0 / s->period_ms;
+        double error = fabs((double)s->sent - expected);
+        bool ok = !nominal || ((error <= 1.0 || error <= expected * RATE_TOLERANCE) && sched.entries[i].dropped == 0);
+        if (!ok) failures++;
+        dropped += sched.entries[i].dropped;
+        printf("0x%03X %6u ms %10.1f %10.1f %9.3f ms %9.3f ms %8u%s\n", s->id, s->period_ms, 1000.0 / s->period_ms,
+               s->sent / seconds, s->sum / n, s->max_dev, sched.entries[i].dropped, ok ? "" : "  MISMATCH");
+    }
+    printf("bus load: %.2f%% (board), %.2f%% (foreign), %.2f%% (total)\n",
+           100.0 * busy_us / end_us, 100.0 * foreign_us / end_us, 100.0 * (busy_us + foreign_us) / end_us);
+    printf("result bus_load_pct=%.2f dropped=%u failures=%u%s\n", 100.0 * (busy_us + foreign_us) / end_us, (unsigned)dropped,
+           (unsigned)failures, failures ? "  MISMATCH" : (nominal ? "" : "  (above nominal load, not checked)"));
+    return failures ? 1 : 0;
+}
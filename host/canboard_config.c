@@ -0,0 +1,272 @@
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "esp_err.h"
+#include "inc/board_config.h"
+#include "inc/can_rx.h"
+#include "inc/can_signals.h"
+#include "inc/inputs.h"
+#include "flash_file.h"
+#include "sim.h"
+
+/**
+ * @brief Reads and writes the board's runtime configuration over CAN, as a service tool would.
+ *
+ * Boots the whole firmware on the ESP-IDF shims with NVS backed by a file,
+ * so saved values persist between runs as they survive a power cycle on the
+ * board, then talks to it only through boardConfigRequest/Response frames
+ * on the shim's virtual TWAI bus. Commands run in order:
+ *   list                    every parameter and element the board has, with ranges
+ *   get NAME[.INDEX]
+ *   set NAME[.INDEX] VALUE  validated and applied at once, in RAM
+ *   save                    persist the values in use to NVS
+ *   defaults                back to the firmware defaults, in RAM
+ *   status                  CRC of the values in use, and whether they were loaded, are unsaved or need a reboot
+ *   watch MS                frames per second of each broadcast ID over MS ms
+ *   check                   the board refuses every can_base_id that would move a broadcast
+ *                           frame onto a received or config ID, or past 0x7FF, and accepts
+ *                           those next to them; then restores the defaults
+ * INDEX is the ADC channel (0 = input 1) or the entry in the message table.
+ * Exits non-zero if the board refuses or does not answer a request.
+ *
+ * Usage: canboard_config [-f nvs file] [-v] command...
+ */
+
+#define DEFAULT_NVS_FILE "canboard-nvs.bin"
+#define BOOT_MS 20
+#define RESPONSE_TIMEOUT_MS 100
+#define MAX_WATCH_IDS 16
+
+static struct {
+    pthread_mutex_t lock;
+    bool have_response;
+    can_frame_t response;
+    uint32_t watch_ids[MAX_WATCH_IDS];
+    uint32_t watch_frames[MAX_WATCH_IDS];
+    size_t watch_count;
+} bus = { .lock = PTHREAD_MUTEX_INITIALIZER };
+
+static void onTransmit(void *ctx, const twai_message_t *msg) {
+    pthread_mutex_lock(&bus.lock);
+    if (msg->identifier == BOARD_CONFIG_RESPONSE_ID) {
+        bus.response = (can_frame_t){ .id = msg->identifier, .dlc = msg->data_length_code };
+        memcpy(bus.response.data, msg->data, sizeof(bus.response.data));
+        bus.have_response = true;
+    } else {
+        size_t i = 0;
+        while (i < bus.watch_count && bus.watch_ids[i] != msg->identifier) i++;
+        if (i == bus.watch_count && bus.watch_count < MAX_WATCH_IDS) bus.watch_ids[bus.watch_count++] = msg->identifier;
+        if (i < MAX_WATCH_IDS) bus.watch_frames[i]++;
+    }
+    pthread_mutex_unlock(&bus.lock);
+}
+
+/**
+ * @brief Sends one request and waits for the board's response.
+ *
+ * @return True if the board answered; `resp` holds the answer
+ */
+static bool transact(board_config_cmd_t cmd, uint8_t param, uint8_t index, int32_t value, boardConfigResponse_t *resp) {
+    boardConfigRequest_t req = { .configCommand = cmd, .configParam = param, .configIndex = index, .configValue = value };
+    twai_message_t msg = { .identifier = BOARD_CONFIG_REQUEST_ID, .data_length_code = BOARD_CONFIG_REQUEST_DLC };
+    boardConfigRequest_pack(&req, msg.data);
+
+    pthread_mutex_lock(&bus.lock);
+    bus.have_response = false;
+    pthread_mutex_unlock(&bus.lock);
+    if (!simTwaiInject(&msg)) return false;
+
+    uint64_t deadline = simNowNs() + RESPONSE_TIMEOUT_MS * 1000000ull;
+    while (simNowNs() < deadline) {
+        simSleepUntilNs(simNowNs() + 1000000ull);
+        pthread_mutex_lock(&bus.lock);
+        bool have = bus.have_response;
+        if (have) boardConfigResponse_unpack(resp, bus.response.data);
+        pthread_mutex_unlock(&bus.lock);
+        if (have && resp->configCommand == (cmd | BOARD_CONFIG_REPLY)) return true;
+    }
+    fprintf(stderr, "no response to command %d\n", cmd);
+    return false;
+}
+
+/**
+ * @brief Resolves NAME[.INDEX] to a parameter and element.
+ */
+static const board_param_t *parseParam(const char *arg, uint8_t *index) {
+    const char *dot = strchr(arg, '.');
+    size_t len = dot ? (size_t)(dot - arg) : strlen(arg);
+    *index = dot ? (uint8_t)atoi(dot + 1) : 0;
+    for (size_t i = 0; i < board_params_count; i++) {
+        if (strlen(board_params[i].name) == len && strncmp(board_params[i].name, arg, len) == 0) return &board_params[i];
+    }
+    fprintf(stderr, "unknown parameter '%.*s', try 'list'\n", (int)len, arg);
+    return NULL;
+}
+
+static bool checkStatus(const boardConfigResponse_t *resp, const char *what) {
+    if (resp->configStatus == BOARD_CONFIG_OK) return true;
+    fprintf(stderr, "%s: %s\n", what, boardConfigStatusName((board_config_status_t)resp->configStatus));
+    return false;
+}
+
+static void printValue(const board_param_t *p, uint8_t index, int32_t value) {
+    char name[40];
+    if (p->scope == BOARD_PARAM_SCALAR) snprintf(name, sizeof(name), "%s", p->name);
+    else snprintf(name, sizeof(name), "%s.%u", p->name, index);
+    printf("%-18s %8ld   [%ld..%ld]%s\n", name, (long)value, (long)p->min, (long)p->max, p->reboot ? " (after reboot)" : "");
+}
+
+static bool cmdList(void) {
+    boardConfigResponse_t resp;
+    for (size_t i = 0; i < board_params_count; i++) {
+        const board_param_t *p = &board_params[i];
+        for (unsigned index = 0; index < 256; index++) {
+            if (!transact(BOARD_CONFIG_CMD_READ, p->id, (uint8_t)index, 0, &resp)) return false;
+            if (resp.configStatus == BOARD_CONFIG_BAD_INDEX) break;
+            if (!checkStatus(&resp, p->name)) return false;
+            printValue(p, (uint8_t)index, resp.configValue);
+            if (p->scope == BOARD_PARAM_SCALAR) break;
+        }
+    }
+    return true;
+}
+
+static bool cmdStatus(void) {
+    boardConfigResponse_t resp;
+    if (!transact(BOARD_CONFIG_CMD_STATUS, 0, 0, 0, &resp) || !checkStatus(&resp, "status")) return false;
+    printf("crc %08lx, %s, %s%s\n", (unsigned long)(uint32_t)resp.configValue,
+           (resp.configIndex & BOARD_CONFIG_FLAG_LOADED) ? "loaded from NVS at boot" : "defaults at boot",
+           (resp.configIndex & BOARD_CONFIG_FLAG_DIRTY) ? "unsaved changes" : "saved",
+           (resp.configIndex & BOARD_CONFIG_FLAG_REBOOT) ? ", reboot to apply" : "");
+    return true;
+}
+
+/**
+ * @brief Whether a broadcast span from `base` stays clear of every ID the board listens on.
+ */
+static bool baseClear(uint32_t base, uint32_t span) {
+    uint32_t last = base + span;
+    if (last > 0x7FF) return false;
+    if (BOARD_CONFIG_REQUEST_ID >= base && BOARD_CONFIG_REQUEST_ID <= last) return false;
+    if (BOARD_CONFIG_RESPONSE_ID >= base && BOARD_CONFIG_RESPONSE_ID <= last) return false;
+    for (size_t i = 0; i < can_rx_table_count; i++) {
+        if (can_rx_table[i].id >= base && can_rx_table[i].id <= last) return false;
+    }
+    return true;
+}
+
+static bool checkBase(uint32_t base, uint32_t span) {
+    const board_param_t *p = boardParamFind(BOARD_PARAM_CAN_BASE_ID);
+    if (base < (uint32_t)p->min || base > (uint32_t)p->max) return true;
+    boardConfigResponse_t resp;
+    if (!transact(BOARD_CONFIG_CMD_WRITE, p->id, 0, (int32_t)base, &resp)) return false;
+    bool clear = baseClear(base, span);
+    bool ok = clear ? resp.configStatus == BOARD_CONFIG_OK : resp.configStatus == BOARD_CONFIG_INCONSISTENT;
+    printf("can_base_id 0x%03lX..0x%03lX  %s%s\n", (unsigned long)base, (unsigned long)(base + span),
+           boardConfigStatusName((board_config_status_t)resp.configStatus), ok ? "" : "  MISMATCH");
+    return ok;
+}
+
+static bool cmdCheck(void) {
+    uint32_t span = 0;
+    for (size_t i = 0; i < can_messages_count; i++) {
+        if (can_messages[i].id > CAN_BASEID && can_messages[i].id - CAN_BASEID > span) span = can_messages[i].id - CAN_BASEID;
+    }
+    uint32_t listened[CAN_RX_MAX_SUBSCRIPTIONS + 2] = { BOARD_CONFIG_REQUEST_ID, BOARD_CONFIG_RESPONSE_ID };
+    size_t count = 2;
+    for (size_t i = 0; i < can_rx_table_count && count < sizeof(listened) / sizeof(listened[0]); i++) {
+        listened[count++] = can_rx_table[i].id;
+    }
+
+    bool ok = checkBase(0x7FF - span, span) && checkBase(0x7FF - span + 1, span);
+    for (size_t i = 0; ok && i < count; i++) {
+        ok = checkBase(listened[i] - span - 1, span) && checkBase(listened[i] - span, span) && checkBase(listened[i], span) &&
+             checkBase(listened[i] + 1, span);
+    }
+    boardConfigResponse_t resp;
+    return transact(BOARD_CONFIG_CMD_DEFAULTS, 0, 0, 0, &resp) && checkStatus(&resp, "defaults") && ok;
+}
+
+static void cmdWatch(uint32_t ms) {
+    pthread_mutex_lock(&bus.lock);
+    memset(bus.watch_frames, 0, sizeof(bus.watch_frames));
+    pthread_mutex_unlock(&bus.lock);
+    simSleepUntilNs(simNowNs() + ms * 1000000ull);
+    pthread_mutex_lock(&bus.lock);
+    for (size_t i = 0; i < bus.watch_count; i++) {
+        if (bus.watch_frames[i] == 0) continue;
+        printf("0x%03lX %7.1f frames/s\n", (unsigned long)bus.watch_ids[i], bus.watch_frames[i] * 1000.0 / ms);
+    }
+    pthread_mutex_unlock(&bus.lock);
+}
+
+static int usage(const char *argv0) {
+    fprintf(stderr, "usage: %s [-f nvs file] [-v] list | get NAME[.INDEX] | set NAME[.INDEX] VALUE | save | defaults | status | watch MS | check ...\n",
+            argv0);
+    return 2;
+}
+
+extern void app_main(void);
+
+int main(int argc, char **argv) {
+    const char *nvs_file = DEFAULT_NVS_FILE;
+    esp_log_level_t level = ESP_LOG_WARN;
+    int arg = 1;
+    for (; arg < argc && argv[arg][0] == '-'; arg++) {
+        if (strcmp(argv[arg], "-f") == 0 && arg + 1 < argc) nvs_file = argv[++arg];
+        else if (strcmp(argv[arg], "-v") == 0) level = ESP_LOG_INFO;
+        else return usage(argv[0]);
+    }
+    if (arg == argc) return usage(argv[0]);
+
+    simLogLevel(level);
+    static flash_file_t ff;
+    ESP_ERROR_CHECK(flashFileOpen(&ff, NULL, 16 * CAN_LOG_SEGMENT_BYTES));
+    simFlashAttach("canlog", &ff);
+    simNvsAttach(nvs_file);
+    simTwaiSetTxSink(onTransmit, NULL);
+
+    simInit(1.0);
+    app_main();
+    simSleepUntilNs(BOOT_MS * 1000000ull);
+
+    bool ok = true;
+    boardConfigResponse_t resp;
+    uint8_t index;
+    while (ok && arg < argc) {
+        const char *cmd = argv[arg++];
+        const board_param_t *p;
+        if (strcmp(cmd, "list") == 0) {
+            ok = cmdList();
+        } else if (strcmp(cmd, "get") == 0 && arg < argc) {
+            ok = (p = parseParam(argv[arg++], &index)) != NULL && transact(BOARD_CONFIG_CMD_READ, p->id, index, 0, &resp) &&
+                 checkStatus(&resp, p->name);
+            if (ok) printValue(p, index, resp.configValue);
+        } else if (strcmp(cmd, "set") == 0 && arg + 1 < argc) {
+            p = parseParam(argv[arg++], &index);
+            int32_t value = (int32_t)strtol(argv[arg++], NULL, 0);
+            ok = p != NULL && transact(BOARD_CONFIG_CMD_WRITE, p->id, index, value, &resp) && checkStatus(&resp, p->name);
+            if (ok) printValue(p, index, resp.configValue);
+        } else if (strcmp(cmd, "save") == 0) {
+            ok = transact(BOARD_CONFIG_CMD_SAVE, 0, 0, 0, &resp) && checkStatus(&resp, "save");
+            if (ok) printf("saved to %s\n", nvs_file);
+        } else if (strcmp(cmd, "defaults") == 0) {
+            ok = transact(BOARD_CONFIG_CMD_DEFAULTS, 0, 0, 0, &resp) && checkStatus(&resp, "defaults");
+        } else if (strcmp(cmd, "status") == 0) {
+            ok = cmdStatus();
+        } else if (strcmp(cmd, "check") == 0) {
+            ok = cmdCheck();
+        } else if (strcmp(cmd, "watch") == 0 && arg < argc) {
+            cmdWatch((uint32_t)atoi(argv[arg++]));
+        } else {
+            ok = false;
+            usage(argv[0]);
+        }
+    }
+
+    // Firmware tasks never return, so leave without joining them
+    fflush(stdout);
+    _Exit(ok ? 0 : 1);
+}
@@ -0,0 +1,435 @@
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "esp_err.h"
+#include "inc/capture.h"
+#include "inc/channels.h"
+#include "synthetic_adc.h"
+#include "synthetic_edges.h"
+
+/**
+ * @brief Checks the frequency and duty capture against synthetic pulse trains and times it per sweep.
+ *
+ * The counters are modelled as on the ESP32-S3: a pulse counter wrapping at
+ * CAPTURE_COUNTER_MODULUS and capture registers holding the latest edge
+ * times on an 80 MHz timer, read once per sweep, CHANNEL_SWEEP_US apart
+ * plus up to READ_JITTER_US late. A read takes READ_NS, and an edge landing
+ * within it leaves the edge times unlatched, as the glue would find.
+ *
+ * The board's `capture_table` must compile, and malformed tables must be
+ * rejected. Then:
+ *  - steady frequencies from 1 Hz to 10 MHz: every closed window within
+ *    two timer ticks over the window (both ends latched) or one read
+ *    interval or period over the window (otherwise), plus rounding
+ *  - duty from 10 to 90 % at 10 Hz to 10 kHz: within 0.1 % plus two timer
+ *    ticks of the period
+ *  - a frequency step: the old value until the window straddling the step,
+ *    a value between the two for that window, the new one after
+ *  - a stop: the last value until `timeout_ms` after the last edge, 0 Hz
+ *    within one read after that, and duty at the level the signal stopped
+ *    at; then the new frequency within two windows of edges resuming
+ *  - a read CAPTURE_MAX_GAP_US late at 1 MHz, with the counter wrapping
+ *    unseen: no window published across it
+ *  - the highest frequency tracked, found by bisection, against the
+ *    counter's limit of CAPTURE_COUNTER_MODULUS - 1 edges per read interval
+ *
+ * Then captureUpdate() is timed for CAPTURE_MAX_INPUTS inputs over
+ * recorded reads: ns per sweep and the share of the sweep period.
+ *
+ * Exits non-zero on any mismatch.
+ *
+ * Usage: capture_bench [bench sweeps]
+ */
+
+#define TIMER_HZ 80000000u      // MCPWM capture timer on the S3 (APB clock)
+#define READ_NS 400             // Three capture registers and the pulse counter
+#define READ_JITTER_US 250      // Latest a sweep's read lands after its due time
+#define WINDOW_MS 100
+#define TIMEOUT_MS 1000
+
+static uint32_t rng = 0x2545F491u;
+static uint32_t xorshift(void) {
+    rng ^= rng << 13;
+    rng ^= rng >> 17;
+    rng ^= rng << 5;
+    return rng;
+}
+
+static int failures;
+
+static void expect(bool ok, const char *what) {
+    if (!ok) {
+        printf("  %s  MISMATCH\n", what);
+        failures++;
+    }
+}
+
+/**
+ * @brief One input's counters and the time of the sweeps reading them.
+ */
+typedef struct {
+    synthetic_edges_t sig;
+    capture_t cap;
+    capture_desc_t desc;
+    sensor_values_t values;
+    uint64_t due_us;            // Next sweep, before jitter
+    uint64_t now_us;            // Time of the last read
+    capture_raw_t raw;          // The last read
+    bool closed;                // The last read closed a window
+    bool close_latched;         // Both ends of that window latched
+    uint64_t span_us;           // And the time it covered
+    bool anchor_latched;
+    uint64_t anchor_us;
+} rig_t;
+
+static void rigInit(rig_t *rig, capture_mode_t mode, uint16_t window_ms, uint16_t timeout_ms) {
+    memset(rig, 0, sizeof(*rig));
+    syntheticEdgesInit(&rig->sig);
+    rig->desc = (capture_desc_t){ .name = "bench", .input = 0, .mode = mode, .window_ms = window_ms, .timeout_ms = timeout_ms };
+    ESP_ERROR_CHECK(captureInit(&rig->cap, &rig->desc, 1, TIMER_HZ));
+    rig->due_us = CHANNEL_SWEEP_US;
+}
+
+static uint32_t toTicks(double ns) { return ns < 0 ? 0 : (uint32_t)(uint64_t)floor(ns * (TIMER_HZ / 1e9)); }
+
+/**
+ * @brief Reads the counters at `t_us` as the glue would, and runs the capture.
+ */
+static void rigReadAt(rig_t *rig, uint64_t t_us) {
+    uint64_t t_ns = t_us * 1000u;
+    uint64_t edges = syntheticEdgesCount(&rig->sig, t_ns);
+    rig->raw = (capture_raw_t){
+        .edges = (uint16_t)(edges % CAPTURE_COUNTER_MODULUS),
+        .rise_ticks = toTicks(syntheticEdgesLastRise(&rig->sig, t_ns)),
+        .fall_ticks = toTicks(syntheticEdgesLastFall(&rig->sig, t_ns)),
+        .latched = syntheticEdgesCount(&rig->sig, t_ns + READ_NS) == edges,
+    };
+    rig->now_us = t_us;
+    captureUpdate(&rig->cap, &rig->raw, t_us, &rig->values);
+
+    const capture_channel_t *c = &rig->cap.ch[0];
+    rig->closed = c->anchored && c->anchor_us == t_us && rig->anchor_us != 0 && rig->anchor_us != t_us;
+    if (rig->closed) {
+        rig->close_latched = rig->anchor_latched && rig->raw.latched;
+        rig->span_us = t_us - rig->anchor_us;
+    }
+    rig->anchor_latched = c->anchor_latched;
+    rig->anchor_us = c->anchored ? c->anchor_us : 0;
+}
+
+/**
+ * @brief Runs the next sweep, up to READ_JITTER_US late.
+ */
+static void rigSweep(rig_t *rig) {
+    rigReadAt(rig, rig->due_us + xorshift() % (READ_JITTER_US + 1));
+    rig->due_us += CHANNEL_SWEEP_US;
+}
+
+static void rigSet(rig_t *rig, double hz, double duty) { syntheticEdgesSet(&rig->sig, rig->due_us * 1000u, hz, duty); }
+
+static double freqHz(const rig_t *rig) { return rig->values.capture_freq[0] / (double)CAPTURE_FREQ_SCALE; }
+
+/**
+ * @brief Largest frequency error of a closed window at `hz`, in Hz.
+ *
+ * Latched at both ends the window is timed to a tick at each; otherwise
+ * each end is off by at most the time from its last edge to its read.
+ */
+static double closeBound(const rig_t *rig, double hz) {
+    double span_s = rig->span_us * 1e-6;
+    double end_s = fmin((CHANNEL_SWEEP_US + READ_JITTER_US) * 1e-6, 1.0 / hz);
+    double timing_s = rig->close_latched ? 2.0 / TIMER_HZ : 2.0 * end_s;
+    return hz * timing_s / (span_s - timing_s) + 1.0 / CAPTURE_FREQ_SCALE;
+}
+
+/**
+ * @brief The board table compiles and malformed tables are refused with the documented error.
+ */
+static void checkValidation(void) {
+    static capture_t cap;
+    const capture_desc_t twice[] = {
+        { .input = 4, .window_ms = 100, .timeout_ms = 500 },
+        { .input = 4, .window_ms = 100, .timeout_ms = 500 },
+    };
+    const capture_desc_t bad_input[] = { { .input = SNAPSHOT_NUM_CHANNELS, .window_ms = 100, .timeout_ms = 500 } };
+    const capture_desc_t no_window[] = { { .input = 4, .timeout_ms = 500 } };
+    const capture_desc_t no_timeout[] = { { .input = 4, .window_ms = 100 } };
+    const capture_desc_t long_glitch[] = { { .input = 4, .window_ms = 100, .timeout_ms = 500, .glitch_ns = CAPTURE_MAX_GLITCH_NS + 1 } };
+    const capture_desc_t wraps[] = { { .input = 4, .window_ms = 60000, .timeout_ms = 60000 } };
+    const capture_desc_t many[CAPTURE_MAX_INPUTS + 1] = {
+        { .input = 4, .window_ms = 100, .timeout_ms = 500 },
+        { .input = 5, .window_ms = 100, .timeout_ms = 500 },
+        { .input = 6, .window_ms = 100, .timeout_ms = 500 },
+    };
+
+    expect(captureInit(&cap, capture_table, capture_table_count, TIMER_HZ) == ESP_OK, "capture_table compiles");
+    expect(captureInit(&cap, twice, 2, TIMER_HZ) == ESP_ERR_INVALID_ARG, "an input used twice is refused");
+    expect(captureInit(&cap, bad_input, 1, TIMER_HZ) == ESP_ERR_INVALID_ARG, "an input past the board's is refused");
+    expect(captureInit(&cap, no_window, 1, TIMER_HZ) == ESP_ERR_INVALID_ARG, "a zero window is refused");
+    expect(captureInit(&cap, no_timeout, 1, TIMER_HZ) == ESP_ERR_INVALID_ARG, "a zero timeout is refused");
+    expect(captureInit(&cap, long_glitch, 1, TIMER_HZ) == ESP_ERR_INVALID_ARG, "a glitch filter past the hardware's is refused");
+    expect(captureInit(&cap, wraps, 1, TIMER_HZ) == ESP_ERR_INVALID_ARG, "a window the capture timer wraps within is refused");
+    expect(captureInit(&cap, many, CAPTURE_MAX_INPUTS, TIMER_HZ) == ESP_OK, "CAPTURE_MAX_INPUTS inputs compile");
+    expect(captureInit(&cap, many, CAPTURE_MAX_INPUTS + 1, TIMER_HZ) == ESP_ERR_NO_MEM, "one input more is refused");
+    expect(captureInit(&cap, NULL, 0, 0) == ESP_OK, "no inputs compile without a timer");
+}
+
+/**
+ * @brief Runs a steady frequency and checks every closed window against closeBound().
+ */
+static void checkFrequencies(void) {
+    static const double freqs[] = { 1, 3.3, 10, 47.5, 100, 999.9, 12345.6, 100000.3, 333333, 1000003.7, 3999999.7, 9876543.2 };
+    for (size_t i = 0; i < sizeof(freqs) / sizeof(freqs[0]); i++) {
+        rig_t rig;
+        double hz = freqs[i];
+        rigInit(&rig, CAPTURE_FREQUENCY, WINDOW_MS, hz < 2 ? 3000 : TIMEOUT_MS);
+        rigSet(&rig, hz, 0.5);
+        uint32_t windows = 0, latched = 0, bad = 0;
+        double worst = 0, worst_bound = 0;
+        for (int s = 0; s < 8 * 400; s++) {
+            rigSweep(&rig);
+            if (!rig.closed) continue;
+            double err = fabs(freqHz(&rig) - hz), bound = closeBound(&rig, hz);
+            windows++;
+            latched += rig.close_latched;
+            bad += err > bound;
+            if (err / hz > worst) {
+                worst = err / hz;
+                worst_bound = bound / hz;
+            }
+        }
+        printf("  %10.1f Hz: %3u windows, %3u timed by the capture timer, worst %9.3f ppm (bound %9.3f)%s\n", hz, windows,
+               latched, worst * 1e6, worst_bound * 1e6, bad || windows == 0 ? "  MISMATCH" : "");
+        failures += bad != 0 || windows == 0;
+    }
+}
+
+/**
+ * @brief Runs PWM at several frequencies and duties and checks the duty once settled.
+ */
+static void checkDuty(void) {
+    static const double freqs[] = { 10, 100, 1000, 4321.7, 10000 };
+    static const double duties[] = { 0.1, 0.25, 0.5, 0.9 };
+    for (size_t f = 0; f < sizeof(freqs) / sizeof(freqs[0]); f++) {
+        for (size_t d = 0; d < sizeof(duties) / sizeof(duties[0]); d++) {
+            rig_t rig;
+            uint16_t window_ms = freqs[f] < 50 ? 500 : WINDOW_MS;
+            rigInit(&rig, CAPTURE_FREQUENCY_DUTY, window_ms, TIMEOUT_MS);
+            rigSet(&rig, freqs[f], duties[d]);
+            double bound = 1.0 + 2.0 * CAPTURE_DUTY_FULL * freqs[f] / TIMER_HZ;
+            uint32_t checked = 0, bad = 0;
+            double worst = 0;
+            for (int s = 0; s < 10 * 400; s++) {
+                rigSweep(&rig);
+                if (rig.now_us < 3000u * window_ms) continue;
+                double err = fabs(rig.values.capture_duty[0] - duties[d] * CAPTURE_DUTY_FULL);
+                checked++;
+                bad += err > bound;
+                if (err > worst) worst = err;
+            }
+            printf("  %7.0f Hz at %4.1f %%: duty worst %.2f (bound %.2f) x0.1 %% over %u sweeps%s\n", freqs[f],
+                   duties[d] * 100, worst, bound, checked, bad ? "  MISMATCH" : "");
+            failures += bad != 0;
+        }
+    }
+}
+
+/**
+ * @brief Steps 100 Hz to 400 Hz and checks the windows either side and across.
+ */
+static void checkStep(void) {
+    rig_t rig;
+    rigInit(&rig, CAPTURE_FREQUENCY, WINDOW_MS, TIMEOUT_MS);
+    rigSet(&rig, 100, 0.5);
+    for (int s = 0; s < 400; s++) rigSweep(&rig);
+    uint64_t step_us = rig.due_us;
+    rigSet(&rig, 400, 0.5);
+    uint32_t bad = 0;
+    uint64_t settled_us = 0;
+    for (int s = 0; s < 400; s++) {
+        rigSweep(&rig);
+        if (!rig.closed) continue;
+        double hz = freqHz(&rig);
+        if (rig.now_us - rig.span_us >= step_us) {
+            bad += fabs(hz - 400) > closeBound(&rig, 400);
+            if (settled_us == 0) settled_us = rig.now_us - step_us;
+        } else {
+            bad += hz < 100 - closeBound(&rig, 100) || hz > 400 + closeBound(&rig, 400);
+        }
+    }
+    printf("  100 -> 400 Hz: settled %.1f ms after the step (window %u ms)%s\n", settled_us / 1000.0, WINDOW_MS,
+           bad || settled_us == 0 || settled_us > 2000u * WINDOW_MS ? "  MISMATCH" : "");
+    failures += bad != 0 || settled_us == 0 || settled_us > 2000u * WINDOW_MS;
+}
+
+/**
+ * @brief Stops a PWM input high or low and checks the timeout, then restarts it.
+ */
+static void checkTimeout(bool stop_high) {
+    rig_t rig;
+    const uint16_t timeout_ms = 200;
+    rigInit(&rig, CAPTURE_FREQUENCY_DUTY, WINDOW_MS, timeout_ms);
+    rigSet(&rig, 1000, 0.3);
+    for (int s = 0; s < 400; s++) rigSweep(&rig);
+    // Stop a tenth or a half of a period into one, inside or past the 30 % high
+    uint64_t stop_us = rig.due_us + (stop_high ? 100 : 500);
+    syntheticEdgesSet(&rig.sig, stop_us * 1000u, 0, 0.3);
+    uint64_t last_edge_us = (uint64_t)(syntheticEdgesLastRise(&rig.sig, stop_us * 1000u) / 1000.0);
+    uint32_t early = 0;
+    uint64_t zero_after_us = 0;
+    while (rig.due_us < stop_us + 2000u * timeout_ms) {
+        rigSweep(&rig);
+        bool zero = rig.values.capture_freq[0] == 0;
+        if (!zero && zero_after_us != 0) early++;
+        if (zero && zero_after_us == 0) zero_after_us = rig.now_us - last_edge_us;
+        if (zero && rig.now_us - last_edge_us < 1000u * timeout_ms) early++;
+    }
+    uint16_t level = rig.values.capture_duty[0];
+    bool late = zero_after_us == 0 || zero_after_us > 1000u * timeout_ms + 2 * (CHANNEL_SWEEP_US + READ_JITTER_US);
+    bool bad_level = level != (stop_high ? CAPTURE_DUTY_FULL : 0);
+
+    syntheticEdgesSet(&rig.sig, rig.due_us * 1000u, 2000, 0.3);
+    uint64_t resume_us = rig.due_us, back_after_us = 0;
+    while (rig.due_us < resume_us + 4000u * WINDOW_MS) {
+        rigSweep(&rig);
+        if (back_after_us == 0 && rig.closed && fabs(freqHz(&rig) - 2000) <= closeBound(&rig, 2000)) {
+            back_after_us = rig.now_us - resume_us;
+        }
+    }
+    bool slow = back_after_us == 0 || back_after_us > 2000u * WINDOW_MS;
+    printf("  stopped %s: 0 Hz %.1f ms after the last edge (timeout %u ms), duty %u; 2 kHz again after %.1f ms%s\n",
+           stop_high ? "high" : "low ", zero_after_us / 1000.0, timeout_ms, level, back_after_us / 1000.0,
+           early || late || bad_level || slow ? "  MISMATCH" : "");
+    failures += early || late || bad_level || slow;
+}
+
+/**
+ * @brief Delays one read past CAPTURE_MAX_GAP_US at 1 MHz and checks no window spans it.
+ */
+static void checkGap(void) {
+    rig_t rig;
+    rigInit(&rig, CAPTURE_FREQUENCY, WINDOW_MS, TIMEOUT_MS);
+    rigSet(&rig, 1e6, 0.5);
+    for (int s = 0; s < 200; s++) rigSweep(&rig);
+    rig.due_us += CAPTURE_MAX_GAP_US + 10000;
+    uint32_t bad = 0, windows = 0;
+    for (int s = 0; s < 400; s++) {
+        rigSweep(&rig);
+        if (!rig.closed) continue;
+        windows++;
+        bad += fabs(freqHz(&rig) - 1e6) > closeBound(&rig, 1e6);
+    }
+    printf("  read %u ms late at 1 MHz (%u counter wraps unseen): %u windows after, %u off%s\n",
+           (CAPTURE_MAX_GAP_US + 10000 + CHANNEL_SWEEP_US) / 1000, (CAPTURE_MAX_GAP_US + 10000) / CAPTURE_COUNTER_MODULUS, windows,
+           bad, bad || windows == 0 ? "  MISMATCH" : "");
+    failures += bad != 0 || windows == 0;
+}
+
+/**
+ * @brief Whether every window over 0.5 s at `hz` is within its bound.
+ */
+static bool tracks(double hz) {
+    rig_t rig;
+    rigInit(&rig, CAPTURE_FREQUENCY, WINDOW_MS, TIMEOUT_MS);
+    rigSet(&rig, hz, 0.5);
+    uint32_t windows = 0;
+    for (int s = 0; s < 200; s++) {
+        rigSweep(&rig);
+        if (!rig.closed) continue;
+        windows++;
+        if (fabs(freqHz(&rig) - hz) > closeBound(&rig, hz)) return false;
+    }
+    return windows > 0;
+}
+
+/**
+ * @brief Bisects for the highest frequency tracked with reads up to READ_JITTER_US late.
+ */
+static double checkMaxFrequency(void) {
+    double lo = 1e6, hi = 1e8;
+    while (hi - lo > 1000) {
+        double mid = (lo + hi) / 2;
+        if (tracks(mid)) lo = mid; else hi = mid;
+    }
+    double limit_min = (CAPTURE_COUNTER_MODULUS - 1) / ((CHANNEL_SWEEP_US + READ_JITTER_US) * 1e-6);
+    double limit_max = (CAPTURE_COUNTER_MODULUS - 1) / (CHANNEL_SWEEP_US * 1e-6);
+    bool bad = lo < limit_min * 0.99 || lo > limit_max * 1.01;
+    printf("  highest tracked %.3f MHz, counter limit %.3f-%.3f MHz (%u edges per %u-%u us read interval)%s\n", lo / 1e6,
+           limit_min / 1e6, limit_max / 1e6, CAPTURE_COUNTER_MODULUS - 1, CHANNEL_SWEEP_US, CHANNEL_SWEEP_US + READ_JITTER_US,
+           bad ? "  MISMATCH" : "");
+    failures += bad;
+    return lo;
+}
+
+/**
+ * @brief Times captureUpdate() for CAPTURE_MAX_INPUTS duty inputs over recorded reads.
+ *
+ * @return Average ns per sweep
+ */
+static double benchCost(uint32_t sweeps) {
+    enum { RECORDED = 4096 };
+    static capture_raw_t raws[RECORDED][CAPTURE_MAX_INPUTS];
+    static capture_t cap;
+    capture_desc_t descs[CAPTURE_MAX_INPUTS];
+    synthetic_edges_t sigs[CAPTURE_MAX_INPUTS];
+    for (int i = 0; i < CAPTURE_MAX_INPUTS; i++) {
+        descs[i] = (capture_desc_t){ .input = (uint8_t)i, .mode = CAPTURE_FREQUENCY_DUTY, .window_ms = 20, .timeout_ms = 200 };
+        syntheticEdgesInit(&sigs[i]);
+        syntheticEdgesSet(&sigs[i], 0, 1234.5 * (i + 1), 0.4);
+    }
+    ESP_ERROR_CHECK(captureInit(&cap, descs, CAPTURE_MAX_INPUTS, TIMER_HZ));
+    for (int n = 0; n < RECORDED; n++) {
+        uint64_t t_ns = (uint64_t)(n + 1) * CHANNEL_SWEEP_US * 1000u;
+        for (int i = 0; i < CAPTURE_MAX_INPUTS; i++) {
+            raws[n][i] = (capture_raw_t){
+                .edges = (uint16_t)(syntheticEdgesCount(&sigs[i], t_ns) % CAPTURE_COUNTER_MODULUS),
+                .rise_ticks = toTicks(syntheticEdgesLastRise(&sigs[i], t_ns)),
+                .fall_ticks = toTicks(syntheticEdgesLastFall(&sigs[i], t_ns)),
+                .latched = true,
+            };
+        }
+    }
+
+    // Replay the recording end to end, each pass after a late read so its windows restart
+    sensor_values_t values = {0};
+    uint64_t sink = 0, now_us = 0;
+    uint64_t t0 = hostMonotonicNs();
+    for (uint32_t s = 0; s < sweeps; s++) {
+        now_us += (s % RECORDED == 0) ? CAPTURE_MAX_GAP_US + 1 : CHANNEL_SWEEP_US;
+        captureUpdate(&cap, raws[s % RECORDED], now_us, &values);
+        sink += values.capture_freq[0];
+    }
+    double avg = (double)(hostMonotonicNs() - t0) / sweeps;
+    printf("  %d inputs: avg %.1f ns/sweep, %.2f ns/input, %.4f%% of a sweep (sink %llu)\n", CAPTURE_MAX_INPUTS, avg,
+           avg / CAPTURE_MAX_INPUTS, avg / (CHANNEL_SWEEP_US * 10.0), (unsigned long long)(sink & 0xFF));
+    return avg;
+}
+
+int main(int argc, char **argv) {
+    uint32_t sweeps = (argc > 1) ? (uint32_t)strtoul(argv[1], NULL, 10) : 2000000;
+    if (sweeps == 0) {
+        fprintf(stderr, "usage: %s [bench sweeps]\n", argv[0]);
+        return 1;
+    }
+
+    printf("validation\n");
+    checkValidation();
+    printf("frequency, %u ms windows, reads every %u us up to %u us late\n", WINDOW_MS, CHANNEL_SWEEP_US, READ_JITTER_US);
+    checkFrequencies();
+    printf("duty\n");
+    checkDuty();
+    printf("step, timeout and late read\n");
+    checkStep();
+    checkTimeout(false);
+    checkTimeout(true);
+    checkGap();
+    printf("counter limit\n");
+    double max_hz = checkMaxFrequency();
+    printf("update cost over %u sweeps\n", (unsigned)sweeps);
+    double ns = benchCost(sweeps);
+
+    printf("result failures=%d max_trackable_hz=%.0f ns_per_sweep=%.1f%s\n", failures, max_hz, ns, failures ? "  MISMATCH" : "");
+    return failures ? 1 : 0;
+}
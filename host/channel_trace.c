@@ -0,0 +1,69 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "esp_err.h"
+#include "inc/channels.h"
+
+/**
+ * @brief Replays a recorded millivolt trace through the channel pipeline.
+ *
+ * Reads CSV rows of filtered, divider-scaled millivolts for every input
+ * (ch0..ch9, an optional header row is skipped) and writes one CSV row of
+ * engineering outputs per input row, converted by `channel_table` exactly as
+ * on the board.
+ *
+ * Usage: channel_trace [trace.csv] (stdin if omitted)
+ */
+
+static int identityCali(void *ctx, int channel, int raw) {
+    return raw;
+}
+
+static const char *slot_names[SENSOR_SLOT_COUNT] = {
+    "cc_inlet_pressure_x100", "exhaust_back_pressure_x100", "crank_case_pressure_x100", "turbo_oil_pressure_x100",
+    "cc_water_temp_dc", "air_temp_dc", "cc_inlet_temp_dc",
+};
+
+int main(int argc, char **argv) {
+    FILE *in = (argc > 1) ? fopen(argv[1], "r") : stdin;
+    if (in == NULL) {
+        perror(argv[1]);
+        return 1;
+    }
+
+    static channel_pipeline_t pipeline;
+    esp_err_t err = channelsInit(&pipeline, channel_table, SNAPSHOT_NUM_CHANNELS, identityCali, NULL);
+    if (err != ESP_OK) {
+        fprintf(stderr, "channelsInit failed: %s\n", esp_err_to_name(err));
+        return 1;
+    }
+
+    printf("row");
+    for (int i = 0; i < SENSOR_SLOT_COUNT; i++) printf(",%s", slot_names[i]);
+    printf("\n");
+
+    char line[512];
+    unsigned row = 0;
+    sensor_values_t values = {0};
+    while (fgets(line, sizeof(line), in) != NULL) {
+        char *p = line;
+        int n = 0;
+        while (n < SNAPSHOT_NUM_CHANNELS) {
+            char *end;
+            long mv = strtol(p, &end, 10);
+            if (end == p) break;
+            values.filtered_mv[n++] = (uint16_t)(mv < 0 ? 0 : mv > UINT16_MAX ? UINT16_MAX : mv);
+            p = end + strspn(end, ", \t");
+        }
+        if (n != SNAPSHOT_NUM_CHANNELS) continue; // Header or malformed row
+
+        channelsConvert(&pipeline, &values);
+        printf("%u", row++);
+        for (int i = 0; i < SENSOR_SLOT_COUNT; i++) printf(",%d", values.outputs[i]);
+        printf("\n");
+    }
+
+    if (in != stdin) fclose(in);
+    return 0;
+}
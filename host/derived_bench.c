@@ -0,0 +1,253 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "esp_err.h"
+#include "inc/channels.h"
+#include "inc/derived.h"
+#include "synthetic_adc.h"
+
+/**
+ * @brief Checks the derived channel engine against reference arithmetic and times it per sweep.
+ *
+ * The board's `derived_table` must compile, and tables with a forward or
+ * out-of-range operand, a window under DERIVED_BUCKETS sweeps, a zero
+ * divisor, a publish index out of range or used twice, or too many
+ * channels or windows must be rejected. A table with every operation, one
+ * chained on another, then runs over a random walk and a ramp, one sweep
+ * every CHANNEL_SWEEP_US, and each output is compared on every sweep with
+ * a brute-force reference over the input history: arithmetic exactly, peak
+ * hold exactly, rolling min/max between the extreme over the window and
+ * over the window plus one bucket, and rate exactly on the ramp.
+ *
+ * Then derivedEvaluate() is timed over generated tables of 10, 50 and 100
+ * channels (three in four arithmetic, one in four windowed, half of them
+ * reading an earlier channel): min/avg/p99/max ns per sweep, and the share
+ * of the sweep period at the average.
+ *
+ * Exits non-zero on any mismatch.
+ *
+ * Usage: derived_bench [bench sweeps]
+ */
+
+#define CHECK_SWEEPS 20000
+#define WINDOW_MS 500
+#define WINDOW_SWEEPS (WINDOW_MS * 1000 / CHANNEL_SWEEP_US)
+#define BUCKET_SWEEPS (WINDOW_SWEEPS / DERIVED_BUCKETS)
+#define RAMP_STEP 3                 // mV per sweep on the rate input
+
+static uint32_t rng = 0x9E3779B9u;
+static uint32_t xorshift(void) {
+    rng ^= rng << 13;
+    rng ^= rng >> 17;
+    rng ^= rng << 5;
+    return rng;
+}
+
+static int failures;
+
+static void expect(bool ok, const char *what) {
+    if (!ok) {
+        printf("  %s  MISMATCH\n", what);
+        failures++;
+    }
+}
+
+static esp_err_t initTable(const derived_desc_t *table, size_t count) {
+    static derived_engine_t engine;
+    return derivedInit(&engine, table, count, CHANNEL_SWEEP_US);
+}
+
+/**
+ * @brief The board table compiles and malformed tables are refused with the documented error.
+ */
+static void checkValidation(void) {
+    static derived_desc_t many[DERIVED_MAX_CHANNELS + 1];
+    const derived_desc_t forward[] = {
+        { .op = DERIVED_OP_DIFF, .a = DERIVED_MV(0), .b = DERIVED_CHANNEL(1) },
+        { .op = DERIVED_OP_SUM, .a = DERIVED_MV(0), .b = DERIVED_MV(1) },
+    };
+    const derived_desc_t self[] = { { .op = DERIVED_OP_MAX, .a = DERIVED_CHANNEL(0), .window_ms = 1000 } };
+    const derived_desc_t bad_slot[] = { { .op = DERIVED_OP_SCALE, .a = DERIVED_OUTPUT(SENSOR_SLOT_COUNT), .mul = 1, .div = 1 } };
+    const derived_desc_t bad_external[] = {
+        { .op = DERIVED_OP_DIFF, .a = DERIVED_MV(0), .b = DERIVED_EXTERNAL(DERIVED_MAX_EXTERNAL) },
+    };
+    const derived_desc_t bad_capture[] = { { .op = DERIVED_OP_SCALE, .a = DERIVED_CAPTURE(SNAPSHOT_NUM_CAPTURE), .mul = 1, .div = 1 } };
+    const derived_desc_t short_window[] = { { .op = DERIVED_OP_RATE, .a = DERIVED_MV(0), .window_ms = 10 } };
+    const derived_desc_t long_hold[] = { { .op = DERIVED_OP_PEAK_HOLD, .a = DERIVED_MV(0), .window_ms = 1000 } };
+    const derived_desc_t zero_div[] = { { .op = DERIVED_OP_SCALE, .a = DERIVED_MV(0), .mul = 1 } };
+    const derived_desc_t bad_publish[] = {
+        { .op = DERIVED_OP_SUM, .a = DERIVED_MV(0), .b = DERIVED_MV(1), .publish = DERIVED_PUBLISH(SNAPSHOT_NUM_DERIVED) },
+    };
+    const derived_desc_t twice[] = {
+        { .op = DERIVED_OP_SUM, .a = DERIVED_MV(0), .b = DERIVED_MV(1), .publish = DERIVED_PUBLISH(2) },
+        { .op = DERIVED_OP_SUM, .a = DERIVED_MV(2), .b = DERIVED_MV(3), .publish = DERIVED_PUBLISH(2) },
+    };
+
+    expect(initTable(derived_table, derived_table_count) == ESP_OK, "derived_table compiles");
+    expect(initTable(forward, 2) == ESP_ERR_INVALID_ARG, "reading a later channel is refused");
+    expect(initTable(self, 1) == ESP_ERR_INVALID_ARG, "reading itself is refused");
+    expect(initTable(bad_slot, 1) == ESP_ERR_INVALID_ARG, "an output past SENSOR_SLOT_COUNT is refused");
+    expect(initTable(bad_external, 1) == ESP_ERR_INVALID_ARG, "an external past DERIVED_MAX_EXTERNAL is refused");
+    expect(initTable(bad_capture, 1) == ESP_ERR_INVALID_ARG, "a capture input past SNAPSHOT_NUM_CAPTURE is refused");
+    expect(initTable(short_window, 1) == ESP_ERR_INVALID_ARG, "a window under DERIVED_BUCKETS sweeps is refused");
+    expect(initTable(zero_div, 1) == ESP_ERR_INVALID_ARG, "a zero divisor is refused");
+    static derived_engine_t fast;
+    expect(derivedInit(&fast, long_hold, 1, 10) == ESP_ERR_INVALID_ARG, "a bucket over UINT16_MAX sweeps is refused");
+    expect(initTable(bad_publish, 1) == ESP_ERR_INVALID_ARG, "a publish index past SNAPSHOT_NUM_DERIVED is refused");
+    expect(initTable(twice, 2) == ESP_ERR_INVALID_ARG, "a publish index used twice is refused");
+
+    for (size_t i = 0; i <= DERIVED_MAX_CHANNELS; i++) {
+        many[i] = (derived_desc_t){ .op = DERIVED_OP_MIN, .a = DERIVED_MV(0), .window_ms = 1000 };
+    }
+    expect(initTable(many, DERIVED_MAX_WINDOWS) == ESP_OK, "DERIVED_MAX_WINDOWS windows compile");
+    expect(initTable(many, DERIVED_MAX_WINDOWS + 1) == ESP_ERR_NO_MEM, "one window more is refused");
+    for (size_t i = 0; i <= DERIVED_MAX_CHANNELS; i++) many[i] = (derived_desc_t){ .op = DERIVED_OP_SUM, .a = DERIVED_MV(0), .b = DERIVED_MV(1) };
+    expect(initTable(many, DERIVED_MAX_CHANNELS) == ESP_OK, "DERIVED_MAX_CHANNELS channels compile");
+    expect(initTable(many, DERIVED_MAX_CHANNELS + 1) == ESP_ERR_NO_MEM, "one channel more is refused");
+}
+
+enum { REF_DIFF, REF_SUM, REF_SCALE, REF_MIN, REF_MAX, REF_PEAK, REF_RATE, REF_CHAINED, REF_COUNT };
+
+static const derived_desc_t check_table[REF_COUNT] = {
+    [REF_DIFF] = { .name = "diff", .op = DERIVED_OP_DIFF, .a = DERIVED_OUTPUT(0), .b = DERIVED_EXTERNAL(DERIVED_EXT_ECU_MAP),
+                   .publish = DERIVED_PUBLISH(0) },
+    [REF_SUM] = { .name = "sum", .op = DERIVED_OP_SUM, .a = DERIVED_OUTPUT(1), .b = DERIVED_MV(3), .publish = DERIVED_PUBLISH(1) },
+    [REF_SCALE] = { .name = "scale", .op = DERIVED_OP_SCALE, .a = DERIVED_OUTPUT(1), .mul = 689476, .div = 100000, .offset = -50,
+                    .publish = DERIVED_PUBLISH(2) },
+    [REF_MIN] = { .name = "min", .op = DERIVED_OP_MIN, .a = DERIVED_OUTPUT(0), .window_ms = WINDOW_MS, .publish = DERIVED_PUBLISH(3) },
+    [REF_MAX] = { .name = "max", .op = DERIVED_OP_MAX, .a = DERIVED_OUTPUT(0), .window_ms = WINDOW_MS, .publish = DERIVED_PUBLISH(4) },
+    [REF_PEAK] = { .name = "peak", .op = DERIVED_OP_PEAK_HOLD, .a = DERIVED_OUTPUT(0), .window_ms = WINDOW_MS,
+                   .publish = DERIVED_PUBLISH(5) },
+    [REF_RATE] = { .name = "rate", .op = DERIVED_OP_RATE, .a = DERIVED_MV(9), .window_ms = WINDOW_MS, .publish = DERIVED_PUBLISH(6) },
+    [REF_CHAINED] = { .name = "max of diff", .op = DERIVED_OP_MAX, .a = DERIVED_CHANNEL(REF_DIFF), .window_ms = WINDOW_MS,
+                      .publish = DERIVED_PUBLISH(7) },
+};
+
+static int32_t extreme(const int32_t *history, size_t from, size_t to, bool max) {
+    int32_t e = history[from];
+    for (size_t i = from + 1; i <= to; i++) e = max ? (history[i] > e ? history[i] : e) : (history[i] < e ? history[i] : e);
+    return e;
+}
+
+/**
+ * @brief Runs every operation over a random walk and compares each sweep with a reference.
+ */
+static void checkOperations(void) {
+    static derived_engine_t engine;
+    static int32_t walk[CHECK_SWEEPS], diff[CHECK_SWEEPS];
+    uint32_t bad[REF_COUNT] = {0};
+    sensor_values_t values = {0};
+    int32_t external[DERIVED_MAX_EXTERNAL] = {0};
+    ESP_ERROR_CHECK(derivedInit(&engine, check_table, REF_COUNT, CHANNEL_SWEEP_US));
+
+    int32_t level = 10000;
+    for (size_t n = 0; n < CHECK_SWEEPS; n++) {
+        level += (int32_t)(xorshift() % 201) - 100;
+        values.outputs[0] = walk[n] = level;
+        values.outputs[1] = (int32_t)(xorshift() % 3000);
+        values.filtered_mv[3] = (uint16_t)(xorshift() % 5000);
+        values.filtered_mv[9] = (uint16_t)(1000 + RAMP_STEP * n);
+        external[DERIVED_EXT_ECU_MAP] = 9000 + (int32_t)(xorshift() % 2000);
+        derivedEvaluate(&engine, &values, external);
+        const int32_t *d = values.derived;
+        diff[n] = level - external[DERIVED_EXT_ECU_MAP];
+
+        bad[REF_DIFF] += d[REF_DIFF] != diff[n];
+        bad[REF_SUM] += d[REF_SUM] != values.outputs[1] + values.filtered_mv[3];
+        bad[REF_SCALE] += d[REF_SCALE] != (int32_t)((int64_t)values.outputs[1] * 689476 / 100000 - 50);
+
+        if (n >= WINDOW_SWEEPS + BUCKET_SWEEPS) {
+            for (int max = 0; max < 2; max++) {
+                int32_t wide = extreme(walk, n - WINDOW_SWEEPS - BUCKET_SWEEPS + 1, n, max);
+                int32_t narrow = extreme(walk, n - WINDOW_SWEEPS + 1, n, max);
+                int32_t got = d[max ? REF_MAX : REF_MIN];
+                bad[max ? REF_MAX : REF_MIN] += max ? (got > wide || got < narrow) : (got < wide || got > narrow);
+            }
+            int32_t wide = extreme(diff, n - WINDOW_SWEEPS - BUCKET_SWEEPS + 1, n, true);
+            int32_t narrow = extreme(diff, n - WINDOW_SWEEPS + 1, n, true);
+            bad[REF_CHAINED] += d[REF_CHAINED] > wide || d[REF_CHAINED] < narrow;
+        }
+
+        size_t complete = (n + 1) / WINDOW_SWEEPS;
+        int32_t peak = complete ? extreme(walk, (complete - 1) * WINDOW_SWEEPS, complete * WINDOW_SWEEPS - 1, true)
+                                : extreme(walk, 0, n, true);
+        bad[REF_PEAK] += d[REF_PEAK] != peak;
+        int32_t rate = n ? RAMP_STEP * (int32_t)(1000000u / CHANNEL_SWEEP_US) : 0;
+        bad[REF_RATE] += d[REF_RATE] != rate;
+    }
+
+    for (int i = 0; i < REF_COUNT; i++) {
+        printf("  %-12s %u of %u sweeps off the reference%s\n", check_table[i].name, (unsigned)bad[i], CHECK_SWEEPS,
+               bad[i] ? "  MISMATCH" : "");
+        failures += bad[i] != 0;
+    }
+}
+
+static int compareU32(const void *a, const void *b) {
+    uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief Times derivedEvaluate() over a generated table of `count` channels.
+ *
+ * @return Average ns per sweep
+ */
+static double benchCost(size_t count, uint32_t sweeps) {
+    static derived_engine_t engine;
+    static derived_desc_t table[DERIVED_MAX_CHANNELS];
+    static const derived_op_t arithmetic[] = { DERIVED_OP_DIFF, DERIVED_OP_SUM, DERIVED_OP_SCALE };
+    static const derived_op_t windowed[] = { DERIVED_OP_MIN, DERIVED_OP_MAX, DERIVED_OP_PEAK_HOLD, DERIVED_OP_RATE };
+    for (size_t i = 0; i < count; i++) {
+        derived_operand_t a = (i >= 2 && i % 2) ? (derived_operand_t)DERIVED_CHANNEL(i - 2)
+                                                : (derived_operand_t)DERIVED_OUTPUT(i % SENSOR_SLOT_COUNT);
+        table[i] = (derived_desc_t){
+            .op = (i % 4 == 3) ? windowed[(i / 4) % 4] : arithmetic[i % 3],
+            .a = a, .b = DERIVED_MV(i % SNAPSHOT_NUM_CHANNELS), .mul = 3, .div = 2, .offset = 7,
+            .window_ms = 1000, .publish = (uint8_t)(i < SNAPSHOT_NUM_DERIVED ? DERIVED_PUBLISH(i) : 0),
+        };
+    }
+    ESP_ERROR_CHECK(derivedInit(&engine, table, count, CHANNEL_SWEEP_US));
+
+    uint32_t *ns = malloc(sweeps * sizeof(*ns));
+    if (ns == NULL) return 0;
+    sensor_values_t values = {0};
+    int32_t external[DERIVED_MAX_EXTERNAL] = {0};
+    uint64_t total = 0, sink = 0;
+    for (uint32_t s = 0; s < sweeps; s++) {
+        for (int i = 0; i < SENSOR_SLOT_COUNT; i++) values.outputs[i] = (int32_t)(xorshift() % 20000);
+        for (int ch = 0; ch < SNAPSHOT_NUM_CHANNELS; ch++) values.filtered_mv[ch] = (uint16_t)(xorshift() % 5000);
+        uint64_t t0 = hostMonotonicNs();
+        derivedEvaluate(&engine, &values, external);
+        ns[s] = (uint32_t)(hostMonotonicNs() - t0);
+        total += ns[s];
+        sink += (uint32_t)values.derived[0];
+    }
+    qsort(ns, sweeps, sizeof(*ns), compareU32);
+    double avg = (double)total / sweeps;
+    printf("  %3zu channels (%2u windowed): min %5u avg %7.1f p99 %5u max %6u ns/sweep, %5.2f ns/channel, %.3f%% of a sweep (sink %llu)\n",
+           count, (unsigned)engine.window_count, (unsigned)ns[0], avg, (unsigned)ns[(sweeps * 99) / 100],
+           (unsigned)ns[sweeps - 1], avg / count, avg / (CHANNEL_SWEEP_US * 10.0), (unsigned long long)(sink & 0xFF));
+    free(ns);
+    return avg;
+}
+
+int main(int argc, char **argv) {
+    uint32_t sweeps = (argc > 1) ? (uint32_t)strtoul(argv[1], NULL, 10) : 200000;
+    if (sweeps == 0) {
+        fprintf(stderr, "usage: %s [bench sweeps]\n", argv[0]);
+        return 1;
+    }
+
+    printf("validation\n");
+    checkValidation();
+    printf("operations over %u sweeps, %u ms windows in %u buckets\n", CHECK_SWEEPS, WINDOW_MS, DERIVED_BUCKETS);
+    checkOperations();
+    printf("evaluation cost over %u sweeps\n", (unsigned)sweeps);
+    double ns10 = benchCost(10, sweeps), ns50 = benchCost(50, sweeps), ns100 = benchCost(100, sweeps);
+
+    printf("result failures=%d ns_per_sweep_10=%.1f ns_per_sweep_50=%.1f ns_per_sweep_100=%.1f%s\n", failures, ns10, ns50,
+           ns100, failures ? "  MISMATCH" : "");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,172 @@
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "inc/diag.h"
+#include "synthetic_adc.h"
+
+/**
+ * @brief Checks the instrumentation aggregates against exact statistics and times a record.
+ *
+ * A diag_t of the bench's own runs on a fake cycle counter that the bench
+ * advances by known durations, so each window's min/avg/max must match
+ * exactly and its p99 must bound the exact p99 within one histogram
+ * bucket. Also checks a counter wrap between stamps, that a stalled writer
+ * reads as an empty window, and, with a writer and reader thread racing,
+ * that no window is ever torn or lost. Finally times diagRecord() on the
+ * host clock.
+ *
+ * Usage: diag_bench [samples per window]
+ */
+
+#define CPU_MHZ 240
+#define WINDOWS 6
+
+static diag_t bench_diag; // Not the firmware's `diag`, which only exists with CONFIG_CANBOARD_DIAG
+
+static uint32_t fake_cycles;
+
+static uint32_t fakeClock(void) { return fake_cycles; }
+
+static uint32_t hostCycles(void) { return (uint32_t)(hostMonotonicNs() * CPU_MHZ / 1000u); }
+
+static int compareU32(const void *a, const void *b) {
+    uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief Duration of sample `n` of window `w` in microseconds: a mostly steady stage with a slow tail.
+ */
+static uint32_t nextDuration(uint32_t *state, uint32_t w) {
+    *state = *state * 1664525u + 1013904223u;
+    uint32_t r = *state >> 8;
+    uint32_t base = 20u + 15u * w + r % 10u;
+    return (r % 100u == 0) ? base * (2u + r % 50u) : base;
+}
+
+/**
+ * @brief Times `samples` stages per window as DIAG_STAMP/DIAG_SINCE would and checks each collected window.
+ *
+ * A collect asks for the window being recorded to close and reports the one
+ * closed by the previous collect, so pass `w` is reported two collects later.
+ */
+static int checkWindows(uint32_t samples) {
+    int failures = 0;
+    uint32_t *exact = malloc((size_t)(WINDOWS + 1) * samples * sizeof(uint32_t));
+    uint32_t state = 7;
+    diag_report_t r;
+
+    fake_cycles = UINT32_MAX - 1000u * CPU_MHZ; // Wraps during the first window
+    for (uint32_t w = 0; w <= WINDOWS + 1; w++) {
+        bool ready = diagCollect(&bench_diag, DIAG_ADC_FILTER, &r);
+        if (w < 2) {
+            failures += r.count != 0; // Nothing recorded before the first close
+        } else {
+            uint32_t *pass = &exact[(size_t)(w - 2) * samples];
+            qsort(pass, samples, sizeof(uint32_t), compareU32);
+            uint64_t sum = 0;
+            for (uint32_t i = 0; i < samples; i++) sum += pass[i];
+            uint32_t p99 = pass[(samples * 99u + 99u) / 100u - 1u];
+            bool ok = ready && r.count == samples && r.min == pass[0] && r.max == pass[samples - 1] &&
+                      r.avg == (uint32_t)(sum / samples) && r.p99 >= p99 && r.p99 <= p99 + p99 / 8u + 1u;
+            printf("window %u: n=%u min %u avg %u p99 %u (exact %u) max %u%s\n", w - 2, (unsigned)r.count, (unsigned)r.min,
+                   (unsigned)r.avg, (unsigned)r.p99, (unsigned)p99, (unsigned)r.max, ok ? "" : "  MISMATCH");
+            failures += !ok;
+        }
+        if (w > WINDOWS) break;
+
+        uint32_t *pass = &exact[(size_t)w * samples];
+        for (uint32_t i = 0; i < samples; i++) {
+            pass[i] = nextDuration(&state, w);
+            const uint32_t t0 = bench_diag.clock();
+            fake_cycles += pass[i] * CPU_MHZ + i % CPU_MHZ; // Partial microseconds truncate
+            diagRecord(&bench_diag, DIAG_ADC_FILTER, diagCyclesToUs(&bench_diag, bench_diag.clock() - t0));
+        }
+    }
+
+    // A writer that stops recording leaves its window open: the reader gets nothing rather than stale data
+    bool stalled = diagCollect(&bench_diag, DIAG_ADC_FILTER, &r) || r.count || diagCollect(&bench_diag, DIAG_ADC_FILTER, &r) || r.count;
+    printf("stalled writer: %s\n", stalled ? "reported data  MISMATCH" : "empty window");
+    failures += stalled;
+    free(exact);
+    return failures;
+}
+
+static atomic_bool racing;
+
+static atomic_uint_fast64_t written;
+
+static void *raceWriter(void *arg) {
+    while (atomic_load(&racing)) {
+        diagRecord(&bench_diag, DIAG_SAMPLE_AGE, 1234);
+        atomic_fetch_add_explicit(&written, 1, memory_order_relaxed);
+    }
+    return NULL;
+}
+
+/**
+ * @brief Races a recording thread against a collecting one; every window must be whole and none lost.
+ */
+static int checkRace(uint64_t samples) {
+    uint64_t collected = 0;
+    uint32_t torn = 0, windows = 0;
+    diag_report_t r;
+
+    atomic_store(&racing, true);
+    pthread_t writer;
+    pthread_create(&writer, NULL, raceWriter, NULL);
+    while (atomic_load_explicit(&written, memory_order_relaxed) < samples) {
+        if (diagCollect(&bench_diag, DIAG_SAMPLE_AGE, &r)) {
+            windows++;
+            collected += r.count;
+            if (r.count && (r.min != 1234 || r.max != 1234 || r.avg != 1234 || r.p99 != 1234)) torn++;
+        }
+    }
+    atomic_store(&racing, false);
+    pthread_join(writer, NULL);
+
+    // Drain: each collect/record pair closes what was recorded since the previous one
+    for (int i = 0; i < 2; i++) {
+        if (diagCollect(&bench_diag, DIAG_SAMPLE_AGE, &r)) collected += r.count;
+        diagRecord(&bench_diag, DIAG_SAMPLE_AGE, 1234);
+        atomic_fetch_add(&written, 1);
+    }
+    if (diagCollect(&bench_diag, DIAG_SAMPLE_AGE, &r)) collected += r.count;
+
+    uint64_t open = bench_diag.metrics[DIAG_SAMPLE_AGE].current.count;
+    uint64_t total = atomic_load(&written);
+    bool ok = torn == 0 && collected + open == total;
+    printf("race: %u windows, %llu of %llu samples collected (%llu still open), %u torn%s\n", (unsigned)windows,
+           (unsigned long long)collected, (unsigned long long)total, (unsigned long long)open, (unsigned)torn,
+           ok ? "" : "  MISMATCH");
+    return !ok;
+}
+
+int main(int argc, char **argv) {
+    uint32_t samples = (argc > 1) ? (uint32_t)strtoul(argv[1], NULL, 10) : 10000;
+    if (samples == 0) return 1;
+
+    int failures = 0;
+    ESP_ERROR_CHECK(diagInit(&bench_diag, fakeClock, CPU_MHZ));
+    failures += checkWindows(samples);
+    failures += checkRace(20000000);
+
+    // Cost of one instrumentation point pair on the host clock
+    ESP_ERROR_CHECK(diagInit(&bench_diag, hostCycles, CPU_MHZ));
+    const uint32_t rounds = 5000000;
+    uint64_t t0 = hostMonotonicNs();
+    for (uint32_t i = 0; i < rounds; i++) diagRecord(&bench_diag, DIAG_CAN_PACK, i & 1023u);
+    uint64_t t1 = hostMonotonicNs();
+    for (uint32_t i = 0; i < rounds; i++) {
+        const uint32_t t = bench_diag.clock();
+        diagRecord(&bench_diag, DIAG_CAN_PACK, diagCyclesToUs(&bench_diag, bench_diag.clock() - t));
+    }
+    uint64_t t2 = hostMonotonicNs();
+    printf("cost: %.1f ns per diagRecord, %.1f ns per stamp/since pair (host clock)\n",
+           (double)(t1 - t0) / rounds, (double)(t2 - t1) / rounds);
+    printf("state: %zu bytes for %d metrics\n", sizeof(diag_t), DIAG_METRIC_COUNT);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,267 @@
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "esp_err.h"
+#include "inc/adc_stream.h"
+#include "inc/channels.h"
+#include "inc/faults.h"
+#include "synthetic_adc.h"
+
+/**
+ * @brief Injects wiring and sensor faults into the channel pipeline and times the classifier.
+ *
+ * Each trace starts with every input healthy: a mid-range level with a few
+ * codes of noise, as the ADC delivers. At FAULT_AT_MS one input is faulted
+ * (open, shorted, pinned, stuck, noisy, stepped faster than the sensor can,
+ * or dipping too briefly to count) and later restored. Sweeps go through
+ * the real stream demux, channelsFilterSweep(), channelsMarkChanges() and
+ * channelsConvert() with `channel_table`, on a virtual clock of one sweep
+ * per SWEEP_US. For each trace it checks that the expected fault latches
+ * within its limit and never flaps, that the output is the failsafe while
+ * latched, that the latch and clear both mark the channel changed, that the
+ * fault clears FAULT_CLEAR_MS after the input recovers, and that no other
+ * input faults. Then it reports the per-sweep cost of the filter pass with
+ * the classifier, and of the classifier alone.
+ *
+ * Exits non-zero on any mismatch.
+ *
+ * Usage: fault_bench [bench sweeps]
+ */
+
+#define BENCH_UNIT 0
+#define FULL_SCALE_MV 3100          // ADC input at full scale with 12 dB attenuation, as in the shim
+#define MAX_CODE 4095
+#define SWEEP_US (ADC_STREAM_SWEEP_SAMPLES * 1000000u / CHANNEL_RATE_HZ)
+#define HEALTHY_NOISE 4             // Codes of noise either side, on every input
+#define FAULT_AT_MS 1000
+#define LATCH_MS (FAULT_SET_MS + 10) // Median delay and sweep granularity on top of the debounce
+#define CLEAR_SLACK_MS 10          // The clear is counted in whole sweeps from the first healthy one
+#define MAX_PHASES 3
+
+typedef struct {
+    uint32_t from_ms;
+    uint16_t mv;                    // Divider-scaled, at the sensor
+    uint16_t noise;                 // Codes either side
+} phase_t;
+
+typedef struct {
+    const char *name;
+    int channel;
+    fault_code_t expect;            // Latched at the end of the fault, FAULT_NONE if nothing may latch
+    uint32_t latch_ms;              // Longest time from FAULT_AT_MS to the first latch
+    uint32_t restore_ms;            // When the input is healthy again (for a step, the step itself)
+    uint32_t run_ms;
+    phase_t phases[MAX_PHASES];     // Overrides of the input from `from_ms`, in order
+} trace_t;
+
+static const trace_t traces[] = {
+    { "open (pressure)", 0, FAULT_OPEN, LATCH_MS, 2000, 3000,
+      { { FAULT_AT_MS, 0, 0 }, { 2000, 2000, HEALTHY_NOISE } } },
+    { "short to 5 V (pressure)", 3, FAULT_SHORT_5V, LATCH_MS, 2000, 3000,
+      { { FAULT_AT_MS, 5000, 0 }, { 2000, 2000, HEALTHY_NOISE } } },
+    { "open (NTC)", 8, FAULT_OPEN, LATCH_MS, 2000, 3000,
+      { { FAULT_AT_MS, PULLUP_VREF_MV, HEALTHY_NOISE }, { 2000, 2500, HEALTHY_NOISE } } },
+    { "open (TMAP NTC, pins the ADC)", 7, FAULT_OPEN, LATCH_MS, 2000, 3000,
+      { { FAULT_AT_MS, PULLUP_VREF_MV, 0 }, { 2000, 2500, HEALTHY_NOISE } } },
+    { "short to ground (NTC)", 9, FAULT_SHORT_GND, LATCH_MS, 2000, 3000,
+      { { FAULT_AT_MS, 0, 0 }, { 2000, 2500, HEALTHY_NOISE } } },
+    { "stuck (oversampled)", 2, FAULT_STUCK, 0, 7000, 8000,
+      { { FAULT_AT_MS, 2000, 0 }, { 7000, 2000, HEALTHY_NOISE } } },
+    { "noise (oversampled)", 1, FAULT_NOISE, LATCH_MS, 2000, 3000,
+      { { FAULT_AT_MS, 2000, 800 }, { 2000, 2000, HEALTHY_NOISE } } },
+    { "implausible step (NTC)", 8, FAULT_RATE, 5, FAULT_AT_MS, 2000,
+      { { FAULT_AT_MS, 3300, HEALTHY_NOISE } } },
+    { "10 ms dropout (pressure)", 0, FAULT_NONE, 0, FAULT_AT_MS, 2000,
+      { { FAULT_AT_MS, 0, 0 }, { FAULT_AT_MS + 10, 2000, HEALTHY_NOISE } } },
+    { "hovering at the threshold (pressure)", 0, FAULT_OPEN, LATCH_MS, 3000, 4000,
+      { { FAULT_AT_MS, 0, 0 }, { 1500, 300, HEALTHY_NOISE }, { 3000, 2000, HEALTHY_NOISE } } },
+};
+
+static uint32_t rng = 0x9E3779B9u;
+static uint32_t xorshift(void) {
+    rng ^= rng << 13;
+    rng ^= rng >> 17;
+    rng ^= rng << 5;
+    return rng;
+}
+
+static int benchCali(void *ctx, int channel, int raw) {
+    return raw * FULL_SCALE_MV / MAX_CODE;
+}
+
+static uint16_t codeFor(int ch, uint16_t mv) {
+    long code = lroundf(mv / channel_table[ch].divider * MAX_CODE / FULL_SCALE_MV);
+    return (uint16_t)(code > MAX_CODE ? MAX_CODE : code);
+}
+
+static uint16_t healthyMv(int ch) {
+    return (channel_table[ch].conversion == CHANNEL_CONVERT_TABLE) ? 2500 : 2000;
+}
+
+/**
+ * @brief Feeds one sweep of samples, each channel at `code[ch]` plus up to `noise[ch]` codes either side.
+ */
+static void feedSweep(adc_stream_t *stream, const uint16_t *code, const uint16_t *noise) {
+    uint8_t buf[ADC_STREAM_FRAME_BYTES];
+    uint32_t len = 0;
+    for (int s = 0; s < ADC_STREAM_SWEEP_SAMPLES; s++) {
+        for (int ch = 0; ch < ADC_STREAM_NUM_CHANNELS; ch++) {
+            int value = code[ch];
+            if (noise[ch] != 0) value += (int)(xorshift() % (2u * noise[ch] + 1u)) - noise[ch];
+            value = value < 0 ? 0 : value > MAX_CODE ? MAX_CODE : value;
+            uint32_t word = ADC_STREAM_WORD(BENCH_UNIT, ch, value);
+            memcpy(&buf[len], &word, sizeof(word));
+            len += sizeof(word);
+        }
+    }
+    adcStreamDemux(stream, buf, len);
+}
+
+static esp_err_t noRead(void *ctx, uint8_t *buf, uint32_t len, uint32_t *out_len, uint32_t timeout_ms) { return ESP_ERR_TIMEOUT; }
+static const adc_stream_hal_t no_hal = { .read = noRead };
+
+/**
+ * @brief Runs one trace and returns the number of mismatches, printing what happened.
+ */
+static int runTrace(const trace_t *t) {
+    static channel_pipeline_t pipeline;
+    static adc_stream_t stream;
+    ESP_ERROR_CHECK(channelsInit(&pipeline, channel_table, SNAPSHOT_NUM_CHANNELS, benchCali, NULL));
+    ESP_ERROR_CHECK(adcStreamInit(&stream, &no_hal, BENCH_UNIT));
+
+    const channel_desc_t *d = &channel_table[t->channel];
+    uint32_t bit = 1u << t->channel;
+    sensor_values_t values = {0};
+    uint16_t code[ADC_STREAM_NUM_CHANNELS], noise[ADC_STREAM_NUM_CHANNELS];
+    int64_t first_latch_ms = -1, clear_ms = -1;
+    uint32_t latches = 0, bystanders = 0, bad_failsafe = 0, unmarked = 0;
+    fault_code_t at_restore = FAULT_NONE;
+    uint32_t prev_faulted = 0;
+
+    for (uint64_t us = 0; us < t->run_ms * 1000ull; us += SWEEP_US) {
+        uint32_t ms = (uint32_t)(us / 1000);
+        for (int ch = 0; ch < ADC_STREAM_NUM_CHANNELS; ch++) {
+            code[ch] = codeFor(ch, healthyMv(ch));
+            noise[ch] = HEALTHY_NOISE;
+        }
+        for (int p = 0; p < MAX_PHASES && t->phases[p].from_ms != 0; p++) {
+            if (ms < t->phases[p].from_ms) break;
+            code[t->channel] = codeFor(t->channel, t->phases[p].mv);
+            noise[t->channel] = t->phases[p].noise;
+        }
+        feedSweep(&stream, code, noise);
+        channelsFilterSweep(&pipeline, &stream, &values);
+        channelsConvert(&pipeline, &values);
+        adcStreamSweepConsume(&stream);
+        values.sweep++;
+        uint32_t changed = channelsMarkChanges(&pipeline, &values);
+
+        if ((values.faulted & ~bit) != 0) bystanders++;
+        bool latched = (values.faulted & bit) != 0;
+        if (latched && !(prev_faulted & bit)) {
+            latches++;
+            if (first_latch_ms < 0) first_latch_ms = ms;
+        }
+        if (!latched && (prev_faulted & bit) && clear_ms < 0) clear_ms = ms;
+        if (((values.faulted ^ prev_faulted) & bit) && !(changed & bit)) unmarked++;
+        if (latched && d->slot != SENSOR_SLOT_NONE && values.outputs[d->slot] != d->fault.failsafe) bad_failsafe++;
+        if (ms < t->restore_ms || at_restore == FAULT_NONE) at_restore = (fault_code_t)values.fault[t->channel];
+        prev_faulted = values.faulted;
+    }
+
+    int failures = 0;
+    uint32_t latch_limit = t->latch_ms ? t->latch_ms : d->fault.stuck_ms + (uint32_t)LATCH_MS;
+    double latch_after = first_latch_ms >= 0 ? (double)(first_latch_ms - FAULT_AT_MS) : -1.0;
+    double clear_after = clear_ms >= 0 ? (double)(clear_ms - (int64_t)t->restore_ms) : -1.0;
+    if (t->expect == FAULT_NONE) {
+        failures += latches != 0;
+    } else {
+        failures += first_latch_ms < 0 || latch_after > latch_limit;
+        failures += latches != 1 || at_restore != t->expect;
+        failures += clear_after < 0 || fabs(clear_after - FAULT_CLEAR_MS) > CLEAR_SLACK_MS;
+    }
+    failures += bystanders != 0 || bad_failsafe != 0 || unmarked != 0;
+
+    printf("%-38s input %2d %-9s latched after %6.1f ms (limit %4u), %u latch, cleared %6.1f ms after recovery%s\n",
+           t->name, t->channel + 1, faultName(at_restore), latch_after, (unsigned)latch_limit, (unsigned)latches, clear_after,
+           failures ? "  MISMATCH" : "");
+    if (bystanders || bad_failsafe || unmarked) {
+        printf("  %u sweeps with another input faulted, %u without the failsafe, %u changes not marked\n",
+               (unsigned)bystanders, (unsigned)bad_failsafe, (unsigned)unmarked);
+    }
+    return failures ? 1 : 0;
+}
+
+/**
+ * @brief Times the filter pass (with the classifier) and the classifier alone on healthy inputs.
+ */
+static void benchCost(uint32_t sweeps) {
+    static channel_pipeline_t pipeline;
+    static adc_stream_t stream;
+    ESP_ERROR_CHECK(channelsInit(&pipeline, channel_table, SNAPSHOT_NUM_CHANNELS, benchCali, NULL));
+    ESP_ERROR_CHECK(adcStreamInit(&stream, &no_hal, BENCH_UNIT));
+
+    uint16_t code[ADC_STREAM_NUM_CHANNELS], noise[ADC_STREAM_NUM_CHANNELS];
+    for (int ch = 0; ch < ADC_STREAM_NUM_CHANNELS; ch++) {
+        code[ch] = codeFor(ch, healthyMv(ch));
+        noise[ch] = HEALTHY_NOISE;
+    }
+    fault_input_t *inputs = malloc((size_t)sweeps * ADC_STREAM_NUM_CHANNELS * sizeof(*inputs));
+    if (inputs == NULL) return;
+
+    sensor_values_t values = {0};
+    uint16_t samples[ADC_STREAM_RING_DEPTH];
+    uint64_t filter_ns = 0;
+    for (uint32_t s = 0; s < sweeps; s++) {
+        feedSweep(&stream, code, noise);
+        for (int ch = 0; ch < ADC_STREAM_NUM_CHANNELS; ch++) {
+            fault_input_t *in = &inputs[(size_t)s * ADC_STREAM_NUM_CHANNELS + ch];
+            size_t n = adcStreamLatest(&stream, ch, samples, adcStreamFresh(&stream, ch));
+            *in = (fault_input_t){ .min_code = UINT16_MAX, .max_code = 0, .updated = true };
+            for (size_t i = 0; i < n; i++) {
+                if (samples[i] < in->min_code) in->min_code = samples[i];
+                if (samples[i] > in->max_code) in->max_code = samples[i];
+            }
+        }
+        uint64_t t0 = hostMonotonicNs();
+        channelsFilterSweep(&pipeline, &stream, &values);
+        filter_ns += hostMonotonicNs() - t0;
+        for (int ch = 0; ch < ADC_STREAM_NUM_CHANNELS; ch++) inputs[(size_t)s * ADC_STREAM_NUM_CHANNELS + ch].mv = values.filtered_mv[ch];
+        adcStreamSweepConsume(&stream);
+    }
+
+    fault_state_t states[ADC_STREAM_NUM_CHANNELS];
+    for (int ch = 0; ch < ADC_STREAM_NUM_CHANNELS; ch++) states[ch] = pipeline.faults[ch];
+    uint32_t sink = 0;
+    uint64_t t0 = hostMonotonicNs();
+    for (uint32_t s = 0; s < sweeps; s++) {
+        for (int ch = 0; ch < ADC_STREAM_NUM_CHANNELS; ch++) {
+            sink += faultUpdate(&states[ch], &channel_table[ch].fault, &inputs[(size_t)s * ADC_STREAM_NUM_CHANNELS + ch]);
+        }
+    }
+    uint64_t fault_ns = hostMonotonicNs() - t0;
+    free(inputs);
+
+    printf("cost over %u sweeps: filter pass %.1f ns/sweep, of which classifying ~%.1f ns/sweep (%.1f ns/channel, sink %u)\n",
+           (unsigned)sweeps, (double)filter_ns / sweeps, (double)fault_ns / sweeps,
+           (double)fault_ns / sweeps / ADC_STREAM_NUM_CHANNELS, (unsigned)sink);
+}
+
+int main(int argc, char **argv) {
+    uint32_t sweeps = (argc > 1) ? (uint32_t)strtoul(argv[1], NULL, 10) : 400000;
+    if (sweeps == 0) {
+        fprintf(stderr, "usage: %s [bench sweeps]\n", argv[0]);
+        return 1;
+    }
+
+    printf("%u us sweeps, latch after %u ms, clear after %u ms, %u mV hysteresis\n", (unsigned)SWEEP_US, FAULT_SET_MS,
+           FAULT_CLEAR_MS, FAULT_HYST_MV);
+    int failures = 0;
+    for (size_t i = 0; i < sizeof(traces) / sizeof(traces[0]); i++) failures += runTrace(&traces[i]);
+    benchCost(sweeps);
+
+    printf("result traces=%zu failures=%d%s\n", sizeof(traces) / sizeof(traces[0]), failures, failures ? "  MISMATCH" : "");
+    return failures ? 1 : 0;
+}
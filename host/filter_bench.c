@@ -0,0 +1,84 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "inc/channels.h"
+#include "inc/filters.h"
+#include "synthetic_adc.h"
+
+/**
+ * @brief Checks the streaming median against medianFilterHelper() and times both.
+ *
+ * Feeds a noisy ramp with occasional spikes through filterPush() for each
+ * window depth and compares every output with the batch median of the same
+ * window, then reports nanoseconds per sample for the sliding filter and for
+ * re-sorting the window on every sample.
+ *
+ * Usage: filter_bench [samples]
+ */
+
+static uint16_t nextSample(uint32_t *state, uint32_t n) {
+    *state = *state * 1664525u + 1013904223u;
+    uint16_t value = (uint16_t)(2048 + (int)((n / 8) % 1024) - 512 + (int)((*state >> 24) % 31) - 15);
+    if (((*state >> 8) & 0xFF) == 0) value = (*state & 0x100) ? 4095 : 0; // Spike
+    return value;
+}
+
+int main(int argc, char **argv) {
+    uint32_t samples = (argc > 1) ? (uint32_t)strtoul(argv[1], NULL, 10) : 1000000;
+    static const uint8_t depths[] = { 5, 9, 15, 31 };
+    uint16_t *input = malloc(samples * sizeof(uint16_t));
+    if (input == NULL) return 1;
+
+    uint32_t state = 1;
+    for (uint32_t n = 0; n < samples; n++) input[n] = nextSample(&state, n);
+
+    int failures = 0;
+    for (size_t d = 0; d < sizeof(depths) / sizeof(depths[0]); d++) {
+        uint8_t depth = depths[d];
+        stream_filter_t filter;
+        filterInit(&filter, depth, 0.0f, 0);
+
+        uint32_t mismatches = 0;
+        uint16_t window[FILTER_MAX_DEPTH];
+        for (uint32_t n = 0; n < samples; n++) {
+            uint16_t out = filterPush(&filter, input[n]);
+            uint32_t count = (n + 1 < depth) ? n + 1 : depth;
+            memcpy(window, &input[n + 1 - count], count * sizeof(uint16_t));
+            if (out != medianFilterHelper(window, (int)count)) mismatches++;
+        }
+
+        volatile uint16_t sink = 0;
+        filterReset(&filter);
+        uint64_t t0 = hostMonotonicNs();
+        for (uint32_t n = 0; n < samples; n++) sink += filterPush(&filter, input[n]);
+        uint64_t stream_ns = hostMonotonicNs() - t0;
+
+        t0 = hostMonotonicNs();
+        for (uint32_t n = depth; n < samples; n++) {
+            memcpy(window, &input[n - depth], depth * sizeof(uint16_t));
+            sink += medianFilterHelper(window, depth);
+        }
+        uint64_t batch_ns = hostMonotonicNs() - t0;
+        (void)sink;
+
+        printf("depth %2u: %u mismatches, streaming %.1f ns/sample, re-sort %.1f ns/sample\n",
+               depth, mismatches, (double)stream_ns / samples, (double)batch_ns / (samples - depth));
+        if (mismatches) failures++;
+    }
+
+    stream_filter_t smooth;
+    filterInit(&smooth, 5, 0.125f, 8);
+    uint16_t prev = filterPush(&smooth, input[0]);
+    uint32_t max_step = 0;
+    for (uint32_t n = 1; n < samples; n++) {
+        uint16_t out = filterPush(&smooth, input[n]);
+        uint32_t step = (out > prev) ? out - prev : prev - out;
+        if (step > max_step) max_step = step;
+        prev = out;
+    }
+    printf("median 5 + IIR 0.125 + slew 8: largest output step %u codes\n", max_step);
+
+    free(input);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,340 @@
+#include <math.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "esp_err.h"
+#include "esp_system.h"
+#include "inc/boot.h"
+#include "inc/can_rx.h"
+#include "inc/can_sched.h"
+#include "inc/can_signals.h"
+#include "inc/capture.h"
+#include "inc/diag.h"
+#include "inc/inputs.h"
+#include "inc/tasks.h"
+#include "flash_file.h"
+#include "sim.h"
+
+/**
+ * @brief Runs the whole firmware on the host, end to end, against the ESP-IDF shims.
+ *
+ * app_main() starts the real ADC, transmit, receive and logger tasks as
+ * pthreads on a simulation clock running `speed` times faster than real
+ * time. Input 1 steps between two levels every STEP_MS; every frame the
+ * board transmits is captured, and the time from each step to the first
+ * ANALOG_VOLTAGE_1 frame (PACKED_VOLTAGES page 0 in the packed build) that
+ * shows it is the sensor→CAN latency. An EMU Black stream and unsubscribed
+ * PMU frames are injected towards the board so reception, the acceptance
+ * filter and the flash logger run too. The board's own diagnostics frames
+ * are decoded and the last window of each metric printed, as is the boot
+ * timeline: when each init step ran, the first frame, and the first frame
+ * packed once every input was valid. The task and system load frames are
+ * decoded too: each task's CPU share and free stack, each core's load and
+ * the heap, as the shim scheduler measures them (see sim.h); with
+ * CONFIG_CANBOARD_DIAG the run fails if a running task never shows up in
+ * them or any system load frame flags a task with less than
+ * LOAD_STACK_MARGIN of its stack never used. Each frequency input in
+ * capture_table is driven with a 40 % square wave, and the run fails if
+ * the last capture values frame is more than 0.1 % off its frequency (or,
+ * for a duty input, 0.5 % off its duty). The free heap is read BOOTED_MS
+ * into the run and at its end; with CONFIG_CANBOARD_STATIC_ALLOCATION the
+ * run fails if anything was taken from the heap in between. Timing
+ * resolution is the host's sleep overshoot times `speed`, so compare runs
+ * made at the same speed.
+ *
+ * The last line is `key=value` pairs for regression scripts.
+ *
+ * Usage: firmware_sim [sim seconds] [speed] [log level 0-5]
+ */
+
+#define STEP_MS 250
+#define STEP_CHANNEL 0
+#define STEP_LOW_RAW 1000
+#define STEP_HIGH_RAW 3000
+#define EMU_PERIOD_MS 20
+#define PMU_PERIOD_MS 50
+#define MAX_TRACKED_IDS 16
+#define MAX_STEPS 4096
+#define CAPTURE_DUTY 0.4
+#define BOOTED_MS 1000              // Boot is long over: every task is up and the log mounted
+
+static const double capture_hz[CAPTURE_MAX_INPUTS] = { 1234.56, 87.5 };
+
+typedef struct {
+    uint32_t id;
+    uint32_t frames;
+    uint64_t last_ns;
+    uint64_t min_gap_ns;
+    uint64_t max_gap_ns;
+} tx_track_t;
+
+static struct {
+    pthread_mutex_t lock;
+    tx_track_t ids[MAX_TRACKED_IDS];
+    size_t id_count;
+    uint64_t frames;
+
+    // Input 1 step tracking, in millivolts as carried on the bus
+    bool step_pending;
+    bool step_high;
+    uint64_t step_ns;
+    uint16_t last_mv;
+    uint16_t plateau_mv[2];     // Settled value at the low and high level, 0 until seen
+    uint64_t latency_ns[MAX_STEPS];
+    size_t steps;
+
+    diagnostics_t diag[DIAG_METRIC_COUNT];   // Last diagnostics frame per metric
+    taskLoad_t task_load[TASK_COUNT];         // Last load frame per task
+    uint32_t task_load_seen;                  // Bit per task with a load frame
+    systemLoad_t system_load;
+    uint8_t low_stack;                        // lowStackTasks of every system load frame, ORed
+    captureValues_t capture;                  // Last capture values frame
+
+    // Boot, as seen on the bus
+    uint64_t first_frame_ns;
+    uint32_t first_frame_id;
+    uint64_t running_ns;        // First board status frame reporting every input valid
+} bus = { .lock = PTHREAD_MUTEX_INITIALIZER };
+
+static void trackFrame(const twai_message_t *msg, uint64_t now) {
+    tx_track_t *t = NULL;
+    for (size_t i = 0; i < bus.id_count; i++) {
+        if (bus.ids[i].id == msg->identifier) t = &bus.ids[i];
+    }
+    if (t == NULL && bus.id_count < MAX_TRACKED_IDS) {
+        t = &bus.ids[bus.id_count++];
+        *t = (tx_track_t){ .id = msg->identifier, .min_gap_ns = UINT64_MAX };
+    }
+    if (t == NULL) return;
+    if (t->frames++ > 0) {
+        uint64_t gap = now - t->last_ns;
+        if (gap < t->min_gap_ns) t->min_gap_ns = gap;
+        if (gap > t->max_gap_ns) t->max_gap_ns = gap;
+    }
+    t->last_ns = now;
+}
+
+/**
+ * @brief TWAI sink: counts every frame and times input 1 steps through ANALOG_VOLTAGE_1
+ *        (or page 0 of PACKED_VOLTAGES with CONFIG_CANBOARD_CAN_PACKED).
+ */
+static void onTransmit(void *ctx, const twai_message_t *msg) {
+    uint64_t now = simNowNs();
+    pthread_mutex_lock(&bus.lock);
+    if (bus.frames++ == 0) {
+        bus.first_frame_ns = now;
+        bus.first_frame_id = msg->identifier;
+    }
+    trackFrame(msg, now);
+    int input1_mv = -1;
+    if (msg->identifier == ANALOG_VOLTAGE_1_ID) {
+        analogVoltage_1_t m;
+        analogVoltage_1_unpack(&m, msg->data);
+        input1_mv = m.input1_voltage;
+    } else if (msg->identifier == PACKED_VOLTAGES_ID) {
+        packedVoltages_t m;
+        packedVoltages_unpack(&m, msg->data);
+        if (m.voltagePage == 0) input1_mv = m.input1_voltage * 2;
+    } else if (msg->identifier == DIAGNOSTICS_ID) {
+        diagnostics_t m;
+        diagnostics_unpack(&m, msg->data);
+        if (m.diagMetric < DIAG_METRIC_COUNT) bus.diag[m.diagMetric] = m;
+    } else if (msg->identifier == TASK_LOAD_ID) {
+        taskLoad_t m;
+        taskLoad_unpack(&m, msg->data);
+        // Frames from before the first load window are all zeros
+        if (m.loadTask < TASK_COUNT && m.loadStackSize != 0) {
+            bus.task_load[m.loadTask] = m;
+            bus.task_load_seen |= 1u << m.loadTask;
+        }
+    } else if (msg->identifier == SYSTEM_LOAD_ID) {
+        systemLoad_unpack(&bus.system_load, msg->data);
+        bus.low_stack |= bus.system_load.lowStackTasks;
+    } else if (msg->identifier == CAPTURE_VALUES_ID) {
+        captureValues_unpack(&bus.capture, msg->data);
+    } else if (msg->identifier == BOARD_STATUS_ID && bus.running_ns == 0) {
+        boardStatus_t m;
+        boardStatus_unpack(&m, msg->data);
+        if (m.channelValid == SNAPSHOT_ALL_CHANNELS) bus.running_ns = now;
+    }
+
+    if (input1_mv >= 0) {
+        uint16_t lo = bus.plateau_mv[0], hi = bus.plateau_mv[1];
+        if (bus.step_pending && lo != 0 && hi != 0) {
+            uint16_t mid = (uint16_t)((lo + hi) / 2);
+            if ((bus.step_high && input1_mv >= mid) || (!bus.step_high && input1_mv <= mid)) {
+                if (bus.steps < MAX_STEPS) bus.latency_ns[bus.steps++] = now - bus.step_ns;
+                bus.step_pending = false;
+            }
+        }
+        bus.last_mv = (uint16_t)input1_mv;
+    }
+    pthread_mutex_unlock(&bus.lock);
+}
+
+static void stepInput(bool high, uint64_t now) {
+    pthread_mutex_lock(&bus.lock);
+    // The value on the bus just before a step is the settled level of the previous half-period
+    if (bus.step_ns != 0) bus.plateau_mv[!high] = bus.last_mv;
+    bus.step_pending = true;
+    bus.step_high = high;
+    bus.step_ns = now;
+    pthread_mutex_unlock(&bus.lock);
+    simAdcSetLevel(STEP_CHANNEL, high ? STEP_HIGH_RAW : STEP_LOW_RAW);
+}
+
+static void injectEmu(uint32_t ms, uint32_t *accepted, uint32_t *offered) {
+    uint16_t rpm = (uint16_t)(800 + ms % 6000);
+    twai_message_t frames[] = {
+        { .identifier = EMU_STREAM_BASEID, .data_length_code = 8, .data = { (uint8_t)rpm, (uint8_t)(rpm >> 8), 40, 30, 180, 0 } },
+        { .identifier = EMU_STREAM_BASEID + 2, .data_length_code = 8, .data = { [6] = 85 } },
+        { .identifier = EMU_STREAM_BASEID + 3, .data_length_code = 8, .data = { [2] = 128 } },
+    };
+    for (size_t i = 0; i < sizeof(frames) / sizeof(frames[0]); i++) {
+        *accepted += simTwaiInject(&frames[i]);
+        (*offered)++;
+    }
+}
+
+static void injectPmu(uint32_t *accepted, uint32_t *offered) {
+    for (uint32_t i = 0; i < 16; i++) {
+        twai_message_t msg = { .identifier = 0x500 + i, .data_length_code = 8 };
+        *accepted += simTwaiInject(&msg);
+        (*offered)++;
+    }
+}
+
+static int compareU64(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+extern void app_main(void);
+
+int main(int argc, char **argv) {
+    uint32_t seconds = (argc > 1) ? (uint32_t)strtoul(argv[1], NULL, 10) : 10;
+    double speed = (argc > 2) ? strtod(argv[2], NULL) : 10.0;
+    int level = (argc > 3) ? atoi(argv[3]) : ESP_LOG_WARN;
+    if (seconds == 0 || speed <= 0.0) {
+        fprintf(stderr, "usage: %s [sim seconds] [speed] [log level 0-5]\n", argv[0]);
+        return 1;
+    }
+
+    simLogLevel((esp_log_level_t)level);
+    synthetic_adc_t *src = simAdcSource();
+    src->amplitude[STEP_CHANNEL] = 0;
+    src->level[STEP_CHANNEL] = STEP_LOW_RAW;
+
+    for (size_t i = 0; i < capture_table_count; i++) {
+        simCaptureSetSignal(CAPTURE_INPUT_GPIO(capture_table[i].input), capture_hz[i], CAPTURE_DUTY);
+    }
+
+    static flash_file_t ff;
+    ESP_ERROR_CHECK(flashFileOpen(&ff, NULL, 16 * CAN_LOG_SEGMENT_BYTES));
+    simFlashAttach("canlog", &ff);
+    simTwaiSetTxSink(onTransmit, NULL);
+
+    uint64_t real_start = hostMonotonicNs();
+    simInit(speed);
+    app_main();
+
+    // Script the inputs on a 1 ms grid until the simulated run is over
+    uint32_t accepted = 0, offered = 0;
+    bool high = false;
+    uint32_t heap_booted = 0;
+    for (uint32_t ms = 1; ms <= seconds * 1000u; ms++) {
+        simSleepUntilNs(ms * 1000000ull);
+        if (ms == BOOTED_MS) heap_booted = esp_get_free_heap_size();
+        if (ms % STEP_MS == 0) stepInput(high = !high, simNowNs());
+        if (ms % EMU_PERIOD_MS == 0) injectEmu(ms, &accepted, &offered);
+        if (ms % PMU_PERIOD_MS == 0) injectPmu(&accepted, &offered);
+    }
+    double real_s = (double)(hostMonotonicNs() - real_start) / 1e9;
+    uint32_t heap_end = esp_get_free_heap_size();
+    int64_t heap_after_boot = (heap_booted != 0) ? (int64_t)heap_booted - heap_end : 0;
+
+    sensor_values_t values;
+    snapshotRead(&sensor_snapshot, &values);
+
+    pthread_mutex_lock(&bus.lock);
+    printf("run: %u s simulated in %.2f s (%.1fx real time)\n", seconds, real_s, seconds / real_s);
+    printf("adc: %u sweeps (%.0f/s)\n", (unsigned)values.sweep, values.sweep / (double)seconds);
+    printf("tx: %llu frames\n", (unsigned long long)bus.frames);
+    for (size_t i = 0; i < bus.id_count; i++) {
+        const tx_track_t *t = &bus.ids[i];
+        printf("  0x%03X %6u frames %6.1f Hz, gap %.2f..%.2f ms\n", (unsigned)t->id, (unsigned)t->frames, t->frames / (double)seconds,
+               t->min_gap_ns == UINT64_MAX ? 0.0 : t->min_gap_ns / 1e6, t->max_gap_ns / 1e6);
+    }
+    printf("rx: %u of %u injected frames passed the acceptance filter, ecu rpm %u clt %d C (%u frames)\n",
+           (unsigned)accepted, (unsigned)offered, ecu_values.rpm, ecu_values.clt_c, (unsigned)ecu_values.frames);
+
+    printf("diagnostics frame 0x%03X, last window per metric:\n", DIAGNOSTICS_ID);
+    for (int i = 0; i < DIAG_METRIC_COUNT; i++) {
+        const diagnostics_t *d = &bus.diag[i];
+        printf("  %-14s min %5u avg %5u p99 %5u max %5u\n", diagMetricName((diag_metric_id_t)i), d->diagMin, d->diagAvg,
+               d->diagP99, d->diagMax);
+    }
+
+    printf("load frames 0x%03X/0x%03X, last window per task (host CPU per simulated second):\n", TASK_LOAD_ID, SYSTEM_LOAD_ID);
+    uint32_t expected_tasks = 0;
+    for (int t = 0; t < TASK_COUNT; t++) {
+        const taskLoad_t *l = &bus.task_load[t];
+        if (!task_placement[t].transient) expected_tasks |= 1u << t;
+        if (!(bus.task_load_seen & (1u << t))) continue;
+        printf("  %-14s core %u prio %2u cpu %5.1f%% stack %5u of %5u free\n", task_placement[t].name, l->loadCore, l->loadPriority,
+               l->loadCpu / 10.0, l->loadStackFree, l->loadStackSize);
+    }
+    const systemLoad_t *sl = &bus.system_load;
+    bool load_ok = !CONFIG_CANBOARD_DIAG || ((bus.task_load_seen & expected_tasks) == expected_tasks && bus.low_stack == 0);
+    printf("  core0 %.1f%% core1 %.1f%%, heap %u KiB free, %u KiB min free, %u KiB largest block, low stack tasks 0x%02X%s\n",
+           sl->core0Load / 10.0, sl->core1Load / 10.0, sl->heapFree, sl->heapMinFree, sl->heapLargestBlock, bus.low_stack,
+           load_ok ? "" : "  MISMATCH");
+
+    printf("capture frame 0x%03X, last values:\n", CAPTURE_VALUES_ID);
+    bool capture_ok = true;
+    for (size_t i = 0; i < capture_table_count; i++) {
+        uint32_t freq = i ? bus.capture.capture2Frequency : bus.capture.capture1Frequency;
+        uint16_t duty = i ? bus.capture.capture2Duty : bus.capture.capture1Duty;
+        double expected_duty = capture_table[i].mode == CAPTURE_FREQUENCY_DUTY ? CAPTURE_DUTY * CAPTURE_DUTY_FULL : 0;
+        bool ok = fabs(freq / 100.0 - capture_hz[i]) <= capture_hz[i] * 0.001 && fabs(duty - expected_duty) <= 5;
+        printf("  input %u %-12s %9.2f Hz (driven %.2f Hz) duty %5.1f%%%s\n", capture_table[i].input + 1, capture_table[i].name,
+               freq / 100.0, capture_hz[i], duty / 10.0, ok ? "" : "  MISMATCH");
+        capture_ok = capture_ok && ok;
+    }
+
+    printf("boot timeline (ms since start):\n");
+    for (boot_step_t step = 0; step < BOOT_STEP_COUNT; step++) {
+        uint32_t start = bootStartUs(&boot_timeline, step), end = bootEndUs(&boot_timeline, step);
+        if (start != 0) printf("  %-13s %8.3f to %8.3f\n", bootStepName(step), start / 1000.0, end / 1000.0);
+        else printf("  %-13s %8s    %8.3f\n", bootStepName(step), "", end / 1000.0);
+    }
+    printf("boot on the bus: first frame 0x%03X at %.3f ms, status reports every input valid at %.3f ms\n",
+           (unsigned)bus.first_frame_id, bus.first_frame_ns / 1e6, bus.running_ns / 1e6);
+    bool booted = bootReached(&boot_timeline, BOOT_STEP_VALID_FRAME);
+    bool heap_ok = !CONFIG_CANBOARD_STATIC_ALLOCATION || heap_after_boot <= 0;
+    printf("heap: %u bytes free %u ms after start, %u at the end: %lld bytes taken after boot%s\n", (unsigned)heap_booted,
+           BOOTED_MS, (unsigned)heap_end, (long long)heap_after_boot, heap_ok ? "" : "  MISMATCH");
+
+    size_t steps = bus.steps;
+    qsort(bus.latency_ns, steps, sizeof(bus.latency_ns[0]), compareU64);
+    double sum = 0;
+    for (size_t i = 0; i < steps; i++) sum += (double)bus.latency_ns[i];
+    double min_ms = steps ? bus.latency_ns[0] / 1e6 : 0, max_ms = steps ? bus.latency_ns[steps - 1] / 1e6 : 0;
+    double avg_ms = steps ? sum / steps / 1e6 : 0, p99_ms = steps ? bus.latency_ns[(steps * 99) / 100] / 1e6 : 0;
+    printf("latency: input %d step to 0x%03X, %zu steps, min %.2f avg %.2f p99 %.2f max %.2f ms\n", STEP_CHANNEL + 1,
+           CONFIG_CANBOARD_CAN_PACKED ? PACKED_VOLTAGES_ID : ANALOG_VOLTAGE_1_ID, steps, min_ms, avg_ms, p99_ms, max_ms);
+    printf("result speed=%.1f sweeps_per_s=%.0f tx_frames=%llu rx_accepted=%u latency_avg_ms=%.2f latency_p99_ms=%.2f latency_max_ms=%.2f "
+           "first_frame_ms=%.2f valid_frame_ms=%.2f core0_load_pct=%.1f core1_load_pct=%.1f heap_min_free_kib=%u "
+           "heap_after_boot_bytes=%lld capture1_hz=%.2f capture2_hz=%.2f%s\n",
+           seconds / real_s, values.sweep / (double)seconds, (unsigned long long)bus.frames, (unsigned)accepted, avg_ms, p99_ms, max_ms,
+           bootEndUs(&boot_timeline, BOOT_STEP_FIRST_FRAME) / 1000.0, bootEndUs(&boot_timeline, BOOT_STEP_VALID_FRAME) / 1000.0,
+           sl->core0Load / 10.0, sl->core1Load / 10.0, sl->heapMinFree, (long long)heap_after_boot, bus.capture.capture1Frequency / 100.0,
+           bus.capture.capture2Frequency / 100.0, load_ok && capture_ok && heap_ok ? "" : " MISMATCH");
+    pthread_mutex_unlock(&bus.lock);
+
+    // Firmware tasks never return, so leave without joining them
+    fflush(stdout);
+    _Exit(steps > 0 && booted && load_ok && capture_ok && heap_ok ? 0 : 1);
+}
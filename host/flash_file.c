@@ -0,0 +1,124 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "flash_file.h"
+
+static esp_err_t flashFileRead(void *ctx, uint32_t offset, void *buf, uint32_t len) {
+    flash_file_t *ff = ctx;
+    if ((uint64_t)offset + len > ff->size) return ESP_ERR_INVALID_SIZE;
+    memcpy(buf, &ff->mem[offset], len);
+    return ESP_OK;
+}
+
+static void writeThrough(flash_file_t *ff, uint32_t offset, uint32_t len) {
+    if (ff->file == NULL) return;
+    fseek(ff->file, offset, SEEK_SET);
+    fwrite(&ff->mem[offset], 1, len, ff->file);
+}
+
+static esp_err_t flashFileWrite(void *ctx, uint32_t offset, const void *buf, uint32_t len) {
+    flash_file_t *ff = ctx;
+    if ((uint64_t)offset + len > ff->size) return ESP_ERR_INVALID_SIZE;
+
+    uint32_t n = len;
+    if (ff->cut_after >= 0 && (int64_t)len > ff->cut_after) n = (uint32_t)ff->cut_after;
+
+    const uint8_t *src = buf;
+    for (uint32_t i = 0; i < n; i++) {
+        if ((src[i] & ~ff->mem[offset + i]) != 0) ff->violations++;
+        ff->mem[offset + i] &= src[i];
+    }
+    writeThrough(ff, offset, n);
+    ff->model_us += (uint64_t)((n + FLASH_MODEL_PAGE_BYTES - 1) / FLASH_MODEL_PAGE_BYTES) * FLASH_MODEL_PAGE_PROGRAM_US;
+
+    if (ff->cut_after >= 0) {
+        ff->cut_after -= n;
+        if (n < len || ff->cut_after == 0) {
+            ff->cut_after = 0;
+            if (n < len) return ESP_FAIL;
+        }
+    }
+    return ESP_OK;
+}
+
+static esp_err_t flashFileErase(void *ctx, uint32_t offset, uint32_t len) {
+    flash_file_t *ff = ctx;
+    if ((uint64_t)offset + len > ff->size || offset % FLASH_FILE_SECTOR_BYTES || len % FLASH_FILE_SECTOR_BYTES) return ESP_ERR_INVALID_ARG;
+    if (ff->cut_after == 0) return ESP_FAIL;
+
+    memset(&ff->mem[offset], 0xFF, len);
+    for (uint32_t s = offset / FLASH_FILE_SECTOR_BYTES; s < (offset + len) / FLASH_FILE_SECTOR_BYTES; s++) ff->sector_erases[s]++;
+    writeThrough(ff, offset, len);
+    ff->model_us += (uint64_t)(len / FLASH_FILE_SECTOR_BYTES) * FLASH_MODEL_SECTOR_ERASE_US;
+    return ESP_OK;
+}
+
+/**
+ * @brief Opens a flash stand-in.
+ *
+ * With a path, an existing file is loaded (its size wins when `size` is 0)
+ * and a missing one is created blank; every later write and erase is
+ * written through to it. Without a path the flash lives in memory only.
+ *
+ * @param ff The flash state
+ * @param path Backing file, or NULL
+ * @param size Flash size in bytes, a multiple of the sector size, or 0 to use the file's
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_INVALID_SIZE if the size is zero or not whole sectors
+ *      - ESP_ERR_NO_MEM if allocation fails
+ *      - ESP_FAIL if the file cannot be opened
+ */
+esp_err_t flashFileOpen(flash_file_t *ff, const char *path, uint32_t size) {
+    memset(ff, 0, sizeof(*ff));
+    ff->cut_after = -1;
+
+    if (path != NULL) {
+        ff->file = fopen(path, "r+b");
+        if (ff->file != NULL && size == 0) {
+            fseek(ff->file, 0, SEEK_END);
+            size = (uint32_t)ftell(ff->file);
+        } else if (ff->file == NULL) {
+            ff->file = fopen(path, "w+b");
+        }
+        if (ff->file == NULL) return ESP_FAIL;
+    }
+    if (size == 0 || size % FLASH_FILE_SECTOR_BYTES) {
+        flashFileClose(ff);
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    ff->size = size;
+    ff->mem = malloc(size);
+    ff->sector_erases = calloc(size / FLASH_FILE_SECTOR_BYTES, sizeof(uint32_t));
+    if (ff->mem == NULL || ff->sector_erases == NULL) {
+        flashFileClose(ff);
+        return ESP_ERR_NO_MEM;
+    }
+    memset(ff->mem, 0xFF, size);
+
+    if (ff->file != NULL) {
+        fseek(ff->file, 0, SEEK_SET);
+        size_t got = fread(ff->mem, 1, size, ff->file);
+        if (got < size) writeThrough(ff, (uint32_t)got, size - (uint32_t)got); // Extend a new or short file with erased bytes
+        fflush(ff->file);
+    }
+    return ESP_OK;
+}
+
+/**
+ * @brief Fills in a log flash interface backed by this stand-in.
+ */
+void flashFileHal(flash_file_t *ff, can_log_flash_t *flash) {
+    *flash = (can_log_flash_t){ .ctx = ff, .size = ff->size, .read = flashFileRead, .write = flashFileWrite, .erase = flashFileErase };
+}
+
+/**
+ * @brief Flushes the backing file and releases the stand-in.
+ */
+void flashFileClose(flash_file_t *ff) {
+    if (ff->file != NULL) fclose(ff->file);
+    free(ff->mem);
+    free(ff->sector_erases);
+    memset(ff, 0, sizeof(*ff));
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "inc/can_log.h"
+
+#define FLASH_FILE_SECTOR_BYTES 4096
+#define FLASH_MODEL_PAGE_BYTES 256
+#define FLASH_MODEL_PAGE_PROGRAM_US 400   // Typical page program time of the module's QSPI NOR
+#define FLASH_MODEL_SECTOR_ERASE_US 45000 // Typical 4 KiB sector erase time
+
+/**
+ * @brief NOR flash stand-in for host builds, optionally backed by a file.
+ *
+ * Behaves like the real part: erase sets whole sectors to 0xFF and writes
+ * can only clear bits, so a write over unerased data is counted as a
+ * violation (and ANDed in, as the hardware would). Per-sector erase counts
+ * show wear, and the busy time the same operations would take on the
+ * module's flash is accumulated in `model_us`.
+ *
+ * For power-loss tests, `cut_after` limits how many more bytes may be
+ * programmed; the write that crosses it is truncated and that and every
+ * later write or erase fails until the budget is reset.
+ */
+typedef struct {
+    uint8_t *mem;
+    uint32_t size;
+    FILE *file;                 // Write-through backing file, or NULL for memory only
+    uint32_t *sector_erases;
+    uint32_t violations;        // Writes that tried to set a programmed bit
+    int64_t cut_after;          // Bytes left before the simulated power cut, -1 for never
+    uint64_t model_us;          // Modeled busy time on the target flash
+} flash_file_t;
+
+esp_err_t flashFileOpen(flash_file_t *ff, const char *path, uint32_t size);
+void flashFileHal(flash_file_t *ff, can_log_flash_t *flash);
+void flashFileClose(flash_file_t *ff);
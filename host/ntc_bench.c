@@ -0,0 +1,70 @@
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "inc/ntc.h"
+#include "synthetic_adc.h"
+
+/**
+ * @brief Compares the fixed-point NTC lookup with the float reference.
+ *
+ * Sweeps every millivolt from 0 to the reference voltage for both sensor
+ * tables, reports the largest difference between ntcLutLookup() and
+ * getSensorTemperature() and where it occurs, then times both. Differences
+ * under 1°C are the reference truncating; larger ones on tmap_table are the
+ * reference landing in a non-monotonic segment.
+ *
+ * Usage: ntc_bench [iterations]
+ */
+
+static void compare(const char *name, const ntc_lut_t *lut, const ntc_point_t *table, size_t size) {
+    double max_err = 0.0;
+    int max_mv = 0, over_1c = 0, overflow = 0;
+    for (int mv = 0; mv <= PULLUP_VREF_MV; mv++) {
+        int8_t ref = getSensorTemperature(mv, NTC_PULLUP_OHMS, PULLUP_VREF_MV, table, size);
+        double lut_c = ntcLutLookup(lut, mv) / 10.0;
+        if (lut_c > INT8_MAX) { // The reference wraps its int8_t result above 127°C
+            overflow++;
+            continue;
+        }
+        double err = fabs(lut_c - ref);
+        if (err > 1.0) over_1c++;
+        if (err > max_err) {
+            max_err = err;
+            max_mv = mv;
+        }
+    }
+    printf("%-10s points kept %zu/%zu (%u breakpoints), max |lut - ref| %.1f C at %d mV, %d mV values differ by > 1 C, %d skipped (ref > 127 C)\n",
+           name, size - lut->dropped, size, lut->count, max_err, max_mv, over_1c, overflow);
+}
+
+int main(int argc, char **argv) {
+    uint32_t iterations = (argc > 1) ? (uint32_t)strtoul(argv[1], NULL, 10) : 20;
+    ntc_lut_t ntc_lut, tmap_lut;
+    if (ntcLutBuild(&ntc_lut, ntc_table, NTC_TABLE_SIZE(ntc_table), NTC_PULLUP_OHMS, PULLUP_VREF_MV) != ESP_OK ||
+        ntcLutBuild(&tmap_lut, tmap_table, NTC_TABLE_SIZE(tmap_table), NTC_PULLUP_OHMS, PULLUP_VREF_MV) != ESP_OK) {
+        printf("failed to build lookups\n");
+        return 1;
+    }
+
+    compare("ntc_table", &ntc_lut, ntc_table, NTC_TABLE_SIZE(ntc_table));
+    compare("tmap_table", &tmap_lut, tmap_table, NTC_TABLE_SIZE(tmap_table));
+
+    volatile int32_t sink = 0;
+    uint64_t t0 = hostMonotonicNs();
+    for (uint32_t n = 0; n < iterations; n++) {
+        for (int mv = 1; mv < PULLUP_VREF_MV; mv++) sink += getSensorTemperature(mv, NTC_PULLUP_OHMS, PULLUP_VREF_MV, tmap_table, NTC_TABLE_SIZE(tmap_table));
+    }
+    uint64_t ref_ns = hostMonotonicNs() - t0;
+
+    t0 = hostMonotonicNs();
+    for (uint32_t n = 0; n < iterations; n++) {
+        for (int mv = 1; mv < PULLUP_VREF_MV; mv++) sink += ntcLutLookup(&tmap_lut, mv);
+    }
+    uint64_t lut_ns = hostMonotonicNs() - t0;
+
+    double conversions = (double)iterations * (PULLUP_VREF_MV - 1);
+    printf("float scan:  %.2f ns/conversion\n", ref_ns / conversions);
+    printf("fixed-point: %.2f ns/conversion\n", lut_ns / conversions);
+    return 0;
+}
@@ -0,0 +1,163 @@
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "esp_err.h"
+#include "inc/adc_stream.h"
+#include "inc/filters.h"
+#include "synthetic_adc.h"
+
+/**
+ * @brief Measures effective resolution and cost of ADC oversampling against the median filter.
+ *
+ * A slow sine spanning 10-90% of full scale is sampled at the per-channel
+ * rate of the DMA scan (ADC_STREAM_SAMPLE_FREQ_HZ / ADC_STREAM_NUM_CHANNELS).
+ * Gaussian noise is added before an ideal 12-bit quantizer. The noise is the
+ * dither, so with none the quantizer's error does not average away. Each
+ * filter's output is compared with the true signal over the same samples
+ * (the block mean for the oversampler), and ENOB is
+ * 12 - log2(rms error in LSB x sqrt(12)). The ADC's own DNL/INL is not
+ * modelled, so the figures are what the decimation can recover, not what a
+ * given chip will reach. Also reports the output rate and ns per sample.
+ *
+ * Exits non-zero if, with 0.5 LSB of noise, 16x oversampling does not reach
+ * 12.8 bits or 64x does not reach 13.8 bits.
+ *
+ * Usage: oversample_bench [seconds of samples per channel] [signal Hz]
+ */
+
+#define CHANNEL_RATE_HZ (ADC_STREAM_SAMPLE_FREQ_HZ / ADC_STREAM_NUM_CHANNELS)
+#define FULL_SCALE 4095
+#define MEDIAN_DEPTH 5             // What the pressure channels used before oversampling
+
+static const uint16_t ratios[] = { 4, 16, 64, 256 };
+static const double noise_lsb[] = { 0.0, 0.25, 0.5, 1.0, 2.0 };
+
+static uint32_t rng;
+static uint32_t xorshift(void) {
+    rng ^= rng << 13;
+    rng ^= rng >> 17;
+    rng ^= rng << 5;
+    return rng;
+}
+
+static double gaussian(void) {
+    double u1 = (xorshift() + 1.0) / 4294967297.0, u2 = (xorshift() + 1.0) / 4294967297.0;
+    return sqrt(-2.0 * log(u1)) * cos(2.0 * M_PI * u2);
+}
+
+static double enob(double sum_sq, uint64_t n) {
+    double rms = sqrt(sum_sq / (double)n);
+    return 12.0 - log2(rms * sqrt(12.0));
+}
+
+/**
+ * @brief Samples the signal `n` times, returning the true values and quantized codes.
+ */
+static void generate(double *truth, uint16_t *codes, size_t n, double noise, double signal_hz) {
+    rng = 0x2545F491u; // Every noise level sees the same noise shape
+    for (size_t i = 0; i < n; i++) {
+        double x = FULL_SCALE * (0.5 + 0.4 * sin(2.0 * M_PI * signal_hz * (double)i / CHANNEL_RATE_HZ));
+        long code = lround(x + noise * gaussian());
+        truth[i] = x;
+        codes[i] = (uint16_t)(code < 0 ? 0 : code > FULL_SCALE ? FULL_SCALE : code);
+    }
+}
+
+/**
+ * @brief ENOB of the sliding median, against the true value at the window's middle sample.
+ */
+static double medianEnob(const double *truth, const uint16_t *codes, size_t n) {
+    stream_filter_t f;
+    ESP_ERROR_CHECK(filterInit(&f, MEDIAN_DEPTH, 0.0f, 0));
+    double sum_sq = 0;
+    uint64_t count = 0;
+    for (size_t i = 0; i < n; i++) {
+        uint16_t out = filterPush(&f, codes[i]);
+        if (i + 1 < MEDIAN_DEPTH) continue;
+        double err = out - truth[i - MEDIAN_DEPTH / 2];
+        sum_sq += err * err;
+        count++;
+    }
+    return enob(sum_sq, count);
+}
+
+/**
+ * @brief ENOB of the oversampler at `ratio`, against the true mean of each block.
+ */
+static double oversampleEnob(const double *truth, const uint16_t *codes, size_t n, uint16_t ratio) {
+    oversampler_t os;
+    ESP_ERROR_CHECK(oversampleInit(&os, ratio));
+    double sum_sq = 0, block = 0;
+    uint64_t count = 0;
+    for (size_t i = 0; i < n; i++) {
+        block += truth[i];
+        if (!oversamplePush(&os, codes[i])) continue;
+        double err = os.output_q / (double)(1u << OVERSAMPLE_FRAC_BITS) - block / ratio;
+        sum_sq += err * err;
+        count++;
+        block = 0;
+    }
+    return enob(sum_sq, count);
+}
+
+int main(int argc, char **argv) {
+    double seconds = (argc > 1) ? atof(argv[1]) : 60.0;
+    double signal_hz = (argc > 2) ? atof(argv[2]) : 0.37;
+    size_t n = (size_t)(seconds * CHANNEL_RATE_HZ);
+    if (n < 256u * 16u || signal_hz <= 0.0) {
+        fprintf(stderr, "usage: %s [seconds, at least %u] [signal Hz]\n", argv[0], 256u * 16u / CHANNEL_RATE_HZ + 1);
+        return 1;
+    }
+
+    double *truth = malloc(n * sizeof(*truth));
+    uint16_t *codes = malloc(n * sizeof(*codes));
+    if (truth == NULL || codes == NULL) return 1;
+
+    printf("%zu samples per channel at %u Hz, %.2f Hz sine over 10-90%% of full scale\n", n, CHANNEL_RATE_HZ, signal_hz);
+    printf("ENOB by input noise (LSB rms, acts as dither):\n");
+    printf("  %-14s %8s", "filter", "out Hz");
+    for (size_t k = 0; k < sizeof(noise_lsb) / sizeof(noise_lsb[0]); k++) printf("  %5.2f", noise_lsb[k]);
+    printf("\n");
+
+    double results[sizeof(ratios) / sizeof(ratios[0]) + 1][sizeof(noise_lsb) / sizeof(noise_lsb[0])];
+    for (size_t k = 0; k < sizeof(noise_lsb) / sizeof(noise_lsb[0]); k++) {
+        generate(truth, codes, n, noise_lsb[k], signal_hz);
+        results[0][k] = medianEnob(truth, codes, n);
+        for (size_t r = 0; r < sizeof(ratios) / sizeof(ratios[0]); r++) {
+            results[r + 1][k] = oversampleEnob(truth, codes, n, ratios[r]);
+        }
+    }
+    for (size_t r = 0; r <= sizeof(ratios) / sizeof(ratios[0]); r++) {
+        char name[24];
+        unsigned rate = r ? CHANNEL_RATE_HZ / ratios[r - 1] : CHANNEL_RATE_HZ;
+        if (r == 0) snprintf(name, sizeof(name), "median %d", MEDIAN_DEPTH);
+        else snprintf(name, sizeof(name), "oversample %ux", ratios[r - 1]);
+        printf("  %-14s %8u", name, rate);
+        for (size_t k = 0; k < sizeof(noise_lsb) / sizeof(noise_lsb[0]); k++) printf("  %5.2f", results[r][k]);
+        printf("\n");
+    }
+
+    // Throughput over the last (noisiest) input
+    stream_filter_t f;
+    oversampler_t os;
+    ESP_ERROR_CHECK(filterInit(&f, MEDIAN_DEPTH, 0.0f, 0));
+    ESP_ERROR_CHECK(oversampleInit(&os, 16));
+    uint32_t sink = 0;
+    uint64_t t0 = hostMonotonicNs();
+    for (size_t i = 0; i < n; i++) sink += filterPush(&f, codes[i]);
+    uint64_t median_ns = hostMonotonicNs() - t0;
+    t0 = hostMonotonicNs();
+    for (size_t i = 0; i < n; i++) sink += oversamplePush(&os, codes[i]);
+    uint64_t oversample_ns = hostMonotonicNs() - t0;
+    printf("cost: median %d %.2f ns/sample, oversample %.2f ns/sample (sink %u)\n", MEDIAN_DEPTH, (double)median_ns / n,
+           (double)oversample_ns / n, sink);
+
+    // Columns: 0.5 LSB of noise is index 2; rows: 16x is 2, 64x is 3
+    bool ok = results[2][2] >= 12.8 && results[3][2] >= 13.8;
+    printf("result enob_median=%.2f enob_16x=%.2f enob_64x=%.2f%s\n", results[0][2], results[2][2], results[3][2],
+           ok ? "" : "  MISMATCH");
+    free(truth);
+    free(codes);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,206 @@
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "sdkconfig.h"
+
+/**
+ * @brief Reports the RAM the firmware's own sources take, per subsystem, from a GNU ld map file, against a budget.
+ *
+ * Adds up the .data and .bss input sections (COMMON and the small-data
+ * variants included, read-only data left out as it sits in flash on the
+ * target) of every object built from main/: `libmain.a(...)` in an
+ * ESP-IDF map, `libcanboard_core.a(...)` or a path under main/ in a host
+ * one. Each source file belongs to a subsystem in `subsystems`; one that
+ * is not listed counts as "other", so nothing goes unreported. With
+ * CONFIG_CANBOARD_STATIC_ALLOCATION the task stacks, queues and locks are
+ * among them, so this is everything the firmware holds once booted, less
+ * what the ESP-IDF drivers allocate for themselves at boot.
+ *
+ * The ESP-IDF map is build/esp32-logger.map. The host build runs this on
+ * firmware_sim's map and fails when it is over budget; host pointers are
+ * twice the size, so its figures run slightly high.
+ *
+ * Exits 1 over the budget, 2 if the map cannot be read or holds no
+ * firmware objects.
+ *
+ * Usage: ram_budget [-l budget KiB] [-v] firmware.map
+ */
+
+#define MAX_SOURCES 64
+
+typedef struct {
+    const char *name;
+    const char *sources[10];
+} subsystem_t;
+
+static const subsystem_t subsystems[] = {
+    { "tasks",   { "main.c", "tasks.c", "task_config.c", "load.c" } },
+    { "inputs",  { "inputs.c", "adc_stream.c", "channels.c", "channel_config.c", "filters.c", "faults.c", "ntc.c", "snapshot.c" } },
+    { "capture", { "capture.c", "capture_config.c" } },
+    { "derived", { "derived.c", "derived_config.c" } },
+    { "can",     { "can.c", "can_sched.c", "can_messages.c", "can_signals.c", "can_tx.c", "can_rx.c", "can_rx_config.c", "can_log.c" } },
+    { "config",  { "board_config.c", "config_store.c" } },
+    { "diag",    { "diag.c", "boot.c" } },
+    { "other",   { NULL } },
+};
+#define SUBSYSTEM_COUNT (sizeof(subsystems) / sizeof(subsystems[0]))
+
+typedef struct {
+    char name[64];
+    uint64_t data;
+    uint64_t bss;
+} source_t;
+
+static source_t sources[MAX_SOURCES];
+static size_t source_count;
+
+static bool isData(const char *section) {
+    if (strncmp(section, ".data.rel.ro", 12) == 0) return false;
+    return strcmp(section, ".data") == 0 || strncmp(section, ".data.", 6) == 0 || strcmp(section, ".sdata") == 0 ||
+           strncmp(section, ".sdata.", 7) == 0;
+}
+
+static bool isBss(const char *section) {
+    return strcmp(section, ".bss") == 0 || strncmp(section, ".bss.", 5) == 0 || strcmp(section, ".sbss") == 0 ||
+           strncmp(section, ".sbss.", 6) == 0 || strcmp(section, "COMMON") == 0;
+}
+
+/**
+ * @brief Source file name of a firmware object, e.g. "can.c" for `libmain.a(can.c.obj)`; false for anything else.
+ */
+static bool firmwareSource(const char *object, char *name, size_t len) {
+    const char *base;
+    const char *paren = strchr(object, '(');
+    if (paren != NULL && (strstr(object, "libmain.a(") != NULL || strstr(object, "libcanboard_core.a(") != NULL)) {
+        base = paren + 1;
+    } else if (paren == NULL && strstr(object, "/main/") != NULL) {
+        base = strrchr(object, '/') + 1;
+    } else {
+        return false;
+    }
+    size_t n = strcspn(base, ")");
+    if (n > 4 && strncmp(base + n - 4, ".obj", 4) == 0) n -= 4;
+    else if (n > 2 && strncmp(base + n - 2, ".o", 2) == 0) n -= 2;
+    if (n == 0 || n >= len) return false;
+    memcpy(name, base, n);
+    name[n] = '\0';
+    return true;
+}
+
+static void addSection(const char *section, uint64_t size, const char *object) {
+    bool data = isData(section);
+    if ((!data && !isBss(section)) || size == 0) return;
+    char name[sizeof(sources[0].name)];
+    if (!firmwareSource(object, name, sizeof(name))) return;
+
+    size_t i = 0;
+    while (i < source_count && strcmp(sources[i].name, name) != 0) i++;
+    if (i == source_count) {
+        if (source_count == MAX_SOURCES) return;
+        snprintf(sources[source_count++].name, sizeof(sources[0].name), "%s", name);
+    }
+    if (data) sources[i].data += size;
+    else sources[i].bss += size;
+}
+
+static size_t subsystemOf(const char *source) {
+    for (size_t s = 0; s < SUBSYSTEM_COUNT; s++) {
+        for (size_t f = 0; f < sizeof(subsystems[s].sources) / sizeof(subsystems[s].sources[0]); f++) {
+            if (subsystems[s].sources[f] != NULL && strcmp(subsystems[s].sources[f], source) == 0) return s;
+        }
+    }
+    return SUBSYSTEM_COUNT - 1;
+}
+
+/**
+ * @brief Reads the input sections of the memory map, skipping the discarded ones listed before it.
+ *
+ * An input section is ` .name  0xaddress  0xsize  object`, with the
+ * address and the rest on the next line when the name is long.
+ */
+static bool readMap(FILE *f) {
+    char *line = NULL, *pending = NULL;
+    size_t cap = 0;
+    bool in_map = false;
+    while (getline(&line, &cap, f) != -1) {
+        if (!in_map) {
+            in_map = strncmp(line, "Linker script and memory map", 28) == 0;
+            continue;
+        }
+        char section[256], object[1024];
+        uint64_t addr, size;
+        if (pending != NULL) {
+            if (sscanf(line, " 0x%" SCNx64 " 0x%" SCNx64 " %1023[^\n]", &addr, &size, object) == 3) addSection(pending, size, object);
+            free(pending);
+            pending = NULL;
+            continue;
+        }
+        if (line[0] != ' ' || (line[1] != '.' && strncmp(line + 1, "COMMON", 6) != 0)) continue;
+        int n = sscanf(line, " %255s 0x%" SCNx64 " 0x%" SCNx64 " %1023[^\n]", section, &addr, &size, object);
+        if (n == 4) addSection(section, size, object);
+        else if (n == 1) pending = strdup(section);
+    }
+    free(pending);
+    free(line);
+    return in_map;
+}
+
+int main(int argc, char **argv) {
+    uint32_t budget_kib = CONFIG_CANBOARD_RAM_BUDGET_KB;
+    bool verbose = false;
+    const char *path = NULL;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-l") == 0 && i + 1 < argc) budget_kib = (uint32_t)strtoul(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "-v") == 0) verbose = true;
+        else if (path == NULL && argv[i][0] != '-') path = argv[i];
+        else {
+            path = NULL;
+            break;
+        }
+    }
+    if (path == NULL || budget_kib == 0) {
+        fprintf(stderr, "usage: %s [-l budget KiB] [-v] firmware.map\n", argv[0]);
+        return 2;
+    }
+
+    FILE *f = fopen(path, "r");
+    if (f == NULL) {
+        perror(path);
+        return 2;
+    }
+    bool ok = readMap(f);
+    fclose(f);
+    if (!ok || source_count == 0) {
+        fprintf(stderr, "%s: no firmware objects in the memory map\n", path);
+        return 2;
+    }
+
+    uint64_t data[SUBSYSTEM_COUNT] = {0}, bss[SUBSYSTEM_COUNT] = {0}, total = 0;
+    for (size_t i = 0; i < source_count; i++) {
+        size_t s = subsystemOf(sources[i].name);
+        data[s] += sources[i].data;
+        bss[s] += sources[i].bss;
+        total += sources[i].data + sources[i].bss;
+    }
+
+    uint64_t budget = (uint64_t)budget_kib * 1024u;
+    printf("RAM of the firmware's sources in %s (.data + .bss):\n", path);
+    printf("  %-10s %8s %8s %8s %6s\n", "subsystem", "data", "bss", "total", "share");
+    for (size_t s = 0; s < SUBSYSTEM_COUNT; s++) {
+        if (data[s] + bss[s] == 0) continue;
+        printf("  %-10s %8" PRIu64 " %8" PRIu64 " %8" PRIu64 " %5.1f%%\n", subsystems[s].name, data[s], bss[s], data[s] + bss[s],
+               100.0 * (data[s] + bss[s]) / total);
+        for (size_t i = 0; verbose && i < source_count; i++) {
+            if (subsystemOf(sources[i].name) != s) continue;
+            printf("    %-18s %8" PRIu64 " %8" PRIu64 "\n", sources[i].name, sources[i].data, sources[i].bss);
+        }
+    }
+    bool over = total > budget;
+    printf("  total %" PRIu64 " bytes of a %" PRIu32 " KiB budget (%.1f%%)%s\n", total, budget_kib, 100.0 * total / budget,
+           over ? ", OVER BUDGET" : "");
+    printf("result ram_bytes=%" PRIu64 " budget_bytes=%" PRIu64 "%s\n", total, budget, over ? " OVER" : "");
+    return over ? 1 : 0;
+}
@@ -0,0 +1,621 @@
+#include <errno.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "esp_err.h"
+#include "inc/adc_stream.h"
+#include "inc/can_sched.h"
+#include "inc/can_signals.h"
+#include "inc/channels.h"
+#include "inc/derived.h"
+#include "sdkconfig.h"
+#include "synthetic_adc.h"
+
+/**
+ * @brief Replays recorded input traces through the firmware's signal path into the CAN frame stream.
+ *
+ * A trace holds the sensor-side (divider-scaled) millivolts of the ten
+ * inputs, one row per sample: CSV with one column per input (a header line
+ * is skipped), or `.bin` with ten little-endian uint16 per row. Rows are at
+ * the channel rate of 2 kHz unless `-r` says otherwise, in which case they
+ * are sample-and-held (or decimated) to it. Each sample goes through the
+ * ADC code it would have read and the real stream demux, then
+ * channelsFilterSweep() (filters and fault classifier), channelsConvert(),
+ * derivedEvaluate() with `derived_table` (no ECU, so a manifold pressure of
+ * 0, and no frequency inputs, so 0 Hz), channelsMarkChanges(), and the scheduler with the compiled-in message
+ * table and packers. The transmit task is modelled on a virtual clock as
+ * canTransmit() runs it: on every 2 ms tick when polling, or on a change
+ * and at its next due tick with CONFIG_CANBOARD_CAN_TX_EVENT_DRIVEN. The
+ * replay is deterministic, so the frames are exactly what the board would
+ * put on an idle bus for that input.
+ *
+ * Frames are written in can_log_dump's CSV format (timestamp, ID, ext, rtr,
+ * DLC, data, message name), to `-o dir` and compared against the golden
+ * `dir/<trace>.csv` given with `-g`, which `-u` writes instead. For each
+ * trace it reports sweeps, frames, the differing lines against the golden
+ * and the time spent per stage; the totals give throughput as sweeps per
+ * second and as a multiple of real time. Traces run in parallel as
+ * separate processes (`-j`), and `-t` fails the run if the pipeline takes
+ * more than the given ns per sweep.
+ *
+ * With no traces it replays SYNTH_TRACES synthetic drives, plus the first
+ * again, and checks that both runs of the first produced the same frames.
+ * `-S file.csv` writes the first synthetic drive as a trace to start from.
+ *
+ * Exits non-zero on a golden mismatch, an unreadable trace, a
+ * non-deterministic replay or a missed cost limit.
+ *
+ * Usage: replay_bench [-j jobs] [-r trace hz] [-o dir] [-g dir [-u]] [-t ns/sweep] [-s seconds] [-S file.csv] [trace...]
+ */
+
+#define BENCH_UNIT 0
+#define FULL_SCALE_MV 3100          // ADC input at full scale with 12 dB attenuation, as in the shim
+#define MAX_CODE 4095
+#define SWEEP_US (ADC_STREAM_SWEEP_SAMPLES * 1000000u / CHANNEL_RATE_HZ)
+#define TICK_US (CAN_SCHED_TICK_MS * 1000u)
+#define SYNTH_TRACES 8
+#define SYNTH_SECONDS 60
+#define SYNTH_OPEN_MS 10000         // Odd synthetic drives lose input 4 for SYNTH_OPEN_LEN_MS here
+#define SYNTH_OPEN_LEN_MS 200
+#define MAX_TRACES 256
+
+#if CONFIG_CANBOARD_CAN_TX_EVENT_DRIVEN
+#define EVENT_DRIVEN true
+#else
+#define EVENT_DRIVEN false
+#endif
+
+typedef enum {
+    STAGE_DEMUX = 0,
+    STAGE_FILTER,
+    STAGE_CONVERT,
+    STAGE_DERIVED,
+    STAGE_MARK,
+    STAGE_SCHED,
+    STAGE_COUNT
+} stage_t;
+
+static const char *const stage_names[STAGE_COUNT] = { "demux", "filter", "convert", "derived", "mark", "sched+pack" };
+
+typedef struct {
+    const char *path;           // NULL for a synthetic drive
+    char name[64];              // Output and golden file name, without .csv
+    uint32_t seed;
+} trace_t;
+
+typedef struct {
+    uint16_t *mv;               // rows x ADC_STREAM_NUM_CHANNELS
+    size_t rows;
+} samples_t;
+
+/**
+ * @brief What a replay sends back to the parent, small enough for one atomic pipe write.
+ */
+typedef struct {
+    uint64_t sweeps;
+    uint64_t frames;
+    uint64_t hash;              // FNV-1a over every frame and its time
+    uint64_t stage_ns[STAGE_COUNT];
+    uint32_t diffs;             // Lines differing from the golden
+    int failed;
+} replay_result_t;
+
+typedef struct {
+    uint32_t trace_hz;
+    const char *out_dir;
+    const char *golden_dir;
+    bool update;
+    double seconds;             // Length of a synthetic drive
+} replay_opts_t;
+
+/**
+ * @brief Frames collected by the transmit hook during one scheduler run, formatted after it is timed.
+ */
+typedef struct {
+    can_frame_t frames[CAN_SCHED_MAX_MESSAGES];
+    size_t count;
+} replay_bus_t;
+
+static int benchCali(void *ctx, int channel, int raw) {
+    return raw * FULL_SCALE_MV / MAX_CODE;
+}
+
+static uint16_t codeFor(int ch, uint16_t mv) {
+    long code = lroundf(mv / channel_table[ch].divider * MAX_CODE / FULL_SCALE_MV);
+    return (uint16_t)(code > MAX_CODE ? MAX_CODE : code);
+}
+
+static esp_err_t noRead(void *ctx, uint8_t *buf, uint32_t len, uint32_t *out_len, uint32_t timeout_ms) { return ESP_ERR_TIMEOUT; }
+static const adc_stream_hal_t no_hal = { .read = noRead };
+
+/**
+ * @brief Transmit hook: the bus always accepts, frames are kept for after the run.
+ */
+static esp_err_t replayTransmit(void *ctx, const can_frame_t *frame) {
+    replay_bus_t *bus = ctx;
+    if (bus->count < CAN_SCHED_MAX_MESSAGES) bus->frames[bus->count++] = *frame;
+    return ESP_OK;
+}
+
+static uint64_t fnv1a(uint64_t hash, const void *data, size_t len) {
+    const uint8_t *p = data;
+    for (size_t i = 0; i < len; i++) hash = (hash ^ p[i]) * 0x100000001B3ull;
+    return hash;
+}
+
+static uint32_t xorshift(uint32_t *state) {
+    *state ^= *state << 13;
+    *state ^= *state >> 17;
+    *state ^= *state << 5;
+    return *state;
+}
+
+/**
+ * @brief Builds a synthetic drive: boost cycles, oil pressure following them, slowly warming NTCs.
+ *
+ * Every input carries a few millivolts of noise. Odd seeds open input 4 for
+ * SYNTH_OPEN_LEN_MS at SYNTH_OPEN_MS, so the fault path and sensorStatus
+ * frames are in the stream too.
+ */
+static bool synthTrace(samples_t *s, uint32_t seed, double seconds) {
+    s->rows = (size_t)(seconds * CHANNEL_RATE_HZ);
+    s->mv = malloc(s->rows * ADC_STREAM_NUM_CHANNELS * sizeof(uint16_t));
+    if (s->mv == NULL) return false;
+
+    uint32_t rng = 0x9E3779B9u ^ (seed * 0x85EBCA6Bu);
+    double phase = (xorshift(&rng) % 1000) / 1000.0;
+    for (size_t r = 0; r < s->rows; r++) {
+        double t = (double)r / CHANNEL_RATE_HZ;
+        double boost = sin(2.0 * M_PI * (t / 8.0 + phase));
+        boost = boost > 0 ? boost * boost : 0;
+        double mv[ADC_STREAM_NUM_CHANNELS] = {
+            1000 + 2500 * boost,                            // Charge cooler inlet pressure
+            800 + 1500 * boost,                             // Exhaust back pressure
+            1600 + 50 * sin(2.0 * M_PI * 30.0 * t),         // Crank case pressure, pulsing
+            1500 + 1000 * boost,                            // Oil pressure
+            0, 0, 0,                                        // Not wired
+            2500 - 600 * t / seconds,                       // TMAP NTC, warming up
+            3000 - 900 * t / seconds,                       // Oil temperature NTC
+            2800 - 500 * t / seconds,                       // Coolant temperature NTC
+        };
+        uint32_t ms = (uint32_t)(t * 1000);
+        if ((seed & 1) && ms >= SYNTH_OPEN_MS && ms < SYNTH_OPEN_MS + SYNTH_OPEN_LEN_MS) mv[3] = 0;
+        for (int ch = 0; ch < ADC_STREAM_NUM_CHANNELS; ch++) {
+            double v = mv[ch] + (double)(xorshift(&rng) % 9) - 4;
+            s->mv[r * ADC_STREAM_NUM_CHANNELS + ch] = (uint16_t)(v < 0 ? 0 : v > 5000 ? 5000 : v);
+        }
+    }
+    return true;
+}
+
+static bool appendRow(samples_t *s, size_t *cap, const uint16_t *row) {
+    if (s->rows == *cap) {
+        size_t grown = *cap ? *cap * 2 : 4096;
+        uint16_t *mv = realloc(s->mv, grown * ADC_STREAM_NUM_CHANNELS * sizeof(uint16_t));
+        if (mv == NULL) return false;
+        s->mv = mv;
+        *cap = grown;
+    }
+    memcpy(&s->mv[s->rows++ * ADC_STREAM_NUM_CHANNELS], row, ADC_STREAM_NUM_CHANNELS * sizeof(uint16_t));
+    return true;
+}
+
+/**
+ * @brief Loads a CSV or `.bin` trace. Missing CSV columns read as 0 mV.
+ */
+static bool loadTrace(samples_t *s, const char *path) {
+    FILE *f = fopen(path, "rb");
+    if (f == NULL) {
+        fprintf(stderr, "%s: %s\n", path, strerror(errno));
+        return false;
+    }
+    size_t cap = 0;
+    uint16_t row[ADC_STREAM_NUM_CHANNELS];
+    const char *ext = strrchr(path, '.');
+    bool ok = true;
+
+    if (ext != NULL && strcmp(ext, ".bin") == 0) {
+        uint8_t raw[ADC_STREAM_NUM_CHANNELS * 2];
+        while (ok && fread(raw, sizeof(raw), 1, f) == 1) {
+            for (int ch = 0; ch < ADC_STREAM_NUM_CHANNELS; ch++) row[ch] = (uint16_t)(raw[2 * ch] | raw[2 * ch + 1] << 8);
+            ok = appendRow(s, &cap, row);
+        }
+    } else {
+        char line[512];
+        while (ok && fgets(line, sizeof(line), f) != NULL) {
+            char *p = line, *end;
+            int ch = 0;
+            for (; ch < ADC_STREAM_NUM_CHANNELS; ch++) {
+                long mv = strtol(p, &end, 10);
+                if (end == p) break;
+                row[ch] = (uint16_t)(mv < 0 ? 0 : mv > UINT16_MAX ? UINT16_MAX : mv);
+                p = (*end == ',') ? end + 1 : end;
+            }
+            if (ch == 0) continue; // Header or blank line
+            for (; ch < ADC_STREAM_NUM_CHANNELS; ch++) row[ch] = 0;
+            ok = appendRow(s, &cap, row);
+        }
+    }
+    fclose(f);
+    if (ok && s->rows == 0) fprintf(stderr, "%s: no samples\n", path);
+    return ok && s->rows != 0;
+}
+
+/**
+ * @brief Runs the scheduler at `now_us` as the transmit task would, and appends its frames to the stream.
+ *
+ * @return Time of the task's next timed wakeup
+ */
+static uint64_t replaySchedule(can_sched_t *sched, replay_bus_t *bus, const sensor_values_t *values, uint64_t now_us,
+                               FILE *out, replay_result_t *r) {
+    uint32_t now_ms = (uint32_t)(now_us / TICK_US) * CAN_SCHED_TICK_MS; // The tick count, as the task sees it
+    bus->count = 0;
+    uint64_t t0 = hostMonotonicNs();
+    uint32_t next_in = canSchedRun(sched, now_ms, values);
+    r->stage_ns[STAGE_SCHED] += hostMonotonicNs() - t0;
+
+    for (size_t i = 0; i < bus->count; i++) {
+        const can_frame_t *frame = &bus->frames[i];
+        const can_message_schema_t *schema = canSchemaFind(frame->id);
+        fprintf(out, "%.6f,0x%03X,0,0,%u,", now_us / 1e6, (unsigned)frame->id, frame->dlc);
+        for (int b = 0; b < frame->dlc; b++) fprintf(out, "%02X", frame->data[b]);
+        fprintf(out, ",%s\n", schema ? schema->name : "");
+        r->hash = fnv1a(r->hash, &now_us, sizeof(now_us));
+        r->hash = fnv1a(r->hash, &frame->id, sizeof(frame->id));
+        r->hash = fnv1a(r->hash, frame->data, frame->dlc);
+        r->frames++;
+    }
+    uint64_t ticks = (next_in + CAN_SCHED_TICK_MS - 1) / CAN_SCHED_TICK_MS;
+    return (now_us / TICK_US + (ticks ? ticks : 1)) * TICK_US;
+}
+
+/**
+ * @brief Replays one trace, writing its frames to `out`.
+ */
+static void replayTrace(const samples_t *s, uint32_t trace_hz, FILE *out, replay_result_t *r) {
+    static channel_pipeline_t pipeline;
+    static adc_stream_t stream;
+    static can_sched_t sched;
+    static replay_bus_t bus;
+    static derived_engine_t derived;
+    const bool event = EVENT_DRIVEN;
+    sensor_values_t values = {0};
+
+    ESP_ERROR_CHECK(channelsInit(&pipeline, channel_table, SNAPSHOT_NUM_CHANNELS, benchCali, NULL));
+    ESP_ERROR_CHECK(adcStreamInit(&stream, &no_hal, BENCH_UNIT));
+    ESP_ERROR_CHECK(derivedInit(&derived, derived_table, derived_table_count, CHANNEL_SWEEP_US));
+    ESP_ERROR_CHECK(canSchedInit(&sched, can_messages, can_messages_count, 0, replayTransmit, &bus));
+    canSchedSetOnChange(&sched, event);
+    r->hash = 0xCBF29CE484222325ull;
+
+    const uint64_t sweeps = (uint64_t)s->rows * CHANNEL_RATE_HZ / trace_hz / ADC_STREAM_SWEEP_SAMPLES;
+    uint64_t next_tick = 0, wake_at = 0;
+    for (uint64_t sweep = 0; sweep < sweeps; sweep++) {
+        uint64_t sweep_us = (sweep + 1) * SWEEP_US;
+        for (; next_tick < sweep_us; next_tick += TICK_US) {
+            if (!event || next_tick == wake_at) wake_at = replaySchedule(&sched, &bus, &values, next_tick, out, r);
+        }
+
+        uint8_t buf[ADC_STREAM_FRAME_BYTES];
+        uint32_t len = 0;
+        for (int k = 0; k < ADC_STREAM_SWEEP_SAMPLES; k++) {
+            uint64_t row = (sweep * ADC_STREAM_SWEEP_SAMPLES + k) * trace_hz / CHANNEL_RATE_HZ;
+            for (int ch = 0; ch < ADC_STREAM_NUM_CHANNELS; ch++) {
+                uint32_t word = ADC_STREAM_WORD(BENCH_UNIT, ch, codeFor(ch, s->mv[row * ADC_STREAM_NUM_CHANNELS + ch]));
+                memcpy(&buf[len], &word, sizeof(word));
+                len += sizeof(word);
+            }
+        }
+
+        uint64_t t0 = hostMonotonicNs();
+        adcStreamDemux(&stream, buf, len);
+        uint64_t t1 = hostMonotonicNs();
+        channelsFilterSweep(&pipeline, &stream, &values);
+        uint64_t t2 = hostMonotonicNs();
+        channelsConvert(&pipeline, &values);
+        uint64_t t3 = hostMonotonicNs();
+        derivedEvaluate(&derived, &values, NULL);
+        uint64_t t4 = hostMonotonicNs();
+        adcStreamSweepConsume(&stream);
+        values.timestamp_us = sweep_us;
+        values.sweep++;
+        uint32_t changed = channelsMarkChanges(&pipeline, &values);
+        uint64_t t5 = hostMonotonicNs();
+        r->stage_ns[STAGE_DEMUX] += t1 - t0;
+        r->stage_ns[STAGE_FILTER] += t2 - t1;
+        r->stage_ns[STAGE_CONVERT] += t3 - t2;
+        r->stage_ns[STAGE_DERIVED] += t4 - t3;
+        r->stage_ns[STAGE_MARK] += t5 - t4;
+
+        if (event && changed) wake_at = replaySchedule(&sched, &bus, &values, sweep_us, out, r);
+    }
+    r->sweeps = sweeps;
+}
+
+static char *readFile(const char *path, size_t *len) {
+    FILE *f = fopen(path, "rb");
+    if (f == NULL) return NULL;
+    char *data = NULL;
+    size_t cap = 0;
+    *len = 0;
+    for (;;) {
+        if (*len == cap) {
+            cap = cap ? cap * 2 : 65536;
+            char *grown = realloc(data, cap + 1);
+            if (grown == NULL) break;
+            data = grown;
+        }
+        size_t got = fread(data + *len, 1, cap - *len, f);
+        if (got == 0) break;
+        *len += got;
+    }
+    fclose(f);
+    if (data != NULL) data[*len] = '\0';
+    return data;
+}
+
+static bool writeFile(const char *path, const char *data, size_t len) {
+    FILE *f = fopen(path, "wb");
+    if (f == NULL || fwrite(data, 1, len, f) != len) {
+        fprintf(stderr, "%s: %s\n", path, strerror(errno));
+        if (f != NULL) fclose(f);
+        return false;
+    }
+    return fclose(f) == 0;
+}
+
+/**
+ * @brief Compares the frame stream with its golden line by line.
+ *
+ * @return Differing lines, counting lines only one side has; the first is described in `first`
+ */
+static uint32_t goldenDiff(const char *golden, const char *got, char *first, size_t first_len) {
+    uint32_t diffs = 0;
+    size_t line = 1;
+    while (*golden != '\0' || *got != '\0') {
+        size_t gl = strcspn(golden, "\n"), nl = strcspn(got, "\n");
+        if (gl != nl || memcmp(golden, got, gl) != 0) {
+            if (diffs++ == 0) {
+                snprintf(first, first_len, "line %zu: expected \"%.*s\", got \"%.*s\"", line, (int)(gl > 60 ? 60 : gl),
+                         golden, (int)(nl > 60 ? 60 : nl), got);
+            }
+        }
+        golden += gl + (golden[gl] == '\n');
+        got += nl + (got[nl] == '\n');
+        line++;
+    }
+    return diffs;
+}
+
+/**
+ * @brief Replays one trace in a child process and prints its report in a single write.
+ */
+static replay_result_t runTrace(const trace_t *t, const replay_opts_t *opts) {
+    replay_result_t r = {0};
+    samples_t s = {0};
+    char *report = NULL, *stream = NULL;
+    size_t report_len = 0, stream_len = 0;
+    FILE *rep = open_memstream(&report, &report_len);
+    FILE *out = open_memstream(&stream, &stream_len);
+
+    bool loaded = t->path ? loadTrace(&s, t->path) : synthTrace(&s, t->seed, opts->seconds);
+    if (!loaded) {
+        fprintf(rep, "%-24s unreadable  MISMATCH\n", t->name);
+        r.failed = 1;
+    } else {
+        replayTrace(&s, opts->trace_hz, out, &r);
+    }
+    fclose(out);
+
+    char path[512], first[640] = "";
+    if (loaded && opts->out_dir != NULL) {
+        snprintf(path, sizeof(path), "%s/%s.csv", opts->out_dir, t->name);
+        r.failed |= !writeFile(path, stream, stream_len);
+    }
+    const char *verdict = "";
+    if (loaded && opts->golden_dir != NULL) {
+        snprintf(path, sizeof(path), "%s/%s.csv", opts->golden_dir, t->name);
+        if (opts->update) {
+            r.failed |= !writeFile(path, stream, stream_len);
+            verdict = ", golden written";
+        } else {
+            size_t golden_len;
+            char *golden = readFile(path, &golden_len);
+            if (golden == NULL) {
+                snprintf(first, sizeof(first), "%s: %s", path, strerror(errno));
+                r.diffs = 1;
+            } else {
+                r.diffs = goldenDiff(golden, stream, first, sizeof(first));
+                free(golden);
+            }
+            verdict = r.diffs ? "" : ", matches golden";
+            r.failed |= r.diffs != 0;
+        }
+    }
+
+    if (loaded) {
+        double seconds = r.sweeps * (SWEEP_US / 1e6);
+        uint64_t total_ns = 0;
+        for (int i = 0; i < STAGE_COUNT; i++) total_ns += r.stage_ns[i];
+        fprintf(rep, "%-24s %8.1f s %8llu sweeps %7llu frames %016llx %6.0f ns/sweep%s%s\n", t->name, seconds,
+                (unsigned long long)r.sweeps, (unsigned long long)r.frames, (unsigned long long)r.hash,
+                r.sweeps ? (double)total_ns / r.sweeps : 0.0, verdict, r.diffs ? "  MISMATCH" : "");
+        if (r.diffs) fprintf(rep, "  %u lines differ, first at %s\n", (unsigned)r.diffs, first);
+    }
+    fclose(rep);
+    fwrite(report, 1, report_len, stdout);
+    fflush(stdout);
+    free(report);
+    free(stream);
+    free(s.mv);
+    return r;
+}
+
+typedef struct {
+    pid_t pid;
+    int fd;
+} child_t;
+
+static bool reapChild(child_t *children, size_t count, replay_result_t *results) {
+    int status;
+    pid_t pid = wait(&status);
+    if (pid < 0) return false;
+    for (size_t i = 0; i < count; i++) {
+        if (children[i].pid != pid) continue;
+        if (read(children[i].fd, &results[i], sizeof(results[i])) != (ssize_t)sizeof(results[i]) ||
+            !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+            results[i].failed = 1;
+        }
+        close(children[i].fd);
+        children[i].pid = 0;
+    }
+    return true;
+}
+
+/**
+ * @brief Runs the traces in parallel, one process each and at most `jobs` at a time.
+ */
+static bool runAll(const trace_t *traces, size_t count, const replay_opts_t *opts, int jobs, replay_result_t *results) {
+    static child_t children[MAX_TRACES];
+    int running = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (running == jobs) {
+            if (!reapChild(children, count, results)) return false;
+            running--;
+        }
+        int fds[2];
+        if (pipe(fds) != 0) return false;
+        fflush(stdout);
+        pid_t pid = fork();
+        if (pid < 0) return false;
+        if (pid == 0) {
+            close(fds[0]);
+            replay_result_t r = runTrace(&traces[i], opts);
+            _exit(write(fds[1], &r, sizeof(r)) == (ssize_t)sizeof(r) ? 0 : 1);
+        }
+        close(fds[1]);
+        children[i] = (child_t){ pid, fds[0] };
+        running++;
+    }
+    while (running-- > 0) {
+        if (!reapChild(children, count, results)) return false;
+    }
+    return true;
+}
+
+static bool writeSynth(const char *path, double seconds) {
+    samples_t s = {0};
+    FILE *f = fopen(path, "w");
+    if (f == NULL || !synthTrace(&s, 0, seconds)) {
+        fprintf(stderr, "%s: %s\n", path, strerror(errno));
+        if (f != NULL) fclose(f);
+        return false;
+    }
+    fprintf(f, "ch0,ch1,ch2,ch3,ch4,ch5,ch6,ch7,ch8,ch9\n");
+    for (size_t r = 0; r < s.rows; r++) {
+        for (int ch = 0; ch < ADC_STREAM_NUM_CHANNELS; ch++) {
+            fprintf(f, "%u%c", s.mv[r * ADC_STREAM_NUM_CHANNELS + ch], ch + 1 < ADC_STREAM_NUM_CHANNELS ? ',' : '\n');
+        }
+    }
+    free(s.mv);
+    return fclose(f) == 0;
+}
+
+static void usage(void) {
+    fprintf(stderr, "Usage: replay_bench [-j jobs] [-r trace hz] [-o dir] [-g dir [-u]] [-t ns/sweep] [-s seconds] "
+                    "[-S file.csv] [trace...]\n");
+}
+
+int main(int argc, char **argv) {
+    replay_opts_t opts = { .trace_hz = CHANNEL_RATE_HZ, .seconds = SYNTH_SECONDS };
+    long online = sysconf(_SC_NPROCESSORS_ONLN);
+    int jobs = online > 0 ? (int)online : 1;
+    double max_ns = 0;
+    const char *synth_path = NULL;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "j:r:o:g:ut:s:S:")) != -1) {
+        switch (opt) {
+        case 'j': jobs = atoi(optarg); break;
+        case 'r': opts.trace_hz = (uint32_t)atol(optarg); break;
+        case 'o': opts.out_dir = optarg; break;
+        case 'g': opts.golden_dir = optarg; break;
+        case 'u': opts.update = true; break;
+        case 't': max_ns = atof(optarg); break;
+        case 's': opts.seconds = atof(optarg); break;
+        case 'S': synth_path = optarg; break;
+        default: usage(); return 2;
+        }
+    }
+    if (jobs < 1 || opts.trace_hz == 0 || opts.seconds <= 0 || (opts.update && opts.golden_dir == NULL)) {
+        usage();
+        return 2;
+    }
+    if (synth_path != NULL) return writeSynth(synth_path, opts.seconds) ? 0 : 1;
+
+    static trace_t traces[MAX_TRACES];
+    static replay_result_t results[MAX_TRACES];
+    size_t count = 0;
+    bool synthetic = optind >= argc;
+    if (synthetic) {
+        for (; count <= SYNTH_TRACES; count++) {
+            traces[count].seed = (uint32_t)(count % SYNTH_TRACES);
+            snprintf(traces[count].name, sizeof(traces[count].name), "synth-%u%s", (unsigned)traces[count].seed,
+                     count == SYNTH_TRACES ? "-again" : "");
+        }
+    } else {
+        for (int i = optind; i < argc && count < MAX_TRACES; i++, count++) {
+            const char *base = strrchr(argv[i], '/');
+            base = base ? base + 1 : argv[i];
+            size_t len = strcspn(base, ".");
+            traces[count].path = argv[i];
+            snprintf(traces[count].name, sizeof(traces[count].name), "%.*s", (int)len, base);
+        }
+    }
+
+    printf("%zu traces, %d jobs, %s transmit, %zu messages, traces at %u Hz\n", count, jobs,
+           EVENT_DRIVEN ? "event-driven" : "polling", can_messages_count, (unsigned)opts.trace_hz);
+    uint64_t wall_start = hostMonotonicNs();
+    if (!runAll(traces, count, &opts, jobs, results)) {
+        perror("replay_bench");
+        return 1;
+    }
+    double wall_s = (hostMonotonicNs() - wall_start) / 1e9;
+
+    replay_result_t total = {0};
+    int failures = 0;
+    for (size_t i = 0; i < count; i++) {
+        total.sweeps += results[i].sweeps;
+        total.frames += results[i].frames;
+        total.diffs += results[i].diffs;
+        for (int s = 0; s < STAGE_COUNT; s++) total.stage_ns[s] += results[i].stage_ns[s];
+        failures += results[i].failed != 0;
+    }
+    bool deterministic = !synthetic || results[0].hash == results[SYNTH_TRACES].hash;
+    failures += !deterministic;
+
+    uint64_t total_ns = 0;
+    printf("per stage:");
+    for (int s = 0; s < STAGE_COUNT; s++) {
+        total_ns += total.stage_ns[s];
+        printf(" %s %.0f", stage_names[s], total.sweeps ? (double)total.stage_ns[s] / total.sweeps : 0.0);
+    }
+    printf(" ns/sweep\n");
+    double ns_per_sweep = total.sweeps ? (double)total_ns / total.sweeps : 0.0;
+    bool too_slow = max_ns > 0 && ns_per_sweep > max_ns;
+    failures += too_slow;
+    if (synthetic) printf("replay of synth-0 in another process: %s\n", deterministic ? "identical" : "DIFFERENT");
+    if (too_slow) printf("pipeline %.0f ns/sweep over the %.0f ns limit\n", ns_per_sweep, max_ns);
+
+    double replayed_s = total.sweeps * (SWEEP_US / 1e6);
+    printf("result traces=%zu sweeps=%llu frames=%llu diffs=%u ns_per_sweep=%.0f sweeps_per_s=%.0f realtime_x=%.0f "
+           "wall_s=%.2f%s\n",
+           count, (unsigned long long)total.sweeps, (unsigned long long)total.frames, (unsigned)total.diffs, ns_per_sweep,
+           wall_s > 0 ? total.sweeps / wall_s : 0.0, wall_s > 0 ? replayed_s / wall_s : 0.0, wall_s,
+           failures ? "  MISMATCH" : "");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+
+typedef struct sim_mcpwm_cap_timer *mcpwm_cap_timer_handle_t;
+typedef struct sim_mcpwm_cap_channel *mcpwm_cap_channel_handle_t;
+
+#define MCPWM_CAPTURE_CLK_SRC_DEFAULT 0
+
+typedef struct {
+    int group_id;
+    int clk_src;
+    uint32_t resolution_hz;
+} mcpwm_capture_timer_config_t;
+
+typedef struct {
+    int gpio_num;
+    int intr_priority;
+    uint32_t prescale;
+    struct {
+        unsigned pos_edge : 1;
+        unsigned neg_edge : 1;
+        unsigned pull_up : 1;
+        unsigned pull_down : 1;
+        unsigned invert_cap_signal : 1;
+        unsigned io_loop_back : 1;
+        unsigned keep_io_conf_at_exit : 1;
+    } flags;
+} mcpwm_capture_channel_config_t;
+
+esp_err_t mcpwm_new_capture_timer(const mcpwm_capture_timer_config_t *config, mcpwm_cap_timer_handle_t *ret_cap_timer);
+esp_err_t mcpwm_capture_timer_get_resolution(mcpwm_cap_timer_handle_t cap_timer, uint32_t *out_resolution);
+esp_err_t mcpwm_capture_timer_enable(mcpwm_cap_timer_handle_t cap_timer);
+esp_err_t mcpwm_capture_timer_start(mcpwm_cap_timer_handle_t cap_timer);
+esp_err_t mcpwm_new_capture_channel(mcpwm_cap_timer_handle_t cap_timer, const mcpwm_capture_channel_config_t *config,
+                                    mcpwm_cap_channel_handle_t *ret_cap_channel);
+esp_err_t mcpwm_capture_channel_enable(mcpwm_cap_channel_handle_t cap_channel);
+esp_err_t mcpwm_capture_get_latched_value(mcpwm_cap_channel_handle_t cap_channel, uint32_t *value);
@@ -0,0 +1,30 @@
+#pragma once
+
+// Host stand-in for the FreeRTOS API used by the firmware: tasks are pthreads,
+// ticks follow the simulation clock (see sim.h).
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef void (*TaskFunction_t)(void *);
+typedef uint8_t StackType_t;    // Stacks are sized in bytes, as in ESP-IDF
+
+// Storage for statically allocated objects, about the size of the target's; the shim keeps its own state in them
+typedef struct { uint64_t opaque[48]; } StaticTask_t;
+typedef struct { uint64_t opaque[16]; } StaticQueue_t;
+typedef StaticQueue_t StaticSemaphore_t;
+
+#define configTICK_RATE_HZ 500  // CONFIG_FREERTOS_HZ
+#define portMAX_DELAY ((TickType_t)0xFFFFFFFFu)
+#define portTICK_PERIOD_MS (1000 / configTICK_RATE_HZ)
+#define pdMS_TO_TICKS(ms) ((TickType_t)(((uint64_t)(ms) * configTICK_RATE_HZ) / 1000u))
+#define pdTICKS_TO_MS(ticks) ((TickType_t)(((uint64_t)(ticks) * 1000u) / configTICK_RATE_HZ))
+#define pdTRUE 1
+#define pdFALSE 0
+#define pdPASS pdTRUE
+#define pdFAIL pdFALSE
+#define tskNO_AFFINITY 0x7FFFFFFF
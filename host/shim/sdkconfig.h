@@ -0,0 +1,24 @@
+#pragma once
+
+// Host build configuration: the project sdkconfig options the firmware sources read.
+
+#define CONFIG_FREERTOS_HZ 500
+#define CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ 240
+#ifndef CONFIG_CANBOARD_DIAG
+#define CONFIG_CANBOARD_DIAG 1 // Build with -DCONFIG_CANBOARD_DIAG=0 to check the instrumentation compiles out
+#endif
+#ifndef CONFIG_CANBOARD_CAN_TX_EVENT_DRIVEN
+#define CONFIG_CANBOARD_CAN_TX_EVENT_DRIVEN 1 // Build with -DCONFIG_CANBOARD_CAN_TX_EVENT_DRIVEN=0 for the polling transmit task
+#endif
+#ifndef CONFIG_CANBOARD_CAN_BITRATE
+#define CONFIG_CANBOARD_CAN_BITRATE 500000
+#endif
+#ifndef CONFIG_CANBOARD_CAN_PACKED
+#define CONFIG_CANBOARD_CAN_PACKED 0 // Build with -DCONFIG_CANBOARD_CAN_PACKED=1 for the packed message table
+#endif
+#ifndef CONFIG_CANBOARD_STATIC_ALLOCATION
+#define CONFIG_CANBOARD_STATIC_ALLOCATION 1 // Build with -DCONFIG_CANBOARD_STATIC_ALLOCATION=0 for tasks, queues and locks from the heap
+#endif
+#ifndef CONFIG_CANBOARD_RAM_BUDGET_KB
+#define CONFIG_CANBOARD_RAM_BUDGET_KB 96
+#endif
@@ -0,0 +1,75 @@
+#include <stdbool.h>
+
+#include "esp_adc/adc_cali_scheme.h"
+#include "esp_adc/adc_continuous.h"
+#include "sim.h"
+
+// Continuous ADC driver backed by the scripted synthetic source, paced on the
+// simulation clock. Calibration is a straight line over the 12 dB range.
+
+#define SIM_ADC_FULL_SCALE_MV 3100
+#define SIM_ADC_MAX_RAW 4095
+
+static struct sim_adc_continuous {
+    synthetic_adc_t src;
+    adc_stream_hal_t hal;
+    bool created;
+} adc;
+
+static struct sim_adc_cali {
+    int unused;
+} cali;
+
+/**
+ * @brief Returns the scripted ADC source, for setting levels before app_main().
+ */
+synthetic_adc_t *simAdcSource(void) {
+    if (!adc.created) {
+        syntheticAdcInit(&adc.src, ADC_STREAM_SAMPLE_FREQ_HZ, true);
+        adc.src.clock_ns = simNowNs;
+        syntheticAdcHal(&adc.src, &adc.hal);
+        adc.created = true;
+    }
+    return &adc.src;
+}
+
+/**
+ * @brief Steps one channel's DC level while the firmware is running.
+ */
+void simAdcSetLevel(int channel, uint16_t level) {
+    __atomic_store_n(&simAdcSource()->level[channel], level, __ATOMIC_RELAXED);
+}
+
+esp_err_t adc_continuous_new_handle(const adc_continuous_handle_cfg_t *hdl_config, adc_continuous_handle_t *ret_handle) {
+    if (hdl_config == NULL || ret_handle == NULL) return ESP_ERR_INVALID_ARG;
+    simAdcSource();
+    *ret_handle = &adc;
+    return ESP_OK;
+}
+
+esp_err_t adc_continuous_config(adc_continuous_handle_t handle, const adc_continuous_config_t *config) {
+    if (handle != &adc || config == NULL || config->pattern_num == 0) return ESP_ERR_INVALID_ARG;
+    adc.src.sample_freq_hz = config->sample_freq_hz;
+    adc.src.unit = config->adc_pattern[0].unit;
+    return ESP_OK;
+}
+
+esp_err_t adc_continuous_start(adc_continuous_handle_t handle) { return adc.hal.start(adc.hal.ctx); }
+
+esp_err_t adc_continuous_stop(adc_continuous_handle_t handle) { return adc.hal.stop(adc.hal.ctx); }
+
+esp_err_t adc_continuous_read(adc_continuous_handle_t handle, uint8_t *buf, uint32_t length_max, uint32_t *out_length, uint32_t timeout_ms) {
+    return adc.hal.read(adc.hal.ctx, buf, length_max, out_length, timeout_ms);
+}
+
+esp_err_t adc_cali_create_scheme_curve_fitting(const adc_cali_curve_fitting_config_t *config, adc_cali_handle_t *ret_handle) {
+    if (config == NULL || ret_handle == NULL) return ESP_ERR_INVALID_ARG;
+    *ret_handle = &cali;
+    return ESP_OK;
+}
+
+esp_err_t adc_cali_raw_to_voltage(adc_cali_handle_t handle, int raw, int *voltage) {
+    if (handle != &cali || voltage == NULL) return ESP_ERR_INVALID_ARG;
+    *voltage = raw * SIM_ADC_FULL_SCALE_MV / SIM_ADC_MAX_RAW;
+    return ESP_OK;
+}
@@ -0,0 +1,193 @@
+#include <math.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "driver/mcpwm_cap.h"
+#include "driver/pulse_cnt.h"
+#include "sim.h"
+#include "synthetic_edges.h"
+
+// Pulse counters and MCPWM capture channels backed by a synthetic pulse
+// train on each GPIO, on the simulation clock. A counter counts rising
+// edges since it was cleared and wraps to 0 at its high limit; a capture
+// channel latches the capture timer at the latest edge of its polarity,
+// at the timer's 80 MHz. Glitch filters are accepted and ignored.
+
+#define SIM_GPIO_COUNT 49
+#define SIM_PCNT_UNITS 4
+#define SIM_MCPWM_GROUPS 2
+#define SIM_MCPWM_CAP_CHANNELS 6
+#define SIM_MCPWM_CAP_HZ 80000000u
+
+struct sim_pcnt_unit {
+    bool used;
+    bool started;
+    int high_limit;
+    int gpio;
+    uint64_t base;              // Edges counted before the last clear
+};
+
+struct sim_pcnt_chan {
+    struct sim_pcnt_unit *unit;
+};
+
+struct sim_mcpwm_cap_timer {
+    bool used;
+    bool started;
+};
+
+struct sim_mcpwm_cap_channel {
+    struct sim_mcpwm_cap_timer *timer;
+    int gpio;
+    bool neg_edge;
+};
+
+static struct sim_capture {
+    pthread_mutex_t lock;
+    synthetic_edges_t signals[SIM_GPIO_COUNT];
+    bool signals_ready;
+    struct sim_pcnt_unit units[SIM_PCNT_UNITS];
+    struct sim_pcnt_chan chans[SIM_PCNT_UNITS];
+    struct sim_mcpwm_cap_timer timers[SIM_MCPWM_GROUPS];
+    struct sim_mcpwm_cap_channel channels[SIM_MCPWM_CAP_CHANNELS];
+    int channel_count;
+} capture = { .lock = PTHREAD_MUTEX_INITIALIZER };
+
+static synthetic_edges_t *signalLocked(int gpio) {
+    if (!capture.signals_ready) {
+        for (int i = 0; i < SIM_GPIO_COUNT; i++) syntheticEdgesInit(&capture.signals[i]);
+        capture.signals_ready = true;
+    }
+    return &capture.signals[gpio];
+}
+
+/**
+ * @brief Drives a GPIO with a square wave from now on, continuing the current period; 0 Hz holds its level.
+ */
+void simCaptureSetSignal(int gpio, double hz, double duty) {
+    if (gpio < 0 || gpio >= SIM_GPIO_COUNT) return;
+    pthread_mutex_lock(&capture.lock);
+    syntheticEdgesSet(signalLocked(gpio), simNowNs(), hz, duty);
+    pthread_mutex_unlock(&capture.lock);
+}
+
+static uint64_t edgesLocked(int gpio) { return syntheticEdgesCount(signalLocked(gpio), simNowNs()); }
+
+esp_err_t pcnt_new_unit(const pcnt_unit_config_t *config, pcnt_unit_handle_t *ret_unit) {
+    if (config == NULL || ret_unit == NULL || config->low_limit >= 0 || config->high_limit <= 0) return ESP_ERR_INVALID_ARG;
+    pthread_mutex_lock(&capture.lock);
+    esp_err_t err = ESP_ERR_NOT_FOUND;
+    for (int i = 0; i < SIM_PCNT_UNITS; i++) {
+        if (capture.units[i].used) continue;
+        capture.units[i] = (struct sim_pcnt_unit){ .used = true, .high_limit = config->high_limit, .gpio = -1 };
+        *ret_unit = &capture.units[i];
+        err = ESP_OK;
+        break;
+    }
+    pthread_mutex_unlock(&capture.lock);
+    return err;
+}
+
+esp_err_t pcnt_unit_set_glitch_filter(pcnt_unit_handle_t unit, const pcnt_glitch_filter_config_t *config) {
+    if (unit == NULL || (config != NULL && config->max_glitch_ns > 12787)) return ESP_ERR_INVALID_ARG;
+    return ESP_OK;
+}
+
+esp_err_t pcnt_new_channel(pcnt_unit_handle_t unit, const pcnt_chan_config_t *config, pcnt_channel_handle_t *ret_chan) {
+    if (unit == NULL || config == NULL || ret_chan == NULL || config->edge_gpio_num < 0 || config->edge_gpio_num >= SIM_GPIO_COUNT) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    unit->gpio = config->edge_gpio_num;
+    struct sim_pcnt_chan *chan = &capture.chans[unit - capture.units];
+    chan->unit = unit;
+    *ret_chan = chan;
+    return ESP_OK;
+}
+
+esp_err_t pcnt_channel_set_edge_action(pcnt_channel_handle_t chan, pcnt_channel_edge_action_t pos_act, pcnt_channel_edge_action_t neg_act) {
+    // Only counting rising edges is modelled
+    if (chan == NULL || pos_act != PCNT_CHANNEL_EDGE_ACTION_INCREASE || neg_act != PCNT_CHANNEL_EDGE_ACTION_HOLD) return ESP_ERR_NOT_SUPPORTED;
+    return ESP_OK;
+}
+
+esp_err_t pcnt_unit_enable(pcnt_unit_handle_t unit) { return unit ? ESP_OK : ESP_ERR_INVALID_ARG; }
+
+esp_err_t pcnt_unit_clear_count(pcnt_unit_handle_t unit) {
+    if (unit == NULL || unit->gpio < 0) return ESP_ERR_INVALID_STATE;
+    pthread_mutex_lock(&capture.lock);
+    unit->base = edgesLocked(unit->gpio);
+    pthread_mutex_unlock(&capture.lock);
+    return ESP_OK;
+}
+
+esp_err_t pcnt_unit_start(pcnt_unit_handle_t unit) {
+    if (unit == NULL || unit->gpio < 0) return ESP_ERR_INVALID_STATE;
+    unit->started = true;
+    return ESP_OK;
+}
+
+esp_err_t pcnt_unit_get_count(pcnt_unit_handle_t unit, int *value) {
+    if (unit == NULL || value == NULL) return ESP_ERR_INVALID_ARG;
+    if (!unit->started) return ESP_ERR_INVALID_STATE;
+    pthread_mutex_lock(&capture.lock);
+    *value = (int)((edgesLocked(unit->gpio) - unit->base) % (uint64_t)unit->high_limit);
+    pthread_mutex_unlock(&capture.lock);
+    return ESP_OK;
+}
+
+esp_err_t mcpwm_new_capture_timer(const mcpwm_capture_timer_config_t *config, mcpwm_cap_timer_handle_t *ret_cap_timer) {
+    if (config == NULL || ret_cap_timer == NULL || config->group_id < 0 || config->group_id >= SIM_MCPWM_GROUPS) return ESP_ERR_INVALID_ARG;
+    pthread_mutex_lock(&capture.lock);
+    struct sim_mcpwm_cap_timer *timer = &capture.timers[config->group_id];
+    esp_err_t err = timer->used ? ESP_ERR_NOT_FOUND : ESP_OK;
+    if (err == ESP_OK) {
+        timer->used = true;
+        *ret_cap_timer = timer;
+    }
+    pthread_mutex_unlock(&capture.lock);
+    return err;
+}
+
+esp_err_t mcpwm_capture_timer_get_resolution(mcpwm_cap_timer_handle_t cap_timer, uint32_t *out_resolution) {
+    if (cap_timer == NULL || out_resolution == NULL) return ESP_ERR_INVALID_ARG;
+    *out_resolution = SIM_MCPWM_CAP_HZ;
+    return ESP_OK;
+}
+
+esp_err_t mcpwm_capture_timer_enable(mcpwm_cap_timer_handle_t cap_timer) { return cap_timer ? ESP_OK : ESP_ERR_INVALID_ARG; }
+
+esp_err_t mcpwm_capture_timer_start(mcpwm_cap_timer_handle_t cap_timer) {
+    if (cap_timer == NULL) return ESP_ERR_INVALID_ARG;
+    cap_timer->started = true;
+    return ESP_OK;
+}
+
+esp_err_t mcpwm_new_capture_channel(mcpwm_cap_timer_handle_t cap_timer, const mcpwm_capture_channel_config_t *config,
+                                    mcpwm_cap_channel_handle_t *ret_cap_channel) {
+    if (cap_timer == NULL || config == NULL || ret_cap_channel == NULL || config->gpio_num < 0 || config->gpio_num >= SIM_GPIO_COUNT ||
+        config->flags.pos_edge == config->flags.neg_edge) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    pthread_mutex_lock(&capture.lock);
+    esp_err_t err = capture.channel_count < SIM_MCPWM_CAP_CHANNELS ? ESP_OK : ESP_ERR_NOT_FOUND;
+    if (err == ESP_OK) {
+        struct sim_mcpwm_cap_channel *chan = &capture.channels[capture.channel_count++];
+        *chan = (struct sim_mcpwm_cap_channel){ .timer = cap_timer, .gpio = config->gpio_num, .neg_edge = config->flags.neg_edge };
+        *ret_cap_channel = chan;
+    }
+    pthread_mutex_unlock(&capture.lock);
+    return err;
+}
+
+esp_err_t mcpwm_capture_channel_enable(mcpwm_cap_channel_handle_t cap_channel) { return cap_channel ? ESP_OK : ESP_ERR_INVALID_ARG; }
+
+esp_err_t mcpwm_capture_get_latched_value(mcpwm_cap_channel_handle_t cap_channel, uint32_t *value) {
+    if (cap_channel == NULL || value == NULL) return ESP_ERR_INVALID_ARG;
+    pthread_mutex_lock(&capture.lock);
+    synthetic_edges_t *sig = signalLocked(cap_channel->gpio);
+    double edge_ns = cap_channel->neg_edge ? syntheticEdgesLastFall(sig, simNowNs()) : syntheticEdgesLastRise(sig, simNowNs());
+    pthread_mutex_unlock(&capture.lock);
+    *value = (!cap_channel->timer->started || edge_ns < 0) ? 0 : (uint32_t)(uint64_t)floor(edge_ns * (SIM_MCPWM_CAP_HZ / 1e9));
+    return ESP_OK;
+}
@@ -0,0 +1,161 @@
+#include <malloc.h>
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "driver/temperature_sensor.h"
+#include "esp_cpu.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_partition.h"
+#include "esp_system.h"
+#include "esp_timer.h"
+#include "sdkconfig.h"
+#include "sim.h"
+
+#define SIM_CPU_TEMPERATURE_C 42.0f
+#define SIM_HEAP_BYTES (320 * 1024)  // Internal RAM left to the application on an ESP32-S3, roughly
+
+// esp_log, esp_timer, esp_cpu, esp_system, esp_heap_caps, esp_partition and the temperature sensor
+
+static esp_log_level_t log_level = ESP_LOG_INFO;
+
+void simLogLevel(esp_log_level_t level) { log_level = level; }
+
+void esp_log_write(esp_log_level_t level, const char *tag, const char *format, ...) {
+    static const char letters[] = "-EWIDV";
+    if (level > log_level) return;
+    // One buffer and one write: fprintf() on unbuffered stderr stages 8 KiB on the stack, which swamps the task's high-water mark
+    char line[320];
+    int prefix = snprintf(line, sizeof(line) - 1, "%c (%llu) %s: ", letters[level], (unsigned long long)(simNowNs() / 1000000ull), tag);
+    if (prefix < 0 || prefix >= (int)sizeof(line) - 1) prefix = 0;
+    va_list args;
+    va_start(args, format);
+    vsnprintf(line + prefix, sizeof(line) - 1 - (size_t)prefix, format, args);
+    va_end(args);
+    strcat(line, "\n");
+    fputs(line, stderr);
+}
+
+int64_t esp_timer_get_time(void) { return (int64_t)(simNowNs() / 1000ull); }
+
+// Code runs at host speed whatever the simulation speed, so cycles follow the host clock
+esp_cpu_cycle_count_t esp_cpu_get_cycle_count(void) {
+    return (esp_cpu_cycle_count_t)(hostMonotonicNs() * CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ / 1000ull);
+}
+
+void esp_restart(void) {
+    fprintf(stderr, "esp_restart() called\n");
+    exit(1);
+}
+
+static pthread_mutex_t heap_lock = PTHREAD_MUTEX_INITIALIZER;
+static size_t heap_baseline = SIZE_MAX;
+static ptrdiff_t heap_charged;
+static uint32_t heap_min_free = SIM_HEAP_BYTES;
+
+/**
+ * @brief Counts memory the target would take from the heap but the host does not (task stacks); negative to give it back.
+ */
+void simHeapCharge(ptrdiff_t bytes) {
+    pthread_mutex_lock(&heap_lock);
+    heap_charged += bytes;
+    pthread_mutex_unlock(&heap_lock);
+}
+
+/**
+ * @brief Free heap: SIM_HEAP_BYTES less what the host has allocated since simInit() and what is charged to it.
+ *
+ * simInit() sets the baseline, so buffers the harness allocated before
+ * starting the firmware do not count. There is no
+ * fragmentation, so the largest free block is all of it, and the minimum is
+ * the lowest value returned so far rather than a true low-water mark.
+ */
+static uint32_t heapFree(void) {
+    struct mallinfo2 info = mallinfo2();
+    size_t in_use = info.uordblks + info.hblkhd;
+    pthread_mutex_lock(&heap_lock);
+    if (heap_baseline == SIZE_MAX) heap_baseline = in_use;
+    size_t used = ((in_use > heap_baseline) ? in_use - heap_baseline : 0) + (size_t)heap_charged;
+    uint32_t free_bytes = (used < SIM_HEAP_BYTES) ? (uint32_t)(SIM_HEAP_BYTES - used) : 0;
+    if (free_bytes < heap_min_free) heap_min_free = free_bytes;
+    pthread_mutex_unlock(&heap_lock);
+    return free_bytes;
+}
+
+void simHeapBaseline(void) { heapFree(); }
+
+uint32_t esp_get_free_heap_size(void) { return heapFree(); }
+
+uint32_t esp_get_minimum_free_heap_size(void) {
+    heapFree();
+    pthread_mutex_lock(&heap_lock);
+    uint32_t min_free = heap_min_free;
+    pthread_mutex_unlock(&heap_lock);
+    return min_free;
+}
+
+size_t heap_caps_get_free_size(uint32_t caps) { return heapFree(); }
+size_t heap_caps_get_largest_free_block(uint32_t caps) { return heapFree(); }
+
+static esp_partition_t partition;
+static flash_file_t *partition_flash;
+static can_log_flash_t partition_hal;
+
+/**
+ * @brief Backs the data partition `label` with a flash image; without one, lookups fail.
+ */
+void simFlashAttach(const char *label, flash_file_t *ff) {
+    partition = (esp_partition_t){ .type = ESP_PARTITION_TYPE_DATA, .subtype = 0x40, .size = ff->size,
+                                   .erase_size = FLASH_FILE_SECTOR_BYTES };
+    snprintf(partition.label, sizeof(partition.label), "%s", label);
+    partition_flash = ff;
+    flashFileHal(ff, &partition_hal);
+}
+
+const esp_partition_t *esp_partition_find_first(esp_partition_type_t type, esp_partition_subtype_t subtype, const char *label) {
+    if (partition_flash == NULL || (type != ESP_PARTITION_TYPE_ANY && type != partition.type)) return NULL;
+    if (subtype != ESP_PARTITION_SUBTYPE_ANY && (int)subtype != partition.subtype) return NULL;
+    if (label != NULL && strcmp(label, partition.label) != 0) return NULL;
+    return &partition;
+}
+
+esp_err_t esp_partition_read(const esp_partition_t *p, size_t src_offset, void *dst, size_t size) {
+    if (p != &partition) return ESP_ERR_INVALID_ARG;
+    return partition_hal.read(partition_hal.ctx, (uint32_t)src_offset, dst, (uint32_t)size);
+}
+
+esp_err_t esp_partition_write(const esp_partition_t *p, size_t dst_offset, const void *src, size_t size) {
+    if (p != &partition) return ESP_ERR_INVALID_ARG;
+    return partition_hal.write(partition_hal.ctx, (uint32_t)dst_offset, src, (uint32_t)size);
+}
+
+esp_err_t esp_partition_erase_range(const esp_partition_t *p, size_t offset, size_t size) {
+    if (p != &partition) return ESP_ERR_INVALID_ARG;
+    return partition_hal.erase(partition_hal.ctx, (uint32_t)offset, (uint32_t)size);
+}
+
+static struct sim_temperature_sensor {
+    bool enabled;
+} temperature_sensor;
+
+esp_err_t temperature_sensor_install(const temperature_sensor_config_t *config, temperature_sensor_handle_t *handle) {
+    if (config == NULL || handle == NULL || config->range_min >= config->range_max) return ESP_ERR_INVALID_ARG;
+    *handle = &temperature_sensor;
+    return ESP_OK;
+}
+
+esp_err_t temperature_sensor_enable(temperature_sensor_handle_t handle) {
+    if (handle != &temperature_sensor) return ESP_ERR_INVALID_ARG;
+    handle->enabled = true;
+    return ESP_OK;
+}
+
+esp_err_t temperature_sensor_get_celsius(temperature_sensor_handle_t handle, float *celsius) {
+    if (handle != &temperature_sensor || celsius == NULL) return ESP_ERR_INVALID_ARG;
+    if (!handle->enabled) return ESP_ERR_INVALID_STATE;
+    *celsius = SIM_CPU_TEMPERATURE_C;
+    return ESP_OK;
+}
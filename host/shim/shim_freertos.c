@@ -0,0 +1,455 @@
+#include <errno.h>
+#include <pthread.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <time.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "sim.h"
+
+// FreeRTOS on pthreads. Priorities and core affinity are accepted but left to
+// the host scheduler; timing follows the simulation clock. Core affinity is
+// kept for the run-time statistics.
+
+#define TICK_NS (1000000000ull / configTICK_RATE_HZ)
+#define SIM_MAX_TASKS 32
+#define SIM_STACK_BYTES (256 * 1024)    // Host stack per task: glibc needs far more than the firmware tasks do
+#define SIM_STACK_PAINT 0xA5A5A5A5A5A5A5A5ull
+#define SIM_CORES 2
+
+static double sim_speed = 1.0;
+static uint64_t sim_epoch_ns;
+static pthread_once_t sim_once = PTHREAD_ONCE_INIT;
+
+static void simDefaultInit(void) {
+    if (sim_epoch_ns == 0) sim_epoch_ns = hostMonotonicNs();
+}
+
+/**
+ * @brief Starts the simulation clock at zero, running `speed` times faster than real time.
+ */
+void simInit(double speed) {
+    sim_speed = (speed > 0.0) ? speed : 1.0;
+    sim_epoch_ns = hostMonotonicNs();
+    pthread_once(&sim_once, simDefaultInit);
+    simHeapBaseline();
+}
+
+/**
+ * @brief Returns the simulation clock in nanoseconds since simInit().
+ */
+uint64_t simNowNs(void) {
+    pthread_once(&sim_once, simDefaultInit);
+    return (uint64_t)((double)(hostMonotonicNs() - sim_epoch_ns) * sim_speed);
+}
+
+/**
+ * @brief Converts a host duration to simulated time.
+ */
+uint64_t simRealNsToSim(uint64_t real_ns) { return (uint64_t)((double)real_ns * sim_speed); }
+
+static struct timespec realDeadline(uint64_t sim_ns) {
+    uint64_t real = sim_epoch_ns + (uint64_t)((double)sim_ns / sim_speed);
+    return (struct timespec){ .tv_sec = (time_t)(real / 1000000000ull), .tv_nsec = (long)(real % 1000000000ull) };
+}
+
+/**
+ * @brief Blocks the calling thread until the simulation clock reaches `sim_ns`.
+ */
+void simSleepUntilNs(uint64_t sim_ns) {
+    pthread_once(&sim_once, simDefaultInit);
+    struct timespec ts = realDeadline(sim_ns);
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR) {}
+}
+
+// Tasks
+
+typedef struct sim_task {
+    pthread_t thread;
+    TaskFunction_t fn;
+    void *arg;
+    pthread_mutex_t notify_lock;
+    pthread_cond_t notified;
+    uint32_t notify_count;
+
+    // Run-time statistics, only for tasks started with xTaskCreatePinnedToCore()
+    BaseType_t core_id;
+    uint32_t stack_depth;       // Bytes, as requested
+    uint64_t *stack;            // Painted host stack, lowest address first
+    uint8_t *stack_entry;       // Stack pointer on entry to the task function
+    bool exited;
+    uint64_t exit_cpu_ns;       // CPU time when the task ended
+    bool idle;                  // One of the per-core idle stand-ins
+    bool heap_stack;            // Created with xTaskCreatePinnedToCore(), so its stack is charged to the heap
+} sim_task_t;
+
+_Static_assert(sizeof(sim_task_t) <= sizeof(StaticTask_t), "StaticTask_t too small for the shim's task record");
+
+static _Thread_local sim_task_t *current_task;
+static pthread_mutex_t tasks_lock = PTHREAD_MUTEX_INITIALIZER;
+static sim_task_t *tasks[SIM_MAX_TASKS];
+static size_t task_count;
+static sim_task_t idle_tasks[SIM_CORES] = { { .core_id = 0, .idle = true }, { .core_id = 1, .idle = true } };
+
+static void condInit(pthread_cond_t *cond);
+static bool condWaitTicks(pthread_cond_t *cond, pthread_mutex_t *lock, TickType_t ticks, uint64_t start_ns);
+
+/**
+ * @brief Clears a task record and sets up its notification slot.
+ */
+static sim_task_t *taskInit(sim_task_t *task) {
+    memset(task, 0, sizeof(*task));
+    pthread_mutex_init(&task->notify_lock, NULL);
+    condInit(&task->notified);
+    return task;
+}
+
+/**
+ * @brief Allocates a task record with its notification slot.
+ */
+static sim_task_t *taskAlloc(void) {
+    sim_task_t *task = malloc(sizeof(*task));
+    return (task == NULL) ? NULL : taskInit(task);
+}
+
+static uint64_t threadCpuNs(clockid_t clock) {
+    struct timespec ts;
+    if (clock_gettime(clock, &ts) != 0) return 0;
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * @brief Records the calling task's final CPU time, so its counter stays readable once the thread is gone.
+ */
+static void taskExit(sim_task_t *task) {
+    pthread_mutex_lock(&tasks_lock);
+    task->exit_cpu_ns = threadCpuNs(CLOCK_THREAD_CPUTIME_ID);
+    task->exited = true;
+    pthread_mutex_unlock(&tasks_lock);
+    if (task->heap_stack) simHeapCharge(-(ptrdiff_t)task->stack_depth);
+}
+
+static void *taskTrampoline(void *p) {
+    sim_task_t *task = p;
+    current_task = task;
+    task->stack_entry = __builtin_frame_address(0);
+    task->fn(task->arg);
+    taskExit(task);
+    return NULL;
+}
+
+/**
+ * @brief Runs a task record on its own pthread, with a painted stack so its high-water mark can be measured.
+ *
+ * The host stack is SIM_STACK_BYTES whatever `stack_depth` is, since libc
+ * needs far more than the firmware tasks do; `stack_depth` is only what
+ * uxTaskGetStackHighWaterMark() measures against.
+ */
+static bool taskLaunch(sim_task_t *task, TaskFunction_t fn, void *arg, uint32_t stack_depth, BaseType_t core_id) {
+    task->fn = fn;
+    task->arg = arg;
+    task->core_id = core_id;
+    task->stack_depth = stack_depth;
+    task->stack = mmap(NULL, SIM_STACK_BYTES, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (task->stack == MAP_FAILED) return false;
+    for (size_t i = 0; i < SIM_STACK_BYTES / sizeof(uint64_t); i++) task->stack[i] = SIM_STACK_PAINT;
+
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setstack(&attr, task->stack, SIM_STACK_BYTES);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+    pthread_mutex_lock(&tasks_lock);
+    int err = (task_count < SIM_MAX_TASKS) ? pthread_create(&task->thread, &attr, taskTrampoline, task) : EAGAIN;
+    if (err == 0) tasks[task_count++] = task;
+    pthread_mutex_unlock(&tasks_lock);
+    pthread_attr_destroy(&attr);
+    if (err != 0) munmap(task->stack, SIM_STACK_BYTES);
+    return err == 0;
+}
+
+/**
+ * @brief Starts a task with its record and stack from the heap; the stack's `stack_depth` bytes count as heap in use until it ends.
+ */
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char *name, uint32_t stack_depth, void *arg,
+                                   UBaseType_t priority, TaskHandle_t *handle, BaseType_t core_id) {
+    sim_task_t *task = taskAlloc();
+    if (task == NULL) return pdFAIL;
+    task->heap_stack = true;
+    simHeapCharge((ptrdiff_t)stack_depth);
+    if (!taskLaunch(task, fn, arg, stack_depth, core_id)) {
+        simHeapCharge(-(ptrdiff_t)stack_depth);
+        free(task);
+        return pdFAIL;
+    }
+    if (handle != NULL) *handle = task;
+    return pdPASS;
+}
+
+/**
+ * @brief Starts a task with its record in `tcb`; `stack` is only checked, the thread runs on a host stack as any other.
+ */
+TaskHandle_t xTaskCreateStaticPinnedToCore(TaskFunction_t fn, const char *name, uint32_t stack_depth, void *arg, UBaseType_t priority,
+                                           StackType_t *stack, StaticTask_t *tcb, BaseType_t core_id) {
+    if (stack == NULL || tcb == NULL) return NULL;
+    sim_task_t *task = taskInit((sim_task_t *)tcb);
+    return taskLaunch(task, fn, arg, stack_depth, core_id) ? task : NULL;
+}
+
+void vTaskDelete(TaskHandle_t task) {
+    if (task != NULL) return;
+    if (current_task != NULL) taskExit(current_task);
+    pthread_exit(NULL);
+}
+
+/**
+ * @brief Returns the calling task. A thread the shim did not start (the host's
+ *        main thread, standing in for the ESP-IDF main task) gets one on first use.
+ */
+TaskHandle_t xTaskGetCurrentTaskHandle(void) {
+    if (current_task == NULL && (current_task = taskAlloc()) == NULL) abort();
+    return current_task;
+}
+
+TickType_t xTaskGetTickCount(void) { return (TickType_t)(simNowNs() / TICK_NS); }
+
+void vTaskDelay(TickType_t ticks) { simSleepUntilNs(simNowNs() + ticks * TICK_NS); }
+
+void vTaskDelayUntil(TickType_t *previous_wake, TickType_t increment) {
+    *previous_wake += increment;
+    simSleepUntilNs((uint64_t)*previous_wake * TICK_NS);
+}
+
+/**
+ * @brief CPU time a task has used so far, read from its thread's CPU clock.
+ *
+ * Called with tasks_lock held, so a task cannot exit while its clock is read.
+ */
+static uint64_t taskCpuNs(const sim_task_t *task) {
+    if (task->exited) return task->exit_cpu_ns;
+    clockid_t clock;
+    return (pthread_getcpuclockid(task->thread, &clock) == 0) ? threadCpuNs(clock) : 0;
+}
+
+/**
+ * @brief Returns a task's run-time counter in microseconds.
+ *
+ * Tasks count the host CPU time their thread used, unscaled, against the
+ * simulation clock, so a load is the host's share per simulated second
+ * whatever the speed. A core's idle task counts the simulated time that
+ * the tasks pinned to it did not use (the main thread is not counted).
+ * Several tasks of one core can run at once on the host, so this idle time
+ * is what the core would have left, not a measurement.
+ */
+uint32_t ulTaskGetRunTimeCounter(TaskHandle_t task) {
+    if (task == NULL) task = xTaskGetCurrentTaskHandle();
+    pthread_mutex_lock(&tasks_lock);
+    uint64_t us;
+    if (task->idle) {
+        uint64_t busy_ns = 0;
+        for (size_t i = 0; i < task_count; i++) {
+            if (tasks[i]->core_id == task->core_id) busy_ns += taskCpuNs(tasks[i]);
+        }
+        uint64_t now_ns = simNowNs();
+        us = (now_ns > busy_ns) ? (now_ns - busy_ns) / 1000u : 0;
+    } else {
+        us = taskCpuNs(task) / 1000u;
+    }
+    pthread_mutex_unlock(&tasks_lock);
+    return (uint32_t)us;
+}
+
+/**
+ * @brief Returns how many bytes of `stack_depth` the task has never touched.
+ *
+ * Use is measured from the task function's entry on the painted host
+ * stack, so it includes whatever glibc needs below the firmware's calls
+ * (printf through the log shim is the largest). Tasks the shim did not
+ * start report 0.
+ */
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task) {
+    if (task == NULL) task = xTaskGetCurrentTaskHandle();
+    if (task->stack == NULL || task->stack_entry == NULL) return 0;
+    size_t untouched = 0;
+    while (untouched < SIM_STACK_BYTES / sizeof(uint64_t) && task->stack[untouched] == SIM_STACK_PAINT) untouched++;
+    size_t used = (size_t)(task->stack_entry - (uint8_t *)&task->stack[untouched]);
+    return (used < task->stack_depth) ? (UBaseType_t)(task->stack_depth - used) : 0;
+}
+
+TaskHandle_t xTaskGetIdleTaskHandleForCore(BaseType_t core_id) {
+    return &idle_tasks[(core_id >= 0 && core_id < SIM_CORES) ? core_id : 0];
+}
+
+/**
+ * @brief Increments a task's notification count, waking it if it waits in ulTaskNotifyTake().
+ */
+BaseType_t xTaskNotifyGive(TaskHandle_t task) {
+    pthread_mutex_lock(&task->notify_lock);
+    task->notify_count++;
+    pthread_cond_signal(&task->notified);
+    pthread_mutex_unlock(&task->notify_lock);
+    return pdPASS;
+}
+
+/**
+ * @brief Waits for the calling task's notification count to be non-zero; returns the count before clearing.
+ */
+uint32_t ulTaskNotifyTake(BaseType_t clear_on_exit, TickType_t ticks_to_wait) {
+    sim_task_t *task = xTaskGetCurrentTaskHandle();
+    uint64_t start = simNowNs() / TICK_NS * TICK_NS; // Timeouts expire on a tick, as on the target
+    pthread_mutex_lock(&task->notify_lock);
+    while (task->notify_count == 0 && condWaitTicks(&task->notified, &task->notify_lock, ticks_to_wait, start)) {}
+    uint32_t count = task->notify_count;
+    if (count > 0) task->notify_count = clear_on_exit ? 0 : count - 1;
+    pthread_mutex_unlock(&task->notify_lock);
+    return count;
+}
+
+// Queues and mutexes
+
+typedef struct sim_queue {
+    pthread_mutex_t lock;
+    pthread_cond_t changed;
+    uint8_t *items;
+    UBaseType_t length;
+    UBaseType_t item_size;
+    UBaseType_t head;
+    UBaseType_t count;
+} sim_queue_t;
+
+/**
+ * @brief Waits on `cond` until woken or `ticks` of simulated time pass; false on timeout.
+ */
+static bool condWaitTicks(pthread_cond_t *cond, pthread_mutex_t *lock, TickType_t ticks, uint64_t start_ns) {
+    if (ticks == 0) return false;
+    if (ticks == portMAX_DELAY) return pthread_cond_wait(cond, lock) == 0;
+    struct timespec ts = realDeadline(start_ns + (uint64_t)ticks * TICK_NS);
+    return pthread_cond_timedwait(cond, lock, &ts) != ETIMEDOUT;
+}
+
+static void condInit(pthread_cond_t *cond) {
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(cond, &attr);
+    pthread_condattr_destroy(&attr);
+}
+
+_Static_assert(sizeof(sim_queue_t) <= sizeof(StaticQueue_t), "StaticQueue_t too small for the shim's queue");
+
+static sim_queue_t *queueInit(sim_queue_t *q, UBaseType_t length, UBaseType_t item_size, uint8_t *items) {
+    memset(q, 0, sizeof(*q));
+    q->items = items;
+    q->length = length;
+    q->item_size = item_size;
+    pthread_mutex_init(&q->lock, NULL);
+    condInit(&q->changed);
+    return q;
+}
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size) {
+    sim_queue_t *q = malloc(sizeof(*q));
+    if (q == NULL) return NULL;
+    uint8_t *items = malloc((size_t)length * item_size);
+    if (items == NULL) {
+        free(q);
+        return NULL;
+    }
+    return queueInit(q, length, item_size, items);
+}
+
+QueueHandle_t xQueueCreateStatic(UBaseType_t length, UBaseType_t item_size, uint8_t *storage, StaticQueue_t *queue) {
+    if (storage == NULL || queue == NULL) return NULL;
+    return queueInit((sim_queue_t *)queue, length, item_size, storage);
+}
+
+BaseType_t xQueueSend(QueueHandle_t q, const void *item, TickType_t ticks_to_wait) {
+    uint64_t start = simNowNs();
+    pthread_mutex_lock(&q->lock);
+    while (q->count == q->length) {
+        if (!condWaitTicks(&q->changed, &q->lock, ticks_to_wait, start)) {
+            pthread_mutex_unlock(&q->lock);
+            return pdFALSE;
+        }
+    }
+    memcpy(&q->items[((q->head + q->count) % q->length) * q->item_size], item, q->item_size);
+    q->count++;
+    pthread_cond_broadcast(&q->changed);
+    pthread_mutex_unlock(&q->lock);
+    return pdTRUE;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t q, void *item, TickType_t ticks_to_wait) {
+    uint64_t start = simNowNs();
+    pthread_mutex_lock(&q->lock);
+    while (q->count == 0) {
+        if (!condWaitTicks(&q->changed, &q->lock, ticks_to_wait, start)) {
+            pthread_mutex_unlock(&q->lock);
+            return pdFALSE;
+        }
+    }
+    memcpy(item, &q->items[q->head * q->item_size], q->item_size);
+    q->head = (q->head + 1) % q->length;
+    q->count--;
+    pthread_cond_broadcast(&q->changed);
+    pthread_mutex_unlock(&q->lock);
+    return pdTRUE;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t q) {
+    pthread_mutex_lock(&q->lock);
+    UBaseType_t count = q->count;
+    pthread_mutex_unlock(&q->lock);
+    return count;
+}
+
+typedef struct sim_mutex {
+    pthread_mutex_t lock;
+    pthread_cond_t released;
+    bool held;
+} sim_mutex_t;
+
+_Static_assert(sizeof(sim_mutex_t) <= sizeof(StaticSemaphore_t), "StaticSemaphore_t too small for the shim's mutex");
+
+static sim_mutex_t *mutexInit(sim_mutex_t *m) {
+    memset(m, 0, sizeof(*m));
+    pthread_mutex_init(&m->lock, NULL);
+    condInit(&m->released);
+    return m;
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void) {
+    sim_mutex_t *m = malloc(sizeof(*m));
+    return (m == NULL) ? NULL : mutexInit(m);
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutexStatic(StaticSemaphore_t *mutex) {
+    return (mutex == NULL) ? NULL : mutexInit((sim_mutex_t *)mutex);
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t m, TickType_t ticks_to_wait) {
+    uint64_t start = simNowNs();
+    pthread_mutex_lock(&m->lock);
+    while (m->held) {
+        if (!condWaitTicks(&m->released, &m->lock, ticks_to_wait, start)) {
+            pthread_mutex_unlock(&m->lock);
+            return pdFALSE;
+        }
+    }
+    m->held = true;
+    pthread_mutex_unlock(&m->lock);
+    return pdTRUE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t m) {
+    pthread_mutex_lock(&m->lock);
+    bool was_held = m->held;
+    m->held = false;
+    pthread_cond_signal(&m->released);
+    pthread_mutex_unlock(&m->lock);
+    return was_held ? pdTRUE : pdFALSE;
+}
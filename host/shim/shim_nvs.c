@@ -0,0 +1,202 @@
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "nvs.h"
+#include "nvs_flash.h"
+#include "sim.h"
+
+// nvs_flash and the NVS blob API on a file: every entry lives in memory and
+// each write rewrites the whole file to a temporary and renames it over the
+// old one, so as on the target an interrupted write leaves the previous
+// value intact. Without a file the store lives in memory only.
+
+#define NVS_MAX_ENTRIES 32
+#define NVS_MAX_NAMESPACES 8
+#define NVS_MAX_BLOB_BYTES 4000
+#define NVS_FILE_MAGIC 0x5356484Eu // "NHVS"
+
+typedef struct {
+    char ns[NVS_KEY_NAME_MAX_SIZE];
+    char key[NVS_KEY_NAME_MAX_SIZE];
+    uint32_t len;
+    uint8_t data[NVS_MAX_BLOB_BYTES];
+} nvs_entry_t;
+
+static struct {
+    pthread_mutex_t lock;
+    const char *path;
+    bool initialized;
+    nvs_entry_t entries[NVS_MAX_ENTRIES];
+    size_t count;
+    char namespaces[NVS_MAX_NAMESPACES][NVS_KEY_NAME_MAX_SIZE];
+    bool writable[NVS_MAX_NAMESPACES];
+    size_t namespace_count;
+} nvs = { .lock = PTHREAD_MUTEX_INITIALIZER };
+
+void simNvsAttach(const char *path) { nvs.path = path; }
+
+static esp_err_t nvsLoadFile(void) {
+    nvs.count = 0;
+    FILE *f = (nvs.path != NULL) ? fopen(nvs.path, "rb") : NULL;
+    if (f == NULL) return ESP_OK; // A fresh device has an empty NVS
+
+    uint32_t magic = 0, count = 0;
+    bool ok = fread(&magic, sizeof(magic), 1, f) == 1 && magic == NVS_FILE_MAGIC && fread(&count, sizeof(count), 1, f) == 1 &&
+              count <= NVS_MAX_ENTRIES;
+    for (uint32_t i = 0; ok && i < count; i++) {
+        nvs_entry_t *e = &nvs.entries[i];
+        ok = fread(e->ns, sizeof(e->ns), 1, f) == 1 && fread(e->key, sizeof(e->key), 1, f) == 1 &&
+             fread(&e->len, sizeof(e->len), 1, f) == 1 && e->len <= NVS_MAX_BLOB_BYTES &&
+             (e->len == 0 || fread(e->data, e->len, 1, f) == 1);
+        e->ns[sizeof(e->ns) - 1] = e->key[sizeof(e->key) - 1] = '\0';
+    }
+    fclose(f);
+    if (!ok) return ESP_ERR_NVS_NO_FREE_PAGES; // Unreadable, as the target reports a damaged partition
+    nvs.count = count;
+    return ESP_OK;
+}
+
+static esp_err_t nvsStoreFile(void) {
+    if (nvs.path == NULL) return ESP_OK;
+
+    char tmp[1024];
+    snprintf(tmp, sizeof(tmp), "%s.tmp", nvs.path);
+    FILE *f = fopen(tmp, "wb");
+    if (f == NULL) return ESP_FAIL;
+    uint32_t magic = NVS_FILE_MAGIC, count = (uint32_t)nvs.count;
+    bool ok = fwrite(&magic, sizeof(magic), 1, f) == 1 && fwrite(&count, sizeof(count), 1, f) == 1;
+    for (size_t i = 0; ok && i < nvs.count; i++) {
+        const nvs_entry_t *e = &nvs.entries[i];
+        ok = fwrite(e->ns, sizeof(e->ns), 1, f) == 1 && fwrite(e->key, sizeof(e->key), 1, f) == 1 &&
+             fwrite(&e->len, sizeof(e->len), 1, f) == 1 && (e->len == 0 || fwrite(e->data, e->len, 1, f) == 1);
+    }
+    ok = (fclose(f) == 0) && ok;
+    if (!ok || rename(tmp, nvs.path) != 0) {
+        remove(tmp);
+        return ESP_FAIL;
+    }
+    return ESP_OK;
+}
+
+static nvs_entry_t *nvsFind(nvs_handle_t handle, const char *key) {
+    for (size_t i = 0; i < nvs.count; i++) {
+        if (strcmp(nvs.entries[i].ns, nvs.namespaces[handle - 1]) == 0 && strcmp(nvs.entries[i].key, key) == 0) {
+            return &nvs.entries[i];
+        }
+    }
+    return NULL;
+}
+
+static bool nvsValidHandle(nvs_handle_t handle) { return handle >= 1 && handle <= nvs.namespace_count; }
+
+esp_err_t nvs_flash_init(void) {
+    pthread_mutex_lock(&nvs.lock);
+    esp_err_t err = nvsLoadFile();
+    nvs.initialized = err == ESP_OK;
+    pthread_mutex_unlock(&nvs.lock);
+    return err;
+}
+
+esp_err_t nvs_flash_erase(void) {
+    pthread_mutex_lock(&nvs.lock);
+    nvs.count = 0;
+    nvs.initialized = false;
+    esp_err_t err = nvsStoreFile();
+    pthread_mutex_unlock(&nvs.lock);
+    return err;
+}
+
+esp_err_t nvs_open(const char *namespace_name, nvs_open_mode_t open_mode, nvs_handle_t *out_handle) {
+    if (namespace_name == NULL || strlen(namespace_name) >= NVS_KEY_NAME_MAX_SIZE) return ESP_ERR_NVS_INVALID_NAME;
+    pthread_mutex_lock(&nvs.lock);
+    esp_err_t err = ESP_OK;
+    if (!nvs.initialized) {
+        err = ESP_ERR_NVS_NOT_INITIALIZED;
+    } else if (nvs.namespace_count == NVS_MAX_NAMESPACES) {
+        err = ESP_ERR_NVS_NOT_ENOUGH_SPACE;
+    } else {
+        snprintf(nvs.namespaces[nvs.namespace_count], NVS_KEY_NAME_MAX_SIZE, "%s", namespace_name);
+        nvs.writable[nvs.namespace_count] = open_mode == NVS_READWRITE;
+        *out_handle = (nvs_handle_t)++nvs.namespace_count;
+    }
+    pthread_mutex_unlock(&nvs.lock);
+    return err;
+}
+
+void nvs_close(nvs_handle_t handle) {}
+
+esp_err_t nvs_get_blob(nvs_handle_t handle, const char *key, void *out_value, size_t *length) {
+    pthread_mutex_lock(&nvs.lock);
+    esp_err_t err = ESP_OK;
+    const nvs_entry_t *e = nvsValidHandle(handle) ? nvsFind(handle, key) : NULL;
+    if (!nvsValidHandle(handle)) {
+        err = ESP_ERR_NVS_INVALID_HANDLE;
+    } else if (e == NULL) {
+        err = ESP_ERR_NVS_NOT_FOUND;
+    } else if (out_value != NULL && *length < e->len) {
+        err = ESP_ERR_NVS_INVALID_LENGTH;
+    } else {
+        if (out_value != NULL) memcpy(out_value, e->data, e->len);
+        *length = e->len;
+    }
+    pthread_mutex_unlock(&nvs.lock);
+    return err;
+}
+
+esp_err_t nvs_set_blob(nvs_handle_t handle, const char *key, const void *value, size_t length) {
+    if (key == NULL || strlen(key) >= NVS_KEY_NAME_MAX_SIZE) return ESP_ERR_NVS_INVALID_NAME;
+    if (length > NVS_MAX_BLOB_BYTES) return ESP_ERR_NVS_NOT_ENOUGH_SPACE;
+    pthread_mutex_lock(&nvs.lock);
+    esp_err_t err = ESP_OK;
+    if (!nvsValidHandle(handle)) {
+        err = ESP_ERR_NVS_INVALID_HANDLE;
+    } else if (!nvs.writable[handle - 1]) {
+        err = ESP_ERR_NVS_READ_ONLY;
+    } else {
+        nvs_entry_t *e = nvsFind(handle, key);
+        if (e == NULL && nvs.count == NVS_MAX_ENTRIES) {
+            err = ESP_ERR_NVS_NOT_ENOUGH_SPACE;
+        } else {
+            nvs_entry_t saved;
+            size_t saved_count = nvs.count;
+            if (e == NULL) {
+                e = &nvs.entries[nvs.count++];
+                memcpy(e->ns, nvs.namespaces[handle - 1], sizeof(e->ns));
+                snprintf(e->key, sizeof(e->key), "%s", key);
+            } else {
+                saved = *e;
+            }
+            e->len = (uint32_t)length;
+            memcpy(e->data, value, length);
+            err = nvsStoreFile();
+            if (err != ESP_OK) { // Roll back, the file still holds the old value
+                if (nvs.count != saved_count) nvs.count = saved_count;
+                else *e = saved;
+            }
+        }
+    }
+    pthread_mutex_unlock(&nvs.lock);
+    return err;
+}
+
+esp_err_t nvs_erase_key(nvs_handle_t handle, const char *key) {
+    pthread_mutex_lock(&nvs.lock);
+    esp_err_t err = ESP_OK;
+    nvs_entry_t *e = nvsValidHandle(handle) ? nvsFind(handle, key) : NULL;
+    if (!nvsValidHandle(handle)) {
+        err = ESP_ERR_NVS_INVALID_HANDLE;
+    } else if (e == NULL) {
+        err = ESP_ERR_NVS_NOT_FOUND;
+    } else {
+        *e = nvs.entries[--nvs.count];
+        err = nvsStoreFile();
+    }
+    pthread_mutex_unlock(&nvs.lock);
+    return err;
+}
+
+esp_err_t nvs_commit(nvs_handle_t handle) { return nvsValidHandle(handle) ? ESP_OK : ESP_ERR_NVS_INVALID_HANDLE; }
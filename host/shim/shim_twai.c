@@ -0,0 +1,245 @@
+#include <pthread.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "driver/twai.h"
+#include "freertos/queue.h"
+#include "inc/can_rx.h"
+#include "sim.h"
+
+// In-memory TWAI controller: transmit hands frames straight to the sink (the
+// bus is never busy), received frames pass the configured acceptance filter
+// into a driver-sized RX queue like the hardware path. Faults are injected
+// by the harness: a bus-off, or a bus where nothing acknowledges, on which
+// frames pile up in the TX queue until it is reconnected.
+
+#define SIM_TWAI_TX_QUEUE_MAX 64
+#define SIM_TWAI_ALERT_QUEUE_LEN 32
+#define SIM_TWAI_RECOVERY_BITS (128ull * 11) // 128 occurrences of 11 recessive bits
+#define SIM_TWAI_ERR_PASSIVE 128
+
+static struct sim_twai {
+    pthread_mutex_t lock;
+    bool installed;
+    bool started;
+    bool disconnected;
+    can_rx_filter_t filter;
+    QueueHandle_t rx_queue;
+    QueueHandle_t alerts;
+    uint32_t alerts_enabled;
+    twai_message_t tx_queue[SIM_TWAI_TX_QUEUE_MAX];
+    uint32_t tx_queue_len;
+    uint32_t bit_ns;            // From the timing config
+    twai_status_info_t status;  // msgs_to_tx is the TX queue
+    sim_twai_tx_fn_t sink;
+    void *sink_ctx;
+    pthread_cond_t recovery;    // Signalled by twai_initiate_recovery() for recoveryThread()
+    bool recovery_thread;
+} twai = { .lock = PTHREAD_MUTEX_INITIALIZER, .recovery = PTHREAD_COND_INITIALIZER };
+
+static void postAlerts(uint32_t alerts) {
+    alerts &= twai.alerts_enabled;
+    if (alerts != 0 && twai.alerts != NULL) xQueueSend(twai.alerts, &alerts, 0);
+}
+
+/**
+ * @brief Registers the callback that receives every transmitted frame.
+ */
+void simTwaiSetTxSink(sim_twai_tx_fn_t fn, void *ctx) {
+    pthread_mutex_lock(&twai.lock);
+    twai.sink = fn;
+    twai.sink_ctx = ctx;
+    pthread_mutex_unlock(&twai.lock);
+}
+
+/**
+ * @brief Puts a frame on the bus towards the board.
+ *
+ * @return True if the frame reached the RX queue, false if the driver is not
+ *         running, the acceptance filter rejected it or the queue was full
+ *         (counted in rx_missed_count)
+ */
+bool simTwaiInject(const twai_message_t *msg) {
+    pthread_mutex_lock(&twai.lock);
+    bool accepted = twai.started && canRxFilterAccepts(&twai.filter, msg->identifier, msg->extd);
+    pthread_mutex_unlock(&twai.lock);
+    if (!accepted) return false;
+    if (xQueueSend(twai.rx_queue, msg, 0) == pdTRUE) return true;
+    pthread_mutex_lock(&twai.lock);
+    twai.status.rx_missed_count++;
+    pthread_mutex_unlock(&twai.lock);
+    return false;
+}
+
+/**
+ * @brief Drives the controller bus-off, as a shorted bus or a burst of errors would.
+ *
+ * Frames already in the TX queue stay there until the driver clears them.
+ */
+void simTwaiBusOff(void) {
+    pthread_mutex_lock(&twai.lock);
+    if (twai.started) {
+        twai.started = false;
+        twai.status.state = TWAI_STATE_BUS_OFF;
+        twai.status.tx_error_counter = 256;
+        postAlerts(TWAI_ALERT_BUS_OFF);
+    }
+    pthread_mutex_unlock(&twai.lock);
+}
+
+/**
+ * @brief Disconnects the board from the bus, or reconnects it.
+ *
+ * While disconnected nothing acknowledges: the first frame sent pushes the
+ * TX error counter to error passive (16 retransmissions on the target) and
+ * every frame stays in the TX queue. On reconnection the queue is sent in
+ * order and the controller returns to error active.
+ */
+void simTwaiSetConnected(bool connected) {
+    twai_message_t backlog[SIM_TWAI_TX_QUEUE_MAX];
+    uint32_t count = 0;
+
+    pthread_mutex_lock(&twai.lock);
+    twai.disconnected = !connected;
+    if (connected && twai.started) {
+        count = twai.status.msgs_to_tx;
+        memcpy(backlog, twai.tx_queue, count * sizeof(backlog[0]));
+        twai.status.msgs_to_tx = 0;
+        if (twai.status.tx_error_counter >= SIM_TWAI_ERR_PASSIVE) postAlerts(TWAI_ALERT_ERR_ACTIVE);
+        twai.status.tx_error_counter = 0;
+    }
+    sim_twai_tx_fn_t sink = twai.sink;
+    void *ctx = twai.sink_ctx;
+    pthread_mutex_unlock(&twai.lock);
+
+    for (uint32_t i = 0; i < count && sink != NULL; i++) sink(ctx, &backlog[i]);
+}
+
+/**
+ * @brief Times each bus-off recovery, started once at install so no pthread_create() runs on the caller's task stack.
+ */
+static void *recoveryThread(void *arg) {
+    pthread_mutex_lock(&twai.lock);
+    while (1) {
+        while (twai.status.state != TWAI_STATE_RECOVERING) pthread_cond_wait(&twai.recovery, &twai.lock);
+        pthread_mutex_unlock(&twai.lock);
+        simSleepUntilNs(simNowNs() + SIM_TWAI_RECOVERY_BITS * twai.bit_ns);
+        pthread_mutex_lock(&twai.lock);
+        twai.status.state = TWAI_STATE_STOPPED;
+        twai.status.tx_error_counter = 0;
+        postAlerts(TWAI_ALERT_BUS_RECOVERED);
+    }
+    return NULL;
+}
+
+esp_err_t twai_driver_install_v2(const twai_general_config_t *g_config, const twai_timing_config_t *t_config,
+                                 const twai_filter_config_t *f_config, twai_handle_t *ret_twai) {
+    if (g_config == NULL || t_config == NULL || f_config == NULL || ret_twai == NULL) return ESP_ERR_INVALID_ARG;
+    pthread_mutex_lock(&twai.lock);
+    esp_err_t err = ESP_ERR_INVALID_STATE;
+    if (!twai.installed) {
+        twai.rx_queue = xQueueCreate(g_config->rx_queue_len, sizeof(twai_message_t));
+        twai.alerts = xQueueCreate(SIM_TWAI_ALERT_QUEUE_LEN, sizeof(uint32_t));
+        err = (twai.rx_queue != NULL && twai.alerts != NULL) ? ESP_OK : ESP_ERR_NO_MEM;
+    }
+    pthread_t thread;
+    if (err == ESP_OK && !twai.recovery_thread) {
+        if (pthread_create(&thread, NULL, recoveryThread, NULL) != 0) err = ESP_ERR_NO_MEM;
+        else pthread_detach(thread);
+        twai.recovery_thread = err == ESP_OK;
+    }
+    if (err == ESP_OK) {
+        twai.filter = (can_rx_filter_t){ .dual = !f_config->single_filter, .acceptance_code = f_config->acceptance_code,
+                                         .acceptance_mask = f_config->acceptance_mask };
+        twai.alerts_enabled = g_config->alerts_enabled;
+        twai.bit_ns = (uint32_t)(1000000000ull * (1u + t_config->tseg_1 + t_config->tseg_2) / t_config->quanta_resolution_hz);
+        twai.tx_queue_len = (g_config->tx_queue_len < SIM_TWAI_TX_QUEUE_MAX) ? g_config->tx_queue_len : SIM_TWAI_TX_QUEUE_MAX;
+        twai.installed = true;
+        twai.status.state = TWAI_STATE_STOPPED;
+        *ret_twai = &twai;
+    }
+    pthread_mutex_unlock(&twai.lock);
+    return err;
+}
+
+esp_err_t twai_start_v2(twai_handle_t handle) {
+    pthread_mutex_lock(&twai.lock);
+    esp_err_t err = (handle == &twai && twai.installed && twai.status.state == TWAI_STATE_STOPPED) ? ESP_OK : ESP_ERR_INVALID_STATE;
+    if (err == ESP_OK) {
+        twai.started = true;
+        twai.status.state = TWAI_STATE_RUNNING;
+    }
+    pthread_mutex_unlock(&twai.lock);
+    return err;
+}
+
+esp_err_t twai_start(void) { return twai_start_v2(&twai); }
+
+esp_err_t twai_transmit(const twai_message_t *message, TickType_t ticks_to_wait) {
+    if (message == NULL || message->data_length_code > TWAI_FRAME_MAX_DLC) return ESP_ERR_INVALID_ARG;
+    pthread_mutex_lock(&twai.lock);
+    esp_err_t err = twai.started ? ESP_OK : ESP_ERR_INVALID_STATE;
+    bool queue = err == ESP_OK && (twai.disconnected || twai.status.msgs_to_tx > 0);
+    if (queue) {
+        if (twai.status.msgs_to_tx == twai.tx_queue_len) {
+            err = ESP_ERR_TIMEOUT; // The firmware never waits on a full queue
+        } else {
+            twai.tx_queue[twai.status.msgs_to_tx++] = *message;
+            if (twai.status.tx_error_counter < SIM_TWAI_ERR_PASSIVE) postAlerts(TWAI_ALERT_ERR_PASS);
+            twai.status.tx_error_counter = SIM_TWAI_ERR_PASSIVE;
+        }
+    }
+    sim_twai_tx_fn_t sink = twai.sink;
+    void *ctx = twai.sink_ctx;
+    pthread_mutex_unlock(&twai.lock);
+    if (err == ESP_OK && !queue && sink != NULL) sink(ctx, message);
+    return err;
+}
+
+esp_err_t twai_receive(twai_message_t *message, TickType_t ticks_to_wait) {
+    if (message == NULL) return ESP_ERR_INVALID_ARG;
+    if (!twai.installed) return ESP_ERR_INVALID_STATE;
+    return (xQueueReceive(twai.rx_queue, message, ticks_to_wait) == pdTRUE) ? ESP_OK : ESP_ERR_TIMEOUT;
+}
+
+esp_err_t twai_get_status_info(twai_status_info_t *status_info) {
+    if (status_info == NULL) return ESP_ERR_INVALID_ARG;
+    pthread_mutex_lock(&twai.lock);
+    if (!twai.installed) {
+        pthread_mutex_unlock(&twai.lock);
+        return ESP_ERR_INVALID_STATE;
+    }
+    *status_info = twai.status;
+    pthread_mutex_unlock(&twai.lock);
+    status_info->msgs_to_rx = uxQueueMessagesWaiting(twai.rx_queue);
+    return ESP_OK;
+}
+
+esp_err_t twai_read_alerts(uint32_t *alerts, TickType_t ticks_to_wait) {
+    if (alerts == NULL) return ESP_ERR_INVALID_ARG;
+    if (!twai.installed) return ESP_ERR_INVALID_STATE;
+    uint32_t more;
+    *alerts = 0;
+    if (xQueueReceive(twai.alerts, alerts, ticks_to_wait) != pdTRUE) return ESP_ERR_TIMEOUT;
+    while (xQueueReceive(twai.alerts, &more, 0) == pdTRUE) *alerts |= more;
+    return ESP_OK;
+}
+
+esp_err_t twai_initiate_recovery(void) {
+    pthread_mutex_lock(&twai.lock);
+    esp_err_t err = (twai.status.state == TWAI_STATE_BUS_OFF) ? ESP_OK : ESP_ERR_INVALID_STATE;
+    if (err == ESP_OK) {
+        twai.status.state = TWAI_STATE_RECOVERING;
+        pthread_cond_signal(&twai.recovery);
+    }
+    pthread_mutex_unlock(&twai.lock);
+    return err;
+}
+
+esp_err_t twai_clear_transmit_queue(void) {
+    pthread_mutex_lock(&twai.lock);
+    esp_err_t err = twai.installed ? ESP_OK : ESP_ERR_INVALID_STATE;
+    twai.status.msgs_to_tx = 0;
+    pthread_mutex_unlock(&twai.lock);
+    return err;
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "driver/twai.h"
+#include "esp_log.h"
+#include "flash_file.h"
+#include "synthetic_adc.h"
+
+/**
+ * @brief Controls for the host build of the whole firmware (see firmware_sim.c).
+ *
+ * The ESP-IDF and FreeRTOS shims in this directory run on one simulation
+ * clock that advances `speed` times faster than the host monotonic clock, so
+ * FreeRTOS ticks, esp_timer and the ADC sample rate all scale together. The
+ * ADC reads from a scripted synthetic source, the pulse counters and MCPWM
+ * capture channels from a synthetic pulse train per GPIO, the TWAI
+ * controller is an in-memory bus whose transmitted frames go to a sink
+ * callback and whose received frames and faults are injected by the
+ * harness, the `canlog` partition is backed by a flash_file_t and NVS by a
+ * file that survives between runs, as the real NVS survives a power cycle.
+ *
+ * The FreeRTOS run-time statistics come from the host: a task's run time
+ * is its thread's CPU time, its stack high-water mark is read from a
+ * painted host stack, and each core's idle time is the simulated time the
+ * tasks pinned to it did not use. The heap is a fixed ESP32-S3-sized pool
+ * less what the host has allocated since simInit() and the stacks of the
+ * tasks created on the heap, as the target takes them from there.
+ */
+
+typedef void (*sim_twai_tx_fn_t)(void *ctx, const twai_message_t *msg);
+
+void simInit(double speed);
+uint64_t simNowNs(void);
+void simSleepUntilNs(uint64_t sim_ns);
+uint64_t simRealNsToSim(uint64_t real_ns);
+void simHeapBaseline(void);  // Heap use so far is the harness's, not the firmware's (called by simInit())
+void simHeapCharge(ptrdiff_t bytes); // Heap the target would use and the host does not: dynamic task stacks
+
+synthetic_adc_t *simAdcSource(void);
+void simAdcSetLevel(int channel, uint16_t level);
+void simCaptureSetSignal(int gpio, double hz, double duty); // Square wave on a frequency input's GPIO, 0 Hz holds the level
+
+void simTwaiSetTxSink(sim_twai_tx_fn_t fn, void *ctx);
+bool simTwaiInject(const twai_message_t *msg);
+void simTwaiBusOff(void);
+void simTwaiSetConnected(bool connected);
+
+void simFlashAttach(const char *label, flash_file_t *ff);
+void simNvsAttach(const char *path); // Before app_main(); NULL (the default) keeps NVS in memory
+void simLogLevel(esp_log_level_t level);
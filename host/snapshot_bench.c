@@ -0,0 +1,165 @@
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "inc/channels.h"
+#include "inc/snapshot.h"
+#include "synthetic_adc.h"
+
+/**
+ * @brief Compares the seqlock sensor snapshot against the previous mutex scheme.
+ *
+ * One writer publishes sweeps whose every field is derived from the sweep
+ * counter, while N readers copy them concurrently and check that all fields
+ * agree. A torn read shows up as a mismatch. The same workload is then run
+ * with a pthread mutex guarding a plain struct, mirroring the old
+ * filtered_voltages/scaled_pressures mutexes.
+ *
+ * The writer publishes once per CHANNEL_SWEEP_US, as the ADC task does, so
+ * readers see the contention they would on the board. `--burst` publishes
+ * back to back instead, to stress the torn-read check.
+ *
+ * Usage: snapshot_bench [readers] [publishes] [--burst]
+ */
+
+typedef struct {
+    bool use_mutex;
+    bool burst;
+    uint32_t publishes;
+    atomic_bool done;
+    sensor_snapshot_t snap;
+    pthread_mutex_t lock;
+    sensor_values_t locked;
+    uint64_t write_ns;
+} bench_t;
+
+typedef struct {
+    bench_t *bench;
+    uint64_t reads;
+    uint64_t read_ns;
+    uint64_t torn;
+} reader_t;
+
+static void fillValues(sensor_values_t *v, uint32_t n) {
+    v->timestamp_us = n;
+    v->sweep = n;
+    for (int i = 0; i < SNAPSHOT_NUM_CHANNELS; i++) {
+        v->raw[i] = (uint16_t)(n + i);
+        v->filtered_mv[i] = (uint16_t)(n * 3 + i);
+    }
+    for (int i = 0; i < SENSOR_SLOT_COUNT; i++) v->outputs[i] = (int32_t)(n * 7 + i);
+}
+
+static bool consistent(const sensor_values_t *v) {
+    uint32_t n = v->sweep;
+    if (v->timestamp_us != n) return false;
+    for (int i = 0; i < SNAPSHOT_NUM_CHANNELS; i++) {
+        if (v->raw[i] != (uint16_t)(n + i) || v->filtered_mv[i] != (uint16_t)(n * 3 + i)) return false;
+    }
+    for (int i = 0; i < SENSOR_SLOT_COUNT; i++) {
+        if (v->outputs[i] != (int32_t)(n * 7 + i)) return false;
+    }
+    return true;
+}
+
+static void *writerThread(void *arg) {
+    bench_t *b = arg;
+    sensor_values_t v;
+    struct timespec next;
+    clock_gettime(CLOCK_MONOTONIC, &next);
+    for (uint32_t n = 1; n <= b->publishes; n++) {
+        fillValues(&v, n);
+        if (!b->burst) {
+            next.tv_nsec += CHANNEL_SWEEP_US * 1000;
+            if (next.tv_nsec >= 1000000000) {
+                next.tv_nsec -= 1000000000;
+                next.tv_sec++;
+            }
+            clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL);
+        }
+        uint64_t t0 = hostMonotonicNs();
+        if (b->use_mutex) {
+            pthread_mutex_lock(&b->lock);
+            b->locked = v;
+            pthread_mutex_unlock(&b->lock);
+        } else {
+            snapshotPublish(&b->snap, &v);
+        }
+        b->write_ns += hostMonotonicNs() - t0;
+    }
+    atomic_store(&b->done, true);
+    return NULL;
+}
+
+static void *readerThread(void *arg) {
+    reader_t *r = arg;
+    bench_t *b = r->bench;
+    sensor_values_t v;
+    while (!atomic_load(&b->done)) {
+        uint64_t t0 = hostMonotonicNs();
+        if (b->use_mutex) {
+            pthread_mutex_lock(&b->lock);
+            v = b->locked;
+            pthread_mutex_unlock(&b->lock);
+        } else {
+            snapshotRead(&b->snap, &v);
+        }
+        r->read_ns += hostMonotonicNs() - t0;
+        r->reads++;
+        if (v.sweep != 0 && !consistent(&v)) r->torn++;
+    }
+    return NULL;
+}
+
+static uint64_t runBench(bool use_mutex, bool burst, int readers, uint32_t publishes) {
+    bench_t b = { .use_mutex = use_mutex, .burst = burst, .publishes = publishes };
+    atomic_init(&b.done, false);
+    snapshotInit(&b.snap);
+    pthread_mutex_init(&b.lock, NULL);
+
+    reader_t *r = calloc((size_t)readers, sizeof(*r));
+    pthread_t *tids = calloc((size_t)readers, sizeof(*tids));
+    for (int i = 0; i < readers; i++) {
+        r[i].bench = &b;
+        pthread_create(&tids[i], NULL, readerThread, &r[i]);
+    }
+    pthread_t writer;
+    pthread_create(&writer, NULL, writerThread, &b);
+    pthread_join(writer, NULL);
+
+    uint64_t reads = 0, read_ns = 0, torn = 0;
+    for (int i = 0; i < readers; i++) {
+        pthread_join(tids[i], NULL);
+        reads += r[i].reads;
+        read_ns += r[i].read_ns;
+        torn += r[i].torn;
+    }
+
+    printf("%-8s publish: %7.1f ns  read: %7.1f ns  reads: %10llu  torn: %llu\n",
+           use_mutex ? "mutex" : "seqlock", (double)b.write_ns / publishes,
+           reads ? (double)read_ns / reads : 0.0, (unsigned long long)reads, (unsigned long long)torn);
+
+    pthread_mutex_destroy(&b.lock);
+    free(r);
+    free(tids);
+    return torn;
+}
+
+int main(int argc, char **argv) {
+    int readers = (argc > 1) ? atoi(argv[1]) : 3;
+    bool burst = (argc > 3) && strcmp(argv[3], "--burst") == 0;
+    uint32_t publishes = (argc > 2) ? (uint32_t)strtoul(argv[2], NULL, 10) : (burst ? 2000000 : 2000);
+
+    if (burst) {
+        printf("readers: %d, publishes: %u back to back, payload: %zu bytes\n", readers, publishes, sizeof(sensor_values_t));
+    } else {
+        printf("readers: %d, publishes: %u, one per %u us, payload: %zu bytes\n", readers, publishes,
+               (unsigned)CHANNEL_SWEEP_US, sizeof(sensor_values_t));
+    }
+    uint64_t torn = runBench(false, burst, readers, publishes);
+    runBench(true, burst, readers, publishes);
+    return torn == 0 ? 0 : 1;
+}
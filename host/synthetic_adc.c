@@ -0,0 +1,106 @@
+#include <math.h>
+#include <string.h>
+#include <time.h>
+
+#include "esp_err.h"
+#include "synthetic_adc.h"
+
+/**
+ * @brief Returns the host monotonic clock in nanoseconds.
+ */
+uint64_t hostMonotonicNs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static uint32_t xorshift32(uint32_t *state) {
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return *state = x;
+}
+
+static esp_err_t syntheticStart(void *ctx) {
+    synthetic_adc_t *src = ctx;
+    src->running = true;
+    src->generated = 0;
+    src->start_ns = src->clock_ns();
+    return ESP_OK;
+}
+
+static esp_err_t syntheticStop(void *ctx) {
+    synthetic_adc_t *src = ctx;
+    src->running = false;
+    return ESP_OK;
+}
+
+static uint16_t syntheticSample(synthetic_adc_t *src, uint8_t ch, uint64_t n) {
+    float value = src->level[ch];
+    if (src->amplitude[ch] > 0 && src->period_samples > 0) {
+        value += src->amplitude[ch] * sinf(6.2831853f * (float)(n % src->period_samples) / (float)src->period_samples);
+    }
+    if (src->noise[ch] > 0) {
+        value += (float)(xorshift32(&src->rng) % (2u * src->noise[ch] + 1u)) - (float)src->noise[ch];
+    }
+    if (value < 0.0f) value = 0.0f;
+    if (value > 4095.0f) value = 4095.0f;
+    return (uint16_t)value;
+}
+
+static esp_err_t syntheticRead(void *ctx, uint8_t *buf, uint32_t len, uint32_t *out_len, uint32_t timeout_ms) {
+    synthetic_adc_t *src = ctx;
+    *out_len = 0;
+    if (!src->running) return ESP_ERR_INVALID_STATE;
+
+    uint32_t words = len / ADC_STREAM_RESULT_BYTES;
+    if (src->paced) {
+        uint64_t deadline = src->clock_ns() + (uint64_t)timeout_ms * 1000000ull;
+        for (;;) {
+            uint64_t now = src->clock_ns();
+            uint64_t due = (now - src->start_ns) * src->sample_freq_hz / 1000000000ull;
+            if (due >= src->generated + words) break;
+            if (now >= deadline) return ESP_ERR_TIMEOUT;
+            struct timespec nap = { 0, 100000 };
+            nanosleep(&nap, NULL);
+        }
+    }
+
+    for (uint32_t i = 0; i < words; i++) {
+        uint8_t ch = (uint8_t)(src->generated % ADC_STREAM_NUM_CHANNELS);
+        uint64_t n = src->generated / ADC_STREAM_NUM_CHANNELS;
+        uint32_t word = ADC_STREAM_WORD(src->unit, ch, syntheticSample(src, ch, n));
+        memcpy(&buf[i * ADC_STREAM_RESULT_BYTES], &word, sizeof(word));
+        src->generated++;
+    }
+    *out_len = words * ADC_STREAM_RESULT_BYTES;
+    return ESP_OK;
+}
+
+/**
+ * @brief Initializes a synthetic source with a mid-scale level on every channel.
+ */
+void syntheticAdcInit(synthetic_adc_t *src, uint32_t sample_freq_hz, bool paced) {
+    memset(src, 0, sizeof(*src));
+    src->sample_freq_hz = sample_freq_hz;
+    src->paced = paced;
+    src->clock_ns = hostMonotonicNs;
+    src->period_samples = 200;
+    src->rng = 0x12345678u;
+    for (int ch = 0; ch < ADC_STREAM_NUM_CHANNELS; ch++) {
+        src->level[ch] = 1000 + 250 * ch;
+        src->amplitude[ch] = 100;
+        src->noise[ch] = 4;
+    }
+}
+
+/**
+ * @brief Fills an ADC stream HAL that reads from the synthetic source.
+ */
+void syntheticAdcHal(synthetic_adc_t *src, adc_stream_hal_t *hal) {
+    hal->ctx = src;
+    hal->start = syntheticStart;
+    hal->stop = syntheticStop;
+    hal->read = syntheticRead;
+}
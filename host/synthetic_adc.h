@@ -0,0 +1,37 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "inc/adc_stream.h"
+
+/**
+ * @brief Synthetic continuous ADC source for host builds.
+ *
+ * Generates TYPE2 result words for a round-robin scan of every channel. Each
+ * channel is a DC level plus an optional sine and uniform noise, in raw
+ * 12-bit codes. When `paced` is set, reads are throttled to `sample_freq_hz`
+ * against `clock_ns` (the host monotonic clock unless replaced, e.g. by the
+ * firmware simulation's scaled clock); otherwise the source runs as fast as
+ * the consumer can drain it.
+ */
+typedef struct {
+    uint32_t sample_freq_hz;
+    bool paced;
+    uint64_t (*clock_ns)(void);
+    uint8_t unit;
+    uint16_t level[ADC_STREAM_NUM_CHANNELS];
+    uint16_t amplitude[ADC_STREAM_NUM_CHANNELS];
+    uint16_t noise[ADC_STREAM_NUM_CHANNELS];
+    uint32_t period_samples; // Sine period in conversions of the owning channel
+
+    // Generator state
+    uint64_t generated;
+    uint64_t start_ns;
+    uint32_t rng;
+    bool running;
+} synthetic_adc_t;
+
+void syntheticAdcInit(synthetic_adc_t *src, uint32_t sample_freq_hz, bool paced);
+void syntheticAdcHal(synthetic_adc_t *src, adc_stream_hal_t *hal);
+uint64_t hostMonotonicNs(void);
@@ -0,0 +1,61 @@
+#include <math.h>
+#include <string.h>
+
+#include "synthetic_edges.h"
+
+/**
+ * @brief Starts a signal held low, with no edges.
+ */
+void syntheticEdgesInit(synthetic_edges_t *sig) {
+    memset(sig, 0, sizeof(*sig));
+    sig->duty = 0.5;
+    sig->rise_before_ns = -1.0;
+    sig->fall_before_ns = -1.0;
+}
+
+static double phaseAt(const synthetic_edges_t *sig, uint64_t t_ns) {
+    return sig->phase0 + sig->hz * (double)(t_ns - sig->t0_ns) * 1e-9;
+}
+
+static double timeOfPhase(const synthetic_edges_t *sig, double phase) {
+    return (double)sig->t0_ns + (phase - sig->phase0) / sig->hz * 1e9;
+}
+
+/**
+ * @brief Changes frequency and duty from `t_ns` on, continuing the current period.
+ */
+void syntheticEdgesSet(synthetic_edges_t *sig, uint64_t t_ns, double hz, double duty) {
+    sig->rise_before_ns = syntheticEdgesLastRise(sig, t_ns);
+    sig->fall_before_ns = syntheticEdgesLastFall(sig, t_ns);
+    sig->phase0 = phaseAt(sig, t_ns);
+    sig->t0_ns = t_ns;
+    sig->hz = hz;
+    sig->duty = duty;
+}
+
+/**
+ * @brief Rising edges up to and including `t_ns`.
+ */
+uint64_t syntheticEdgesCount(const synthetic_edges_t *sig, uint64_t t_ns) {
+    double phase = phaseAt(sig, t_ns);
+    return phase < 1.0 ? 0 : (uint64_t)floor(phase);
+}
+
+/**
+ * @brief Time of the latest rising edge at or before `t_ns`, -1 if none.
+ */
+double syntheticEdgesLastRise(const synthetic_edges_t *sig, uint64_t t_ns) {
+    double k = floor(phaseAt(sig, t_ns));
+    if (sig->hz > 0.0 && k >= 1.0 && k > sig->phase0) return timeOfPhase(sig, k);
+    return sig->rise_before_ns;
+}
+
+/**
+ * @brief Time of the latest falling edge at or before `t_ns`, -1 if none.
+ */
+double syntheticEdgesLastFall(const synthetic_edges_t *sig, uint64_t t_ns) {
+    double phase = phaseAt(sig, t_ns);
+    double fall = floor(phase - sig->duty) + sig->duty;
+    if (sig->hz > 0.0 && fall >= 1.0 + sig->duty && fall > sig->phase0) return timeOfPhase(sig, fall);
+    return sig->fall_before_ns;
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <stdint.h>
+
+/**
+ * @brief Synthetic pulse train for the frequency inputs on the host.
+ *
+ * A square wave whose frequency and duty can be stepped at any time without
+ * a phase jump. Edges are computed, not generated, so a query costs the
+ * same at 1 Hz and at 10 MHz: rising edges fall on whole periods (the first
+ * one period after the signal starts) and falling edges `duty` of a period
+ * after each. A frequency of 0 holds the level of the last edge. Queries
+ * must not go back before the last syntheticEdgesSet().
+ */
+typedef struct {
+    double hz;
+    double duty;                // Share of each period high, strictly between 0 and 1
+    uint64_t t0_ns;             // Start of the current segment
+    double phase0;              // Periods completed at t0_ns
+    double rise_before_ns;      // Latest edges before t0_ns, -1 if none
+    double fall_before_ns;
+} synthetic_edges_t;
+
+void syntheticEdgesInit(synthetic_edges_t *sig);
+void syntheticEdgesSet(synthetic_edges_t *sig, uint64_t t_ns, double hz, double duty);
+uint64_t syntheticEdgesCount(const synthetic_edges_t *sig, uint64_t t_ns);
+double syntheticEdgesLastRise(const synthetic_edges_t *sig, uint64_t t_ns);
+double syntheticEdgesLastFall(const synthetic_edges_t *sig, uint64_t t_ns);
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+
+#define ADC_STREAM_NUM_CHANNELS 10
+#define ADC_STREAM_SAMPLE_FREQ_HZ 20000 // Total conversions per second across the whole scan pattern
+#define ADC_STREAM_SWEEP_SAMPLES 5      // Fresh samples required on every channel to complete a sweep
+#define ADC_STREAM_RING_DEPTH 32        // Per-channel history, must be a power of two
+#define ADC_STREAM_RESULT_BYTES 4       // SOC_ADC_DIGI_RESULT_BYTES on the ESP32-S3
+#define ADC_STREAM_FRAME_BYTES (ADC_STREAM_NUM_CHANNELS * ADC_STREAM_SWEEP_SAMPLES * ADC_STREAM_RESULT_BYTES)
+#define ADC_STREAM_STORE_FRAMES 4       // DMA frames held by the driver before it starts dropping
+
+// ESP32-S3 ADC_DIGI_OUTPUT_FORMAT_TYPE2 result word: data[11:0], channel[16:13], unit[17]
+#define ADC_STREAM_WORD_DATA(w)    ((uint16_t)((w) & 0x0FFF))
+#define ADC_STREAM_WORD_CHANNEL(w) ((uint8_t)(((w) >> 13) & 0x0F))
+#define ADC_STREAM_WORD_UNIT(w)    ((uint8_t)(((w) >> 17) & 0x01))
+#define ADC_STREAM_WORD(unit, ch, data) \
+    ((uint32_t)(((uint32_t)(unit) & 0x01) << 17 | ((uint32_t)(ch) & 0x0F) << 13 | ((uint32_t)(data) & 0x0FFF)))
+
+#if (ADC_STREAM_RING_DEPTH & (ADC_STREAM_RING_DEPTH - 1)) != 0
+#error "ADC_STREAM_RING_DEPTH must be a power of two"
+#endif
+
+/**
+ * @brief Hardware abstraction for a continuous (DMA) ADC source.
+ *
+ * On target this wraps the ESP-IDF adc_continuous driver; on the host it is
+ * backed by a synthetic sample generator. `read` must deliver whole result
+ * words in the TYPE2 layout described above.
+ */
+typedef struct {
+    void *ctx;
+    esp_err_t (*start)(void *ctx);
+    esp_err_t (*stop)(void *ctx);
+    esp_err_t (*read)(void *ctx, uint8_t *buf, uint32_t len, uint32_t *out_len, uint32_t timeout_ms);
+} adc_stream_hal_t;
+
+typedef struct {
+    uint64_t samples;    // Result words demultiplexed into a channel ring
+    uint64_t frames;     // Successful HAL reads
+    uint32_t sweeps;     // Completed sweeps (every channel refreshed)
+    uint32_t discarded;  // Words for an unknown unit/channel
+    uint32_t timeouts;   // HAL reads that returned no data
+} adc_stream_stats_t;
+
+typedef struct {
+    const adc_stream_hal_t *hal;
+    uint8_t frame[ADC_STREAM_FRAME_BYTES];
+    uint16_t ring[ADC_STREAM_NUM_CHANNELS][ADC_STREAM_RING_DEPTH];
+    uint8_t head[ADC_STREAM_NUM_CHANNELS];
+    uint8_t fresh[ADC_STREAM_NUM_CHANNELS];
+    uint8_t unit;
+    adc_stream_stats_t stats;
+} adc_stream_t;
+
+esp_err_t adcStreamInit(adc_stream_t *stream, const adc_stream_hal_t *hal, uint8_t unit);
+esp_err_t adcStreamStart(adc_stream_t *stream);
+esp_err_t adcStreamStop(adc_stream_t *stream);
+esp_err_t adcStreamPoll(adc_stream_t *stream, uint32_t timeout_ms);
+void adcStreamDemux(adc_stream_t *stream, const uint8_t *buf, uint32_t len);
+bool adcStreamSweepReady(const adc_stream_t *stream);
+void adcStreamSweepConsume(adc_stream_t *stream);
+uint8_t adcStreamFresh(const adc_stream_t *stream, int channel);
+size_t adcStreamLatest(const adc_stream_t *stream, int channel, uint16_t *out, size_t count);
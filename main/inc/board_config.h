@@ -0,0 +1,162 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+#include "inc/can_rx.h"
+#include "inc/can_sched.h"
+#include "inc/channels.h"
+
+#define BOARD_CONFIG_MAGIC 0x46434243u  // "CBCF", little-endian
+#define BOARD_CONFIG_VERSION 7          // Bump whenever board_config_t or the blob header change layout
+#define BOARD_CONFIG_HEADER_BYTES 16
+#define BOARD_CONFIG_BLOB_BYTES (BOARD_CONFIG_HEADER_BYTES + sizeof(board_config_t))
+#define BOARD_CONFIG_REPLY 0x80         // Set in configCommand of a response
+
+/**
+ * @brief Commands carried in configCommand of boardConfigRequest (see the DBC).
+ */
+typedef enum {
+    BOARD_CONFIG_CMD_READ = 1,      // Value of configParam[configIndex]
+    BOARD_CONFIG_CMD_WRITE,         // Validate and apply configValue, in RAM only
+    BOARD_CONFIG_CMD_SAVE,          // Persist the values in use
+    BOARD_CONFIG_CMD_DEFAULTS,      // Return every value to the firmware defaults, in RAM only
+    BOARD_CONFIG_CMD_STATUS,        // configValue = CRC of the values in use, configIndex = BOARD_CONFIG_FLAG_* bits
+} board_config_cmd_t;
+
+typedef enum {
+    BOARD_CONFIG_OK = 0,
+    BOARD_CONFIG_UNKNOWN_PARAM,
+    BOARD_CONFIG_BAD_INDEX,
+    BOARD_CONFIG_OUT_OF_RANGE,
+    BOARD_CONFIG_INCONSISTENT,      // In range, but contradicts another value (e.g. v_min_mv >= v_max_mv)
+    BOARD_CONFIG_STORAGE_FAILED,
+    BOARD_CONFIG_BAD_COMMAND,
+} board_config_status_t;
+
+#define BOARD_CONFIG_FLAG_LOADED 0x01   // The values at boot came from storage
+#define BOARD_CONFIG_FLAG_DIRTY 0x02    // The values in use differ from storage
+#define BOARD_CONFIG_FLAG_REBOOT 0x04   // A changed value only takes effect after a reboot
+
+/**
+ * @brief Wire identifiers of the parameters. Never renumber: tools address parameters by these.
+ */
+typedef enum {
+    BOARD_PARAM_CAN_BASE_ID = 1,
+    BOARD_PARAM_TX_PERIOD,
+    BOARD_PARAM_DIVIDER,
+    BOARD_PARAM_FILTER_DEPTH,
+    BOARD_PARAM_DEADBAND,
+    BOARD_PARAM_V_MIN,
+    BOARD_PARAM_V_MAX,
+    BOARD_PARAM_OUT_MIN,
+    BOARD_PARAM_OUT_MAX,
+} board_param_id_t;
+
+typedef enum {
+    BOARD_PARAM_U8,
+    BOARD_PARAM_U16,
+    BOARD_PARAM_I16,
+    BOARD_PARAM_I32,
+} board_param_type_t;
+
+typedef enum {
+    BOARD_PARAM_SCALAR,
+    BOARD_PARAM_PER_MESSAGE,        // Indexed by entry in the active CAN message table
+    BOARD_PARAM_PER_CHANNEL,        // Indexed by ADC channel
+} board_param_scope_t;
+
+/**
+ * @brief Runtime settings of one analog input, overriding its channel_table entry.
+ *
+ * Filter depth applies to CHANNEL_FILTER_MEDIAN channels, the span and
+ * outputs to CHANNEL_CONVERT_LINEAR ones; on other channels they are kept
+ * but have no effect.
+ */
+typedef struct {
+    uint16_t divider_x1000;
+    uint8_t filter_depth;
+    uint16_t deadband_mv;
+    int16_t v_min_mv;
+    int16_t v_max_mv;
+    int32_t out_min_x100;
+    int32_t out_max_x100;
+} board_channel_config_t;
+
+/**
+ * @brief Every runtime setting, stored in NVS as one blob.
+ */
+typedef struct {
+    uint16_t can_base_id;                               // ID of the first broadcast frame, 0x620 in the DBC
+    uint16_t tx_period_ms[CAN_SCHED_MAX_MESSAGES];
+    board_channel_config_t channels[SNAPSHOT_NUM_CHANNELS];
+} board_config_t;
+
+/**
+ * @brief One entry of the parameter table: where a value lives and what it may hold.
+ */
+typedef struct {
+    uint8_t id;                     // board_param_id_t
+    const char *name;
+    board_param_type_t type;
+    board_param_scope_t scope;
+    uint16_t offset;                // Of the value, or of the first element's value, in board_config_t
+    int32_t min;
+    int32_t max;
+    bool reboot;                    // Only read at boot
+} board_param_t;
+
+/**
+ * @brief Persistent storage for the config blob, so the store runs against NVS or a file.
+ */
+typedef struct {
+    void *ctx;
+    esp_err_t (*load)(void *ctx, void *buf, size_t *len);   // ESP_ERR_NOT_FOUND if nothing saved, *len is the buffer size in, blob size out
+    esp_err_t (*save)(void *ctx, const void *buf, size_t len);  // Must replace the old blob atomically
+} board_config_storage_t;
+
+/**
+ * @brief Values in use, their defaults and their persistence.
+ *
+ * Not thread-safe: callers share one lock around requests and reads.
+ */
+typedef struct {
+    board_config_t active;
+    board_config_t defaults;
+    board_config_t boot;            // Values at boot, still in effect for reboot-only parameters
+    const board_config_storage_t *storage;
+    size_t channel_count;
+    size_t message_count;
+    uint16_t message_id_span;       // Highest message ID above CAN_BASEID in the message table
+    uint32_t table_id;              // CRC of the message count and IDs, which per-message values are indexed by
+    const can_rx_sub_t *rx_subs;    // Received IDs the broadcast span must stay clear of
+    size_t rx_count;
+    uint32_t saved_crc;             // CRC of the values the next boot will load, 0 if storage holds an unusable blob
+    esp_err_t load_err;             // Why the boot values are the defaults, ESP_OK if they were loaded
+    uint32_t generation;            // Incremented on every change to `active`
+} board_config_store_t;
+
+extern const board_param_t board_params[];
+extern const size_t board_params_count;
+
+void boardConfigDefaults(board_config_t *cfg, const channel_desc_t *channels, size_t channel_count,
+                         const can_message_def_t *messages, size_t message_count);
+esp_err_t boardConfigInit(board_config_store_t *store, const board_config_t *defaults, size_t channel_count,
+                          const can_message_def_t *messages, size_t message_count, const can_rx_sub_t *rx_subs, size_t rx_count,
+                          const board_config_storage_t *storage);
+board_config_status_t boardConfigValidate(const board_config_store_t *store, const board_config_t *cfg);
+board_config_status_t boardConfigGet(const board_config_store_t *store, uint8_t id, uint8_t index, int32_t *value);
+board_config_status_t boardConfigSet(board_config_store_t *store, uint8_t id, uint8_t index, int32_t value);
+board_config_status_t boardConfigSave(board_config_store_t *store);
+void boardConfigRestoreDefaults(board_config_store_t *store);
+uint8_t boardConfigFlags(const board_config_store_t *store);
+void boardConfigEffective(const board_config_store_t *store, board_config_t *cfg);
+uint32_t boardConfigCrc(const board_config_t *cfg);
+bool boardConfigHandleRequest(board_config_store_t *store, const can_frame_t *request, can_frame_t *response);
+const board_param_t *boardParamFind(uint8_t id);
+size_t boardParamCount(const board_config_store_t *store, const board_param_t *param);
+void boardConfigApplyChannels(const board_config_t *cfg, const channel_desc_t *base, channel_desc_t *out, size_t count);
+void boardConfigApplyMessages(const board_config_t *cfg, const can_message_def_t *base, can_message_def_t *out, size_t count);
+const char *boardConfigStatusName(board_config_status_t status);
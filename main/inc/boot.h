@@ -0,0 +1,57 @@
+#pragma once
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief Steps of the boot sequence, in microseconds since the application started.
+ *
+ * Init steps have a start and an end; milestones only an end. Steps on
+ * different cores overlap, so the durations do not add up to the total.
+ */
+typedef enum {
+    BOOT_STEP_CONFIG,           // NVS and runtime configuration (app_main, core 0)
+    BOOT_STEP_CAN,              // RX filter, TWAI driver and TX stage (app_main, core 0)
+    BOOT_STEP_CPU_TEMP,         // On-die temperature sensor (core 1)
+    BOOT_STEP_ADC,              // DMA scan pattern and calibration (core 1)
+    BOOT_STEP_SENSOR_TABLES,    // NTC lookups and channel pipeline (core 1)
+    BOOT_STEP_CAPTURE,          // Pulse counters and capture timers of the frequency inputs (core 1)
+    BOOT_STEP_CAN_LOG,          // canlog partition scan (canLogger), off the path to the first frame
+    BOOT_STEP_FIRST_FRAME,      // First frame queued, the board status frame while still booting
+    BOOT_STEP_FIRST_SWEEP,      // First sweep published
+    BOOT_STEP_ALL_VALID,        // First sweep with every input valid
+    BOOT_STEP_VALID_FRAME,      // First frame packed from a sweep with every input valid
+    BOOT_STEP_COUNT
+} boot_step_t;
+
+/**
+ * @brief When each step started and ended, each recorded once by the task running it.
+ *
+ * A zero time means not yet; recorded times are at least 1 us.
+ */
+typedef struct {
+    atomic_uint_least32_t start_us[BOOT_STEP_COUNT];
+    atomic_uint_least32_t end_us[BOOT_STEP_COUNT];
+} boot_timeline_t;
+
+extern boot_timeline_t boot_timeline;
+
+void bootStart(boot_timeline_t *tl, boot_step_t step, int64_t now_us);
+void bootEnd(boot_timeline_t *tl, boot_step_t step, int64_t now_us);
+uint32_t bootStartUs(const boot_timeline_t *tl, boot_step_t step);
+uint32_t bootEndUs(const boot_timeline_t *tl, boot_step_t step);
+const char *bootStepName(boot_step_t step);
+
+/**
+ * @brief Returns true once a step has ended.
+ */
+static inline bool bootReached(const boot_timeline_t *tl, boot_step_t step) {
+    return step < BOOT_STEP_COUNT && atomic_load_explicit(&tl->end_us[step], memory_order_acquire) != 0;
+}
+
+// Recording points, on esp_timer time. Only the first start and end of a
+// step count, and once recorded a milestone costs one atomic load, so it
+// can be marked from a hot loop.
+#define BOOT_START(step) bootStart(&boot_timeline, (step), esp_timer_get_time())
+#define BOOT_END(step) do { if (!bootReached(&boot_timeline, (step))) bootEnd(&boot_timeline, (step), esp_timer_get_time()); } while (0)
@@ -2,18 +2,57 @@
 
 #include "driver/gpio.h"
 #include "driver/twai.h"
+#include "inc/can_log.h"
+#include "inc/can_rx.h"
+#include "inc/can_sched.h"
+#include "inc/can_tx.h"
+#include "inc/diag.h"
 
 #define DRIVECAN_TX_GPIO_NUM       GPIO_NUM_12
 #define DRIVECAN_RX_GPIO_NUM       GPIO_NUM_11
 
-#define CAN_BASEID 0x620
+#define CAN_LOG_PARTITION_LABEL    "canlog"
+#define CAN_LOG_STALL_MS           96    // Longest the logger is held up by flash (can_log_bench's worst backlog)
+#define CAN_FLASH_ERASE_MS         45    // One 4 KiB sector erase, during which flash code stalls on both cores
+#define CAN_RX_STALL_MS            (CAN_FLASH_ERASE_MS + 3 * CAN_SCHED_TICK_MS) // An NVS commit on the receive task or a logger erase, plus scheduling
+#define CAN_LOG_STATS_INTERVAL_MS  10000
+#define DIAG_DUMP_INTERVAL_MS      5000
+#define CAN_SUPERVISOR_POLL_MS     100   // Error counters are sampled at least this often
+#define CAN_SUPERVISOR_ALERTS      (TWAI_ALERT_BUS_OFF | TWAI_ALERT_BUS_RECOVERED | TWAI_ALERT_ERR_PASS | TWAI_ALERT_ERR_ACTIVE)
+
+// Queue lengths, sized at compile time from the bitrate and the TX stage
+#define CAN_MIN_FRAME_BITS         47    // Standard frame with no data and no stuff bits, interframe space included
+#define CAN_FRAMES_IN_MS(ms)       (((uint32_t)CONFIG_CANBOARD_CAN_BITRATE / CAN_MIN_FRAME_BITS * (ms) + 999u) / 1000u) // Most the bus can carry
+#define CAN_LOG_QUEUE_LEN          CAN_FRAMES_IN_MS(CAN_LOG_STALL_MS) // Received frames buffered while the logger waits on flash
+#define CAN_RX_QUEUE_LEN           CAN_FRAMES_IN_MS(CAN_RX_STALL_MS)  // TWAI driver RX queue
+#define CAN_TX_QUEUE_LEN           CAN_TX_INFLIGHT_ACTIVE             // TWAI driver TX queue: the TX stage never hands it more
+
+#if CONFIG_CANBOARD_CAN_BITRATE == 250000
+#define CAN_TIMING_CONFIG()        TWAI_TIMING_CONFIG_250KBITS()
+#elif CONFIG_CANBOARD_CAN_BITRATE == 1000000
+#define CAN_TIMING_CONFIG()        TWAI_TIMING_CONFIG_1MBITS()
+#else
+#define CAN_TIMING_CONFIG()        TWAI_TIMING_CONFIG_500KBITS()
+#endif
+
 
 extern twai_handle_t twai_can;
 
 static const char* can_log = "can";
+static const char* diag_log = "diag";
 
 extern twai_timing_config_t t_can_config;
 extern twai_filter_config_t f_config;
 extern twai_general_config_t can_config; 
 
+esp_err_t initCanRx(void);
+esp_err_t initCanLog(void);
+esp_err_t initCanTx(void);
+esp_err_t canSendFrame(const can_frame_t *frame);
 void canTransmit(void *arg);
+void canSupervisor(void *arg);
+void canReceive(void *arg);
+void canLogger(void *arg);
+#if CONFIG_CANBOARD_DIAG
+void diagDump(void *arg);
+#endif
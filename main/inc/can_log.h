@@ -0,0 +1,117 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+
+#define CAN_LOG_SEGMENT_BYTES 65536     // Erase/append unit, one flash block so it can be block-erased
+#define CAN_LOG_SECTOR_BYTES 4096       // Smallest erasable unit, the erase-ahead step
+#define CAN_LOG_BLOCK_BYTES 1024        // Records are batched and written (and checksummed) in blocks of at most this size
+#define CAN_LOG_FLUSH_MS 100            // Longest a record may sit in RAM, bounds what a power cut can lose
+#define CAN_LOG_SEGMENT_MAGIC 0x474C4E43u // "CNLG"
+#define CAN_LOG_VERSION 1
+
+#define CAN_LOG_SEGMENT_HEADER_BYTES 16
+#define CAN_LOG_BLOCK_HEADER_BYTES 16
+#define CAN_LOG_RECORD_MAX_BYTES 17     // Flags, 4-byte time delta, 4-byte ID and 8 data bytes
+
+#define CAN_LOG_FLAG_EXTENDED 0x01
+#define CAN_LOG_FLAG_RTR 0x02
+
+#if (CAN_LOG_SEGMENT_BYTES % CAN_LOG_SECTOR_BYTES) != 0
+#error "CAN_LOG_SEGMENT_BYTES must be a whole number of sectors"
+#endif
+
+/**
+ * @brief NOR flash region the log is written to.
+ *
+ * On target this wraps an esp_partition; on the host it is backed by a file.
+ * Writes may only clear bits, so every byte is written once between erases.
+ * `size` must be a multiple of CAN_LOG_SEGMENT_BYTES and `erase` is only ever
+ * called on whole, aligned sectors.
+ */
+typedef struct {
+    void *ctx;
+    uint32_t size;
+    esp_err_t (*read)(void *ctx, uint32_t offset, void *buf, uint32_t len);
+    esp_err_t (*write)(void *ctx, uint32_t offset, const void *buf, uint32_t len);
+    esp_err_t (*erase)(void *ctx, uint32_t offset, uint32_t len);
+} can_log_flash_t;
+
+/**
+ * @brief One logged frame, as passed in by the receive path and returned by the reader.
+ */
+typedef struct {
+    uint64_t timestamp_us;
+    uint32_t id;
+    uint8_t dlc;
+    uint8_t flags;          // CAN_LOG_FLAG_*
+    uint8_t data[8];
+} can_log_record_t;
+
+typedef struct {
+    uint64_t records;       // Frames accepted by canLogAppend()
+    uint64_t bytes;         // Bytes written to flash, headers included
+    uint32_t blocks;        // Blocks written
+    uint32_t segments;      // Segments opened
+    uint32_t sectors_erased;
+    uint32_t write_errors;  // Failed flash reads, writes or erases
+} can_log_stats_t;
+
+/**
+ * @brief Append-only writer over a ring of flash segments.
+ *
+ * Each segment starts with a header carrying a sequence number that grows
+ * by one per segment, so after a reset the newest segment is the one with
+ * the highest sequence. Records are batched into blocks, each with its own
+ * base timestamp and CRC; a block cut short by power loss fails its CRC and
+ * ends the readable log there. Segments are used round-robin so erases
+ * spread evenly, and the next segment is erased one sector at a time,
+ * keeping pace with the current one, so opening it never stalls on a
+ * full erase.
+ */
+typedef struct {
+    const can_log_flash_t *flash;
+    uint32_t segment_count;
+    uint32_t segment;           // Index of the segment being appended to
+    uint32_t seq;               // Its sequence number
+    uint32_t write_offset;      // Offset within the segment of the next block
+    uint32_t erased_ahead;      // Bytes of the next segment already erased
+
+    uint8_t block[CAN_LOG_BLOCK_BYTES];
+    uint16_t block_len;         // Bytes used, header included
+    uint16_t block_records;
+    uint64_t block_base_us;     // Timestamp of the first record in the block
+    uint64_t last_us;           // Timestamp of the previous record in the block
+
+    can_log_stats_t stats;
+} can_log_t;
+
+/**
+ * @brief Sequential reader, oldest record first.
+ */
+typedef struct {
+    const can_log_flash_t *flash;
+    uint32_t segment_count;
+    uint32_t segment;
+    uint32_t seq;
+    uint32_t segments_left;     // Segments still to visit, the current one included
+    uint32_t block_offset;      // Offset within the segment of the next block
+    uint8_t block[CAN_LOG_BLOCK_BYTES];
+    uint16_t block_len;
+    uint16_t pos;               // Read position within `block`
+    uint16_t records_left;
+    uint64_t last_us;
+} can_log_reader_t;
+
+esp_err_t canLogMount(can_log_t *log, const can_log_flash_t *flash);
+esp_err_t canLogAppend(can_log_t *log, const can_log_record_t *record);
+esp_err_t canLogFlush(can_log_t *log);
+bool canLogFlushDue(const can_log_t *log, uint64_t now_us);
+
+esp_err_t canLogReaderOpen(can_log_reader_t *reader, const can_log_flash_t *flash);
+esp_err_t canLogReaderNext(can_log_reader_t *reader, can_log_record_t *record);
+
+uint32_t canLogCrc32(uint32_t crc, const uint8_t *data, size_t len);
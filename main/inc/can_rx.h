@@ -0,0 +1,85 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+#include "inc/can_sched.h"
+
+#define CAN_RX_STD_IDS 2048             // 11-bit identifier space, indexed directly
+#define CAN_RX_MAX_SUBSCRIPTIONS 64
+#define CAN_RX_EXHAUSTIVE_MAX 16        // Largest subscription set whose dual filter split is searched exhaustively
+#define CAN_RX_NO_HANDLER 0xFF
+
+// ECUMaster EMU Black CAN stream (EMU default base ID)
+#define EMU_STREAM_BASEID 0x600
+
+typedef void (*can_rx_handler_fn_t)(void *ctx, const can_frame_t *frame);
+
+/**
+ * @brief One subscribed standard identifier and the handler that consumes it.
+ */
+typedef struct {
+    uint32_t id;
+    can_rx_handler_fn_t handler;
+    void *ctx;
+} can_rx_sub_t;
+
+/**
+ * @brief TWAI acceptance filter, in the driver's twai_filter_config_t layout.
+ *
+ * Mask bits set to 1 are "don't care". In single filter mode the code/mask
+ * cover ID[31:21], RTR[20] and both data bytes; in dual filter mode filter 1
+ * covers ID[31:21] and filter 2 ID[15:5]. `accepted_ids` is how many of
+ * the 2048 standard IDs the hardware will let through.
+ */
+typedef struct {
+    bool dual;
+    uint32_t acceptance_code;
+    uint32_t acceptance_mask;
+    uint32_t accepted_ids;
+} can_rx_filter_t;
+
+typedef struct {
+    uint64_t frames;        // Frames offered to canRxDispatch()
+    uint64_t dispatched;    // Frames handed to a handler
+    uint64_t unsubscribed;  // Standard frames that passed the hardware filter but have no handler
+    uint64_t extended;      // Extended frames, never subscribed
+} can_rx_stats_t;
+
+/**
+ * @brief Receive dispatcher: a direct 2048-entry map from standard ID to subscription.
+ */
+typedef struct {
+    const can_rx_sub_t *subs;
+    size_t count;
+    uint8_t index[CAN_RX_STD_IDS];  // Subscription index, CAN_RX_NO_HANDLER if none
+    can_rx_stats_t stats;
+} can_rx_t;
+
+/**
+ * @brief Latest values decoded from the ECU stream.
+ *
+ * Written only by the CAN receive task. Each field is naturally aligned and
+ * stored in one write, so readers see whole values, but fields may come from
+ * different frames.
+ */
+typedef struct {
+    uint16_t rpm;
+    uint16_t map_kpa;
+    uint8_t tps_half_pct;   // 0.5 %/bit
+    int8_t iat_c;
+    int16_t clt_c;
+    uint8_t lambda_q7;      // 1/128 per bit
+    uint32_t frames;        // ECU frames consumed
+} ecu_values_t;
+
+extern const can_rx_sub_t can_rx_table[];
+extern const size_t can_rx_table_count;
+extern volatile ecu_values_t ecu_values;
+
+esp_err_t canRxInit(can_rx_t *rx, const can_rx_sub_t *subs, size_t count);
+bool canRxDispatch(can_rx_t *rx, const can_frame_t *frame, bool extended);
+esp_err_t canRxComputeFilter(const can_rx_sub_t *subs, size_t count, can_rx_filter_t *filter);
+bool canRxFilterAccepts(const can_rx_filter_t *filter, uint32_t id, bool extended);
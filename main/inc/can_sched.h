@@ -0,0 +1,107 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+#include "inc/snapshot.h"
+
+#define CAN_BASEID 0x620
+#define CAN_SCHED_MAX_MESSAGES 16
+#define CAN_SCHED_TICK_MS 2 // One FreeRTOS tick at CONFIG_FREERTOS_HZ=500
+#define CAN_SCHED_CHANNEL(ch) (1u << (ch))
+
+/**
+ * @brief Hardware-independent CAN frame, converted to twai_message_t at the driver edge.
+ */
+typedef struct {
+    uint32_t id;
+    uint8_t dlc;
+    uint8_t data[8];
+} can_frame_t;
+
+/**
+ * @brief What a packer that rotates through pages, metrics or tasks carries from one frame to the next.
+ *
+ * Held in the message's scheduler entry and zeroed by canSchedInit(), so
+ * every scheduler starts each rotation afresh and none share one.
+ */
+typedef struct {
+    uint8_t next;               // Next page, metric or task in the rotation
+    uint32_t frames;            // Frames packed so far
+    uint32_t page_sweep[2];     // Sweep each input page last carried, packed voltages only
+} can_pack_state_t;
+
+typedef void (*can_pack_fn_t)(const sensor_values_t *values, uint8_t *data, can_pack_state_t *state);
+
+/**
+ * @brief Static description of one periodic message.
+ *
+ * `offset_ms` staggers messages with the same period so they do not all
+ * become due on the same tick. With on-change sends enabled, a message
+ * whose `channels` have changed goes out as soon as `min_interval_ms` has
+ * passed since its last frame, and `period_ms` becomes its heartbeat.
+ */
+typedef struct {
+    uint32_t id;
+    uint16_t period_ms;
+    uint16_t offset_ms;
+    uint8_t dlc;
+    can_pack_fn_t pack;
+    uint32_t channels;          // ADC channels packed into the frame, bit n for channel n
+    uint16_t min_interval_ms;   // Earliest resend after a change, 0 to send on the periodic grid only
+} can_message_def_t;
+
+typedef struct {
+    const can_message_def_t *def;
+    uint32_t next_due_ms;
+    uint32_t last_sent_ms;
+    uint32_t packed_sweep;  // Sweep carried by the last frame attempted
+    uint32_t sent;
+    uint32_t early;     // Of `sent`, frames sent ahead of their slot because their channels changed
+    uint32_t dropped;   // Due but the TX queue was full
+    uint32_t resyncs;   // Fell more than a period behind and skipped ahead
+    uint32_t held;      // Runs skipped because a packed channel was not yet valid
+    can_pack_state_t pack_state;
+} can_sched_entry_t;
+
+/**
+ * @brief Non-blocking transmit hook. Must return ESP_ERR_TIMEOUT rather than
+ *        wait when the TX queue is full.
+ */
+typedef esp_err_t (*can_sched_tx_fn_t)(void *ctx, const can_frame_t *frame);
+
+typedef struct {
+    can_sched_entry_t entries[CAN_SCHED_MAX_MESSAGES];
+    size_t count;
+    can_sched_tx_fn_t transmit;
+    void *ctx;
+    bool on_change;     // Send messages early when their channels change, see canSchedSetOnChange()
+} can_sched_t;
+
+/**
+ * @brief Bus utilisation of a message table, from worst-case stuffed frame lengths.
+ */
+typedef struct {
+    uint32_t frames_per_s;      // At the nominal periods
+    uint32_t bits_per_s;
+    uint32_t peak_frames_per_s; // With every on-change message sent at its min_interval_ms
+    uint32_t peak_bits_per_s;
+    float load;                 // bits_per_s / bitrate, 1.0 is a saturated bus
+    float peak_load;
+} can_bus_load_t;
+
+extern const can_message_def_t can_messages_wide[];     // 16-bit signals, 0x620-0x624
+extern const size_t can_messages_wide_count;
+extern const can_message_def_t can_messages_packed[];   // 12-bit and scaled signals, 0x626-0x627
+extern const size_t can_messages_packed_count;
+extern const can_message_def_t *const can_messages;     // The table selected by CONFIG_CANBOARD_CAN_PACKED
+extern const size_t can_messages_count;
+
+esp_err_t canSchedInit(can_sched_t *sched, const can_message_def_t *table, size_t count, uint32_t now_ms,
+                       can_sched_tx_fn_t transmit, void *ctx);
+void canSchedSetOnChange(can_sched_t *sched, bool enable);
+uint32_t canSchedRun(can_sched_t *sched, uint32_t now_ms, const sensor_values_t *values);
+uint32_t canFrameBits(uint8_t dlc, bool extended);
+can_bus_load_t canSchedBusLoad(const can_message_def_t *table, size_t count, uint32_t bitrate);
@@ -0,0 +1,549 @@
+// Generated by dbc/dbc2c.py from esp32-canboard.dbc - do not edit.
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define ANALOG_VOLTAGE_1_ID 0x620u
+#define ANALOG_VOLTAGE_1_DLC 8
+#define ANALOG_VOLTAGE_2_ID 0x621u
+#define ANALOG_VOLTAGE_2_DLC 8
+#define ANALOG_VOLTAGE_3_ID 0x622u
+#define ANALOG_VOLTAGE_3_DLC 8
+#define SENSOR_VALUES_1_ID 0x623u
+#define SENSOR_VALUES_1_DLC 8
+#define SENSOR_VALUES_2_ID 0x624u
+#define SENSOR_VALUES_2_DLC 8
+#define DIAGNOSTICS_ID 0x625u
+#define DIAGNOSTICS_DLC 8
+#define PACKED_VOLTAGES_ID 0x626u
+#define PACKED_VOLTAGES_DLC 8
+#define PACKED_SENSORS_ID 0x627u
+#define PACKED_SENSORS_DLC 8
+#define BOARD_STATUS_ID 0x628u
+#define BOARD_STATUS_DLC 8
+#define SENSOR_STATUS_ID 0x629u
+#define SENSOR_STATUS_DLC 4
+#define DERIVED_VALUES_ID 0x62Au
+#define DERIVED_VALUES_DLC 8
+#define TASK_LOAD_ID 0x62Bu
+#define TASK_LOAD_DLC 8
+#define SYSTEM_LOAD_ID 0x62Cu
+#define SYSTEM_LOAD_DLC 8
+#define CAPTURE_VALUES_ID 0x62Du
+#define CAPTURE_VALUES_DLC 8
+#define BOARD_CONFIG_REQUEST_ID 0x62Eu
+#define BOARD_CONFIG_REQUEST_DLC 8
+#define BOARD_CONFIG_RESPONSE_ID 0x62Fu
+#define BOARD_CONFIG_RESPONSE_DLC 8
+
+typedef struct {
+    const char *name;
+    uint16_t start;
+    uint8_t length;
+    bool is_signed;
+    float factor;
+    float offset;
+    const char *unit;
+    int8_t mux;             // Multiplexor value the signal is present for, -1 if always present
+} can_signal_def_t;
+
+typedef struct {
+    uint32_t id;
+    const char *name;
+    uint8_t dlc;
+    uint8_t signal_count;
+    const can_signal_def_t *signals;
+    int8_t mux_signal;      // Index of the multiplexor signal, -1 if the message is not multiplexed
+} can_message_schema_t;
+
+extern const can_message_schema_t can_schema[];
+extern const size_t can_schema_count;
+
+const can_message_schema_t *canSchemaFind(uint32_t id);
+int32_t canSignalRaw(const can_signal_def_t *sig, const uint8_t *data);
+float canSignalPhysical(const can_signal_def_t *sig, const uint8_t *data);
+bool canSignalPresent(const can_message_schema_t *msg, const can_signal_def_t *sig, const uint8_t *data);
+
+typedef struct {
+    int8_t cpuTemperature; // 8 bit, x1 C
+    uint16_t input1_voltage; // 16 bit, x0.001 V
+    uint16_t input2_voltage; // 16 bit, x0.001 V
+    uint16_t input3_voltage; // 16 bit, x0.001 V
+} analogVoltage_1_t;
+
+static inline void analogVoltage_1_pack(const analogVoltage_1_t *m, uint8_t *data) {
+    data[0] = (uint8_t)(((uint32_t)m->cpuTemperature & 0xFFu));
+    data[1] = (uint8_t)(0u);
+    data[2] = (uint8_t)(((uint32_t)m->input1_voltage & 0xFFu));
+    data[3] = (uint8_t)((((uint32_t)m->input1_voltage >> 8) & 0xFFu));
+    data[4] = (uint8_t)(((uint32_t)m->input2_voltage & 0xFFu));
+    data[5] = (uint8_t)((((uint32_t)m->input2_voltage >> 8) & 0xFFu));
+    data[6] = (uint8_t)(((uint32_t)m->input3_voltage & 0xFFu));
+    data[7] = (uint8_t)((((uint32_t)m->input3_voltage >> 8) & 0xFFu));
+}
+
+static inline void analogVoltage_1_unpack(analogVoltage_1_t *m, const uint8_t *data) {
+    m->cpuTemperature = (int8_t)((int32_t)(((uint32_t)(data[0] & 0xFFu)) << 24) >> 24);
+    m->input1_voltage = (uint16_t)((uint32_t)(data[2] & 0xFFu) | ((uint32_t)(data[3] & 0xFFu) << 8));
+    m->input2_voltage = (uint16_t)((uint32_t)(data[4] & 0xFFu) | ((uint32_t)(data[5] & 0xFFu) << 8));
+    m->input3_voltage = (uint16_t)((uint32_t)(data[6] & 0xFFu) | ((uint32_t)(data[7] & 0xFFu) << 8));
+}
+
+typedef struct {
+    uint16_t input4_voltage; // 16 bit, x0.001 V
+    uint16_t input5_voltage; // 16 bit, x0.001 V
+    uint16_t input6_voltage; // 16 bit, x0.001 V
+    uint16_t input7_voltage; // 16 bit, x0.001 V
+} analogVoltage_2_t;
+
+static inline void analogVoltage_2_pack(const analogVoltage_2_t *m, uint8_t *data) {
+    data[0] = (uint8_t)(((uint32_t)m->input4_voltage & 0xFFu));
+    data[1] = (uint8_t)((((uint32_t)m->input4_voltage >> 8) & 0xFFu));
+    data[2] = (uint8_t)(((uint32_t)m->input5_voltage & 0xFFu));
+    data[3] = (uint8_t)((((uint32_t)m->input5_voltage >> 8) & 0xFFu));
+    data[4] = (uint8_t)(((uint32_t)m->input6_voltage & 0xFFu));
+    data[5] = (uint8_t)((((uint32_t)m->input6_voltage >> 8) & 0xFFu));
+    data[6] = (uint8_t)(((uint32_t)m->input7_voltage & 0xFFu));
+    data[7] = (uint8_t)((((uint32_t)m->input7_voltage >> 8) & 0xFFu));
+}
+
+static inline void analogVoltage_2_unpack(analogVoltage_2_t *m, const uint8_t *data) {
+    m->input4_voltage = (uint16_t)((uint32_t)(data[0] & 0xFFu) | ((uint32_t)(data[1] & 0xFFu) << 8));
+    m->input5_voltage = (uint16_t)((uint32_t)(data[2] & 0xFFu) | ((uint32_t)(data[3] & 0xFFu) << 8));
+    m->input6_voltage = (uint16_t)((uint32_t)(data[4] & 0xFFu) | ((uint32_t)(data[5] & 0xFFu) << 8));
+    m->input7_voltage = (uint16_t)((uint32_t)(data[6] & 0xFFu) | ((uint32_t)(data[7] & 0xFFu) << 8));
+}
+
+typedef struct {
+    uint16_t input8_voltage; // 16 bit, x0.001 V
+    uint16_t input9_voltage; // 16 bit, x0.001 V
+    uint16_t input10_voltage; // 16 bit, x0.001 V
+} analogVoltage_3_t;
+
+static inline void analogVoltage_3_pack(const analogVoltage_3_t *m, uint8_t *data) {
+    data[0] = (uint8_t)(((uint32_t)m->input8_voltage & 0xFFu));
+    data[1] = (uint8_t)((((uint32_t)m->input8_voltage >> 8) & 0xFFu));
+    data[2] = (uint8_t)(((uint32_t)m->input9_voltage & 0xFFu));
+    data[3] = (uint8_t)((((uint32_t)m->input9_voltage >> 8) & 0xFFu));
+    data[4] = (uint8_t)(((uint32_t)m->input10_voltage & 0xFFu));
+    data[5] = (uint8_t)((((uint32_t)m->input10_voltage >> 8) & 0xFFu));
+    data[6] = (uint8_t)(0u);
+    data[7] = (uint8_t)(0u);
+}
+
+static inline void analogVoltage_3_unpack(analogVoltage_3_t *m, const uint8_t *data) {
+    m->input8_voltage = (uint16_t)((uint32_t)(data[0] & 0xFFu) | ((uint32_t)(data[1] & 0xFFu) << 8));
+    m->input9_voltage = (uint16_t)((uint32_t)(data[2] & 0xFFu) | ((uint32_t)(data[3] & 0xFFu) << 8));
+    m->input10_voltage = (uint16_t)((uint32_t)(data[4] & 0xFFu) | ((uint32_t)(data[5] & 0xFFu) << 8));
+}
+
+typedef struct {
+    int8_t chargeCoolerWaterTemp; // 8 bit, x1 C
+    int8_t airTemp; // 8 bit, x1 C
+    int8_t chargeCoolerInletTemp; // 8 bit, x1 C
+    uint16_t chargeCoolerInletPressure; // 16 bit, x0.01 kPa
+    uint16_t exhaustBackPressure; // 16 bit, x0.01 psi
+} sensorValues_1_t;
+
+static inline void sensorValues_1_pack(const sensorValues_1_t *m, uint8_t *data) {
+    data[0] = (uint8_t)(((uint32_t)m->chargeCoolerWaterTemp & 0xFFu));
+    data[1] = (uint8_t)(((uint32_t)m->airTemp & 0xFFu));
+    data[2] = (uint8_t)(((uint32_t)m->chargeCoolerInletTemp & 0xFFu));
+    data[3] = (uint8_t)(((uint32_t)m->chargeCoolerInletPressure & 0xFFu));
+    data[4] = (uint8_t)((((uint32_t)m->chargeCoolerInletPressure >> 8) & 0xFFu));
+    data[5] = (uint8_t)(((uint32_t)m->exhaustBackPressure & 0xFFu));
+    data[6] = (uint8_t)((((uint32_t)m->exhaustBackPressure >> 8) & 0xFFu));
+    data[7] = (uint8_t)(0u);
+}
+
+static inline void sensorValues_1_unpack(sensorValues_1_t *m, const uint8_t *data) {
+    m->chargeCoolerWaterTemp = (int8_t)((int32_t)(((uint32_t)(data[0] & 0xFFu)) << 24) >> 24);
+    m->airTemp = (int8_t)((int32_t)(((uint32_t)(data[1] & 0xFFu)) << 24) >> 24);
+    m->chargeCoolerInletTemp = (int8_t)((int32_t)(((uint32_t)(data[2] & 0xFFu)) << 24) >> 24);
+    m->chargeCoolerInletPressure = (uint16_t)((uint32_t)(data[3] & 0xFFu) | ((uint32_t)(data[4] & 0xFFu) << 8));
+    m->exhaustBackPressure = (uint16_t)((uint32_t)(data[5] & 0xFFu) | ((uint32_t)(data[6] & 0xFFu) << 8));
+}
+
+typedef struct {
+    uint16_t crankCasePressure; // 16 bit, x0.01 kPa
+    uint16_t turboOilPressure; // 16 bit, x0.01 bar
+} sensorValues_2_t;
+
+static inline void sensorValues_2_pack(const sensorValues_2_t *m, uint8_t *data) {
+    data[0] = (uint8_t)(((uint32_t)m->crankCasePressure & 0xFFu));
+    data[1] = (uint8_t)((((uint32_t)m->crankCasePressure >> 8) & 0xFFu));
+    data[2] = (uint8_t)(((uint32_t)m->turboOilPressure & 0xFFu));
+    data[3] = (uint8_t)((((uint32_t)m->turboOilPressure >> 8) & 0xFFu));
+    data[4] = (uint8_t)(0u);
+    data[5] = (uint8_t)(0u);
+    data[6] = (uint8_t)(0u);
+    data[7] = (uint8_t)(0u);
+}
+
+static inline void sensorValues_2_unpack(sensorValues_2_t *m, const uint8_t *data) {
+    m->crankCasePressure = (uint16_t)((uint32_t)(data[0] & 0xFFu) | ((uint32_t)(data[1] & 0xFFu) << 8));
+    m->turboOilPressure = (uint16_t)((uint32_t)(data[2] & 0xFFu) | ((uint32_t)(data[3] & 0xFFu) << 8));
+}
+
+typedef struct {
+    uint8_t diagMetric; // 8 bit, x1
+    uint16_t diagMin; // 14 bit, x1
+    uint16_t diagAvg; // 14 bit, x1
+    uint16_t diagP99; // 14 bit, x1
+    uint16_t diagMax; // 14 bit, x1
+} diagnostics_t;
+
+static inline void diagnostics_pack(const diagnostics_t *m, uint8_t *data) {
+    data[0] = (uint8_t)(((uint32_t)m->diagMetric & 0xFFu));
+    data[1] = (uint8_t)(((uint32_t)m->diagMin & 0xFFu));
+    data[2] = (uint8_t)((((uint32_t)m->diagMin >> 8) & 0x3Fu) | (((uint32_t)m->diagAvg << 6) & 0xC0u));
+    data[3] = (uint8_t)((((uint32_t)m->diagAvg >> 2) & 0xFFu));
+    data[4] = (uint8_t)((((uint32_t)m->diagAvg >> 10) & 0x0Fu) | (((uint32_t)m->diagP99 << 4) & 0xF0u));
+    data[5] = (uint8_t)((((uint32_t)m->diagP99 >> 4) & 0xFFu));
+    data[6] = (uint8_t)((((uint32_t)m->diagP99 >> 12) & 0x03u) | (((uint32_t)m->diagMax << 2) & 0xFCu));
+    data[7] = (uint8_t)((((uint32_t)m->diagMax >> 6) & 0xFFu));
+}
+
+static inline void diagnostics_unpack(diagnostics_t *m, const uint8_t *data) {
+    m->diagMetric = (uint8_t)((uint32_t)(data[0] & 0xFFu));
+    m->diagMin = (uint16_t)((uint32_t)(data[1] & 0xFFu) | ((uint32_t)(data[2] & 0x3Fu) << 8));
+    m->diagAvg = (uint16_t)(((uint32_t)(data[2] & 0xC0u) >> 6) | ((uint32_t)(data[3] & 0xFFu) << 2) | ((uint32_t)(data[4] & 0x0Fu) << 10));
+    m->diagP99 = (uint16_t)(((uint32_t)(data[4] & 0xF0u) >> 4) | ((uint32_t)(data[5] & 0xFFu) << 4) | ((uint32_t)(data[6] & 0x03u) << 12));
+    m->diagMax = (uint16_t)(((uint32_t)(data[6] & 0xFCu) >> 2) | ((uint32_t)(data[7] & 0xFFu) << 6));
+}
+
+typedef struct {
+    uint8_t voltagePage; // 4 bit, x1 (multiplexor)
+    uint16_t input1_voltage; // 12 bit, x0.002 V, page 0
+    uint16_t input2_voltage; // 12 bit, x0.002 V, page 0
+    uint16_t input3_voltage; // 12 bit, x0.002 V, page 0
+    uint16_t input4_voltage; // 12 bit, x0.002 V, page 0
+    uint16_t input5_voltage; // 12 bit, x0.002 V, page 0
+    uint16_t input6_voltage; // 12 bit, x0.002 V, page 1
+    uint16_t input7_voltage; // 12 bit, x0.002 V, page 1
+    uint16_t input8_voltage; // 12 bit, x0.002 V, page 1
+    uint16_t input9_voltage; // 12 bit, x0.002 V, page 1
+    uint16_t input10_voltage; // 12 bit, x0.002 V, page 1
+    int8_t cpuTemperature; // 8 bit, x1 C, page 2
+} packedVoltages_t;
+
+static inline void packedVoltages_pack(const packedVoltages_t *m, uint8_t *data) {
+    switch (m->voltagePage) {
+        case 0:
+            data[0] = (uint8_t)(((uint32_t)m->voltagePage & 0x0Fu) | (((uint32_t)m->input1_voltage << 4) & 0xF0u));
+            data[1] = (uint8_t)((((uint32_t)m->input1_voltage >> 4) & 0xFFu));
+            data[2] = (uint8_t)(((uint32_t)m->input2_voltage & 0xFFu));
+            data[3] = (uint8_t)((((uint32_t)m->input2_voltage >> 8) & 0x0Fu) | (((uint32_t)m->input3_voltage << 4) & 0xF0u));
+            data[4] = (uint8_t)((((uint32_t)m->input3_voltage >> 4) & 0xFFu));
+            data[5] = (uint8_t)(((uint32_t)m->input4_voltage & 0xFFu));
+            data[6] = (uint8_t)((((uint32_t)m->input4_voltage >> 8) & 0x0Fu) | (((uint32_t)m->input5_voltage << 4) & 0xF0u));
+            data[7] = (uint8_t)((((uint32_t)m->input5_voltage >> 4) & 0xFFu));
+            break;
+        case 1:
+            data[0] = (uint8_t)(((uint32_t)m->voltagePage & 0x0Fu) | (((uint32_t)m->input6_voltage << 4) & 0xF0u));
+            data[1] = (uint8_t)((((uint32_t)m->input6_voltage >> 4) & 0xFFu));
+            data[2] = (uint8_t)(((uint32_t)m->input7_voltage & 0xFFu));
+            data[3] = (uint8_t)((((uint32_t)m->input7_voltage >> 8) & 0x0Fu) | (((uint32_t)m->input8_voltage << 4) & 0xF0u));
+            data[4] = (uint8_t)((((uint32_t)m->input8_voltage >> 4) & 0xFFu));
+            data[5] = (uint8_t)(((uint32_t)m->input9_voltage & 0xFFu));
+            data[6] = (uint8_t)((((uint32_t)m->input9_voltage >> 8) & 0x0Fu) | (((uint32_t)m->input10_voltage << 4) & 0xF0u));
+            data[7] = (uint8_t)((((uint32_t)m->input10_voltage >> 4) & 0xFFu));
+            break;
+        case 2:
+            data[0] = (uint8_t)(((uint32_t)m->voltagePage & 0x0Fu));
+            data[1] = (uint8_t)(((uint32_t)m->cpuTemperature & 0xFFu));
+            data[2] = (uint8_t)(0u);
+            data[3] = (uint8_t)(0u);
+            data[4] = (uint8_t)(0u);
+            data[5] = (uint8_t)(0u);
+            data[6] = (uint8_t)(0u);
+            data[7] = (uint8_t)(0u);
+            break;
+        default:
+            data[0] = (uint8_t)(((uint32_t)m->voltagePage & 0x0Fu));
+            data[1] = (uint8_t)(0u);
+            data[2] = (uint8_t)(0u);
+            data[3] = (uint8_t)(0u);
+            data[4] = (uint8_t)(0u);
+            data[5] = (uint8_t)(0u);
+            data[6] = (uint8_t)(0u);
+            data[7] = (uint8_t)(0u);
+            break;
+    }
+}
+
+static inline void packedVoltages_unpack(packedVoltages_t *m, const uint8_t *data) {
+    m->voltagePage = (uint8_t)((uint32_t)(data[0] & 0x0Fu));
+    switch (m->voltagePage) {
+        case 0:
+            m->input1_voltage = (uint16_t)(((uint32_t)(data[0] & 0xF0u) >> 4) | ((uint32_t)(data[1] & 0xFFu) << 4));
+            m->input2_voltage = (uint16_t)((uint32_t)(data[2] & 0xFFu) | ((uint32_t)(data[3] & 0x0Fu) << 8));
+            m->input3_voltage = (uint16_t)(((uint32_t)(data[3] & 0xF0u) >> 4) | ((uint32_t)(data[4] & 0xFFu) << 4));
+            m->input4_voltage = (uint16_t)((uint32_t)(data[5] & 0xFFu) | ((uint32_t)(data[6] & 0x0Fu) << 8));
+            m->input5_voltage = (uint16_t)(((uint32_t)(data[6] & 0xF0u) >> 4) | ((uint32_t)(data[7] & 0xFFu) << 4));
+            break;
+        case 1:
+            m->input6_voltage = (uint16_t)(((uint32_t)(data[0] & 0xF0u) >> 4) | ((uint32_t)(data[1] & 0xFFu) << 4));
+            m->input7_voltage = (uint16_t)((uint32_t)(data[2] & 0xFFu) | ((uint32_t)(data[3] & 0x0Fu) << 8));
+            m->input8_voltage = (uint16_t)(((uint32_t)(data[3] & 0xF0u) >> 4) | ((uint32_t)(data[4] & 0xFFu) << 4));
+            m->input9_voltage = (uint16_t)((uint32_t)(data[5] & 0xFFu) | ((uint32_t)(data[6] & 0x0Fu) << 8));
+            m->input10_voltage = (uint16_t)(((uint32_t)(data[6] & 0xF0u) >> 4) | ((uint32_t)(data[7] & 0xFFu) << 4));
+            break;
+        case 2:
+            m->cpuTemperature = (int8_t)((int32_t)(((uint32_t)(data[1] & 0xFFu)) << 24) >> 24);
+            break;
+        default:
+            break;
+    }
+}
+
+typedef struct {
+    int8_t chargeCoolerWaterTemp; // 8 bit, x1 C
+    int8_t airTemp; // 8 bit, x1 C
+    int8_t chargeCoolerInletTemp; // 8 bit, x1 C
+    uint16_t chargeCoolerInletPressure; // 12 bit, x0.1 kPa
+    uint16_t crankCasePressure; // 12 bit, x0.1 kPa
+    uint8_t exhaustBackPressure; // 8 bit, x0.5 psi
+    uint8_t turboOilPressure; // 8 bit, x0.05 bar
+} packedSensors_t;
+
+static inline void packedSensors_pack(const packedSensors_t *m, uint8_t *data) {
+    data[0] = (uint8_t)(((uint32_t)m->chargeCoolerWaterTemp & 0xFFu));
+    data[1] = (uint8_t)(((uint32_t)m->airTemp & 0xFFu));
+    data[2] = (uint8_t)(((uint32_t)m->chargeCoolerInletTemp & 0xFFu));
+    data[3] = (uint8_t)(((uint32_t)m->chargeCoolerInletPressure & 0xFFu));
+    data[4] = (uint8_t)((((uint32_t)m->chargeCoolerInletPressure >> 8) & 0x0Fu) | (((uint32_t)m->crankCasePressure << 4) & 0xF0u));
+    data[5] = (uint8_t)((((uint32_t)m->crankCasePressure >> 4) & 0xFFu));
+    data[6] = (uint8_t)(((uint32_t)m->exhaustBackPressure & 0xFFu));
+    data[7] = (uint8_t)(((uint32_t)m->turboOilPressure & 0xFFu));
+}
+
+static inline void packedSensors_unpack(packedSensors_t *m, const uint8_t *data) {
+    m->chargeCoolerWaterTemp = (int8_t)((int32_t)(((uint32_t)(data[0] & 0xFFu)) << 24) >> 24);
+    m->airTemp = (int8_t)((int32_t)(((uint32_t)(data[1] & 0xFFu)) << 24) >> 24);
+    m->chargeCoolerInletTemp = (int8_t)((int32_t)(((uint32_t)(data[2] & 0xFFu)) << 24) >> 24);
+    m->chargeCoolerInletPressure = (uint16_t)((uint32_t)(data[3] & 0xFFu) | ((uint32_t)(data[4] & 0x0Fu) << 8));
+    m->crankCasePressure = (uint16_t)(((uint32_t)(data[4] & 0xF0u) >> 4) | ((uint32_t)(data[5] & 0xFFu) << 4));
+    m->exhaustBackPressure = (uint8_t)((uint32_t)(data[6] & 0xFFu));
+    m->turboOilPressure = (uint8_t)((uint32_t)(data[7] & 0xFFu));
+}
+
+typedef struct {
+    uint8_t boardState; // 4 bit, x1
+    uint16_t channelValid; // 10 bit, x1
+    uint32_t sampleTime; // 32 bit, x1 ms
+} boardStatus_t;
+
+static inline void boardStatus_pack(const boardStatus_t *m, uint8_t *data) {
+    data[0] = (uint8_t)(((uint32_t)m->boardState & 0x0Fu));
+    data[1] = (uint8_t)(((uint32_t)m->channelValid & 0xFFu));
+    data[2] = (uint8_t)((((uint32_t)m->channelValid >> 8) & 0x03u));
+    data[3] = (uint8_t)(0u);
+    data[4] = (uint8_t)(((uint32_t)m->sampleTime & 0xFFu));
+    data[5] = (uint8_t)((((uint32_t)m->sampleTime >> 8) & 0xFFu));
+    data[6] = (uint8_t)((((uint32_t)m->sampleTime >> 16) & 0xFFu));
+    data[7] = (uint8_t)((((uint32_t)m->sampleTime >> 24) & 0xFFu));
+}
+
+static inline void boardStatus_unpack(boardStatus_t *m, const uint8_t *data) {
+    m->boardState = (uint8_t)((uint32_t)(data[0] & 0x0Fu));
+    m->channelValid = (uint16_t)((uint32_t)(data[1] & 0xFFu) | ((uint32_t)(data[2] & 0x03u) << 8));
+    m->sampleTime = (uint32_t)((uint32_t)(data[4] & 0xFFu) | ((uint32_t)(data[5] & 0xFFu) << 8) | ((uint32_t)(data[6] & 0xFFu) << 16) | ((uint32_t)(data[7] & 0xFFu) << 24));
+}
+
+typedef struct {
+    uint8_t input1_fault; // 3 bit, x1
+    uint8_t input2_fault; // 3 bit, x1
+    uint8_t input3_fault; // 3 bit, x1
+    uint8_t input4_fault; // 3 bit, x1
+    uint8_t input5_fault; // 3 bit, x1
+    uint8_t input6_fault; // 3 bit, x1
+    uint8_t input7_fault; // 3 bit, x1
+    uint8_t input8_fault; // 3 bit, x1
+    uint8_t input9_fault; // 3 bit, x1
+    uint8_t input10_fault; // 3 bit, x1
+} sensorStatus_t;
+
+static inline void sensorStatus_pack(const sensorStatus_t *m, uint8_t *data) {
+    data[0] = (uint8_t)(((uint32_t)m->input1_fault & 0x07u) | (((uint32_t)m->input2_fault << 3) & 0x38u) | (((uint32_t)m->input3_fault << 6) & 0xC0u));
+    data[1] = (uint8_t)((((uint32_t)m->input3_fault >> 2) & 0x01u) | (((uint32_t)m->input4_fault << 1) & 0x0Eu) | (((uint32_t)m->input5_fault << 4) & 0x70u) | (((uint32_t)m->input6_fault << 7) & 0x80u));
+    data[2] = (uint8_t)((((uint32_t)m->input6_fault >> 1) & 0x03u) | (((uint32_t)m->input7_fault << 2) & 0x1Cu) | (((uint32_t)m->input8_fault << 5) & 0xE0u));
+    data[3] = (uint8_t)(((uint32_t)m->input9_fault & 0x07u) | (((uint32_t)m->input10_fault << 3) & 0x38u));
+}
+
+static inline void sensorStatus_unpack(sensorStatus_t *m, const uint8_t *data) {
+    m->input1_fault = (uint8_t)((uint32_t)(data[0] & 0x07u));
+    m->input2_fault = (uint8_t)(((uint32_t)(data[0] & 0x38u) >> 3));
+    m->input3_fault = (uint8_t)(((uint32_t)(data[0] & 0xC0u) >> 6) | ((uint32_t)(data[1] & 0x01u) << 2));
+    m->input4_fault = (uint8_t)(((uint32_t)(data[1] & 0x0Eu) >> 1));
+    m->input5_fault = (uint8_t)(((uint32_t)(data[1] & 0x70u) >> 4));
+    m->input6_fault = (uint8_t)(((uint32_t)(data[1] & 0x80u) >> 7) | ((uint32_t)(data[2] & 0x03u) << 1));
+    m->input7_fault = (uint8_t)(((uint32_t)(data[2] & 0x1Cu) >> 2));
+    m->input8_fault = (uint8_t)(((uint32_t)(data[2] & 0xE0u) >> 5));
+    m->input9_fault = (uint8_t)((uint32_t)(data[3] & 0x07u));
+    m->input10_fault = (uint8_t)(((uint32_t)(data[3] & 0x38u) >> 3));
+}
+
+typedef struct {
+    int16_t chargeCoolerPressureDrop; // 16 bit, x0.01 kPa
+    uint16_t crankCasePressurePeak; // 16 bit, x0.01 kPa
+    int16_t chargeCoolerWaterTempRate; // 16 bit, x0.1 C/s
+    int8_t chargeCoolerInletTempMin; // 8 bit, x1 C
+    int8_t chargeCoolerInletTempMax; // 8 bit, x1 C
+} derivedValues_t;
+
+static inline void derivedValues_pack(const derivedValues_t *m, uint8_t *data) {
+    data[0] = (uint8_t)(((uint32_t)m->chargeCoolerPressureDrop & 0xFFu));
+    data[1] = (uint8_t)((((uint32_t)m->chargeCoolerPressureDrop >> 8) & 0xFFu));
+    data[2] = (uint8_t)(((uint32_t)m->crankCasePressurePeak & 0xFFu));
+    data[3] = (uint8_t)((((uint32_t)m->crankCasePressurePeak >> 8) & 0xFFu));
+    data[4] = (uint8_t)(((uint32_t)m->chargeCoolerWaterTempRate & 0xFFu));
+    data[5] = (uint8_t)((((uint32_t)m->chargeCoolerWaterTempRate >> 8) & 0xFFu));
+    data[6] = (uint8_t)(((uint32_t)m->chargeCoolerInletTempMin & 0xFFu));
+    data[7] = (uint8_t)(((uint32_t)m->chargeCoolerInletTempMax & 0xFFu));
+}
+
+static inline void derivedValues_unpack(derivedValues_t *m, const uint8_t *data) {
+    m->chargeCoolerPressureDrop = (int16_t)((int32_t)(((uint32_t)(data[0] & 0xFFu) | ((uint32_t)(data[1] & 0xFFu) << 8)) << 16) >> 16);
+    m->crankCasePressurePeak = (uint16_t)((uint32_t)(data[2] & 0xFFu) | ((uint32_t)(data[3] & 0xFFu) << 8));
+    m->chargeCoolerWaterTempRate = (int16_t)((int32_t)(((uint32_t)(data[4] & 0xFFu) | ((uint32_t)(data[5] & 0xFFu) << 8)) << 16) >> 16);
+    m->chargeCoolerInletTempMin = (int8_t)((int32_t)(((uint32_t)(data[6] & 0xFFu)) << 24) >> 24);
+    m->chargeCoolerInletTempMax = (int8_t)((int32_t)(((uint32_t)(data[7] & 0xFFu)) << 24) >> 24);
+}
+
+typedef struct {
+    uint8_t loadTask; // 4 bit, x1
+    uint8_t loadCore; // 4 bit, x1
+    uint8_t loadPriority; // 8 bit, x1
+    uint16_t loadCpu; // 10 bit, x0.1 %
+    uint16_t loadStackFree; // 16 bit, x1 B
+    uint16_t loadStackSize; // 16 bit, x1 B
+} taskLoad_t;
+
+static inline void taskLoad_pack(const taskLoad_t *m, uint8_t *data) {
+    data[0] = (uint8_t)(((uint32_t)m->loadTask & 0x0Fu) | (((uint32_t)m->loadCore << 4) & 0xF0u));
+    data[1] = (uint8_t)(((uint32_t)m->loadPriority & 0xFFu));
+    data[2] = (uint8_t)(((uint32_t)m->loadCpu & 0xFFu));
+    data[3] = (uint8_t)((((uint32_t)m->loadCpu >> 8) & 0x03u) | (((uint32_t)m->loadStackFree << 2) & 0xFCu));
+    data[4] = (uint8_t)((((uint32_t)m->loadStackFree >> 6) & 0xFFu));
+    data[5] = (uint8_t)((((uint32_t)m->loadStackFree >> 14) & 0x03u) | (((uint32_t)m->loadStackSize << 2) & 0xFCu));
+    data[6] = (uint8_t)((((uint32_t)m->loadStackSize >> 6) & 0xFFu));
+    data[7] = (uint8_t)((((uint32_t)m->loadStackSize >> 14) & 0x03u));
+}
+
+static inline void taskLoad_unpack(taskLoad_t *m, const uint8_t *data) {
+    m->loadTask = (uint8_t)((uint32_t)(data[0] & 0x0Fu));
+    m->loadCore = (uint8_t)(((uint32_t)(data[0] & 0xF0u) >> 4));
+    m->loadPriority = (uint8_t)((uint32_t)(data[1] & 0xFFu));
+    m->loadCpu = (uint16_t)((uint32_t)(data[2] & 0xFFu) | ((uint32_t)(data[3] & 0x03u) << 8));
+    m->loadStackFree = (uint16_t)(((uint32_t)(data[3] & 0xFCu) >> 2) | ((uint32_t)(data[4] & 0xFFu) << 6) | ((uint32_t)(data[5] & 0x03u) << 14));
+    m->loadStackSize = (uint16_t)(((uint32_t)(data[5] & 0xFCu) >> 2) | ((uint32_t)(data[6] & 0xFFu) << 6) | ((uint32_t)(data[7] & 0x03u) << 14));
+}
+
+typedef struct {
+    uint16_t core0Load; // 10 bit, x0.1 %
+    uint16_t core1Load; // 10 bit, x0.1 %
+    uint16_t heapFree; // 12 bit, x1 KiB
+    uint16_t heapMinFree; // 12 bit, x1 KiB
+    uint16_t heapLargestBlock; // 12 bit, x1 KiB
+    uint8_t lowStackTasks; // 8 bit, x1
+} systemLoad_t;
+
+static inline void systemLoad_pack(const systemLoad_t *m, uint8_t *data) {
+    data[0] = (uint8_t)(((uint32_t)m->core0Load & 0xFFu));
+    data[1] = (uint8_t)((((uint32_t)m->core0Load >> 8) & 0x03u) | (((uint32_t)m->core1Load << 2) & 0xFCu));
+    data[2] = (uint8_t)((((uint32_t)m->core1Load >> 6) & 0x0Fu) | (((uint32_t)m->heapFree << 4) & 0xF0u));
+    data[3] = (uint8_t)((((uint32_t)m->heapFree >> 4) & 0xFFu));
+    data[4] = (uint8_t)(((uint32_t)m->heapMinFree & 0xFFu));
+    data[5] = (uint8_t)((((uint32_t)m->heapMinFree >> 8) & 0x0Fu) | (((uint32_t)m->heapLargestBlock << 4) & 0xF0u));
+    data[6] = (uint8_t)((((uint32_t)m->heapLargestBlock >> 4) & 0xFFu));
+    data[7] = (uint8_t)(((uint32_t)m->lowStackTasks & 0xFFu));
+}
+
+static inline void systemLoad_unpack(systemLoad_t *m, const uint8_t *data) {
+    m->core0Load = (uint16_t)((uint32_t)(data[0] & 0xFFu) | ((uint32_t)(data[1] & 0x03u) << 8));
+    m->core1Load = (uint16_t)(((uint32_t)(data[1] & 0xFCu) >> 2) | ((uint32_t)(data[2] & 0x0Fu) << 6));
+    m->heapFree = (uint16_t)(((uint32_t)(data[2] & 0xF0u) >> 4) | ((uint32_t)(data[3] & 0xFFu) << 4));
+    m->heapMinFree = (uint16_t)((uint32_t)(data[4] & 0xFFu) | ((uint32_t)(data[5] & 0x0Fu) << 8));
+    m->heapLargestBlock = (uint16_t)(((uint32_t)(data[5] & 0xF0u) >> 4) | ((uint32_t)(data[6] & 0xFFu) << 4));
+    m->lowStackTasks = (uint8_t)((uint32_t)(data[7] & 0xFFu));
+}
+
+typedef struct {
+    uint32_t capture1Frequency; // 22 bit, x0.01 Hz
+    uint16_t capture1Duty; // 10 bit, x0.1 %
+    uint32_t capture2Frequency; // 22 bit, x0.01 Hz
+    uint16_t capture2Duty; // 10 bit, x0.1 %
+} captureValues_t;
+
+static inline void captureValues_pack(const captureValues_t *m, uint8_t *data) {
+    data[0] = (uint8_t)(((uint32_t)m->capture1Frequency & 0xFFu));
+    data[1] = (uint8_t)((((uint32_t)m->capture1Frequency >> 8) & 0xFFu));
+    data[2] = (uint8_t)((((uint32_t)m->capture1Frequency >> 16) & 0x3Fu) | (((uint32_t)m->capture1Duty << 6) & 0xC0u));
+    data[3] = (uint8_t)((((uint32_t)m->capture1Duty >> 2) & 0xFFu));
+    data[4] = (uint8_t)(((uint32_t)m->capture2Frequency & 0xFFu));
+    data[5] = (uint8_t)((((uint32_t)m->capture2Frequency >> 8) & 0xFFu));
+    data[6] = (uint8_t)((((uint32_t)m->capture2Frequency >> 16) & 0x3Fu) | (((uint32_t)m->capture2Duty << 6) & 0xC0u));
+    data[7] = (uint8_t)((((uint32_t)m->capture2Duty >> 2) & 0xFFu));
+}
+
+static inline void captureValues_unpack(captureValues_t *m, const uint8_t *data) {
+    m->capture1Frequency = (uint32_t)((uint32_t)(data[0] & 0xFFu) | ((uint32_t)(data[1] & 0xFFu) << 8) | ((uint32_t)(data[2] & 0x3Fu) << 16));
+    m->capture1Duty = (uint16_t)(((uint32_t)(data[2] & 0xC0u) >> 6) | ((uint32_t)(data[3] & 0xFFu) << 2));
+    m->capture2Frequency = (uint32_t)((uint32_t)(data[4] & 0xFFu) | ((uint32_t)(data[5] & 0xFFu) << 8) | ((uint32_t)(data[6] & 0x3Fu) << 16));
+    m->capture2Duty = (uint16_t)(((uint32_t)(data[6] & 0xC0u) >> 6) | ((uint32_t)(data[7] & 0xFFu) << 2));
+}
+
+typedef struct {
+    uint8_t configCommand; // 8 bit, x1
+    uint8_t configParam; // 8 bit, x1
+    uint8_t configIndex; // 8 bit, x1
+    int32_t configValue; // 32 bit, x1
+} boardConfigRequest_t;
+
+static inline void boardConfigRequest_pack(const boardConfigRequest_t *m, uint8_t *data) {
+    data[0] = (uint8_t)(((uint32_t)m->configCommand & 0xFFu));
+    data[1] = (uint8_t)(0u);
+    data[2] = (uint8_t)(((uint32_t)m->configParam & 0xFFu));
+    data[3] = (uint8_t)(((uint32_t)m->configIndex & 0xFFu));
+    data[4] = (uint8_t)(((uint32_t)m->configValue & 0xFFu));
+    data[5] = (uint8_t)((((uint32_t)m->configValue >> 8) & 0xFFu));
+    data[6] = (uint8_t)((((uint32_t)m->configValue >> 16) & 0xFFu));
+    data[7] = (uint8_t)((((uint32_t)m->configValue >> 24) & 0xFFu));
+}
+
+static inline void boardConfigRequest_unpack(boardConfigRequest_t *m, const uint8_t *data) {
+    m->configCommand = (uint8_t)((uint32_t)(data[0] & 0xFFu));
+    m->configParam = (uint8_t)((uint32_t)(data[2] & 0xFFu));
+    m->configIndex = (uint8_t)((uint32_t)(data[3] & 0xFFu));
+    m->configValue = (int32_t)((uint32_t)(data[4] & 0xFFu) | ((uint32_t)(data[5] & 0xFFu) << 8) | ((uint32_t)(data[6] & 0xFFu) << 16) | ((uint32_t)(data[7] & 0xFFu) << 24));
+}
+
+typedef struct {
+    uint8_t configCommand; // 8 bit, x1
+    uint8_t configStatus; // 8 bit, x1
+    uint8_t configParam; // 8 bit, x1
+    uint8_t configIndex; // 8 bit, x1
+    int32_t configValue; // 32 bit, x1
+} boardConfigResponse_t;
+
+static inline void boardConfigResponse_pack(const boardConfigResponse_t *m, uint8_t *data) {
+    data[0] = (uint8_t)(((uint32_t)m->configCommand & 0xFFu));
+    data[1] = (uint8_t)(((uint32_t)m->configStatus & 0xFFu));
+    data[2] = (uint8_t)(((uint32_t)m->configParam & 0xFFu));
+    data[3] = (uint8_t)(((uint32_t)m->configIndex & 0xFFu));
+    data[4] = (uint8_t)(((uint32_t)m->configValue & 0xFFu));
+    data[5] = (uint8_t)((((uint32_t)m->configValue >> 8) & 0xFFu));
+    data[6] = (uint8_t)((((uint32_t)m->configValue >> 16) & 0xFFu));
+    data[7] = (uint8_t)((((uint32_t)m->configValue >> 24) & 0xFFu));
+}
+
+static inline void boardConfigResponse_unpack(boardConfigResponse_t *m, const uint8_t *data) {
+    m->configCommand = (uint8_t)((uint32_t)(data[0] & 0xFFu));
+    m->configStatus = (uint8_t)((uint32_t)(data[1] & 0xFFu));
+    m->configParam = (uint8_t)((uint32_t)(data[2] & 0xFFu));
+    m->configIndex = (uint8_t)((uint32_t)(data[3] & 0xFFu));
+    m->configValue = (int32_t)((uint32_t)(data[4] & 0xFFu) | ((uint32_t)(data[5] & 0xFFu) << 8) | ((uint32_t)(data[6] & 0xFFu) << 16) | ((uint32_t)(data[7] & 0xFFu) << 24));
+}
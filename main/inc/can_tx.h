@@ -0,0 +1,80 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+#include "inc/can_sched.h"
+
+#define CAN_TX_MAX_IDS 16           // Distinct IDs with a latest-value slot
+#define CAN_TX_INFLIGHT_ACTIVE 8    // Frames handed to the driver at once while error active
+#define CAN_TX_INFLIGHT_PASSIVE 1   // ...and while error passive, when frames may not be getting through
+
+/**
+ * @brief Fault confinement state of the controller, as far as transmission is concerned.
+ */
+typedef enum {
+    CAN_BUS_ERROR_ACTIVE,
+    CAN_BUS_ERROR_PASSIVE,  // An error counter reached 128, e.g. nothing on the bus acknowledges
+    CAN_BUS_OFF,            // TX error counter passed 255; recovering, nothing can be sent
+} can_bus_state_t;
+
+/**
+ * @brief Driver operations used by the TX stage, so it runs against TWAI or a fake.
+ */
+typedef struct {
+    void *ctx;
+    esp_err_t (*transmit)(void *ctx, const can_frame_t *frame);    // Non-blocking, ESP_ERR_TIMEOUT when the queue is full
+    uint32_t (*queued)(void *ctx);                                  // Frames waiting in the driver's TX queue
+    esp_err_t (*flush)(void *ctx);                                  // Drop everything in the driver's TX queue
+    esp_err_t (*recover)(void *ctx);                                // Begin bus-off recovery
+    esp_err_t (*start)(void *ctx);                                  // Restart the controller once recovered
+} can_tx_hal_t;
+
+typedef struct {
+    uint64_t submitted;         // Frames offered by the scheduler
+    uint64_t queued;            // Frames handed to the driver
+    uint64_t superseded;        // Replaced in their slot by a newer frame of the same ID before reaching the driver
+    uint64_t flushed;           // Dropped from the driver's queue at bus-off
+    uint64_t rejected;          // Refused by the driver for a reason other than a full queue
+    uint32_t bus_offs;
+    uint32_t recoveries;
+    uint32_t error_passive;     // Entries into error passive
+    uint32_t last_recovery_us;  // Bus-off to restart, last and worst
+    uint32_t max_recovery_us;
+    uint32_t tx_errors;         // Latest TX/RX error counters
+    uint32_t rx_errors;
+} can_tx_stats_t;
+
+/**
+ * @brief Transmit stage between the scheduler and the driver.
+ *
+ * Holds at most one frame per ID. A frame submitted while an older one of
+ * the same ID is still waiting replaces it, so when the bus is slow,
+ * congested or gone the newest data wins and nothing queues up behind it.
+ * Frames move to the driver lowest ID first, keeping only a few in its
+ * queue; the rest of the back-pressure stays in the slots.
+ *
+ * Not thread-safe: callers share one lock between submitting, pumping and
+ * reporting bus events.
+ */
+typedef struct {
+    const can_tx_hal_t *hal;
+    can_frame_t slots[CAN_TX_MAX_IDS];
+    uint32_t pending;           // Bit n set while slots[n] holds a frame
+    size_t count;               // Slots assigned to an ID
+    can_bus_state_t state;
+    int64_t bus_off_us;
+    can_tx_stats_t stats;
+} can_tx_t;
+
+esp_err_t canTxInit(can_tx_t *tx, const can_tx_hal_t *hal);
+esp_err_t canTxSubmit(can_tx_t *tx, const can_frame_t *frame);
+size_t canTxPump(can_tx_t *tx);
+bool canTxPending(const can_tx_t *tx);
+void canTxBusOff(can_tx_t *tx, int64_t now_us);
+esp_err_t canTxBusRecovered(can_tx_t *tx, int64_t now_us);
+void canTxErrorPassive(can_tx_t *tx, bool passive);
+void canTxErrorCounters(can_tx_t *tx, uint32_t tx_errors, uint32_t rx_errors);
+const char *canBusStateName(can_bus_state_t state);
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+#include "inc/snapshot.h"
+
+#define CAPTURE_MAX_INPUTS SNAPSHOT_NUM_CAPTURE
+#define CAPTURE_COUNTER_MODULUS 32767   // The pulse counter runs 0..32766 and wraps to 0 at its high limit
+#define CAPTURE_MAX_GAP_US 50000        // Reads further apart than this restart the window (the ADC read timeout)
+#define CAPTURE_MAX_GLITCH_NS 12700     // The pulse counter's filter is 1023 APB cycles at most
+#define CAPTURE_FREQ_SCALE 100          // Frequencies are in 0.01 Hz
+#define CAPTURE_DUTY_FULL 1000          // Duty in 0.1 %
+
+typedef enum {
+    CAPTURE_FREQUENCY = 0,      // Rising edges only
+    CAPTURE_FREQUENCY_DUTY,     // And the width of the high pulses
+} capture_mode_t;
+
+/**
+ * @brief Describes one frequency input: where it is wired and how it is averaged.
+ *
+ * The table of descriptors is the only place that knows which inputs are
+ * frequency inputs; the ADC keeps sampling them, but their voltages are
+ * the signal's average and mean nothing.
+ */
+typedef struct {
+    const char *name;
+    uint8_t input;              // Board input, 0-9 as in channel_table
+    capture_mode_t mode;
+    uint16_t window_ms;         // Shortest averaging window; a window closes on the first edge after it
+    uint16_t timeout_ms;        // No edge for this long reads as 0 Hz
+    uint16_t glitch_ns;         // Pulses shorter than this are not counted, 0 disables
+} capture_desc_t;
+
+/**
+ * @brief What the counters read for one input at one sweep.
+ *
+ * Edges come from a pulse counter, the edge times from capture registers
+ * latched by the hardware on every edge, so nothing runs per edge. The
+ * registers only hold the latest edge, so the glue reads the rising one
+ * twice around the others; if an edge lands in between, the times do not
+ * belong to the count and `latched` is false.
+ */
+typedef struct {
+    uint16_t edges;             // Rising edges, modulo CAPTURE_COUNTER_MODULUS
+    uint32_t rise_ticks;        // Capture timer at the latest rising edge
+    uint32_t fall_ticks;        // And at the latest falling edge, CAPTURE_FREQUENCY_DUTY only
+    bool latched;               // The times belong to the latest of `edges`
+} capture_raw_t;
+
+/**
+ * @brief Per-input state. Counts are extended to 32 bits and only differences are used.
+ */
+typedef struct {
+    uint32_t window_us;
+    uint32_t timeout_us;
+    uint16_t last_raw;
+    uint32_t edges;             // Extended edge count
+    uint64_t last_us;           // Time of the last read
+    uint64_t last_edge_us;      // Read at which the count last moved
+    bool primed;                // `last_raw` holds a read
+    bool anchored;              // The window below has started
+    bool anchor_latched;        // `anchor_ticks` is the anchor edge's time
+    uint32_t anchor_edges;
+    uint64_t anchor_us;
+    uint32_t anchor_ticks;
+    uint32_t timeout_ticks;     // Longest pulse or gap sampled
+    uint32_t sampled_rise;      // Rising edge whose pulse was last sampled
+    uint64_t high_sum;          // Widths of pulses ended before a read, in capture ticks, this window
+    uint64_t low_sum;           // Gaps before pulses still high at a read
+    uint32_t high_count;
+    uint32_t low_count;
+    uint32_t freq;              // Published frequency, 0.01 Hz
+    uint16_t duty;              // Published duty, 0.1 %
+} capture_channel_t;
+
+typedef struct {
+    const capture_desc_t *descs;
+    size_t count;
+    uint32_t timer_hz;          // Capture timer rate
+    capture_channel_t ch[CAPTURE_MAX_INPUTS];
+} capture_t;
+
+extern const capture_desc_t capture_table[];
+extern const size_t capture_table_count;
+
+esp_err_t captureInit(capture_t *cap, const capture_desc_t *table, size_t count, uint32_t timer_hz);
+void captureUpdate(capture_t *cap, const capture_raw_t *raw, uint64_t now_us, sensor_values_t *values);
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+#include "inc/adc_stream.h"
+#include "inc/faults.h"
+#include "inc/filters.h"
+#include "inc/ntc.h"
+#include "inc/snapshot.h"
+
+#define CHANNEL_POLY_TERMS 4
+#define CHANNEL_MAX_LUTS 4
+#define CHANNEL_RATE_HZ (ADC_STREAM_SAMPLE_FREQ_HZ / ADC_STREAM_NUM_CHANNELS)
+#define CHANNEL_SWEEP_US (ADC_STREAM_SWEEP_SAMPLES * 1000000u / CHANNEL_RATE_HZ) // One sweep of every channel
+
+typedef enum {
+    CHANNEL_FILTER_NONE = 0,    // Latest sample only
+    CHANNEL_FILTER_MEDIAN,      // Sliding median of the last `filter_depth` samples, then optional IIR/slew
+    CHANNEL_FILTER_OVERSAMPLE,  // Mean of each block of `oversample` samples, with sub-LSB resolution
+} channel_filter_t;
+
+typedef enum {
+    CHANNEL_CONVERT_NONE = 0,   // Voltage only, no engineering output
+    CHANNEL_CONVERT_LINEAR,     // Clamped linear span, output x100 (getSensorPressure)
+    CHANNEL_CONVERT_POLYNOMIAL, // c0 + c1*V + c2*V^2 + c3*V^3 with V in volts, output x100
+    CHANNEL_CONVERT_TABLE,      // NTC characterisation table, output in 0.1°C
+} channel_conversion_t;
+
+/**
+ * @brief Describes how one analog input is filtered, scaled and converted.
+ *
+ * The table of descriptors is the only place that knows what is wired to
+ * each input; fitting a different sensor is a change to channel_config.c.
+ */
+typedef struct {
+    const char *name;
+    float divider;                      // Input divider scaling back to the 0-5 V sensor range
+    channel_filter_t filter;
+    uint8_t filter_depth;               // Median window, 1 to FILTER_MAX_DEPTH
+    float iir_alpha;                    // Weight of each new median in a first-order IIR, 0 to disable
+    uint16_t slew_limit;                // Max change in raw codes per ADC sample, 0 to disable
+    uint16_t oversample;                // Samples per output with CHANNEL_FILTER_OVERSAMPLE, power of two 4-256
+    uint16_t deadband_mv;               // Filtered change that marks the channel's CAN messages dirty, 0 never does
+    channel_conversion_t conversion;
+    sensor_slot_t slot;                 // Snapshot output fed by this channel
+    fault_limits_t fault;               // Wiring and plausibility checks, and the output used while they fail
+    union {
+        struct { int16_t v_min_mv, v_max_mv; float out_min, out_max; } linear;
+        struct { float coeff[CHANNEL_POLY_TERMS]; } poly;
+        struct { const ntc_point_t *table; uint8_t size; uint16_t r_pullup; uint16_t v_ref_mv; } ntc;
+    };
+} channel_desc_t;
+
+/**
+ * @brief Converts a raw ADC code on a channel to calibrated, unscaled millivolts.
+ */
+typedef int (*channel_cali_fn_t)(void *ctx, int channel, int raw);
+
+typedef struct {
+    const channel_desc_t *desc;
+    size_t count;
+    channel_cali_fn_t cali;
+    void *cali_ctx;
+    stream_filter_t filters[SNAPSHOT_NUM_CHANNELS];
+    oversampler_t oversamplers[SNAPSHOT_NUM_CHANNELS];
+    ntc_lut_t luts[CHANNEL_MAX_LUTS];
+    int8_t lut_index[SNAPSHOT_NUM_CHANNELS];
+    uint8_t lut_count;
+    uint16_t reported_mv[SNAPSHOT_NUM_CHANNELS];    // Filtered value at each channel's last change
+    uint32_t reported_valid;                        // `valid` at the last channelsMarkChanges()
+    uint32_t reported_faulted;                      // `faulted` at the last channelsMarkChanges()
+    fault_state_t faults[SNAPSHOT_NUM_CHANNELS];
+} channel_pipeline_t;
+
+extern const channel_desc_t channel_table[SNAPSHOT_NUM_CHANNELS];
+
+esp_err_t channelsInit(channel_pipeline_t *pipeline, const channel_desc_t *table, size_t count,
+                       channel_cali_fn_t cali, void *cali_ctx);
+void channelsFilterSweep(channel_pipeline_t *pipeline, const adc_stream_t *stream, sensor_values_t *values);
+uint32_t channelsMarkChanges(channel_pipeline_t *pipeline, sensor_values_t *values);
+void channelsConvert(const channel_pipeline_t *pipeline, sensor_values_t *values);
+uint16_t getSensorPressure(float v_mv, int v_min_mv, int v_max_mv, float p_min, float p_max);
+uint16_t medianFilterHelper(uint16_t *samples, int count);
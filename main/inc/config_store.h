@@ -0,0 +1,17 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "esp_err.h"
+#include "inc/board_config.h"
+#include "inc/can_sched.h"
+
+#define CONFIG_STORE_NAMESPACE "canboard"
+#define CONFIG_STORE_KEY "config"
+
+static const char* config_log = "config";
+
+esp_err_t initConfigStore(void);
+void configStoreRead(board_config_t *cfg);
+uint32_t configStoreGeneration(void);
+void configStoreRequest(void *ctx, const can_frame_t *frame);
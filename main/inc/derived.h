@@ -0,0 +1,120 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+#include "inc/snapshot.h"
+
+#define DERIVED_MAX_CHANNELS 128
+#define DERIVED_MAX_WINDOWS 32      // Channels with a time window (min, max, peak hold, rate)
+#define DERIVED_MAX_EXTERNAL 4      // Values from outside the ADC path, e.g. received over CAN
+#define DERIVED_BUCKETS 8           // Rolling windows are tracked in this many steps
+#define DERIVED_EXT_ECU_MAP 0       // External value: manifold pressure from the ECU stream, kPa x100
+#define DERIVED_PUBLISH(n) ((n) + 1) // Publishes a channel as the snapshot's derived[n]
+
+// Operands: where a derived channel reads its inputs from
+#define DERIVED_OUTPUT(slot) { DERIVED_SRC_OUTPUT, (uint8_t)(slot) }
+#define DERIVED_MV(ch) { DERIVED_SRC_MV, (uint8_t)(ch) }
+#define DERIVED_EXTERNAL(n) { DERIVED_SRC_EXTERNAL, (uint8_t)(n) }
+#define DERIVED_CHANNEL(n) { DERIVED_SRC_CHANNEL, (uint8_t)(n) }
+#define DERIVED_CAPTURE(n) { DERIVED_SRC_CAPTURE, (uint8_t)(n) }
+
+typedef enum {
+    DERIVED_SRC_OUTPUT = 0,     // outputs[index], a slot's engineering value (the failsafe while its input is faulted)
+    DERIVED_SRC_MV,             // filtered_mv[index]
+    DERIVED_SRC_EXTERNAL,       // The index-th value passed to derivedEvaluate()
+    DERIVED_SRC_CHANNEL,        // An earlier derived channel
+    DERIVED_SRC_CAPTURE,        // capture_freq[index], 0.01 Hz
+} derived_src_t;
+
+typedef enum {
+    DERIVED_OP_DIFF = 0,        // a - b
+    DERIVED_OP_SUM,             // a + b
+    DERIVED_OP_SCALE,           // a * mul / div + offset
+    DERIVED_OP_MIN,             // Lowest a over the last `window_ms`
+    DERIVED_OP_MAX,             // Highest a over the last `window_ms`
+    DERIVED_OP_PEAK_HOLD,       // Highest a in each `window_ms`, held through the next one
+    DERIVED_OP_RATE,            // Change of a per second, over the last `window_ms`
+    DERIVED_OP_COUNT
+} derived_op_t;
+
+typedef struct {
+    uint8_t src;                // derived_src_t
+    uint8_t index;
+} derived_operand_t;
+
+/**
+ * @brief One derived channel, computed every sweep from converted values.
+ *
+ * Values are in the units of their operands: a difference of two kPa x100
+ * slots is kPa x100, a rate of a 0.1°C slot is 0.1°C per second.
+ */
+typedef struct {
+    const char *name;
+    derived_op_t op;
+    derived_operand_t a;
+    derived_operand_t b;        // DERIVED_OP_DIFF and DERIVED_OP_SUM only
+    uint16_t window_ms;         // Windowed operations, at least DERIVED_BUCKETS sweeps; a bucket (the whole window for
+                                // DERIVED_OP_PEAK_HOLD) at most UINT16_MAX sweeps
+    int32_t mul, div, offset;   // DERIVED_OP_SCALE only
+    uint8_t publish;            // DERIVED_PUBLISH(index in the snapshot's derived[]), 0 to only feed other channels
+} derived_desc_t;
+
+typedef struct derived_engine derived_engine_t;
+typedef struct derived_step derived_step_t;
+typedef void (*derived_fn_t)(derived_engine_t *engine, const derived_step_t *step);
+
+/**
+ * @brief One precompiled channel: its evaluator and register indexes.
+ */
+struct derived_step {
+    derived_fn_t fn;
+    const derived_desc_t *desc;
+    uint8_t out;
+    uint8_t a;
+    uint8_t b;
+    uint8_t window;             // Index in `windows`, windowed operations only
+};
+
+/**
+ * @brief State of one rolling or tumbling window, in whole sweeps.
+ */
+typedef struct {
+    int32_t bucket[DERIVED_BUCKETS];    // Extreme of each completed bucket, or a rate's value at its start
+    int32_t completed;                  // Extreme of the completed buckets, kept on each rollover
+    int32_t current;                    // Extreme of the bucket being filled, or a peak hold's window so far
+    int32_t held;                       // A peak hold's last complete window
+    uint16_t bucket_sweeps;
+    uint16_t fill;                      // Sweeps into the current bucket
+    uint8_t head;                       // Next bucket to complete
+    uint8_t filled;                     // Completed buckets, up to DERIVED_BUCKETS
+} derived_window_t;
+
+// Register file: the snapshot's outputs, millivolts and frequencies, the external values, then every derived channel
+#define DERIVED_REG_OUTPUT 0
+#define DERIVED_REG_MV (DERIVED_REG_OUTPUT + SENSOR_SLOT_COUNT)
+#define DERIVED_REG_CAPTURE (DERIVED_REG_MV + SNAPSHOT_NUM_CHANNELS)
+#define DERIVED_REG_EXTERNAL (DERIVED_REG_CAPTURE + SNAPSHOT_NUM_CAPTURE)
+#define DERIVED_REG_CHANNEL (DERIVED_REG_EXTERNAL + DERIVED_MAX_EXTERNAL)
+#define DERIVED_REG_COUNT (DERIVED_REG_CHANNEL + DERIVED_MAX_CHANNELS)
+
+_Static_assert(DERIVED_REG_COUNT <= 256, "Derived registers are indexed by uint8_t");
+
+struct derived_engine {
+    size_t count;
+    uint32_t sweeps_per_s;
+    derived_step_t steps[DERIVED_MAX_CHANNELS];
+    derived_window_t windows[DERIVED_MAX_WINDOWS];
+    uint8_t window_count;
+    uint8_t publish_slot[SNAPSHOT_NUM_DERIVED]; // Snapshot derived[] index of each published channel
+    uint8_t publish_reg[SNAPSHOT_NUM_DERIVED];  // And its register
+    uint8_t publish_count;
+    int32_t regs[DERIVED_REG_COUNT];
+};
+
+extern const derived_desc_t derived_table[];
+extern const size_t derived_table_count;
+
+esp_err_t derivedInit(derived_engine_t *engine, const derived_desc_t *table, size_t count, uint32_t sweep_us);
+void derivedEvaluate(derived_engine_t *engine, sensor_values_t *values, const int32_t *external);
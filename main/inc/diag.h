@@ -0,0 +1,106 @@
+#pragma once
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+#include "sdkconfig.h"
+
+#define DIAG_HIST_SUB_BITS 3                                // 8 buckets per power of two, p99 within 12.5 %
+#define DIAG_HIST_MAX_EXP 20                                // Values from 2^20 us (~1 s) up share the last bucket
+#define DIAG_HIST_BUCKETS ((DIAG_HIST_MAX_EXP - DIAG_HIST_SUB_BITS + 2) << DIAG_HIST_SUB_BITS)
+#define DIAG_FIELD_MAX 0x3FFF                               // Largest value carried in a diagnostics frame field
+
+/**
+ * @brief Hot-path measurements, each aggregated per window into min/avg/p99/max.
+ *
+ * Stage durations are timed with the CPU cycle counter inside one task (so
+ * always on one core); the sample age crosses cores and uses esp_timer.
+ * Everything is in microseconds except the TX queue depth and failures.
+ */
+typedef enum {
+    DIAG_ADC_FILTER,    // Median/IIR filter and calibration of one sweep (adcProcess)
+    DIAG_ADC_CONVERT,   // Engineering conversions of one sweep (adcProcess)
+    DIAG_ADC_LOOP,      // Time between published sweeps (adcProcess)
+    DIAG_CAN_PACK,      // canSchedRun(): pack and queue every due frame (canTransmit)
+    DIAG_CAN_LOOP,      // Wake-up lateness: tick jitter when polling, ticks overslept when event-driven (canTransmit)
+    DIAG_SAMPLE_AGE,    // Sweep sampled to its frame queued on the TWAI driver
+    DIAG_TX_QUEUE,      // Frames waiting in the TWAI TX queue, per transmit wake
+    DIAG_TX_FAILURES,   // twai_transmit() failures per transmit wake
+    DIAG_METRIC_COUNT
+} diag_metric_id_t;
+
+typedef uint32_t (*diag_clock_fn_t)(void);
+
+/**
+ * @brief Aggregate of one window of samples.
+ */
+typedef struct {
+    uint32_t count;
+    uint32_t min;
+    uint32_t max;
+    uint64_t sum;
+    uint16_t hist[DIAG_HIST_BUCKETS];   // Log-linear histogram, saturating counts
+} diag_window_t;
+
+/**
+ * @brief One metric, written by a single task and read by another.
+ *
+ * The writer records into `current`. A reader asks for the window to be
+ * closed by bumping `close_req`; on its next record the writer copies
+ * `current` into `closed`, starts a new window and acknowledges by storing
+ * `close_req` into `close_ack`. Neither side ever blocks, and a metric whose
+ * writer has stopped simply never acknowledges.
+ */
+typedef struct {
+    diag_window_t current;
+    diag_window_t closed;
+    atomic_uint close_req;
+    atomic_uint close_ack;
+    uint64_t total;         // Samples since boot
+} diag_metric_t;
+
+/**
+ * @brief Statistics of a closed window, as broadcast and printed.
+ */
+typedef struct {
+    uint32_t count;
+    uint32_t min;
+    uint32_t avg;
+    uint32_t p99;
+    uint32_t max;
+} diag_report_t;
+
+typedef struct {
+    diag_metric_t metrics[DIAG_METRIC_COUNT];
+    diag_clock_fn_t clock;
+    uint32_t cycles_per_us;
+    atomic_uint report_seq;                     // Odd while `reports` is being updated
+    diag_report_t reports[DIAG_METRIC_COUNT];   // Latest closed window per metric
+} diag_t;
+
+esp_err_t diagInit(diag_t *diag, diag_clock_fn_t clock, uint32_t cycles_per_us);
+void diagRecord(diag_t *diag, diag_metric_id_t metric, uint32_t value);
+bool diagCollect(diag_t *diag, diag_metric_id_t metric, diag_report_t *report);
+void diagReports(diag_t *diag, diag_report_t reports[DIAG_METRIC_COUNT]);
+uint32_t diagPercentile(const diag_window_t *window, uint32_t permille);
+const char *diagMetricName(diag_metric_id_t metric);
+
+/**
+ * @brief Converts a cycle count delta to whole microseconds.
+ */
+static inline uint32_t diagCyclesToUs(const diag_t *diag, uint32_t cycles) { return cycles / diag->cycles_per_us; }
+
+// Instrumentation points. With CONFIG_CANBOARD_DIAG disabled they expand to
+// nothing, so the hot paths compile exactly as without them.
+#if CONFIG_CANBOARD_DIAG
+extern diag_t diag;
+#define DIAG_STAMP(name) const uint32_t name = diag.clock()
+#define DIAG_SINCE(metric, name) diagRecord(&diag, (metric), diagCyclesToUs(&diag, diag.clock() - (name)))
+#define DIAG_RECORD(metric, value) diagRecord(&diag, (metric), (value))
+#else
+#define DIAG_STAMP(name)
+#define DIAG_SINCE(metric, name) ((void)0)
+#define DIAG_RECORD(metric, value) ((void)0)
+#endif
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define FAULT_SET_MS 20         // Net time an input must be wrong for a fault to latch, except an implausible step
+#define FAULT_CLEAR_MS 500      // Fault-free time before a channel is trusted again
+#define FAULT_HYST_MV 100       // A latched rail fault clears only this far back inside the window
+#define FAULT_PINNED_CODE 4095  // Every sample at full scale is the high rail, whatever the millivolts say
+
+/**
+ * @brief What is wrong with an input, as carried in the sensorStatus frame (3 bits).
+ *
+ * A pull-down input that is open reads the same as one shorted to ground,
+ * and a pull-up input that is open the same as one shorted to its supply,
+ * so both are reported as open.
+ */
+typedef enum {
+    FAULT_NONE = 0,
+    FAULT_OPEN,         // At the rail an open input floats to (or shorted to it)
+    FAULT_SHORT_GND,    // Below the window on a pull-up input
+    FAULT_SHORT_5V,     // Above the window on a pull-down input
+    FAULT_STUCK,        // Not a single code of change for `stuck_ms`
+    FAULT_NOISE,        // Peak-to-peak within a sweep above `noise_mv`
+    FAULT_RATE,         // Filtered value moved faster than the sensor can
+    FAULT_COUNT
+} fault_code_t;
+
+/**
+ * @brief Plausibility limits of one input, in divider-scaled (sensor side) millivolts.
+ *
+ * Every check is disabled by a zero limit, so an unused input never faults.
+ */
+typedef struct {
+    uint16_t low_mv;            // Readings below are at the low rail
+    uint16_t high_mv;           // Readings above, or pinned at full scale, are at the high rail
+    bool open_high;             // An open input floats high (pull-up, e.g. an NTC), otherwise low
+    uint16_t noise_mv;          // Largest peak-to-peak of one sweep's samples
+    uint16_t rate_mv_per_ms;    // Largest plausible rate of change of the filtered value
+    uint16_t stuck_ms;          // Longest time the raw code may not move at all
+    int32_t failsafe;           // Output substituted while faulted, in the slot's units
+} fault_limits_t;
+
+/**
+ * @brief What one sweep of a channel looked like.
+ */
+typedef struct {
+    uint16_t mv;                // Filtered, divider-scaled millivolts
+    uint16_t min_code;          // Smallest and largest fresh raw code, min > max if there were none
+    uint16_t max_code;
+    bool updated;               // The filter produced a new output (always, except between oversampled blocks)
+} fault_input_t;
+
+/**
+ * @brief Per-channel classifier state, with the limits converted to sweeps and codes.
+ */
+typedef struct {
+    uint16_t noise_codes;       // noise_mv in raw codes, 0 disables
+    uint16_t rate_step_mv;      // Largest change between two filter outputs, 0 disables
+    uint16_t stuck_sweeps;      // 0 disables
+    uint16_t set_sweeps;
+    uint16_t clear_sweeps;
+    uint16_t flat_sweeps;       // Consecutive sweeps on `flat_code` alone
+    uint16_t flat_code;
+    uint16_t last_mv;           // Filter output at the last update
+    bool primed;                // `last_mv` holds a real output
+    uint8_t code;               // Latched fault_code_t
+    uint8_t pending;            // Latest classification, and for how many sweeps in a row
+    uint16_t pending_count;
+    uint16_t set_count;         // Up on every wrong sweep, down on every right one, latches at `set_sweeps`
+    uint16_t clear_count;       // Right sweeps in a row while latched
+} fault_state_t;
+
+void faultInit(fault_state_t *state, const fault_limits_t *limits, float mv_per_code, uint32_t update_us, uint32_t sweep_us);
+fault_code_t faultUpdate(fault_state_t *state, const fault_limits_t *limits, const fault_input_t *in);
+const char *faultName(fault_code_t code);
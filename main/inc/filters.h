@@ -0,0 +1,56 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+
+#define FILTER_MAX_DEPTH 31
+#define OVERSAMPLE_MIN_RATIO 4
+#define OVERSAMPLE_MAX_RATIO 256
+#define OVERSAMPLE_FRAC_BITS 8      // Fractional bits of the decimated output, more than any ratio resolves
+
+/**
+ * @brief Streaming filter for one input: sliding median, then optional
+ *        first-order IIR, then optional rate-of-change (slew) limit.
+ *
+ * Every stage keeps its state between samples, so the filter can be fed at
+ * the full ADC rate and the output is always current. The median keeps its
+ * window sorted and moves only the replaced element, so for a slowly moving
+ * signal an update touches one or two entries.
+ */
+typedef struct {
+    uint16_t history[FILTER_MAX_DEPTH];  // Window in arrival order (circular)
+    uint16_t sorted[FILTER_MAX_DEPTH];   // Same window, ascending
+    uint8_t depth;
+    uint8_t count;
+    uint8_t head;
+    uint16_t alpha_q16;                  // IIR weight of a new sample, 0 disables the stage
+    uint16_t slew_limit;                 // Max change per sample, 0 disables the stage
+    int64_t iir_q16;
+    uint16_t output;
+} stream_filter_t;
+
+/**
+ * @brief Accumulate-and-decimate oversampler for one input.
+ *
+ * Sums `ratio` consecutive samples and emits their mean with
+ * OVERSAMPLE_FRAC_BITS fractional bits, once per block. With at least
+ * ~0.5 LSB of noise on the input, each 4x of ratio adds one effective bit
+ * (16x: +2, 64x: +3), at 1/ratio of the sample rate.
+ */
+typedef struct {
+    uint32_t acc;
+    uint16_t count;
+    uint16_t ratio;
+    uint8_t shift;                      // log2(ratio)
+    uint32_t output_q;                  // Mean of the last full block, in 1/2^OVERSAMPLE_FRAC_BITS codes
+    uint32_t blocks;                    // Blocks emitted
+} oversampler_t;
+
+esp_err_t filterInit(stream_filter_t *filter, uint8_t depth, float iir_alpha, uint16_t slew_limit);
+void filterReset(stream_filter_t *filter);
+uint16_t filterMedian(const stream_filter_t *filter);
+uint16_t filterPush(stream_filter_t *filter, uint16_t sample);
+esp_err_t oversampleInit(oversampler_t *os, uint16_t ratio);
+bool oversamplePush(oversampler_t *os, uint16_t sample);
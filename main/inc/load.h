@@ -0,0 +1,64 @@
+#pragma once
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "sdkconfig.h"
+#include "inc/tasks.h"
+
+#define LOAD_CORES 2
+#define LOAD_PERIOD_MS 1000         // Load window, one sample per window
+#define LOAD_STACK_MARGIN 512       // A task with less stack than this never touched is flagged
+
+_Static_assert(TASK_COUNT <= 8, "The systemLoad frame flags low stacks in 8 bits");
+
+/**
+ * @brief Raw counters read once per window by the load monitor.
+ *
+ * Run times are FreeRTOS run-time counters (esp_timer microseconds on the
+ * target), which wrap; only differences between samples are used.
+ */
+typedef struct {
+    uint32_t now;                       // Run-time clock
+    uint32_t running;                   // Bit per task read into this sample
+    uint32_t runtime[TASK_COUNT];       // Run-time counter per task
+    uint32_t stack_free[TASK_COUNT];    // Bytes of stack never touched since the task started
+    uint32_t idle_runtime[LOAD_CORES];  // Run-time counter of each core's idle task
+    uint32_t heap_free;
+    uint32_t heap_min_free;             // Lowest free heap since boot
+    uint32_t heap_largest;              // Largest block that can be allocated
+} load_sample_t;
+
+/**
+ * @brief Load over the last window, as broadcast and printed.
+ */
+typedef struct {
+    uint32_t window;                    // Run-time clock ticks covered, 0 before the second sample
+    uint32_t running;                   // Bit per task with a report
+    uint32_t low_stack;                 // Bit per task with less than LOAD_STACK_MARGIN free
+    uint16_t cpu_permille[TASK_COUNT];  // Share of one core
+    uint32_t stack_free[TASK_COUNT];
+    uint16_t core_permille[LOAD_CORES]; // Share of each core outside its idle task, interrupts included
+    uint32_t heap_free;
+    uint32_t heap_min_free;
+    uint32_t heap_largest;
+} load_report_t;
+
+/**
+ * @brief Load state, written by the load monitor and read by the CAN packers and console dump.
+ */
+typedef struct {
+    load_sample_t last;
+    bool primed;                        // `last` holds a sample
+    atomic_uint report_seq;             // Odd while `report` is being updated
+    load_report_t report;
+} load_t;
+
+void loadInit(load_t *load);
+bool loadUpdate(load_t *load, const load_sample_t *sample);
+void loadReport(load_t *load, load_report_t *report);
+
+#if CONFIG_CANBOARD_DIAG
+extern load_t task_load;
+#endif
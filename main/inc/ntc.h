@@ -0,0 +1,66 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+
+#define PULLUP_VREF_MV 5025
+#define NTC_PULLUP_OHMS 2400
+#define NTC_TABLE_SIZE(x) (sizeof(x) / sizeof((x)[0]))
+#define NTC_TABLE_MAX_POINTS 64
+#define NTC_LUT_SUBDIVISIONS 5      // Breakpoints per table segment, must divide 10
+#define NTC_LUT_MAX_POINTS 320
+#define NTC_LUT_INVALID ((int16_t)-1280) // -128.0°C, matches the legacy error value
+
+_Static_assert(10 % NTC_LUT_SUBDIVISIONS == 0, "NTC_LUT_SUBDIVISIONS must divide 10 for exact deci-°C breakpoints");
+_Static_assert((NTC_TABLE_MAX_POINTS - 1) * NTC_LUT_SUBDIVISIONS + 1 <= NTC_LUT_MAX_POINTS, "NTC lookup too small");
+
+typedef struct {
+    int16_t temp_c;      // Temperature in °C
+    int32_t resistance;  // Resistance in ohms
+} ntc_point_t;
+
+/**
+ * @brief Precomputed millivolt -> deci-°C lookup for one sensor and divider.
+ *
+ * Breakpoints are stored in ascending millivolts with a Q16 slope per
+ * segment, so a lookup is a binary search plus one multiply and shift. Each
+ * table segment is split into NTC_LUT_SUBDIVISIONS pieces along its
+ * resistance, so the piecewise-linear voltage curve tracks the table's
+ * resistance interpolation closely.
+ */
+typedef struct {
+    uint16_t mv[NTC_LUT_MAX_POINTS];
+    int16_t deci_c[NTC_LUT_MAX_POINTS];
+    int32_t slope_q16[NTC_LUT_MAX_POINTS];  // deci-°C per mV for segment [i, i + 1]
+    uint16_t count;
+    uint8_t dropped;                        // Table points rejected as non-monotonic
+    uint16_t v_ref_mv;
+} ntc_lut_t;
+
+esp_err_t ntcLutBuild(ntc_lut_t *lut, const ntc_point_t *table, size_t table_size, int r_pullup, int v_ref_mv);
+int16_t ntcLutLookup(const ntc_lut_t *lut, int v_mv);
+int8_t getSensorTemperature(int v_mv, int r_pullup, int v_ref_mv, const ntc_point_t *table, size_t table_size);
+
+static const ntc_point_t ntc_table[] = { // Bosch 0280130026, Bosch 0280130039
+    { -40, 45313 }, { -30, 26114 }, { -20, 15462 }, { -10,  9397 },
+    {   0,  5896 }, {  10,  3792 }, {  20,  2500 }, {  30,  1707 },
+    {  40,  1175 }, {  50,   834 }, {  60,   596 }, {  70,   436 },
+    {  80,   323 }, {  90,   243 }, { 100,   187 }, { 110,   144 },
+    { 120,   113 }, { 130,    89 }, { 140,    71 }
+};
+
+static const ntc_point_t tmap_table[] = { // BMW TMAP 13627843531
+    {   0,  4094 }, {  5,  3362 }, { 10,  2854 }, { 15,  2425 }, { 20,  2039 },
+    { 25,  1745 }, { 30,  1489 }, { 35,  1291 }, { 40,  1110 }, { 45,   950 },
+    { 50,   710 }, { 51,   698 }, { 52,   692 }, { 53,   687 }, { 54,   634 },
+    { 55,   691 }, { 56,   707 }, { 57,   724 }, { 58,   687 }, { 59,   528 },
+    { 60,   500 }, { 61,   492 }, { 62,   472 }, { 63,   468 }, { 64,   464 },
+    { 65,   458 }, { 66,   444 }, { 67,   427 }, { 68,   421 }, { 69,   416 },
+    { 70,   411 }, { 71,   398 }, { 72,   385 }, { 73,   375 }, { 74,   366 },
+    { 75,   362 }, { 76,   359 }, { 77,   344 }, { 78,   335 }, { 79,   341 },
+    { 80,   358 }, { 81,   332 }, { 82,   323 }, { 83,   326 }, { 84,   328 },
+    { 85,   321 }, { 90,   284 }, { 95,   252 }, {100,   225 }, {105,   200 },
+    {110,   178 }, {115,   159 }, {120,   142 }
+};
\ No newline at end of file
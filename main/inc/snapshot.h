@@ -0,0 +1,67 @@
+#pragma once
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#define SNAPSHOT_NUM_CHANNELS 10
+#define SNAPSHOT_ALL_CHANNELS ((1u << SNAPSHOT_NUM_CHANNELS) - 1)
+#define SNAPSHOT_NUM_DERIVED 8
+#define SNAPSHOT_NUM_CAPTURE 2
+
+/**
+ * @brief Engineering outputs carried in the snapshot and on the bus.
+ *
+ * Pressures are x100 in the unit noted, temperatures are in 0.1°C. Which
+ * input feeds which slot is set by the channel descriptor table.
+ */
+typedef enum {
+    SENSOR_SLOT_NONE = -1,
+    SENSOR_SLOT_CC_INLET_PRESSURE = 0,  // kPa
+    SENSOR_SLOT_EXHAUST_BACK_PRESSURE,  // psi
+    SENSOR_SLOT_CRANK_CASE_PRESSURE,    // kPa
+    SENSOR_SLOT_TURBO_OIL_PRESSURE,     // bar
+    SENSOR_SLOT_CC_WATER_TEMP,
+    SENSOR_SLOT_AIR_TEMP,
+    SENSOR_SLOT_CC_INLET_TEMP,
+    SENSOR_SLOT_COUNT
+} sensor_slot_t;
+
+/**
+ * @brief One complete sweep of sensor data, as published by the ADC task.
+ */
+typedef struct {
+    uint64_t timestamp_us;                              // Time the sweep's last samples were read
+    uint32_t sweep;                                     // Sweep counter, increments once per publish
+    uint32_t changed_sweep[SNAPSHOT_NUM_CHANNELS];      // Last sweep that moved each channel past its deadband, 0 if none
+    uint32_t valid;                                     // Bit n set once channel n's filter is primed (full window or first block)
+    uint32_t faulted;                                   // Bit n set while channel n has a latched fault and outputs its failsafe
+    uint16_t raw[SNAPSHOT_NUM_CHANNELS];                // Median raw ADC code per channel
+    uint16_t filtered_mv[SNAPSHOT_NUM_CHANNELS];        // Filtered, divider-scaled millivolts per channel
+    uint8_t filtered_frac[SNAPSHOT_NUM_CHANNELS];       // Sub-millivolt part of filtered_mv in 1/256 mV, oversampled channels only
+    uint8_t fault[SNAPSHOT_NUM_CHANNELS];               // Latched fault_code_t per channel
+    int32_t outputs[SENSOR_SLOT_COUNT];                 // Engineering values, see sensor_slot_t
+    int32_t derived[SNAPSHOT_NUM_DERIVED];              // Published derived channels, see derived_table
+    uint32_t capture_freq[SNAPSHOT_NUM_CAPTURE];        // Frequency inputs in 0.01 Hz, see capture_table
+    uint16_t capture_duty[SNAPSHOT_NUM_CAPTURE];        // Their duty in 0.1 %
+    int8_t cpu_temperature;                             // On-die temperature in °C
+} sensor_values_t;
+
+#define SNAPSHOT_WORDS ((sizeof(sensor_values_t) + sizeof(uint32_t) - 1) / sizeof(uint32_t))
+
+/**
+ * @brief Single-writer, multi-reader sequence lock around sensor_values_t.
+ *
+ * The writer never blocks and readers never block the writer; a reader that
+ * overlaps a publish simply retries. The payload is stored as relaxed atomic
+ * words so concurrent access is well-defined on both cores and on the host.
+ */
+typedef struct {
+    atomic_uint_least32_t seq;
+    atomic_uint_least32_t words[SNAPSHOT_WORDS];
+} sensor_snapshot_t;
+
+void snapshotInit(sensor_snapshot_t *snap);
+void snapshotPublish(sensor_snapshot_t *snap, const sensor_values_t *values);
+uint32_t snapshotRead(sensor_snapshot_t *snap, sensor_values_t *out);
+uint32_t snapshotVersion(sensor_snapshot_t *snap);
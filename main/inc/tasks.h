@@ -0,0 +1,55 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "sdkconfig.h"
+
+#define TASK_ANY_CORE -1    // Left to the scheduler (tskNO_AFFINITY)
+
+/**
+ * @brief Every task the firmware starts, in the order app_main starts them.
+ *
+ * The index is also the task number carried in the taskLoad frame (0x62B).
+ */
+typedef enum {
+    TASK_INIT_INPUTS,       // Brings up the inputs at boot, then deletes itself
+    TASK_CAN_TRANSMIT,
+    TASK_CAN_SUPERVISOR,
+    TASK_CAN_RECEIVE,
+    TASK_CAN_LOGGER,
+    TASK_ADC_PROCESS,
+    TASK_DIAG_DUMP,         // CONFIG_CANBOARD_DIAG only
+    TASK_LOAD_MONITOR,      // CONFIG_CANBOARD_DIAG only
+    TASK_COUNT
+} task_id_t;
+
+/**
+ * @brief Where one task runs: its core, priority and stack size.
+ *
+ * With CONFIG_CANBOARD_STATIC_ALLOCATION a task whose `stack` is set runs
+ * on that buffer and control block instead of heap; see TASK_STACK in
+ * task_config.c.
+ */
+typedef struct {
+    const char *name;
+    uint32_t stack_bytes;
+    uint8_t priority;
+    int8_t core;            // 0 or 1, or TASK_ANY_CORE
+    bool transient;         // Deletes itself once done, so it is never monitored
+#if CONFIG_CANBOARD_STATIC_ALLOCATION
+    StackType_t *stack;     // stack_bytes of static stack, NULL to take it from the heap
+    StaticTask_t *tcb;
+#endif
+} task_placement_t;
+
+extern const task_placement_t task_placement[TASK_COUNT];
+extern TaskHandle_t task_handles[TASK_COUNT];  // Running tasks, NULL for transient or not started
+
+esp_err_t taskStart(task_id_t id, TaskFunction_t fn, void *arg);
+#if CONFIG_CANBOARD_DIAG
+void loadMonitor(void *arg);
+#endif
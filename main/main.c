@@ -13,25 +13,89 @@
 #include "esp_err.h"
 #include "esp_log.h"
 #include "esp_system.h"
+#include "esp_cpu.h"
+#include "esp_timer.h"
 #include "driver/gpio.h"
 #include "driver/twai.h"
 
 #define USB_PRESENCE_DETECT GPIO_NUM_38
 
 #include "inc/inputs.h"
+#include "inc/boot.h"
 #include "inc/can.h"
+#include "inc/config_store.h"
+#include "inc/diag.h"
+#include "inc/load.h"
+#include "inc/tasks.h"
+
+#define BOOT_REPORT_TIMEOUT_MS 2000
+
+static const char *boot_log = "boot";
+
+#if CONFIG_CANBOARD_DIAG
+static uint32_t cpuCycles(void) { return esp_cpu_get_cycle_count(); }
+#endif
+
+/**
+ * @brief Brings up the analog inputs on core 1, then wakes app_main.
+ *
+ * @param arg The task to notify when the inputs are ready
+ */
+static void initInputsTask(void *arg)
+{
+    initInputs();
+    xTaskNotifyGive((TaskHandle_t)arg);
+    vTaskDelete(NULL);
+}
+
+/**
+ * @brief Waits for the boot milestones, then logs when each step started and ended.
+ *
+ * Gives up after BOOT_REPORT_TIMEOUT_MS (an input that never becomes
+ * valid, say) and logs the steps reached so far.
+ */
+static void logBootTimeline(void)
+{
+    TickType_t deadline = xTaskGetTickCount() + pdMS_TO_TICKS(BOOT_REPORT_TIMEOUT_MS);
+    while ((!bootReached(&boot_timeline, BOOT_STEP_VALID_FRAME) || !bootReached(&boot_timeline, BOOT_STEP_CAN_LOG)) &&
+           (int32_t)(deadline - xTaskGetTickCount()) > 0) {
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+
+    for (boot_step_t step = 0; step < BOOT_STEP_COUNT; step++) {
+        uint32_t start = bootStartUs(&boot_timeline, step), end = bootEndUs(&boot_timeline, step);
+        if (end == 0) {
+            ESP_LOGW(boot_log, "%-13s not reached", bootStepName(step));
+        } else if (start == 0) {
+            ESP_LOGI(boot_log, "%-13s at %8.3f ms", bootStepName(step), end / 1000.0);
+        } else {
+            ESP_LOGI(boot_log, "%-13s %8.3f ms to %8.3f ms (%.3f ms)", bootStepName(step), start / 1000.0, end / 1000.0,
+                     (end - start) / 1000.0);
+        }
+    }
+    if (bootReached(&boot_timeline, BOOT_STEP_VALID_FRAME)) {
+        ESP_LOGI(boot_log, "First Frame at %.3f ms, First Valid Frame at %.3f ms",
+                 bootEndUs(&boot_timeline, BOOT_STEP_FIRST_FRAME) / 1000.0, bootEndUs(&boot_timeline, BOOT_STEP_VALID_FRAME) / 1000.0);
+    }
+}
 
 void app_main(void)
 {
-    initCpuTempSensor();
-    ESP_LOGI(adc_log, "Current CPU Temperature: %u°C", getCpuTemperature());
+#if CONFIG_CANBOARD_DIAG
+    ESP_ERROR_CHECK(diagInit(&diag, cpuCycles, CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ));
+    loadInit(&task_load);
+#endif
+    // Runtime configuration first: the sensor pipeline and CAN schedule are built from it
+    BOOT_START(BOOT_STEP_CONFIG);
+    ESP_ERROR_CHECK(initConfigStore());
+    BOOT_END(BOOT_STEP_CONFIG);
+    snapshotInit(&sensor_snapshot);
 
-    initAdcChannels();
-    //for(int i = 0; i <= 9; i++){ // Display voltage readings on initial startup.
-    //    ESP_LOGI(adc_log, "ADC %u, GPIO %u: %u mV", i, i+1, getScaledMillivolts(i, false));
-    //    ESP_LOGI(adc_log, "ADC %u, GPIO %u: %u mV (Scaled 0-5v)", i, i+1, getScaledMillivolts(i, true));
-    //}
+    // Inputs come up on Core 1 while CAN comes up here on Core 0 (cores, priorities and stacks are in task_placement)
+    ESP_ERROR_CHECK(taskStart(TASK_INIT_INPUTS, initInputsTask, xTaskGetCurrentTaskHandle()));
 
+    BOOT_START(BOOT_STEP_CAN);
+    ESP_ERROR_CHECK(initCanRx());
     if(twai_driver_install_v2(&can_config, &t_can_config, &f_config, &twai_can) == ESP_OK){
         ESP_LOGI(can_log, "TWAI Driver Installed");
         if(twai_start_v2(twai_can) == ESP_OK){
@@ -44,20 +108,32 @@ void app_main(void)
         ESP_LOGI(can_log, "Failed to Install TWAI Driver!");
         abort();
     }
+    ESP_ERROR_CHECK(initCanTx());
+    BOOT_END(BOOT_STEP_CAN);
 
-    filtered_voltages_mutex = xSemaphoreCreateMutex();
-    scaled_pressures_mutex = xSemaphoreCreateMutex();
-    if (filtered_voltages_mutex == NULL || scaled_pressures_mutex == NULL) {
-        ESP_LOGE(adc_log, "Failed to create mutexes! Aborting...");
-        abort();
-    }
+    // Transmit CAN on Core 0, supervised: bus-off recovery, error state and TX back-pressure.
+    // The board status frame goes out straight away; frames carrying inputs wait until they are valid.
+    ESP_ERROR_CHECK(taskStart(TASK_CAN_TRANSMIT, canTransmit, NULL));
+    ESP_ERROR_CHECK(taskStart(TASK_CAN_SUPERVISOR, canSupervisor, task_handles[TASK_CAN_TRANSMIT]));
+
+    // Receive and dispatch CAN on Core 0, reception outranks transmission so the RX queue never fills.
+    // Received frames are also logged to flash once the logger has mounted the canlog partition.
+    ESP_ERROR_CHECK(taskStart(TASK_CAN_RECEIVE, canReceive, NULL));
+    ESP_ERROR_CHECK(taskStart(TASK_CAN_LOGGER, canLogger, NULL));
 
-    // Process ADCs on Core 1
-    xTaskCreatePinnedToCore(adcProcess, "adcProcess", 4096, NULL, 5, NULL, 1);
+    // Process ADCs and publish converted sweeps on Core 1 once the inputs are up, waking the transmit task when a channel changes
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+#if CONFIG_CANBOARD_CAN_TX_EVENT_DRIVEN
+    ESP_ERROR_CHECK(taskStart(TASK_ADC_PROCESS, adcProcess, task_handles[TASK_CAN_TRANSMIT]));
+#else
+    ESP_ERROR_CHECK(taskStart(TASK_ADC_PROCESS, adcProcess, NULL));
+#endif
 
-    // Process Pressures on Core 0
-    xTaskCreatePinnedToCore(pressureProcess, "pressureProcess", 4096, NULL, 5, NULL, 0);
-   
-    // Transmit CAN on Core 0
-    xTaskCreatePinnedToCore(canTransmit, "canTransmit", 4096, NULL, 10, NULL, 0);
+#if CONFIG_CANBOARD_DIAG
+    // Print the instrumentation windows at low priority, the same windows the diagnostics frame carries,
+    // and measure every task's CPU time and stack, each core's idle time and the heap once a second
+    ESP_ERROR_CHECK(taskStart(TASK_DIAG_DUMP, diagDump, NULL));
+    ESP_ERROR_CHECK(taskStart(TASK_LOAD_MONITOR, loadMonitor, NULL));
+#endif
+    logBootTimeline();
 }
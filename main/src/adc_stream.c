@@ -0,0 +1,150 @@
+#include <stdint.h>
+#include <string.h>
+
+#include "esp_err.h"
+#include "inc/adc_stream.h"
+
+/**
+ * @brief Initializes a continuous ADC acquisition engine.
+ *
+ * The engine owns a single DMA frame buffer and a small per-channel ring of
+ * raw conversion results. It does not start the underlying source; call
+ * adcStreamStart() once the HAL is ready.
+ *
+ * @param stream The engine state to initialize
+ * @param hal The hardware abstraction supplying result words
+ * @param unit The ADC unit whose results are accepted, others are discarded
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_INVALID_ARG if the stream, HAL or HAL read callback is NULL
+ */
+esp_err_t adcStreamInit(adc_stream_t *stream, const adc_stream_hal_t *hal, uint8_t unit) {
+    if (stream == NULL || hal == NULL || hal->read == NULL) return ESP_ERR_INVALID_ARG;
+
+    memset(stream, 0, sizeof(*stream));
+    stream->hal = hal;
+    stream->unit = unit;
+    return ESP_OK;
+}
+
+/**
+ * @brief Starts the underlying continuous ADC source.
+ */
+esp_err_t adcStreamStart(adc_stream_t *stream) {
+    if (stream == NULL || stream->hal == NULL) return ESP_ERR_INVALID_ARG;
+    return (stream->hal->start != NULL) ? stream->hal->start(stream->hal->ctx) : ESP_OK;
+}
+
+/**
+ * @brief Stops the underlying continuous ADC source.
+ */
+esp_err_t adcStreamStop(adc_stream_t *stream) {
+    if (stream == NULL || stream->hal == NULL) return ESP_ERR_INVALID_ARG;
+    return (stream->hal->stop != NULL) ? stream->hal->stop(stream->hal->ctx) : ESP_OK;
+}
+
+/**
+ * @brief Reads one DMA frame from the HAL and demultiplexes it.
+ *
+ * Blocks for at most `timeout_ms` waiting for the source to deliver a frame.
+ * A timeout is counted but is not treated as a fault, so the caller can keep
+ * polling without special handling.
+ *
+ * @param stream The engine state
+ * @param timeout_ms Maximum time to wait for a frame in milliseconds
+ * @return
+ *      - ESP_OK if a frame was read and demultiplexed
+ *      - ESP_ERR_TIMEOUT if no data was available in time
+ *      - Error code from the HAL read callback otherwise
+ */
+esp_err_t adcStreamPoll(adc_stream_t *stream, uint32_t timeout_ms) {
+    uint32_t len = 0;
+    esp_err_t err = stream->hal->read(stream->hal->ctx, stream->frame, sizeof(stream->frame), &len, timeout_ms);
+    if (err == ESP_ERR_TIMEOUT || (err == ESP_OK && len == 0)) {
+        stream->stats.timeouts++;
+        return ESP_ERR_TIMEOUT;
+    }
+    if (err != ESP_OK) return err;
+
+    stream->stats.frames++;
+    adcStreamDemux(stream, stream->frame, len);
+    return ESP_OK;
+}
+
+/**
+ * @brief Splits a buffer of TYPE2 result words into the per-channel rings.
+ *
+ * Trailing bytes that do not form a whole result word are ignored. Words from
+ * another ADC unit or an out-of-range channel are counted and dropped.
+ *
+ * @param stream The engine state
+ * @param buf The raw result words, as delivered by the DMA engine
+ * @param len The number of valid bytes in `buf`
+ */
+void adcStreamDemux(adc_stream_t *stream, const uint8_t *buf, uint32_t len) {
+    for (uint32_t i = 0; i + ADC_STREAM_RESULT_BYTES <= len; i += ADC_STREAM_RESULT_BYTES) {
+        uint32_t word;
+        memcpy(&word, &buf[i], sizeof(word));
+
+        uint8_t ch = ADC_STREAM_WORD_CHANNEL(word);
+        if (ADC_STREAM_WORD_UNIT(word) != stream->unit || ch >= ADC_STREAM_NUM_CHANNELS) {
+            stream->stats.discarded++;
+            continue;
+        }
+
+        uint8_t head = stream->head[ch];
+        stream->ring[ch][head] = ADC_STREAM_WORD_DATA(word);
+        stream->head[ch] = (head + 1) & (ADC_STREAM_RING_DEPTH - 1);
+        if (stream->fresh[ch] < UINT8_MAX) stream->fresh[ch]++;
+        stream->stats.samples++;
+    }
+}
+
+/**
+ * @brief Returns true once every channel has `ADC_STREAM_SWEEP_SAMPLES` fresh samples.
+ */
+bool adcStreamSweepReady(const adc_stream_t *stream) {
+    for (int ch = 0; ch < ADC_STREAM_NUM_CHANNELS; ch++) {
+        if (stream->fresh[ch] < ADC_STREAM_SWEEP_SAMPLES) return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Marks the current sweep as consumed so the next one can be detected.
+ */
+void adcStreamSweepConsume(adc_stream_t *stream) {
+    memset(stream->fresh, 0, sizeof(stream->fresh));
+    stream->stats.sweeps++;
+}
+
+/**
+ * @brief Returns how many samples a channel has received since the last consumed sweep.
+ *
+ * The count saturates at the ring depth, as older samples have been overwritten.
+ */
+uint8_t adcStreamFresh(const adc_stream_t *stream, int channel) {
+    if (channel < 0 || channel >= ADC_STREAM_NUM_CHANNELS) return 0;
+    return (stream->fresh[channel] > ADC_STREAM_RING_DEPTH) ? ADC_STREAM_RING_DEPTH : stream->fresh[channel];
+}
+
+/**
+ * @brief Copies the most recent samples for a channel, newest last.
+ *
+ * @param stream The engine state
+ * @param channel The ADC channel to copy
+ * @param out Destination buffer
+ * @param count Number of samples requested, clamped to the ring depth
+ * @return The number of samples written to `out`
+ */
+size_t adcStreamLatest(const adc_stream_t *stream, int channel, uint16_t *out, size_t count) {
+    if (channel < 0 || channel >= ADC_STREAM_NUM_CHANNELS || out == NULL) return 0;
+    if (count > ADC_STREAM_RING_DEPTH) count = ADC_STREAM_RING_DEPTH;
+
+    uint8_t idx = (stream->head[channel] - count) & (ADC_STREAM_RING_DEPTH - 1);
+    for (size_t i = 0; i < count; i++) {
+        out[i] = stream->ring[channel][idx];
+        idx = (idx + 1) & (ADC_STREAM_RING_DEPTH - 1);
+    }
+    return count;
+}
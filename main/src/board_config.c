@@ -0,0 +1,492 @@
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "esp_err.h"
+#include "inc/board_config.h"
+#include "inc/can_log.h"
+#include "inc/can_signals.h"
+
+#define CHANNEL_FIELD(f) offsetof(board_config_t, channels[0].f)
+
+/**
+ * @brief The runtime parameters, in wire ID order.
+ *
+ * Ranges are checked on every write and on load; values that depend on each
+ * other are checked by boardConfigValidate().
+ */
+const board_param_t board_params[] = {
+    { BOARD_PARAM_CAN_BASE_ID,  "can_base_id",   BOARD_PARAM_U16, BOARD_PARAM_SCALAR,      offsetof(board_config_t, can_base_id),
+      0x100, 0x7F0, true },
+    { BOARD_PARAM_TX_PERIOD,    "tx_period_ms",  BOARD_PARAM_U16, BOARD_PARAM_PER_MESSAGE, offsetof(board_config_t, tx_period_ms),
+      CAN_SCHED_TICK_MS, 10000, false },
+    { BOARD_PARAM_DIVIDER,      "divider_x1000", BOARD_PARAM_U16, BOARD_PARAM_PER_CHANNEL, CHANNEL_FIELD(divider_x1000), 1000, 10000, false },
+    { BOARD_PARAM_FILTER_DEPTH, "filter_depth",  BOARD_PARAM_U8,  BOARD_PARAM_PER_CHANNEL, CHANNEL_FIELD(filter_depth), 1, FILTER_MAX_DEPTH, false },
+    { BOARD_PARAM_DEADBAND,     "deadband_mv",   BOARD_PARAM_U16, BOARD_PARAM_PER_CHANNEL, CHANNEL_FIELD(deadband_mv), 0, 5000, false },
+    { BOARD_PARAM_V_MIN,        "v_min_mv",      BOARD_PARAM_I16, BOARD_PARAM_PER_CHANNEL, CHANNEL_FIELD(v_min_mv), 0, 5000, false },
+    { BOARD_PARAM_V_MAX,        "v_max_mv",      BOARD_PARAM_I16, BOARD_PARAM_PER_CHANNEL, CHANNEL_FIELD(v_max_mv), 0, 5000, false },
+    { BOARD_PARAM_OUT_MIN,      "out_min_x100",  BOARD_PARAM_I32, BOARD_PARAM_PER_CHANNEL, CHANNEL_FIELD(out_min_x100), -65535, 65535, false },
+    { BOARD_PARAM_OUT_MAX,      "out_max_x100",  BOARD_PARAM_I32, BOARD_PARAM_PER_CHANNEL, CHANNEL_FIELD(out_max_x100), -65535, 65535, false },
+};
+
+const size_t board_params_count = sizeof(board_params) / sizeof(board_params[0]);
+
+static void putLe16(uint8_t *p, uint16_t v) { p[0] = (uint8_t)v; p[1] = (uint8_t)(v >> 8); }
+static void putLe32(uint8_t *p, uint32_t v) { putLe16(p, (uint16_t)v); putLe16(p + 2, (uint16_t)(v >> 16)); }
+static uint16_t getLe16(const uint8_t *p) { return (uint16_t)(p[0] | p[1] << 8); }
+static uint32_t getLe32(const uint8_t *p) { return getLe16(p) | (uint32_t)getLe16(p + 2) << 16; }
+
+static int32_t roundX(float value, float scale) {
+    float scaled = value * scale;
+    return (int32_t)(scaled >= 0.0f ? scaled + 0.5f : scaled - 0.5f);
+}
+
+/**
+ * @brief Address of element `index` of a parameter.
+ */
+static void *paramPtr(board_config_t *cfg, const board_param_t *p, uint8_t index) {
+    static const uint8_t type_size[] = { [BOARD_PARAM_U8] = 1, [BOARD_PARAM_U16] = 2, [BOARD_PARAM_I16] = 2, [BOARD_PARAM_I32] = 4 };
+    size_t stride = (p->scope == BOARD_PARAM_PER_CHANNEL) ? sizeof(board_channel_config_t)
+                  : (p->scope == BOARD_PARAM_PER_MESSAGE) ? type_size[p->type] : 0;
+    return (uint8_t *)cfg + p->offset + index * stride;
+}
+
+static int32_t paramRead(const board_config_t *cfg, const board_param_t *p, uint8_t index) {
+    const void *v = paramPtr((board_config_t *)cfg, p, index);
+    switch (p->type) {
+        case BOARD_PARAM_U8: return *(const uint8_t *)v;
+        case BOARD_PARAM_U16: return *(const uint16_t *)v;
+        case BOARD_PARAM_I16: return *(const int16_t *)v;
+        default: return *(const int32_t *)v;
+    }
+}
+
+static void paramWrite(board_config_t *cfg, const board_param_t *p, uint8_t index, int32_t value) {
+    void *v = paramPtr(cfg, p, index);
+    switch (p->type) {
+        case BOARD_PARAM_U8: *(uint8_t *)v = (uint8_t)value; break;
+        case BOARD_PARAM_U16: *(uint16_t *)v = (uint16_t)value; break;
+        case BOARD_PARAM_I16: *(int16_t *)v = (int16_t)value; break;
+        default: *(int32_t *)v = value; break;
+    }
+}
+
+/**
+ * @brief Returns the table entry for a wire ID, or NULL.
+ */
+const board_param_t *boardParamFind(uint8_t id) {
+    for (size_t i = 0; i < board_params_count; i++) {
+        if (board_params[i].id == id) return &board_params[i];
+    }
+    return NULL;
+}
+
+/**
+ * @brief Number of elements a parameter has on this board: 1, one per message or one per channel.
+ */
+size_t boardParamCount(const board_config_store_t *store, const board_param_t *param) {
+    switch (param->scope) {
+        case BOARD_PARAM_PER_MESSAGE: return store->message_count;
+        case BOARD_PARAM_PER_CHANNEL: return store->channel_count;
+        default: return 1;
+    }
+}
+
+/**
+ * @brief Fills a config with the compiled-in behaviour of the channel and message tables.
+ *
+ * With these values the board behaves exactly as it did before runtime
+ * configuration existed, so an empty NVS changes nothing.
+ *
+ * @param cfg The config to fill
+ * @param channels The channel descriptors, indexed by ADC channel
+ * @param channel_count Number of channels, at most SNAPSHOT_NUM_CHANNELS
+ * @param messages The active CAN message table
+ * @param message_count Number of messages, at most CAN_SCHED_MAX_MESSAGES
+ */
+void boardConfigDefaults(board_config_t *cfg, const channel_desc_t *channels, size_t channel_count,
+                         const can_message_def_t *messages, size_t message_count) {
+    memset(cfg, 0, sizeof(*cfg)); // Padding too, so the CRC depends on the values only
+    cfg->can_base_id = CAN_BASEID;
+    for (size_t i = 0; i < message_count && i < CAN_SCHED_MAX_MESSAGES; i++) cfg->tx_period_ms[i] = messages[i].period_ms;
+
+    for (size_t ch = 0; ch < channel_count && ch < SNAPSHOT_NUM_CHANNELS; ch++) {
+        const channel_desc_t *d = &channels[ch];
+        board_channel_config_t *c = &cfg->channels[ch];
+        c->divider_x1000 = (uint16_t)roundX(d->divider, 1000.0f);
+        c->filter_depth = (d->filter == CHANNEL_FILTER_MEDIAN) ? d->filter_depth : 1;
+        c->deadband_mv = d->deadband_mv;
+        if (d->conversion == CHANNEL_CONVERT_LINEAR) {
+            c->v_min_mv = d->linear.v_min_mv;
+            c->v_max_mv = d->linear.v_max_mv;
+            c->out_min_x100 = roundX(d->linear.out_min, 100.0f);
+            c->out_max_x100 = roundX(d->linear.out_max, 100.0f);
+        } else {
+            c->v_max_mv = 5000;
+        }
+    }
+}
+
+/**
+ * @brief Checks every value against its range and against the values it depends on.
+ *
+ * @param store The store, for the channel and message counts
+ * @param cfg The values to check
+ * @return
+ *      - BOARD_CONFIG_OK if the values can be applied
+ *      - BOARD_CONFIG_OUT_OF_RANGE if a value is outside its parameter's range
+ *      - BOARD_CONFIG_INCONSISTENT if a linear span is empty, or the broadcast IDs
+ *        would pass 0x7FF or cover the config request/response IDs or an ID the
+ *        board receives
+ */
+board_config_status_t boardConfigValidate(const board_config_store_t *store, const board_config_t *cfg) {
+    for (size_t i = 0; i < board_params_count; i++) {
+        const board_param_t *p = &board_params[i];
+        for (size_t n = 0; n < boardParamCount(store, p); n++) {
+            int32_t v = paramRead(cfg, p, (uint8_t)n);
+            if (v < p->min || v > p->max) return BOARD_CONFIG_OUT_OF_RANGE;
+        }
+    }
+
+    for (size_t ch = 0; ch < store->channel_count; ch++) {
+        if (cfg->channels[ch].v_min_mv >= cfg->channels[ch].v_max_mv) return BOARD_CONFIG_INCONSISTENT;
+    }
+
+    uint32_t first = cfg->can_base_id, last = first + store->message_id_span;
+    if (last > 0x7FF) return BOARD_CONFIG_INCONSISTENT;
+    if ((BOARD_CONFIG_REQUEST_ID >= first && BOARD_CONFIG_REQUEST_ID <= last) ||
+        (BOARD_CONFIG_RESPONSE_ID >= first && BOARD_CONFIG_RESPONSE_ID <= last)) {
+        return BOARD_CONFIG_INCONSISTENT;
+    }
+    for (size_t i = 0; i < store->rx_count; i++) {
+        if (store->rx_subs[i].id >= first && store->rx_subs[i].id <= last) return BOARD_CONFIG_INCONSISTENT;
+    }
+    return BOARD_CONFIG_OK;
+}
+
+/**
+ * @brief CRC-32 of a config's values.
+ */
+uint32_t boardConfigCrc(const board_config_t *cfg) {
+    return canLogCrc32(0, (const uint8_t *)cfg, sizeof(*cfg));
+}
+
+/**
+ * @brief Identifies a message table by a CRC of its size and IDs.
+ *
+ * `tx_period_ms[]` is stored by position in the table, and which table is
+ * built in depends on Kconfig, so a blob is only valid for the table that
+ * saved it.
+ */
+static uint32_t boardConfigTableId(const can_message_def_t *messages, size_t message_count) {
+    uint8_t buf[2];
+    putLe16(buf, (uint16_t)message_count);
+    uint32_t crc = canLogCrc32(0, buf, sizeof(buf));
+    for (size_t i = 0; i < message_count; i++) {
+        putLe16(buf, (uint16_t)messages[i].id);
+        crc = canLogCrc32(crc, buf, sizeof(buf));
+    }
+    return crc;
+}
+
+/**
+ * @brief Parses a stored blob: a header (magic, version, payload size, payload CRC, table ID) then the raw board_config_t.
+ */
+static esp_err_t boardConfigParse(const board_config_store_t *store, const uint8_t *blob, size_t len, board_config_t *cfg) {
+    if (len != BOARD_CONFIG_BLOB_BYTES || getLe32(&blob[0]) != BOARD_CONFIG_MAGIC) return ESP_ERR_INVALID_SIZE;
+    if (getLe16(&blob[4]) != BOARD_CONFIG_VERSION || getLe16(&blob[6]) != sizeof(board_config_t) ||
+        getLe32(&blob[12]) != store->table_id) {
+        return ESP_ERR_INVALID_VERSION;
+    }
+
+    memcpy(cfg, &blob[BOARD_CONFIG_HEADER_BYTES], sizeof(*cfg));
+    return (getLe32(&blob[8]) == boardConfigCrc(cfg)) ? ESP_OK : ESP_ERR_INVALID_CRC;
+}
+
+/**
+ * @brief Sets up the store and loads the saved values, falling back to the defaults.
+ *
+ * A missing, truncated, older-layout, corrupt or out-of-range blob, or one
+ * saved under another message table, leaves the defaults in use; `load_err`
+ * says why. Loading is one read and one CRC over a few hundred bytes, so
+ * it adds nothing measurable to boot.
+ *
+ * @param store The store to initialize
+ * @param defaults Values to use when nothing valid is saved, see boardConfigDefaults()
+ * @param channel_count Number of ADC channels, at most SNAPSHOT_NUM_CHANNELS
+ * @param messages The active CAN message table, for its size, ID span and table ID
+ * @param message_count Number of messages, at most CAN_SCHED_MAX_MESSAGES
+ * @param rx_subs The receive subscriptions, whose IDs the broadcast frames may not move onto
+ * @param rx_count Number of entries in `rx_subs`
+ * @param storage Persistent storage, or NULL to run on the defaults with saving disabled
+ * @return
+ *      - ESP_OK on success, whether or not saved values were loaded
+ *      - ESP_ERR_INVALID_ARG if an argument is invalid or the defaults do not validate
+ */
+esp_err_t boardConfigInit(board_config_store_t *store, const board_config_t *defaults, size_t channel_count,
+                          const can_message_def_t *messages, size_t message_count, const can_rx_sub_t *rx_subs, size_t rx_count,
+                          const board_config_storage_t *storage) {
+    if (store == NULL || defaults == NULL || messages == NULL || (rx_count > 0 && rx_subs == NULL) ||
+        channel_count > SNAPSHOT_NUM_CHANNELS || message_count > CAN_SCHED_MAX_MESSAGES) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    memset(store, 0, sizeof(*store));
+    store->defaults = *defaults;
+    store->storage = storage;
+    store->channel_count = channel_count;
+    store->message_count = message_count;
+    store->rx_subs = rx_subs;
+    store->rx_count = rx_count;
+    for (size_t i = 0; i < message_count; i++) {
+        if (messages[i].id > CAN_BASEID && messages[i].id - CAN_BASEID > store->message_id_span) {
+            store->message_id_span = (uint16_t)(messages[i].id - CAN_BASEID);
+        }
+    }
+    store->table_id = boardConfigTableId(messages, message_count);
+    if (boardConfigValidate(store, defaults) != BOARD_CONFIG_OK) return ESP_ERR_INVALID_ARG;
+
+    store->active = *defaults;
+    store->saved_crc = boardConfigCrc(defaults); // Nothing saved boots the defaults
+    store->load_err = ESP_ERR_NOT_FOUND;
+    if (storage != NULL) {
+        uint8_t blob[BOARD_CONFIG_BLOB_BYTES];
+        size_t len = sizeof(blob);
+        board_config_t loaded;
+        esp_err_t err = storage->load(storage->ctx, blob, &len);
+        if (err == ESP_OK) err = boardConfigParse(store, blob, len, &loaded);
+        if (err == ESP_OK && boardConfigValidate(store, &loaded) != BOARD_CONFIG_OK) err = ESP_ERR_INVALID_ARG;
+        if (err == ESP_OK) {
+            store->active = loaded;
+            store->saved_crc = boardConfigCrc(&loaded);
+        } else if (err != ESP_ERR_NOT_FOUND) {
+            store->saved_crc = 0; // Something unusable is saved, so the values in use are unsaved
+        }
+        store->load_err = err;
+    }
+    store->boot = store->active;
+    return ESP_OK;
+}
+
+/**
+ * @brief Reads one element of a parameter from the values in use.
+ *
+ * @return
+ *      - BOARD_CONFIG_OK on success
+ *      - BOARD_CONFIG_UNKNOWN_PARAM if no parameter has that ID
+ *      - BOARD_CONFIG_BAD_INDEX if the parameter has no such element on this board
+ */
+board_config_status_t boardConfigGet(const board_config_store_t *store, uint8_t id, uint8_t index, int32_t *value) {
+    const board_param_t *p = boardParamFind(id);
+    if (p == NULL) return BOARD_CONFIG_UNKNOWN_PARAM;
+    if (index >= boardParamCount(store, p)) return BOARD_CONFIG_BAD_INDEX;
+    *value = paramRead(&store->active, p, index);
+    return BOARD_CONFIG_OK;
+}
+
+/**
+ * @brief Validates and applies one element of a parameter, in RAM only.
+ *
+ * The whole config is validated with the new value before it replaces the
+ * values in use, so a rejected write changes nothing. `generation` moves on
+ * when the value actually changes.
+ *
+ * @return
+ *      - BOARD_CONFIG_OK on success
+ *      - Status from boardConfigGet() or boardConfigValidate() otherwise
+ */
+board_config_status_t boardConfigSet(board_config_store_t *store, uint8_t id, uint8_t index, int32_t value) {
+    int32_t current;
+    board_config_status_t status = boardConfigGet(store, id, index, &current);
+    if (status != BOARD_CONFIG_OK) return status;
+
+    const board_param_t *p = boardParamFind(id);
+    if (value < p->min || value > p->max) return BOARD_CONFIG_OUT_OF_RANGE;
+    if (value == current) return BOARD_CONFIG_OK;
+
+    board_config_t next = store->active;
+    paramWrite(&next, p, index, value);
+    status = boardConfigValidate(store, &next);
+    if (status != BOARD_CONFIG_OK) return status;
+
+    store->active = next;
+    store->generation++;
+    return BOARD_CONFIG_OK;
+}
+
+/**
+ * @brief Persists the values in use.
+ *
+ * The storage replaces the previous blob atomically, so a power cut leaves
+ * either the old or the new values, never a mix.
+ *
+ * @return
+ *      - BOARD_CONFIG_OK on success
+ *      - BOARD_CONFIG_STORAGE_FAILED if there is no storage or it failed to write
+ */
+board_config_status_t boardConfigSave(board_config_store_t *store) {
+    if (store->storage == NULL) return BOARD_CONFIG_STORAGE_FAILED;
+
+    uint8_t blob[BOARD_CONFIG_BLOB_BYTES];
+    uint32_t crc = boardConfigCrc(&store->active);
+    putLe32(&blob[0], BOARD_CONFIG_MAGIC);
+    putLe16(&blob[4], BOARD_CONFIG_VERSION);
+    putLe16(&blob[6], sizeof(board_config_t));
+    putLe32(&blob[8], crc);
+    putLe32(&blob[12], store->table_id);
+    memcpy(&blob[BOARD_CONFIG_HEADER_BYTES], &store->active, sizeof(store->active));
+
+    if (store->storage->save(store->storage->ctx, blob, sizeof(blob)) != ESP_OK) return BOARD_CONFIG_STORAGE_FAILED;
+    store->saved_crc = crc;
+    return BOARD_CONFIG_OK;
+}
+
+/**
+ * @brief Puts the defaults back in use, in RAM only; save to make it stick.
+ */
+void boardConfigRestoreDefaults(board_config_store_t *store) {
+    if (memcmp(&store->active, &store->defaults, sizeof(store->active)) == 0) return;
+    store->active = store->defaults;
+    store->generation++;
+}
+
+/**
+ * @brief BOARD_CONFIG_FLAG_* bits describing the values in use.
+ */
+uint8_t boardConfigFlags(const board_config_store_t *store) {
+    uint8_t flags = (store->load_err == ESP_OK) ? BOARD_CONFIG_FLAG_LOADED : 0;
+    if (boardConfigCrc(&store->active) != store->saved_crc) flags |= BOARD_CONFIG_FLAG_DIRTY;
+    for (size_t i = 0; i < board_params_count; i++) {
+        const board_param_t *p = &board_params[i];
+        for (size_t n = 0; p->reboot && n < boardParamCount(store, p); n++) {
+            if (paramRead(&store->active, p, (uint8_t)n) != paramRead(&store->boot, p, (uint8_t)n)) flags |= BOARD_CONFIG_FLAG_REBOOT;
+        }
+    }
+    return flags;
+}
+
+/**
+ * @brief The values the firmware should run with now: those in use, with reboot-only parameters as at boot.
+ */
+void boardConfigEffective(const board_config_store_t *store, board_config_t *cfg) {
+    *cfg = store->active;
+    for (size_t i = 0; i < board_params_count; i++) {
+        const board_param_t *p = &board_params[i];
+        for (size_t n = 0; p->reboot && n < boardParamCount(store, p); n++) {
+            paramWrite(cfg, p, (uint8_t)n, paramRead(&store->boot, p, (uint8_t)n));
+        }
+    }
+}
+
+/**
+ * @brief Serves one boardConfigRequest frame.
+ *
+ * Every request is answered on BOARD_CONFIG_RESPONSE_ID with the command
+ * (| BOARD_CONFIG_REPLY), a status, the parameter and index echoed and the
+ * resulting value: the value read or now in use after a write. The
+ * request/response IDs do not follow can_base_id, so a tool can always
+ * reach the board.
+ *
+ * @param store The store
+ * @param request A received frame
+ * @param response Filled with the reply when the function returns true
+ * @return True if `request` was a config request and `response` should be sent
+ */
+bool boardConfigHandleRequest(board_config_store_t *store, const can_frame_t *request, can_frame_t *response) {
+    if (request->id != BOARD_CONFIG_REQUEST_ID || request->dlc < BOARD_CONFIG_REQUEST_DLC) return false;
+
+    boardConfigRequest_t req;
+    boardConfigRequest_unpack(&req, request->data);
+    boardConfigResponse_t resp = { .configCommand = req.configCommand | BOARD_CONFIG_REPLY, .configParam = req.configParam,
+                                   .configIndex = req.configIndex, .configValue = req.configValue };
+
+    board_config_status_t status;
+    switch (req.configCommand) {
+        case BOARD_CONFIG_CMD_READ:
+            status = boardConfigGet(store, req.configParam, req.configIndex, &resp.configValue);
+            break;
+        case BOARD_CONFIG_CMD_WRITE:
+            status = boardConfigSet(store, req.configParam, req.configIndex, req.configValue);
+            if (status == BOARD_CONFIG_OK) boardConfigGet(store, req.configParam, req.configIndex, &resp.configValue);
+            break;
+        case BOARD_CONFIG_CMD_SAVE:
+            status = boardConfigSave(store);
+            break;
+        case BOARD_CONFIG_CMD_DEFAULTS:
+            boardConfigRestoreDefaults(store);
+            status = BOARD_CONFIG_OK;
+            break;
+        case BOARD_CONFIG_CMD_STATUS:
+            resp.configIndex = boardConfigFlags(store);
+            resp.configValue = (int32_t)boardConfigCrc(&store->active);
+            status = BOARD_CONFIG_OK;
+            break;
+        default:
+            status = BOARD_CONFIG_BAD_COMMAND;
+            break;
+    }
+    resp.configStatus = (uint8_t)status;
+
+    memset(response, 0, sizeof(*response));
+    response->id = BOARD_CONFIG_RESPONSE_ID;
+    response->dlc = BOARD_CONFIG_RESPONSE_DLC;
+    boardConfigResponse_pack(&resp, response->data);
+    return true;
+}
+
+/**
+ * @brief Overlays the runtime settings on the compiled channel table.
+ *
+ * @param cfg The values to apply, already validated
+ * @param base The compiled descriptors
+ * @param out Receives `count` descriptors for channelsInit()
+ * @param count Number of channels
+ */
+void boardConfigApplyChannels(const board_config_t *cfg, const channel_desc_t *base, channel_desc_t *out, size_t count) {
+    for (size_t ch = 0; ch < count; ch++) {
+        const board_channel_config_t *c = &cfg->channels[ch];
+        out[ch] = base[ch];
+        out[ch].divider = c->divider_x1000 / 1000.0f;
+        out[ch].deadband_mv = c->deadband_mv;
+        if (base[ch].filter == CHANNEL_FILTER_MEDIAN) out[ch].filter_depth = c->filter_depth;
+        if (base[ch].conversion == CHANNEL_CONVERT_LINEAR) {
+            out[ch].linear.v_min_mv = c->v_min_mv;
+            out[ch].linear.v_max_mv = c->v_max_mv;
+            out[ch].linear.out_min = c->out_min_x100 / 100.0f;
+            out[ch].linear.out_max = c->out_max_x100 / 100.0f;
+        }
+    }
+}
+
+/**
+ * @brief Overlays the runtime settings on the compiled message table: periods, and IDs moved to can_base_id.
+ *
+ * @param cfg The values to apply, already validated
+ * @param base The compiled message table
+ * @param out Receives `count` messages for canSchedInit()
+ * @param count Number of messages
+ */
+void boardConfigApplyMessages(const board_config_t *cfg, const can_message_def_t *base, can_message_def_t *out, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        out[i] = base[i];
+        out[i].id = base[i].id - CAN_BASEID + cfg->can_base_id;
+        out[i].period_ms = cfg->tx_period_ms[i];
+    }
+}
+
+/**
+ * @brief Short name of a request status, for logs and tools.
+ */
+const char *boardConfigStatusName(board_config_status_t status) {
+    switch (status) {
+        case BOARD_CONFIG_OK: return "ok";
+        case BOARD_CONFIG_UNKNOWN_PARAM: return "unknown parameter";
+        case BOARD_CONFIG_BAD_INDEX: return "bad index";
+        case BOARD_CONFIG_OUT_OF_RANGE: return "out of range";
+        case BOARD_CONFIG_INCONSISTENT: return "inconsistent";
+        case BOARD_CONFIG_STORAGE_FAILED: return "storage failed";
+        case BOARD_CONFIG_BAD_COMMAND: return "bad command";
+        default: return "?";
+    }
+}
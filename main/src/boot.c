@@ -0,0 +1,74 @@
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "inc/boot.h"
+
+boot_timeline_t boot_timeline;
+
+static const char *const step_names[BOOT_STEP_COUNT] = {
+    [BOOT_STEP_CONFIG] = "config",
+    [BOOT_STEP_CAN] = "can",
+    [BOOT_STEP_CPU_TEMP] = "cpu_temp",
+    [BOOT_STEP_ADC] = "adc",
+    [BOOT_STEP_SENSOR_TABLES] = "sensor_tables",
+    [BOOT_STEP_CAPTURE] = "capture",
+    [BOOT_STEP_CAN_LOG] = "can_log",
+    [BOOT_STEP_FIRST_FRAME] = "first_frame",
+    [BOOT_STEP_FIRST_SWEEP] = "first_sweep",
+    [BOOT_STEP_ALL_VALID] = "all_valid",
+    [BOOT_STEP_VALID_FRAME] = "valid_frame",
+};
+
+/**
+ * @brief Stores `now_us` into an unset time, keeping the first one recorded.
+ */
+static void bootRecord(atomic_uint_least32_t *slot, int64_t now_us) {
+    if (atomic_load_explicit(slot, memory_order_relaxed) != 0) return;
+    uint_least32_t expected = 0;
+    uint_least32_t t = (now_us < 1) ? 1 : (uint_least32_t)now_us;
+    atomic_compare_exchange_strong_explicit(slot, &expected, t, memory_order_release, memory_order_relaxed);
+}
+
+/**
+ * @brief Records the start of a step, the first time only.
+ *
+ * @param tl The boot timeline
+ * @param step The step starting
+ * @param now_us Microseconds since the application started
+ */
+void bootStart(boot_timeline_t *tl, boot_step_t step, int64_t now_us) {
+    if (step < BOOT_STEP_COUNT) bootRecord(&tl->start_us[step], now_us);
+}
+
+/**
+ * @brief Records the end of a step, or the moment a milestone is reached, the first time only.
+ *
+ * @param tl The boot timeline
+ * @param step The step ending
+ * @param now_us Microseconds since the application started
+ */
+void bootEnd(boot_timeline_t *tl, boot_step_t step, int64_t now_us) {
+    if (step < BOOT_STEP_COUNT) bootRecord(&tl->end_us[step], now_us);
+}
+
+/**
+ * @brief Returns when a step started, 0 if it has not or is a milestone.
+ */
+uint32_t bootStartUs(const boot_timeline_t *tl, boot_step_t step) {
+    return (step < BOOT_STEP_COUNT) ? atomic_load_explicit(&tl->start_us[step], memory_order_acquire) : 0;
+}
+
+/**
+ * @brief Returns when a step ended, 0 if it has not.
+ */
+uint32_t bootEndUs(const boot_timeline_t *tl, boot_step_t step) {
+    return (step < BOOT_STEP_COUNT) ? atomic_load_explicit(&tl->end_us[step], memory_order_acquire) : 0;
+}
+
+/**
+ * @brief Returns the name of a step as logged, or "?" if out of range.
+ */
+const char *bootStepName(boot_step_t step) {
+    return (step < BOOT_STEP_COUNT) ? step_names[step] : "?";
+}
@@ -6,124 +6,559 @@
 
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "freertos/queue.h"
 #include "freertos/semphr.h"
 
 #include "esp_err.h"
 #include "esp_log.h"
+#include "esp_partition.h"
+#include "esp_timer.h"
 #include "driver/gpio.h"
 #include "driver/twai.h"
 
+#include "inc/board_config.h"
+#include "inc/boot.h"
 #include "inc/can.h"
+#include "inc/can_signals.h"
+#include "inc/config_store.h"
+#include "inc/diag.h"
 #include "inc/inputs.h"
+#include "inc/load.h"
 
 twai_handle_t twai_can;
 
-twai_timing_config_t t_can_config = TWAI_TIMING_CONFIG_500KBITS();
+twai_timing_config_t t_can_config = CAN_TIMING_CONFIG();
 twai_filter_config_t f_config = TWAI_FILTER_CONFIG_ACCEPT_ALL();
 
 twai_general_config_t can_config = { .controller_id = 0, .mode = TWAI_MODE_NORMAL, .tx_io = DRIVECAN_TX_GPIO_NUM, .rx_io = DRIVECAN_RX_GPIO_NUM,
-                                   .clkout_io = TWAI_IO_UNUSED, .bus_off_io = TWAI_IO_UNUSED, .tx_queue_len = 64, .rx_queue_len = 64,
-                                   .alerts_enabled = TWAI_ALERT_NONE, .clkout_divider = 0 };
+                                   .clkout_io = TWAI_IO_UNUSED, .bus_off_io = TWAI_IO_UNUSED, .tx_queue_len = CAN_TX_QUEUE_LEN, .rx_queue_len = CAN_RX_QUEUE_LEN,
+                                   .alerts_enabled = CAN_SUPERVISOR_ALERTS, .clkout_divider = 0 };
+
+static can_rx_t can_rx;
+static can_rx_sub_t can_rx_subs[CAN_RX_MAX_SUBSCRIPTIONS];
+static can_tx_t can_tx;
+static can_message_def_t tx_messages[CAN_SCHED_MAX_MESSAGES]; // can_messages with the configured periods and base ID
+static SemaphoreHandle_t can_tx_lock; // Shared by the transmit and supervisor tasks around can_tx
+static QueueHandle_t volatile can_log_queue; // Set by the logger task once the log is mounted
+#if CONFIG_CANBOARD_STATIC_ALLOCATION
+static StaticSemaphore_t can_tx_lock_buf;
+static StaticQueue_t can_log_queue_buf;
+static uint8_t can_log_queue_storage[CAN_LOG_QUEUE_LEN * sizeof(can_log_record_t)];
+#endif
+static can_log_flash_t can_log_flash;
+static can_log_t can_logger;
+static uint32_t can_log_dropped;
+#if CONFIG_CANBOARD_DIAG
+static uint32_t can_tx_failures; // twai_transmit() failures since the transmit task last woke, under can_tx_lock
+#endif
              
+static esp_err_t twaiTxTransmit(void *ctx, const can_frame_t *frame) {
+    twai_message_t msg = { .identifier = frame->id, .data_length_code = frame->dlc };
+    memcpy(msg.data, frame->data, sizeof(msg.data));
+    esp_err_t err = twai_transmit(&msg, 0);
+#if CONFIG_CANBOARD_DIAG
+    if (err != ESP_OK) can_tx_failures++;
+#endif
+    return err;
+}
+
+static uint32_t twaiTxQueued(void *ctx) {
+    twai_status_info_t status;
+    return (twai_get_status_info(&status) == ESP_OK) ? status.msgs_to_tx : 0;
+}
+
+static esp_err_t twaiTxFlush(void *ctx) { return twai_clear_transmit_queue(); }
+static esp_err_t twaiTxRecover(void *ctx) { return twai_initiate_recovery(); }
+static esp_err_t twaiTxStart(void *ctx) { return twai_start(); }
+
+static const can_tx_hal_t twai_tx_hal = { .transmit = twaiTxTransmit, .queued = twaiTxQueued, .flush = twaiTxFlush,
+                                          .recover = twaiTxRecover, .start = twaiTxStart };
+
+/**
+ * @brief Rebuilds `tx_messages` from `can_messages` and the runtime configuration.
+ *
+ * @return True if the table changed
+ */
+static bool canConfigureMessages(void) {
+    board_config_t cfg;
+    can_message_def_t messages[CAN_SCHED_MAX_MESSAGES];
+    configStoreRead(&cfg);
+    boardConfigApplyMessages(&cfg, can_messages, messages, can_messages_count);
+    if (memcmp(messages, tx_messages, can_messages_count * sizeof(messages[0])) == 0) return false;
+    memcpy(tx_messages, messages, can_messages_count * sizeof(messages[0]));
+    return true;
+}
+
+/**
+ * @brief Sets up the TX stage between the scheduler and the TWAI driver.
+ *
+ * Logs the bus load the configured message table puts on the bus at the
+ * configured bitrate. Must run after initConfigStore() and before the
+ * transmit and supervisor tasks start.
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_NO_MEM if the lock cannot be allocated
+ */
+esp_err_t initCanTx(void)
+{
+    canConfigureMessages();
+    can_bus_load_t load = canSchedBusLoad(tx_messages, can_messages_count, CONFIG_CANBOARD_CAN_BITRATE);
+    ESP_LOGI(can_log, "CAN %d kbit/s, %s frames from 0x%03lx: %lu frames/s, bus load %.1f%% (%.1f%% if every input changes every sweep)",
+             CONFIG_CANBOARD_CAN_BITRATE / 1000, (can_messages == can_messages_packed) ? "packed" : "16-bit",
+             (unsigned long)tx_messages[0].id, (unsigned long)load.frames_per_s, load.load * 100.0f, load.peak_load * 100.0f);
+
+#if CONFIG_CANBOARD_STATIC_ALLOCATION
+    can_tx_lock = xSemaphoreCreateMutexStatic(&can_tx_lock_buf);
+#else
+    can_tx_lock = xSemaphoreCreateMutex();
+#endif
+    if (can_tx_lock == NULL) return ESP_ERR_NO_MEM;
+    return canTxInit(&can_tx, &twai_tx_hal);
+}
+
 /**
- * @brief Initializes a TWAI message with the given identifier and 8 data bytes.
- *        All data bytes are initially set to 0.
+ * @brief Hands a scheduler frame to the TX stage, replacing any older frame of its ID.
  *
- * @param id The identifier of the message.
+ * Marks the first frame, and the first packed from a sweep with every
+ * input valid, in the boot timeline.
  *
- * @return The initialized TWAI message.
+ * @param ctx The sensor values being packed, for the sample age
+ * @param frame The frame to transmit
+ * @return
+ *      - ESP_OK if the frame was accepted
+ *      - Error code from canTxSubmit() otherwise
  */
-twai_message_t init_twai_message(uint32_t id) {
-    twai_message_t msg = { .identifier = id, .data_length_code = 8 };
-    memset(msg.data, 0, sizeof(msg.data));
-    return msg;
+static esp_err_t canQueueFrame(void *ctx, const can_frame_t *frame) {
+    const sensor_values_t *values = ctx;
+    esp_err_t err = canTxSubmit(&can_tx, frame);
+    if (err == ESP_OK) {
+        BOOT_END(BOOT_STEP_FIRST_FRAME);
+        if (values->valid == SNAPSHOT_ALL_CHANNELS) BOOT_END(BOOT_STEP_VALID_FRAME);
+    }
+#if CONFIG_CANBOARD_DIAG
+    if (err == ESP_OK && values->sweep > 0) DIAG_RECORD(DIAG_SAMPLE_AGE, (uint32_t)(esp_timer_get_time() - values->timestamp_us));
+#endif
+    return err;
 }
 
+/**
+ * @brief Sends one frame outside the schedule (e.g. a config response) through the TX stage.
+ *
+ * @param frame The frame to transmit
+ * @return
+ *      - ESP_OK if the frame was accepted
+ *      - Error code from canTxSubmit() otherwise
+ */
+esp_err_t canSendFrame(const can_frame_t *frame)
+{
+    xSemaphoreTake(can_tx_lock, portMAX_DELAY);
+    esp_err_t err = canTxSubmit(&can_tx, frame);
+    if (err == ESP_OK) canTxPump(&can_tx);
+    xSemaphoreGive(can_tx_lock);
+    return err;
+}
+
+/**
+ * @brief (Re)starts the scheduler on `tx_messages`.
+ */
+static void canTransmitSchedule(can_sched_t *sched, sensor_values_t *values) {
+    ESP_ERROR_CHECK(canSchedInit(sched, tx_messages, can_messages_count, pdTICKS_TO_MS(xTaskGetTickCount()), canQueueFrame, values));
+#if CONFIG_CANBOARD_CAN_TX_EVENT_DRIVEN
+    canSchedSetOnChange(sched, true);
+#endif
+}
+
+/**
+ * @brief Picks up configuration changes to the message table, restarting the schedule if it changed.
+ */
+static void canTransmitReconfigure(can_sched_t *sched, sensor_values_t *values, uint32_t *generation) {
+    uint32_t now = configStoreGeneration();
+    if (now == *generation) return;
+    *generation = now;
+    if (canConfigureMessages()) canTransmitSchedule(sched, values);
+}
+
+/**
+ * @brief Runs the scheduler on the latest snapshot and pushes its frames towards the driver.
+ *
+ * @return Milliseconds until the next message becomes due, or one tick if
+ *         frames are still waiting for room in the driver
+ */
+static uint32_t canTransmitRun(can_sched_t *sched, sensor_values_t *values) {
+    snapshotRead(&sensor_snapshot, values);
+    xSemaphoreTake(can_tx_lock, portMAX_DELAY);
+    DIAG_STAMP(t_pack);
+    uint32_t next_in = canSchedRun(sched, pdTICKS_TO_MS(xTaskGetTickCount()), values);
+    canTxPump(&can_tx);
+    if (canTxPending(&can_tx) && next_in > CAN_SCHED_TICK_MS) next_in = CAN_SCHED_TICK_MS;
+    DIAG_SINCE(DIAG_CAN_PACK, t_pack);
+    xSemaphoreGive(can_tx_lock);
+    return next_in;
+}
+
+#if CONFIG_CANBOARD_DIAG
+/**
+ * @brief Records the per-wake transmit diagnostics: wake-up lateness and TX queue state.
+ *
+ * @param late_us How late the task woke, or negative when there was no deadline (first pass, notification)
+ */
+static void canTransmitDiag(int64_t late_us) {
+    if (late_us >= 0) DIAG_RECORD(DIAG_CAN_LOOP, (uint32_t)late_us);
+
+    twai_status_info_t status;
+    if (twai_get_status_info(&status) == ESP_OK) DIAG_RECORD(DIAG_TX_QUEUE, status.msgs_to_tx);
+
+    xSemaphoreTake(can_tx_lock, portMAX_DELAY); // The receive task's canSendFrame() counts failures too
+    uint32_t failures = can_tx_failures;
+    can_tx_failures = 0;
+    xSemaphoreGive(can_tx_lock);
+    DIAG_RECORD(DIAG_TX_FAILURES, failures);
+}
+#endif
+
+#if CONFIG_CANBOARD_CAN_TX_EVENT_DRIVEN
 /**
  * @brief The CAN transmit task.
  *
  * This task is responsible for transmitting CAN messages to the bus. It
- * periodically reads the filtered and scaled ADC values and constructs
- * the CAN messages accordingly. The messages are then transmitted using
- * the TWAI driver.
+ * sleeps on its task notification until either the ADC task publishes a
+ * sweep that moved a channel past its deadband or the scheduler's next
+ * message falls due (the next tick, while frames wait for room in the
+ * driver), whichever comes first; the supervisor also wakes it when the
+ * bus comes back. Each wake takes a lock-free copy of the latest sensor
+ * snapshot and lets the scheduler queue every message from the
+ * `can_messages` table that is due or whose channels changed, so fresh
+ * values reach the bus within one sweep rather than on the next fixed
+ * slot, and the task does not wake when there is nothing to send. Frames
+ * pass through the TX stage, which keeps only the newest frame per ID when
+ * the bus cannot keep up. Configuration changes to the message periods are
+ * picked up on the next wake. With CONFIG_CANBOARD_DIAG the pack time, ticks
+ * overslept past a deadline, TX queue depth, transmit failures and the age
+ * of the packed sweep are recorded every wake.
+ */
+void canTransmit(void *arg)
+{
+    ESP_LOGI(can_log, "CAN Transmit Task Started (event-driven)");
+    static can_sched_t sched;
+    static sensor_values_t values;
+    uint32_t config_generation = configStoreGeneration();
+    canTransmitSchedule(&sched, &values);
+
+    while(1) {
+        canTransmitReconfigure(&sched, &values, &config_generation);
+        uint32_t next_in = canTransmitRun(&sched, &values);
+
+        // Sleep to the tick the next message is due on; a notification cuts it short
+        TickType_t wait = (next_in == UINT32_MAX) ? portMAX_DELAY : (next_in + portTICK_PERIOD_MS - 1) / portTICK_PERIOD_MS;
+        if (wait == 0) wait = 1;
+#if CONFIG_CANBOARD_DIAG
+        TickType_t deadline = xTaskGetTickCount() + wait;
+        bool notified = ulTaskNotifyTake(pdTRUE, wait) != 0;
+        int64_t overslept = (int32_t)(xTaskGetTickCount() - deadline);
+        canTransmitDiag(notified ? -1 : (overslept > 0 ? overslept : 0) * portTICK_PERIOD_MS * 1000LL);
+#else
+        ulTaskNotifyTake(pdTRUE, wait);
+#endif
+    }
+    vTaskDelete(NULL);
+}
+#else
+/**
+ * @brief The CAN transmit task.
+ *
+ * This task is responsible for transmitting CAN messages to the bus. It
+ * wakes on an absolute tick, takes a lock-free copy of the latest sensor
+ * snapshot and lets the scheduler pack and queue every message from the
+ * `can_messages` table that is due, each at its own rate. Frames pass
+ * through the TX stage, which keeps only the newest frame per ID when the
+ * bus cannot keep up. Configuration changes to the message periods are
+ * picked up on the next tick. With CONFIG_CANBOARD_DIAG the pack time, tick
+ * jitter, TX queue depth, transmit failures and the age of the packed sweep
+ * are recorded every tick.
  */
 void canTransmit(void *arg)
 {
     ESP_LOGI(can_log, "CAN Transmit Task Started");
-    // Setup CAN Packets
-    twai_message_t tx_msg[5];
-    for (size_t i = 0; i <= 4; ++i) {
-        tx_msg[i] = init_twai_message(CAN_BASEID + i);
+    static can_sched_t sched;
+    static sensor_values_t values;
+    uint32_t config_generation = configStoreGeneration();
+    canTransmitSchedule(&sched, &values);
+
+#if CONFIG_CANBOARD_DIAG
+    int64_t last_wake_us = 0;
+#endif
+    TickType_t last_wake = xTaskGetTickCount();
+    while(1) {
+        canTransmitReconfigure(&sched, &values, &config_generation);
+        canTransmitRun(&sched, &values);
+#if CONFIG_CANBOARD_DIAG
+        int64_t now_us = esp_timer_get_time();
+        int64_t jitter = (now_us - last_wake_us) - CAN_SCHED_TICK_MS * 1000LL;
+        canTransmitDiag(last_wake_us == 0 ? -1 : (jitter < 0 ? -jitter : jitter));
+        last_wake_us = now_us;
+#endif
+        vTaskDelayUntil(&last_wake, pdMS_TO_TICKS(CAN_SCHED_TICK_MS));
+    }
+    vTaskDelete(NULL);
+}
+#endif
+
+/**
+ * @brief The CAN supervisor task.
+ *
+ * Waits on the TWAI alerts. On bus-off it drops the driver's stale TX
+ * queue and starts recovery, and once the controller reports the bus
+ * recovered it restarts it, so a shorted or disturbed bus never needs a
+ * power cycle. Error passive (typically nothing acknowledging, e.g. a
+ * disconnected bus) limits the driver to one in-flight frame so the TX
+ * stage keeps only the newest data. The error counters are sampled at
+ * least every CAN_SUPERVISOR_POLL_MS, and the transmit task is woken
+ * when the bus comes back with frames waiting.
+ *
+ * @param arg The transmit task, notified when waiting frames can move on
+ */
+void canSupervisor(void *arg)
+{
+    ESP_LOGI(can_log, "CAN Supervisor Task Started");
+    TaskHandle_t tx_task = (TaskHandle_t)arg;
+    int64_t next_stats = esp_timer_get_time() + CAN_LOG_STATS_INTERVAL_MS * 1000LL;
+    while(1) {
+        uint32_t alerts = 0;
+        if (twai_read_alerts(&alerts, pdMS_TO_TICKS(CAN_SUPERVISOR_POLL_MS)) != ESP_OK) alerts = 0;
+        twai_status_info_t status;
+        bool have_status = twai_get_status_info(&status) == ESP_OK;
+        int64_t now = esp_timer_get_time();
+
+        xSemaphoreTake(can_tx_lock, portMAX_DELAY);
+        can_bus_state_t before = can_tx.state;
+        if (have_status) canTxErrorCounters(&can_tx, status.tx_error_counter, status.rx_error_counter);
+        if (alerts & TWAI_ALERT_ERR_PASS) canTxErrorPassive(&can_tx, true);
+        if (alerts & TWAI_ALERT_ERR_ACTIVE) canTxErrorPassive(&can_tx, false);
+        if (alerts & TWAI_ALERT_BUS_OFF) canTxBusOff(&can_tx, now);
+        esp_err_t err = (alerts & TWAI_ALERT_BUS_RECOVERED) ? canTxBusRecovered(&can_tx, now) : ESP_OK;
+        can_bus_state_t after = can_tx.state;
+        bool wake = after != before && after != CAN_BUS_OFF && canTxPending(&can_tx);
+        can_tx_stats_t stats = can_tx.stats;
+        xSemaphoreGive(can_tx_lock);
+
+        if (err != ESP_OK) ESP_LOGE(can_log, "Failed to Restart TWAI Driver After Bus-Off (%s)", esp_err_to_name(err));
+        if (after != before) {
+            if (before == CAN_BUS_OFF) {
+                ESP_LOGW(can_log, "CAN bus recovered in %lu us (%lu bus-offs)", stats.last_recovery_us, stats.bus_offs);
+            } else {
+                ESP_LOGW(can_log, "CAN bus %s, TEC %lu REC %lu", canBusStateName(after), stats.tx_errors, stats.rx_errors);
+            }
+        }
+        if (wake && tx_task != NULL) xTaskNotifyGive(tx_task);
+
+        if (now >= next_stats) {
+            ESP_LOGI(can_log, "CAN TX: %s, TEC %lu REC %lu, %llu submitted, %llu queued, %llu superseded, %llu flushed, "
+                     "%lu bus-offs, worst recovery %lu us", canBusStateName(after), stats.tx_errors, stats.rx_errors,
+                     stats.submitted, stats.queued, stats.superseded, stats.flushed, stats.bus_offs, stats.max_recovery_us);
+            next_stats = now + CAN_LOG_STATS_INTERVAL_MS * 1000LL;
+        }
     }
+    vTaskDelete(NULL);
+}
+
+static esp_err_t canLogPartitionRead(void *ctx, uint32_t offset, void *buf, uint32_t len) {
+    return esp_partition_read(ctx, offset, buf, len);
+}
+
+static esp_err_t canLogPartitionWrite(void *ctx, uint32_t offset, const void *buf, uint32_t len) {
+    return esp_partition_write(ctx, offset, buf, len);
+}
+
+static esp_err_t canLogPartitionErase(void *ctx, uint32_t offset, uint32_t len) {
+    return esp_partition_erase_range(ctx, offset, len);
+}
+
+/**
+ * @brief Mounts the CAN log on the `canlog` partition and creates the receive queue.
+ *
+ * Called by the logger task, so the scan of the partition stays off the
+ * path to the first frame. The receive task starts handing frames over
+ * once the queue is published, so frames received before that are not
+ * logged.
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_NOT_FOUND if the partition table has no `canlog` partition
+ *      - ESP_ERR_NO_MEM if the queue cannot be allocated
+ *      - Error code from canLogMount() otherwise
+ */
+esp_err_t initCanLog(void)
+{
+    const esp_partition_t *partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, CAN_LOG_PARTITION_LABEL);
+    if (partition == NULL) return ESP_ERR_NOT_FOUND;
+
+    can_log_flash = (can_log_flash_t){ .ctx = (void *)partition, .size = partition->size - partition->size % CAN_LOG_SEGMENT_BYTES,
+                                       .read = canLogPartitionRead, .write = canLogPartitionWrite, .erase = canLogPartitionErase };
+    esp_err_t err = canLogMount(&can_logger, &can_log_flash);
+    if (err != ESP_OK) return err;
+
+#if CONFIG_CANBOARD_STATIC_ALLOCATION
+    QueueHandle_t queue = xQueueCreateStatic(CAN_LOG_QUEUE_LEN, sizeof(can_log_record_t), can_log_queue_storage, &can_log_queue_buf);
+#else
+    QueueHandle_t queue = xQueueCreate(CAN_LOG_QUEUE_LEN, sizeof(can_log_record_t));
+#endif
+    if (queue == NULL) return ESP_ERR_NO_MEM;
+    can_log_queue = queue;
+
+    ESP_LOGI(can_log, "CAN log mounted: %lu segments, appending to segment %lu (seq %lu) at %lu",
+             can_logger.segment_count, can_logger.segment, can_logger.seq, can_logger.write_offset);
+    return ESP_OK;
+}
+
+/**
+ * @brief Builds the RX dispatch table and narrows `f_config` to the subscribed IDs.
+ *
+ * The vehicle's `can_rx_table` is followed by the board's own services
+ * (the config request). Must run before the TWAI driver is installed. With
+ * CONFIG_CANBOARD_CAN_LOG_ALL_FRAMES the filter stays open so the flash log
+ * sees the whole bus.
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_INVALID_SIZE if there are more than CAN_RX_MAX_SUBSCRIPTIONS subscriptions
+ *      - Error code from canRxInit() or canRxComputeFilter() otherwise
+ */
+esp_err_t initCanRx(void)
+{
+    if (can_rx_table_count + 1 > CAN_RX_MAX_SUBSCRIPTIONS) return ESP_ERR_INVALID_SIZE;
+    size_t count = can_rx_table_count;
+    memcpy(can_rx_subs, can_rx_table, count * sizeof(can_rx_subs[0]));
+    can_rx_subs[count++] = (can_rx_sub_t){ BOARD_CONFIG_REQUEST_ID, configStoreRequest, NULL };
 
+    esp_err_t err = canRxInit(&can_rx, can_rx_subs, count);
+    if (err != ESP_OK) return err;
+
+#ifdef CONFIG_CANBOARD_CAN_LOG_ALL_FRAMES
+    ESP_LOGI(can_log, "RX acceptance filter open, logging all frames");
+#else
+    can_rx_filter_t filter;
+    err = canRxComputeFilter(can_rx_subs, count, &filter);
+    if (err != ESP_OK) return err;
+    f_config = (twai_filter_config_t){ .acceptance_code = filter.acceptance_code, .acceptance_mask = filter.acceptance_mask,
+                                       .single_filter = !filter.dual };
+    ESP_LOGI(can_log, "RX acceptance filter: %s, code 0x%08lx mask 0x%08lx, %lu of 2048 IDs pass for %u subscriptions",
+             filter.dual ? "dual" : "single", filter.acceptance_code, filter.acceptance_mask, filter.accepted_ids, count);
+#endif
+    return ESP_OK;
+}
+
+/**
+ * @brief The CAN receive task.
+ *
+ * Drains the TWAI RX queue as fast as frames arrive and hands each one to
+ * its subscriber through the `can_rx_table` dispatch map. When the flash log
+ * is mounted every received frame is also timestamped and passed to the
+ * logger through a deep queue, so flash writes and erases never hold up
+ * reception. Frames that do not fit are counted as dropped.
+ */
+void canReceive(void *arg)
+{
+    ESP_LOGI(can_log, "CAN Receive Task Started");
+    twai_message_t msg;
+    can_frame_t frame;
+    can_log_record_t rec;
     while(1) {
-        
-        uint16_t voltages_copy[NUM_ADC_CHANNELS];
-        if (xSemaphoreTake(filtered_voltages_mutex, pdMS_TO_TICKS(5)) == pdTRUE) {
-            memcpy(voltages_copy, filtered_voltages, sizeof(voltages_copy));
-            xSemaphoreGive(filtered_voltages_mutex);
+        if (twai_receive(&msg, portMAX_DELAY) != ESP_OK) continue;
+
+        frame.id = msg.identifier;
+        frame.dlc = (msg.data_length_code > 8) ? 8 : msg.data_length_code;
+        memcpy(frame.data, msg.data, sizeof(frame.data));
+        canRxDispatch(&can_rx, &frame, msg.extd);
+
+        if (can_log_queue == NULL) continue;
+        rec.timestamp_us = esp_timer_get_time();
+        rec.id = frame.id;
+        rec.dlc = frame.dlc;
+        rec.flags = (msg.extd ? CAN_LOG_FLAG_EXTENDED : 0) | (msg.rtr ? CAN_LOG_FLAG_RTR : 0);
+        memcpy(rec.data, frame.data, sizeof(rec.data));
+        if (xQueueSend(can_log_queue, &rec, 0) != pdTRUE) can_log_dropped++;
+    }
+    vTaskDelete(NULL);
+}
+
+/**
+ * @brief The CAN logger task.
+ *
+ * Mounts the flash log, then appends received frames to it; if the log
+ * cannot be mounted the task ends and reception carries on unlogged. Blocks are written when they
+ * fill, or once the queue is empty and the oldest pending frame is
+ * CAN_LOG_FLUSH_MS old, which bounds what a power cut can lose.
+ */
+void canLogger(void *arg)
+{
+    ESP_LOGI(can_log, "CAN Logger Task Started");
+    BOOT_START(BOOT_STEP_CAN_LOG);
+    esp_err_t mount_err = initCanLog();
+    BOOT_END(BOOT_STEP_CAN_LOG);
+    if (mount_err != ESP_OK) {
+        ESP_LOGW(can_log, "CAN logging disabled: %s", esp_err_to_name(mount_err));
+        vTaskDelete(NULL);
+        return;
+    }
+
+    can_log_record_t rec;
+    int64_t next_stats = esp_timer_get_time() + CAN_LOG_STATS_INTERVAL_MS * 1000LL;
+    while(1) {
+        if (xQueueReceive(can_log_queue, &rec, pdMS_TO_TICKS(CAN_LOG_FLUSH_MS)) == pdTRUE) {
+            esp_err_t err = canLogAppend(&can_logger, &rec);
+            if (err != ESP_OK) ESP_LOGW(can_log, "CAN log write failed: %s", esp_err_to_name(err));
+        }
+
+        int64_t now = esp_timer_get_time();
+        if (uxQueueMessagesWaiting(can_log_queue) == 0 && canLogFlushDue(&can_logger, now)) {
+            esp_err_t err = canLogFlush(&can_logger);
+            if (err != ESP_OK) ESP_LOGW(can_log, "CAN log write failed: %s", esp_err_to_name(err));
+        }
+
+        if (now >= next_stats) {
+            twai_status_info_t status;
+            uint32_t rx_missed = (twai_get_status_info(&status) == ESP_OK) ? status.rx_missed_count : 0;
+            ESP_LOGI(can_log, "CAN log: %llu frames, %llu bytes, %lu dropped, %lu RX missed, %lu write errors, %llu dispatched",
+                     can_logger.stats.records, can_logger.stats.bytes, can_log_dropped, rx_missed,
+                     can_logger.stats.write_errors, can_rx.stats.dispatched);
+            next_stats = now + CAN_LOG_STATS_INTERVAL_MS * 1000LL;
         }
+    }
+    vTaskDelete(NULL);
+}
 
-        uint16_t pressures_copy[4];
-        if (xSemaphoreTake(scaled_pressures_mutex, pdMS_TO_TICKS(5)) == pdTRUE) {
-            memcpy(pressures_copy, scaled_pressures, sizeof(pressures_copy));
-            xSemaphoreGive(scaled_pressures_mutex);
+#if CONFIG_CANBOARD_DIAG
+/**
+ * @brief Prints the latest diagnostics windows and task load to the console.
+ *
+ * Runs at low priority every DIAG_DUMP_INTERVAL_MS. The windows are the ones
+ * last broadcast in the diagnostics and load frames, so they always agree.
+ */
+void diagDump(void *arg)
+{
+    diag_report_t reports[DIAG_METRIC_COUNT];
+    load_report_t load;
+    TickType_t last_wake = xTaskGetTickCount();
+    while(1) {
+        vTaskDelayUntil(&last_wake, pdMS_TO_TICKS(DIAG_DUMP_INTERVAL_MS));
+        diagReports(&diag, reports);
+        for (int i = 0; i < DIAG_METRIC_COUNT; i++) {
+            ESP_LOGI(diag_log, "%-14s n=%-5lu min %-5lu avg %-5lu p99 %-5lu max %lu", diagMetricName((diag_metric_id_t)i),
+                     reports[i].count, reports[i].min, reports[i].avg, reports[i].p99, reports[i].max);
         }
 
-        // Base Message
-        tx_msg[0].data[0] = (int8_t) getCpuTemperature(); // CPU Temperature (-128C > +127C)
-        tx_msg[0].data[1] = 0x00; // Unused / Spare
-        tx_msg[0].data[2] = voltages_copy[0] & 0xFF; // Analog Input 1 - Charge Cooler Inlet Pressure (BMW TMAP 13627843531)
-        tx_msg[0].data[3] = (voltages_copy[0] >> 8) & 0xFF;
-        tx_msg[0].data[4] = voltages_copy[1]; // Analog Input 2 - Exhaust Back Pressure
-        tx_msg[0].data[5] = (voltages_copy[1] >> 8) & 0xFF;
-        tx_msg[0].data[6] = voltages_copy[2]; // Analog Input 3 - Crank Case Pressure (Bosch MAP 0261230119)
-        tx_msg[0].data[7] = (voltages_copy[2] >> 8) & 0xFF;
-        twai_transmit(&tx_msg[0], pdMS_TO_TICKS(1000));
-        vTaskDelay(pdMS_TO_TICKS(10));
-
-        // BASE + 1
-        tx_msg[1].data[0] = voltages_copy[3]; // Analog Input 4 - Turbo Regulator Oil Pressure
-        tx_msg[1].data[1] = (voltages_copy[3] >> 8) & 0xFF;
-        tx_msg[1].data[2] = voltages_copy[4]; // Analog Input 5
-        tx_msg[1].data[3] = (voltages_copy[4] >> 8) & 0xFF;
-        tx_msg[1].data[4] = voltages_copy[5]; // Analog Input 6
-        tx_msg[1].data[5] = (voltages_copy[5] >> 8) & 0xFF;
-        tx_msg[1].data[6] = voltages_copy[6]; // Analog Input 7
-        tx_msg[1].data[7] = (voltages_copy[6] >> 8) & 0xFF;
-        twai_transmit(&tx_msg[1], pdMS_TO_TICKS(1000));
-        vTaskDelay(pdMS_TO_TICKS(10));
-
-        // BASE + 2
-        tx_msg[2].data[0] = voltages_copy[7]; // Analog Input 8 - Charge Cooler Inlet Temperature (BMW TMAP 13627843531)
-        tx_msg[2].data[1] = (voltages_copy[7] >> 8) & 0xFF; 
-        tx_msg[2].data[2] = voltages_copy[8]; // Analog Input 9 - Charge Cooler Water Temperature (Bosch 0280130026)
-        tx_msg[2].data[3] = (voltages_copy[8] >> 8) & 0xFF;
-        tx_msg[2].data[4] = voltages_copy[9]; // Analog Input 10 - Air Temperature (Bosch 0280130039)
-        tx_msg[2].data[5] = (voltages_copy[9] >> 8) & 0xFF;
-        twai_transmit(&tx_msg[2], pdMS_TO_TICKS(1000));
-        vTaskDelay(pdMS_TO_TICKS(10));
-        
-        // BASE + 3
-        tx_msg[3].data[0] = getSensorTemperature(voltages_copy[8], 2400, PULLUP_VREF_MV, ntc_table, NTC_TABLE_SIZE(ntc_table)); // Charge Cooler Water Temperature (C)
-        tx_msg[3].data[1] = getSensorTemperature(voltages_copy[9], 2400, PULLUP_VREF_MV, ntc_table, NTC_TABLE_SIZE(ntc_table)); // Air Temperature (C)
-        tx_msg[3].data[2] = getSensorTemperature(voltages_copy[7], 2400, PULLUP_VREF_MV, tmap_table, NTC_TABLE_SIZE(tmap_table)); // Charge Cooler Inlet Temperature (C)
-
-        tx_msg[3].data[3] = pressures_copy[0]; // Charge Cooler Inlet Pressure (kPa)
-        tx_msg[3].data[4] = (pressures_copy[0] >> 8) & 0xFF;
-        tx_msg[3].data[5] = pressures_copy[1]; // Exhaust Back Pressure (Psi)
-        tx_msg[3].data[6] = (pressures_copy[1] >> 8) & 0xFF;
-        twai_transmit(&tx_msg[3], pdMS_TO_TICKS(1000));
-        vTaskDelay(pdMS_TO_TICKS(10));
-
-        // BASE + 4
-        tx_msg[4].data[0] = pressures_copy[2]; // Crank Case Pressure (kPa)
-        tx_msg[4].data[1] = (pressures_copy[2] >> 8) & 0xFF;
-        tx_msg[4].data[2] = pressures_copy[3]; // Turbo Regulator Oil Pressure (Psi)
-        tx_msg[4].data[3] = (pressures_copy[3] >> 8) & 0xFF;
-        twai_transmit(&tx_msg[4], pdMS_TO_TICKS(1000));
-
-        vTaskDelay(pdMS_TO_TICKS(80));
+        loadReport(&task_load, &load);
+        for (int t = 0; t < TASK_COUNT; t++) {
+            if (!(load.running & (1u << t))) continue;
+            const task_placement_t *p = &task_placement[t];
+            ESP_LOGI(diag_log, "%-14s core %-2d prio %-2u cpu %3u.%u%% stack %5lu of %5lu free", p->name, p->core, p->priority,
+                     load.cpu_permille[t] / 10, load.cpu_permille[t] % 10, load.stack_free[t], p->stack_bytes);
+        }
+        ESP_LOGI(diag_log, "Load core0 %u.%u%% core1 %u.%u%%, heap %lu free, %lu min free, %lu largest block",
+                 load.core_permille[0] / 10, load.core_permille[0] % 10, load.core_permille[1] / 10, load.core_permille[1] % 10,
+                 load.heap_free, load.heap_min_free, load.heap_largest);
     }
     vTaskDelete(NULL);
 }
+#endif
@@ -0,0 +1,406 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "esp_err.h"
+#include "inc/can_log.h"
+
+// Record flag byte: dlc[3:0], extended[4], rtr[5], 32-bit delta[6]
+#define RECORD_DLC_MASK 0x0F
+#define RECORD_EXTENDED 0x10
+#define RECORD_RTR 0x20
+#define RECORD_WIDE_DELTA 0x40
+
+#define BLOCK_ERASED 0xFFFF
+
+static void putLe16(uint8_t *p, uint16_t v) { p[0] = (uint8_t)v; p[1] = (uint8_t)(v >> 8); }
+static void putLe32(uint8_t *p, uint32_t v) { putLe16(p, (uint16_t)v); putLe16(p + 2, (uint16_t)(v >> 16)); }
+static void putLe64(uint8_t *p, uint64_t v) { putLe32(p, (uint32_t)v); putLe32(p + 4, (uint32_t)(v >> 32)); }
+static uint16_t getLe16(const uint8_t *p) { return (uint16_t)(p[0] | p[1] << 8); }
+static uint32_t getLe32(const uint8_t *p) { return getLe16(p) | (uint32_t)getLe16(p + 2) << 16; }
+static uint64_t getLe64(const uint8_t *p) { return getLe32(p) | (uint64_t)getLe32(p + 4) << 32; }
+
+/**
+ * @brief Standard CRC-32 (IEEE 802.3, reflected), chainable by passing the previous result.
+ *
+ * Uses a 16-entry table, small enough to keep in DRAM and fast enough for
+ * the few tens of kB/s a saturated bus produces.
+ *
+ * @param crc 0 to start, or the result of the previous call
+ * @param data The bytes to add
+ * @param len The number of bytes
+ * @return The updated CRC
+ */
+uint32_t canLogCrc32(uint32_t crc, const uint8_t *data, size_t len) {
+    static const uint32_t table[16] = {
+        0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+        0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C,
+    };
+    crc = ~crc;
+    for (size_t i = 0; i < len; i++) {
+        crc = (crc >> 4) ^ table[(crc ^ data[i]) & 0x0F];
+        crc = (crc >> 4) ^ table[(crc ^ (data[i] >> 4)) & 0x0F];
+    }
+    return ~crc;
+}
+
+/**
+ * @brief Reads a segment header, returning true and its sequence if it is valid.
+ */
+static bool readSegmentHeader(const can_log_flash_t *flash, uint32_t segment, uint32_t *seq) {
+    uint8_t hdr[CAN_LOG_SEGMENT_HEADER_BYTES];
+    if (flash->read(flash->ctx, segment * CAN_LOG_SEGMENT_BYTES, hdr, sizeof(hdr)) != ESP_OK) return false;
+    if (getLe32(&hdr[0]) != CAN_LOG_SEGMENT_MAGIC || getLe16(&hdr[4]) != CAN_LOG_VERSION) return false;
+    if (getLe32(&hdr[12]) != canLogCrc32(0, hdr, 12)) return false;
+    *seq = getLe32(&hdr[8]);
+    return true;
+}
+
+/**
+ * @brief Reads and checks the block at `offset` of a segment.
+ *
+ * @param flash The flash region
+ * @param segment The segment index
+ * @param offset Offset of the block within the segment
+ * @param block Destination, CAN_LOG_BLOCK_BYTES long
+ * @return
+ *      - ESP_OK if a complete block with a valid CRC was read
+ *      - ESP_ERR_NOT_FOUND if the space is still erased (end of the segment's data)
+ *      - ESP_ERR_INVALID_CRC if the block is torn or corrupt
+ *      - Error code from the flash read otherwise
+ */
+static esp_err_t readBlock(const can_log_flash_t *flash, uint32_t segment, uint32_t offset, uint8_t *block) {
+    if (offset + CAN_LOG_BLOCK_HEADER_BYTES > CAN_LOG_SEGMENT_BYTES) return ESP_ERR_NOT_FOUND;
+
+    uint32_t base = segment * CAN_LOG_SEGMENT_BYTES + offset;
+    esp_err_t err = flash->read(flash->ctx, base, block, CAN_LOG_BLOCK_HEADER_BYTES);
+    if (err != ESP_OK) return err;
+
+    uint16_t len = getLe16(&block[0]);
+    if (len == BLOCK_ERASED) return ESP_ERR_NOT_FOUND;
+    if (len < CAN_LOG_BLOCK_HEADER_BYTES || len > CAN_LOG_BLOCK_BYTES || offset + len > CAN_LOG_SEGMENT_BYTES) return ESP_ERR_INVALID_CRC;
+
+    err = flash->read(flash->ctx, base + CAN_LOG_BLOCK_HEADER_BYTES, &block[CAN_LOG_BLOCK_HEADER_BYTES], len - CAN_LOG_BLOCK_HEADER_BYTES);
+    if (err != ESP_OK) return err;
+    return (getLe32(&block[4]) == canLogCrc32(0, &block[8], len - 8)) ? ESP_OK : ESP_ERR_INVALID_CRC;
+}
+
+/**
+ * @brief Erases whatever is left of the next segment and starts appending to it.
+ */
+static esp_err_t openNextSegment(can_log_t *log) {
+    const can_log_flash_t *flash = log->flash;
+    uint32_t next = (log->segment + 1) % log->segment_count;
+    uint32_t base = next * CAN_LOG_SEGMENT_BYTES;
+
+    if (log->erased_ahead < CAN_LOG_SEGMENT_BYTES) {
+        esp_err_t err = flash->erase(flash->ctx, base + log->erased_ahead, CAN_LOG_SEGMENT_BYTES - log->erased_ahead);
+        if (err != ESP_OK) return err;
+        log->stats.sectors_erased += (CAN_LOG_SEGMENT_BYTES - log->erased_ahead) / CAN_LOG_SECTOR_BYTES;
+    }
+
+    uint8_t hdr[CAN_LOG_SEGMENT_HEADER_BYTES];
+    putLe32(&hdr[0], CAN_LOG_SEGMENT_MAGIC);
+    putLe16(&hdr[4], CAN_LOG_VERSION);
+    putLe16(&hdr[6], 0);
+    putLe32(&hdr[8], log->seq + 1);
+    putLe32(&hdr[12], canLogCrc32(0, hdr, 12));
+    esp_err_t err = flash->write(flash->ctx, base, hdr, sizeof(hdr));
+    if (err != ESP_OK) return err;
+
+    log->segment = next;
+    log->seq++;
+    log->write_offset = CAN_LOG_SEGMENT_HEADER_BYTES;
+    log->erased_ahead = 0;
+    log->stats.segments++;
+    log->stats.bytes += sizeof(hdr);
+    return ESP_OK;
+}
+
+/**
+ * @brief Finds the end of the log in a flash region and prepares to append to it.
+ *
+ * The newest valid segment is scanned block by block. Appending resumes
+ * after its last good block; if that segment ends in a torn block the next
+ * write starts a fresh segment instead, so nothing is ever written over
+ * partially programmed flash. A blank region gets its first segment here.
+ *
+ * @param log The writer state to initialize
+ * @param flash The flash region, at least two segments long
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_INVALID_ARG if the log or flash is NULL or incomplete
+ *      - ESP_ERR_INVALID_SIZE if the region is not a whole number of segments, or is shorter than two
+ *      - Error code from the flash callbacks otherwise
+ */
+esp_err_t canLogMount(can_log_t *log, const can_log_flash_t *flash) {
+    if (log == NULL || flash == NULL || flash->read == NULL || flash->write == NULL || flash->erase == NULL) return ESP_ERR_INVALID_ARG;
+    if (flash->size % CAN_LOG_SEGMENT_BYTES != 0 || flash->size / CAN_LOG_SEGMENT_BYTES < 2) return ESP_ERR_INVALID_SIZE;
+
+    memset(log, 0, sizeof(*log));
+    log->flash = flash;
+    log->segment_count = flash->size / CAN_LOG_SEGMENT_BYTES;
+
+    bool found = false;
+    for (uint32_t s = 0; s < log->segment_count; s++) {
+        uint32_t seq;
+        if (readSegmentHeader(flash, s, &seq) && (!found || seq > log->seq)) {
+            found = true;
+            log->segment = s;
+            log->seq = seq;
+        }
+    }
+
+    if (!found) {
+        // Blank or foreign region: start at segment 0 with sequence 1
+        log->segment = log->segment_count - 1;
+        log->seq = 0;
+        return openNextSegment(log);
+    }
+
+    log->write_offset = CAN_LOG_SEGMENT_HEADER_BYTES;
+    while (true) {
+        esp_err_t err = readBlock(flash, log->segment, log->write_offset, log->block);
+        if (err == ESP_OK) {
+            log->write_offset += getLe16(&log->block[0]);
+        } else if (err == ESP_ERR_NOT_FOUND) {
+            break;
+        } else if (err == ESP_ERR_INVALID_CRC) {
+            log->write_offset = CAN_LOG_SEGMENT_BYTES; // Torn tail, continue in a fresh segment
+            break;
+        } else {
+            return err;
+        }
+    }
+    return ESP_OK;
+}
+
+/**
+ * @brief Writes the pending block to flash, then erases the next segment's next sector if it is due.
+ *
+ * @param log The writer state
+ * @return
+ *      - ESP_OK on success, or if no records are pending
+ *      - Error code from the flash callbacks otherwise; the pending block is discarded
+ */
+esp_err_t canLogFlush(can_log_t *log) {
+    if (log->block_records == 0) return ESP_OK;
+
+    putLe16(&log->block[0], log->block_len);
+    putLe16(&log->block[2], log->block_records);
+    putLe64(&log->block[8], log->block_base_us);
+    putLe32(&log->block[4], canLogCrc32(0, &log->block[8], log->block_len - 8));
+
+    esp_err_t err = ESP_OK;
+    if (log->write_offset + log->block_len > CAN_LOG_SEGMENT_BYTES) err = openNextSegment(log);
+    if (err == ESP_OK) err = log->flash->write(log->flash->ctx, log->segment * CAN_LOG_SEGMENT_BYTES + log->write_offset, log->block, log->block_len);
+
+    if (err == ESP_OK) {
+        log->write_offset += log->block_len;
+        log->stats.blocks++;
+        log->stats.bytes += log->block_len;
+
+        // Keep the next segment erased one sector ahead of this one's fill level
+        if (log->erased_ahead < CAN_LOG_SEGMENT_BYTES && log->erased_ahead < log->write_offset + CAN_LOG_SECTOR_BYTES) {
+            uint32_t next = (log->segment + 1) % log->segment_count;
+            err = log->flash->erase(log->flash->ctx, next * CAN_LOG_SEGMENT_BYTES + log->erased_ahead, CAN_LOG_SECTOR_BYTES);
+            if (err == ESP_OK) {
+                log->erased_ahead += CAN_LOG_SECTOR_BYTES;
+                log->stats.sectors_erased++;
+            }
+        }
+    }
+    if (err != ESP_OK) log->stats.write_errors++;
+
+    log->block_len = 0;
+    log->block_records = 0;
+    return err;
+}
+
+/**
+ * @brief Encodes a frame into the pending block, flushing first if it does not fit.
+ *
+ * Each record stores the time since the previous record in the block, in
+ * microseconds (2 bytes, or 4 for longer gaps), a 2-byte standard or 4-byte
+ * extended ID and only the DLC's data bytes, so a standard 8-byte frame
+ * takes 13 bytes. A gap too long for 32 bits, or time going backwards,
+ * starts a new block with a fresh base timestamp.
+ *
+ * @param log The writer state
+ * @param record The frame to log
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_INVALID_ARG if the DLC is above 8
+ *      - Error code from canLogFlush() otherwise; the new record is still kept
+ */
+esp_err_t canLogAppend(can_log_t *log, const can_log_record_t *record) {
+    if (record->dlc > 8) return ESP_ERR_INVALID_ARG;
+
+    bool extended = (record->flags & CAN_LOG_FLAG_EXTENDED) != 0;
+    uint64_t delta = record->timestamp_us - log->last_us;
+    bool wide = delta > UINT16_MAX;
+    uint16_t size = 1 + (wide ? 4 : 2) + (extended ? 4 : 2) + record->dlc;
+
+    esp_err_t err = ESP_OK;
+    if (log->block_records > 0 &&
+        (log->block_len + size > CAN_LOG_BLOCK_BYTES || record->timestamp_us < log->last_us || delta > UINT32_MAX)) {
+        err = canLogFlush(log);
+    }
+    if (log->block_records == 0) {
+        log->block_len = CAN_LOG_BLOCK_HEADER_BYTES;
+        log->block_base_us = record->timestamp_us;
+        log->last_us = record->timestamp_us;
+        delta = 0;
+        wide = false;
+        size = 1 + 2 + (extended ? 4 : 2) + record->dlc;
+    }
+
+    uint8_t *p = &log->block[log->block_len];
+    *p++ = (record->dlc & RECORD_DLC_MASK) | (extended ? RECORD_EXTENDED : 0) |
+           ((record->flags & CAN_LOG_FLAG_RTR) ? RECORD_RTR : 0) | (wide ? RECORD_WIDE_DELTA : 0);
+    if (wide) {
+        putLe32(p, (uint32_t)delta);
+        p += 4;
+    } else {
+        putLe16(p, (uint16_t)delta);
+        p += 2;
+    }
+    if (extended) {
+        putLe32(p, record->id & 0x1FFFFFFF);
+        p += 4;
+    } else {
+        putLe16(p, (uint16_t)(record->id & 0x7FF));
+        p += 2;
+    }
+    memcpy(p, record->data, record->dlc);
+
+    log->block_len += size;
+    log->block_records++;
+    log->last_us = record->timestamp_us;
+    log->stats.records++;
+    return err;
+}
+
+/**
+ * @brief Returns true when the oldest pending record has waited CAN_LOG_FLUSH_MS.
+ */
+bool canLogFlushDue(const can_log_t *log, uint64_t now_us) {
+    return log->block_records > 0 && now_us - log->block_base_us >= (uint64_t)CAN_LOG_FLUSH_MS * 1000;
+}
+
+/**
+ * @brief Opens a reader positioned at the oldest record in a flash region.
+ *
+ * The oldest valid segment is found by sequence number; reading then follows
+ * consecutive sequence numbers around the ring until a gap, a blank segment
+ * or the newest segment's last good block.
+ *
+ * @param reader The reader state to initialize
+ * @param flash The flash region
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_INVALID_SIZE if the region is not a whole number of segments
+ *      - ESP_ERR_NOT_FOUND if the region holds no log
+ */
+esp_err_t canLogReaderOpen(can_log_reader_t *reader, const can_log_flash_t *flash) {
+    if (flash->size % CAN_LOG_SEGMENT_BYTES != 0 || flash->size == 0) return ESP_ERR_INVALID_SIZE;
+
+    memset(reader, 0, sizeof(*reader));
+    reader->flash = flash;
+    reader->segment_count = flash->size / CAN_LOG_SEGMENT_BYTES;
+
+    bool found = false;
+    for (uint32_t s = 0; s < reader->segment_count; s++) {
+        uint32_t seq;
+        if (readSegmentHeader(flash, s, &seq) && (!found || seq < reader->seq)) {
+            found = true;
+            reader->segment = s;
+            reader->seq = seq;
+        }
+    }
+    if (!found) return ESP_ERR_NOT_FOUND;
+
+    reader->segments_left = reader->segment_count;
+    reader->block_offset = CAN_LOG_SEGMENT_HEADER_BYTES;
+    return ESP_OK;
+}
+
+/**
+ * @brief Loads the next good block, moving on to the next segment when one runs out.
+ */
+static esp_err_t loadNextBlock(can_log_reader_t *reader) {
+    while (reader->segments_left > 0) {
+        esp_err_t err = readBlock(reader->flash, reader->segment, reader->block_offset, reader->block);
+        if (err == ESP_OK) {
+            reader->block_len = getLe16(&reader->block[0]);
+            reader->records_left = getLe16(&reader->block[2]);
+            reader->last_us = getLe64(&reader->block[8]);
+            reader->pos = CAN_LOG_BLOCK_HEADER_BYTES;
+            reader->block_offset += reader->block_len;
+            if (reader->records_left > 0) return ESP_OK;
+            continue;
+        }
+        if (err != ESP_ERR_NOT_FOUND && err != ESP_ERR_INVALID_CRC) return err;
+
+        // End of this segment's data, continue only into the segment written right after it
+        uint32_t next = (reader->segment + 1) % reader->segment_count, seq;
+        reader->segments_left--;
+        if (reader->segments_left == 0 || !readSegmentHeader(reader->flash, next, &seq) || seq != reader->seq + 1) break;
+        reader->segment = next;
+        reader->seq = seq;
+        reader->block_offset = CAN_LOG_SEGMENT_HEADER_BYTES;
+    }
+    reader->segments_left = 0;
+    return ESP_ERR_NOT_FOUND;
+}
+
+/**
+ * @brief Decodes the next record.
+ *
+ * @param reader The reader state
+ * @param record The decoded frame
+ * @return
+ *      - ESP_OK if a record was returned
+ *      - ESP_ERR_NOT_FOUND at the end of the log
+ *      - ESP_ERR_INVALID_SIZE if a block's records overrun its length
+ *      - Error code from the flash read otherwise
+ */
+esp_err_t canLogReaderNext(can_log_reader_t *reader, can_log_record_t *record) {
+    if (reader->records_left == 0) {
+        esp_err_t err = loadNextBlock(reader);
+        if (err != ESP_OK) return err;
+    }
+
+    const uint8_t *p = &reader->block[reader->pos];
+    const uint8_t *end = &reader->block[reader->block_len];
+    if (p >= end) return ESP_ERR_INVALID_SIZE;
+
+    uint8_t flags = *p++;
+    uint8_t dlc = flags & RECORD_DLC_MASK;
+    uint8_t size = ((flags & RECORD_WIDE_DELTA) ? 4 : 2) + ((flags & RECORD_EXTENDED) ? 4 : 2) + dlc;
+    if (dlc > 8 || p + size > end) return ESP_ERR_INVALID_SIZE;
+
+    if (flags & RECORD_WIDE_DELTA) {
+        reader->last_us += getLe32(p);
+        p += 4;
+    } else {
+        reader->last_us += getLe16(p);
+        p += 2;
+    }
+    memset(record, 0, sizeof(*record));
+    record->timestamp_us = reader->last_us;
+    if (flags & RECORD_EXTENDED) {
+        record->id = getLe32(p);
+        p += 4;
+    } else {
+        record->id = getLe16(p);
+        p += 2;
+    }
+    record->dlc = dlc;
+    record->flags = ((flags & RECORD_EXTENDED) ? CAN_LOG_FLAG_EXTENDED : 0) | ((flags & RECORD_RTR) ? CAN_LOG_FLAG_RTR : 0);
+    memcpy(record->data, p, dlc);
+
+    reader->pos = (uint16_t)(p + dlc - reader->block);
+    reader->records_left--;
+    return ESP_OK;
+}
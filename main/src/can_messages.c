@@ -0,0 +1,392 @@
+#include <stddef.h>
+#include <stdint.h>
+
+#include "inc/can_sched.h"
+#include "inc/can_signals.h"
+#include "inc/diag.h"
+#include "inc/load.h"
+
+_Static_assert(ANALOG_VOLTAGE_1_ID == CAN_BASEID, "esp32-canboard.dbc does not start at CAN_BASEID");
+
+#define CAN_CHANGE_INTERVAL_MS 4 // Caps each on-change frame at 250 Hz, ~25% of 500 kbit/s for all four at once
+#define CH(n) CAN_SCHED_CHANNEL(n)
+#define PACKED_INPUTS_PER_PAGE 5
+#define PACKED_BOARD_EVERY 10   // Every 10th 0x626 frame is the board page, unless an input page has changed
+#define BOARD_STATE_BOOTING 0   // boardState values, see the DBC
+#define BOARD_STATE_RUNNING 1
+
+/**
+ * @brief Rounds a deci-°C snapshot value to the whole degrees carried on the bus.
+ */
+static inline int8_t deciToCelsius(int32_t deci_c) {
+    int32_t c = (deci_c >= 0 ? deci_c + 5 : deci_c - 5) / 10;
+    return (int8_t)(c > INT8_MAX ? INT8_MAX : c < INT8_MIN ? INT8_MIN : c);
+}
+
+/**
+ * @brief Rescales a non-negative snapshot value to `step` units per bit, rounding and saturating at `max`.
+ */
+static inline uint16_t scaleToField(int32_t value, int32_t step, uint16_t max) {
+    if (value <= 0) return 0;
+    int32_t raw = (value + step / 2) / step;
+    return (uint16_t)(raw > max ? max : raw);
+}
+
+/**
+ * @brief Saturates a signed snapshot value to a 16-bit signed signal.
+ */
+static inline int16_t toInt16(int32_t value) {
+    return (int16_t)(value > INT16_MAX ? INT16_MAX : value < INT16_MIN ? INT16_MIN : value);
+}
+
+// Each packer maps one sweep onto the DBC-generated message struct; the
+// generated *_pack routine owns the byte layout (see dbc/dbc2c.py). Packers
+// that rotate keep their place in `state`, the message's scheduler entry.
+
+static void packAnalogVoltage1(const sensor_values_t *v, uint8_t *data, can_pack_state_t *state) {
+    analogVoltage_1_t m = {
+        .cpuTemperature = v->cpu_temperature,
+        .input1_voltage = v->filtered_mv[0], // Charge Cooler Inlet Pressure (BMW TMAP 13627843531)
+        .input2_voltage = v->filtered_mv[1], // Exhaust Back Pressure
+        .input3_voltage = v->filtered_mv[2], // Crank Case Pressure (Bosch MAP 0261230119)
+    };
+    analogVoltage_1_pack(&m, data);
+}
+
+static void packAnalogVoltage2(const sensor_values_t *v, uint8_t *data, can_pack_state_t *state) {
+    analogVoltage_2_t m = {
+        .input4_voltage = v->filtered_mv[3], // Turbo Regulator Oil Pressure
+        .input5_voltage = v->filtered_mv[4],
+        .input6_voltage = v->filtered_mv[5],
+        .input7_voltage = v->filtered_mv[6],
+    };
+    analogVoltage_2_pack(&m, data);
+}
+
+static void packAnalogVoltage3(const sensor_values_t *v, uint8_t *data, can_pack_state_t *state) {
+    analogVoltage_3_t m = {
+        .input8_voltage = v->filtered_mv[7],  // Charge Cooler Inlet Temperature (BMW TMAP 13627843531)
+        .input9_voltage = v->filtered_mv[8],  // Charge Cooler Water Temperature (Bosch 0280130026)
+        .input10_voltage = v->filtered_mv[9], // Air Temperature (Bosch 0280130039)
+    };
+    analogVoltage_3_pack(&m, data);
+}
+
+static void packSensorValues1(const sensor_values_t *v, uint8_t *data, can_pack_state_t *state) {
+    sensorValues_1_t m = {
+        .chargeCoolerWaterTemp = deciToCelsius(v->outputs[SENSOR_SLOT_CC_WATER_TEMP]),
+        .airTemp = deciToCelsius(v->outputs[SENSOR_SLOT_AIR_TEMP]),
+        .chargeCoolerInletTemp = deciToCelsius(v->outputs[SENSOR_SLOT_CC_INLET_TEMP]),
+        .chargeCoolerInletPressure = (uint16_t)v->outputs[SENSOR_SLOT_CC_INLET_PRESSURE],
+        .exhaustBackPressure = (uint16_t)v->outputs[SENSOR_SLOT_EXHAUST_BACK_PRESSURE],
+    };
+    sensorValues_1_pack(&m, data);
+}
+
+static void packSensorValues2(const sensor_values_t *v, uint8_t *data, can_pack_state_t *state) {
+    sensorValues_2_t m = {
+        .crankCasePressure = (uint16_t)v->outputs[SENSOR_SLOT_CRANK_CASE_PRESSURE],
+        .turboOilPressure = (uint16_t)v->outputs[SENSOR_SLOT_TURBO_OIL_PRESSURE],
+    };
+    sensorValues_2_pack(&m, data);
+}
+
+/**
+ * @brief Returns true if a channel on an input page changed after the page was last packed.
+ */
+static bool packedPageChanged(const sensor_values_t *v, int page, uint32_t packed_sweep) {
+    for (int ch = page * PACKED_INPUTS_PER_PAGE; ch < (page + 1) * PACKED_INPUTS_PER_PAGE; ch++) {
+        if ((int32_t)(v->changed_sweep[ch] - packed_sweep) > 0) return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Packs one page of the multiplexed input voltage frame.
+ *
+ * The two input pages alternate and every PACKED_BOARD_EVERY-th frame
+ * carries the board page (CPU temperature). A page whose channels changed
+ * since it last went out is sent first, so an on-change frame carries the
+ * change.
+ */
+static void packPackedVoltages(const sensor_values_t *v, uint8_t *data, can_pack_state_t *state) {
+    uint32_t *page_sweep = state->page_sweep;
+    uint8_t page = state->next;
+    bool board_due = ++state->frames % PACKED_BOARD_EVERY == 0;
+    if (!packedPageChanged(v, page, page_sweep[page]) && packedPageChanged(v, page ^ 1, page_sweep[page ^ 1])) {
+        page ^= 1;
+    } else if (board_due && !packedPageChanged(v, page, page_sweep[page])) {
+        page = 2;
+    }
+
+    packedVoltages_t m = { .voltagePage = page };
+    if (page == 2) {
+        m.cpuTemperature = v->cpu_temperature;
+        packedVoltages_pack(&m, data);
+        return;
+    }
+    uint16_t mv[PACKED_INPUTS_PER_PAGE];
+    for (int i = 0; i < PACKED_INPUTS_PER_PAGE; i++) mv[i] = scaleToField(v->filtered_mv[page * PACKED_INPUTS_PER_PAGE + i], 2, 0xFFF);
+    if (page == 0) {
+        m.input1_voltage = mv[0];   // Charge Cooler Inlet Pressure (BMW TMAP 13627843531)
+        m.input2_voltage = mv[1];   // Exhaust Back Pressure
+        m.input3_voltage = mv[2];   // Crank Case Pressure (Bosch MAP 0261230119)
+        m.input4_voltage = mv[3];   // Turbo Regulator Oil Pressure
+        m.input5_voltage = mv[4];
+    } else {
+        m.input6_voltage = mv[0];
+        m.input7_voltage = mv[1];
+        m.input8_voltage = mv[2];   // Charge Cooler Inlet Temperature (BMW TMAP 13627843531)
+        m.input9_voltage = mv[3];   // Charge Cooler Water Temperature (Bosch 0280130026)
+        m.input10_voltage = mv[4];  // Air Temperature (Bosch 0280130039)
+    }
+    packedVoltages_pack(&m, data);
+    page_sweep[page] = v->sweep;
+    state->next = page ^ 1;
+}
+
+static void packPackedSensors(const sensor_values_t *v, uint8_t *data, can_pack_state_t *state) {
+    packedSensors_t m = {
+        .chargeCoolerWaterTemp = deciToCelsius(v->outputs[SENSOR_SLOT_CC_WATER_TEMP]),
+        .airTemp = deciToCelsius(v->outputs[SENSOR_SLOT_AIR_TEMP]),
+        .chargeCoolerInletTemp = deciToCelsius(v->outputs[SENSOR_SLOT_CC_INLET_TEMP]),
+        .chargeCoolerInletPressure = scaleToField(v->outputs[SENSOR_SLOT_CC_INLET_PRESSURE], 10, 0xFFF),  // 0.1 kPa
+        .crankCasePressure = scaleToField(v->outputs[SENSOR_SLOT_CRANK_CASE_PRESSURE], 10, 0xFFF),        // 0.1 kPa
+        .exhaustBackPressure = (uint8_t)scaleToField(v->outputs[SENSOR_SLOT_EXHAUST_BACK_PRESSURE], 50, 0xFF), // 0.5 psi
+        .turboOilPressure = (uint8_t)scaleToField(v->outputs[SENSOR_SLOT_TURBO_OIL_PRESSURE], 5, 0xFF),    // 0.05 bar
+    };
+    packedSensors_pack(&m, data);
+}
+
+/**
+ * @brief Reports whether every input is valid yet, and which are.
+ *
+ * Packs no channels, so the scheduler never holds it back: at offset 0 it
+ * is the first frame on the bus after boot, and it tells the ECU which of
+ * the frames that follow it can trust. The sample time is that of the
+ * packed sweep (0 before the first), so a frozen value means stale data
+ * and a smaller one a reboot.
+ */
+static void packBoardStatus(const sensor_values_t *v, uint8_t *data, can_pack_state_t *state) {
+    boardStatus_t m = {
+        .boardState = (v->valid == SNAPSHOT_ALL_CHANNELS) ? BOARD_STATE_RUNNING : BOARD_STATE_BOOTING,
+        .channelValid = (uint16_t)v->valid,
+        .sampleTime = (uint32_t)(v->timestamp_us / 1000),
+    };
+    boardStatus_pack(&m, data);
+}
+
+/**
+ * @brief Reports each input's latched fault, 3 bits apiece (see fault_code_t).
+ *
+ * Packs no channels, so it is never held back; an input still filling its
+ * filter reads ok. A faulted input's engineering value is its failsafe in
+ * every frame, and its voltage stays what was measured.
+ */
+static void packSensorStatus(const sensor_values_t *v, uint8_t *data, can_pack_state_t *state) {
+    sensorStatus_t m = {
+        .input1_fault = v->fault[0],
+        .input2_fault = v->fault[1],
+        .input3_fault = v->fault[2],
+        .input4_fault = v->fault[3],
+        .input5_fault = v->fault[4],
+        .input6_fault = v->fault[5],
+        .input7_fault = v->fault[6],
+        .input8_fault = v->fault[7],
+        .input9_fault = v->fault[8],
+        .input10_fault = v->fault[9],
+    };
+    sensorStatus_pack(&m, data);
+}
+
+/**
+ * @brief Packs the published derived channels, see derived_table.
+ *
+ * Peaks, rates and rolling extremes summarise a window, so the frame goes
+ * out on its period only.
+ */
+static void packDerivedValues(const sensor_values_t *v, uint8_t *data, can_pack_state_t *state) {
+    derivedValues_t m = {
+        .chargeCoolerPressureDrop = toInt16(v->derived[0]),
+        .crankCasePressurePeak = scaleToField(v->derived[1], 1, UINT16_MAX),
+        .chargeCoolerWaterTempRate = toInt16(v->derived[2]),
+        .chargeCoolerInletTempMin = deciToCelsius(v->derived[3]),
+        .chargeCoolerInletTempMax = deciToCelsius(v->derived[4]),
+    };
+    derivedValues_pack(&m, data);
+}
+
+/**
+ * @brief Packs the frequency inputs, see capture_table.
+ *
+ * Each frequency is averaged over its input's window, so the frame goes out
+ * on its period only. An input with no edges for its timeout reads 0 Hz.
+ */
+static void packCaptureValues(const sensor_values_t *v, uint8_t *data, can_pack_state_t *state) {
+    captureValues_t m = {
+        .capture1Frequency = v->capture_freq[0] > 0x3FFFFF ? 0x3FFFFF : v->capture_freq[0],
+        .capture1Duty = v->capture_duty[0],
+        .capture2Frequency = v->capture_freq[1] > 0x3FFFFF ? 0x3FFFFF : v->capture_freq[1],
+        .capture2Duty = v->capture_duty[1],
+    };
+    captureValues_pack(&m, data);
+}
+
+#if CONFIG_CANBOARD_DIAG
+static inline uint16_t diagField(uint32_t value) { return (uint16_t)(value > DIAG_FIELD_MAX ? DIAG_FIELD_MAX : value); }
+
+/**
+ * @brief Broadcasts one instrumentation metric per frame, in rotation.
+ *
+ * Each metric's window is closed when it is sent, so with the frame every
+ * 100 ms each metric covers the previous 800 ms. A metric whose task has not
+ * run since its last frame reads as all zeros.
+ */
+static void packDiagnostics(const sensor_values_t *v, uint8_t *data, can_pack_state_t *state) {
+    diag_report_t r;
+    diagnostics_t m = { .diagMetric = state->next };
+    if (diagCollect(&diag, (diag_metric_id_t)state->next, &r)) {
+        m.diagMin = diagField(r.min);
+        m.diagAvg = diagField(r.avg);
+        m.diagP99 = diagField(r.p99);
+        m.diagMax = diagField(r.max);
+    }
+    diagnostics_pack(&m, data);
+    state->next = (uint8_t)((state->next + 1) % DIAG_METRIC_COUNT);
+}
+
+/**
+ * @brief Broadcasts one running task's CPU share, free stack and placement per frame, in rotation.
+ *
+ * Tasks that are not running (initInputs once it is done) are skipped, so
+ * with the frame every 100 ms each task is reported every 700 ms. Figures
+ * are those of the load monitor's last window; before its first window
+ * every field but the task number reads 0.
+ */
+static void packTaskLoad(const sensor_values_t *v, uint8_t *data, can_pack_state_t *state) {
+    load_report_t r;
+    loadReport(&task_load, &r);
+    uint8_t task = state->next;
+    for (int i = 0; i < TASK_COUNT && !(r.running & (1u << task)); i++) task = (uint8_t)((task + 1) % TASK_COUNT);
+
+    taskLoad_t m = { .loadTask = task };
+    if (r.running & (1u << task)) {
+        const task_placement_t *p = &task_placement[task];
+        m.loadCore = (uint8_t)(p->core == TASK_ANY_CORE ? 15 : p->core);
+        m.loadPriority = p->priority;
+        m.loadCpu = r.cpu_permille[task];
+        m.loadStackFree = (uint16_t)(r.stack_free[task] > UINT16_MAX ? UINT16_MAX : r.stack_free[task]);
+        m.loadStackSize = (uint16_t)(p->stack_bytes > UINT16_MAX ? UINT16_MAX : p->stack_bytes);
+    }
+    taskLoad_pack(&m, data);
+    state->next = (uint8_t)((task + 1) % TASK_COUNT);
+}
+
+/**
+ * @brief Broadcasts each core's load, the heap and which tasks are short of stack.
+ */
+static void packSystemLoad(const sensor_values_t *v, uint8_t *data, can_pack_state_t *state) {
+    load_report_t r;
+    loadReport(&task_load, &r);
+    systemLoad_t m = {
+        .core0Load = r.core_permille[0],
+        .core1Load = r.core_permille[1],
+        .heapFree = scaleToField((int32_t)(r.heap_free >> 10), 1, 0xFFF),
+        .heapMinFree = scaleToField((int32_t)(r.heap_min_free >> 10), 1, 0xFFF),
+        .heapLargestBlock = scaleToField((int32_t)(r.heap_largest >> 10), 1, 0xFFF),
+        .lowStackTasks = (uint8_t)r.low_stack,
+    };
+    systemLoad_pack(&m, data);
+}
+#endif
+
+#if CONFIG_CANBOARD_DIAG
+#define DIAGNOSTICS_MESSAGE \
+    { .id = DIAGNOSTICS_ID,      .period_ms = 100, .offset_ms = 14, .dlc = DIAGNOSTICS_DLC,      .pack = packDiagnostics },
+#define LOAD_MESSAGES \
+    { .id = TASK_LOAD_ID,        .period_ms = 100, .offset_ms = 18, .dlc = TASK_LOAD_DLC,        .pack = packTaskLoad }, \
+    { .id = SYSTEM_LOAD_ID,      .period_ms = 1000, .offset_ms = 10, .dlc = SYSTEM_LOAD_DLC,     .pack = packSystemLoad },
+#else
+#define DIAGNOSTICS_MESSAGE
+#define LOAD_MESSAGES
+#endif
+
+#define STATUS_MESSAGES \
+    { .id = BOARD_STATUS_ID,     .period_ms = 100, .offset_ms = 0, .dlc = BOARD_STATUS_DLC,     .pack = packBoardStatus }, \
+    { .id = SENSOR_STATUS_ID,    .period_ms = 20,  .offset_ms = 12, .dlc = SENSOR_STATUS_DLC,   .pack = packSensorStatus },
+
+#define DERIVED_MESSAGE \
+    { .id = DERIVED_VALUES_ID,   .period_ms = 100, .offset_ms = 16, .dlc = DERIVED_VALUES_DLC,  .pack = packDerivedValues, \
+      .channels = CH(0) | CH(2) | CH(7) | CH(8) },
+
+#define CAPTURE_MESSAGE \
+    { .id = CAPTURE_VALUES_ID,   .period_ms = 20,  .offset_ms = 10, .dlc = CAPTURE_VALUES_DLC,  .pack = packCaptureValues },
+
+/**
+ * @brief Periodic message table with 16-bit signals, in ID order.
+ *
+ * Pressure frames go out at 100 Hz, raw input voltages at 50 Hz and the
+ * slow-moving temperature voltages at 10 Hz. Offsets stagger frames so no
+ * two share a tick, except the 10 Hz board status frame, which goes first
+ * after boot. The 50 Hz sensor status frame carries each input's fault,
+ * the 10 Hz derived values frame the channels in derived_table, and the
+ * 50 Hz capture values frame the frequency inputs in capture_table; it has
+ * the one slot the 20 ms frames leave, shared once a second with 0x62C.
+ * IDs come from dbc/esp32-canboard.dbc. The diagnostics and load frames
+ * are only built with CONFIG_CANBOARD_DIAG.
+ *
+ * With CONFIG_CANBOARD_CAN_TX_EVENT_DRIVEN the pressure and input voltage
+ * frames also go out as soon as a pressure channel moves past its deadband,
+ * at most every CAN_CHANGE_INTERVAL_MS; their periods become heartbeats.
+ */
+const can_message_def_t can_messages_wide[] = {
+    { .id = ANALOG_VOLTAGE_1_ID, .period_ms = 20,  .offset_ms = 0, .dlc = ANALOG_VOLTAGE_1_DLC, .pack = packAnalogVoltage1,
+      .channels = CH(0) | CH(1) | CH(2), .min_interval_ms = CAN_CHANGE_INTERVAL_MS },
+    { .id = ANALOG_VOLTAGE_2_ID, .period_ms = 20,  .offset_ms = 2, .dlc = ANALOG_VOLTAGE_2_DLC, .pack = packAnalogVoltage2,
+      .channels = CH(3) | CH(4) | CH(5) | CH(6), .min_interval_ms = CAN_CHANGE_INTERVAL_MS },
+    { .id = ANALOG_VOLTAGE_3_ID, .period_ms = 100, .offset_ms = 4, .dlc = ANALOG_VOLTAGE_3_DLC, .pack = packAnalogVoltage3,
+      .channels = CH(7) | CH(8) | CH(9) },
+    { .id = SENSOR_VALUES_1_ID,  .period_ms = 10,  .offset_ms = 6, .dlc = SENSOR_VALUES_1_DLC,  .pack = packSensorValues1,
+      .channels = CH(0) | CH(1) | CH(7) | CH(8) | CH(9), .min_interval_ms = CAN_CHANGE_INTERVAL_MS },
+    { .id = SENSOR_VALUES_2_ID,  .period_ms = 10,  .offset_ms = 8, .dlc = SENSOR_VALUES_2_DLC,  .pack = packSensorValues2,
+      .channels = CH(2) | CH(3), .min_interval_ms = CAN_CHANGE_INTERVAL_MS },
+    DIAGNOSTICS_MESSAGE
+    STATUS_MESSAGES
+    DERIVED_MESSAGE
+    LOAD_MESSAGES
+    CAPTURE_MESSAGE
+};
+
+/**
+ * @brief Periodic message table with packed signals, in ID order.
+ *
+ * Two frames carry what the wide table spreads over five. 0x626 goes out
+ * at 100 Hz with the input pages alternating, so every input voltage
+ * reaches the bus at ~45 Hz, temperatures included. 0x627 carries every
+ * engineering value at 100 Hz. Both also go out on change, as in the wide
+ * table. The diagnostics, status, derived values, load and capture values
+ * frames are shared with it.
+ */
+const can_message_def_t can_messages_packed[] = {
+    { .id = PACKED_VOLTAGES_ID,  .period_ms = 10,  .offset_ms = 0, .dlc = PACKED_VOLTAGES_DLC,  .pack = packPackedVoltages,
+      .channels = CH(0) | CH(1) | CH(2) | CH(3) | CH(4) | CH(5) | CH(6) | CH(7) | CH(8) | CH(9),
+      .min_interval_ms = CAN_CHANGE_INTERVAL_MS },
+    { .id = PACKED_SENSORS_ID,   .period_ms = 10,  .offset_ms = 4, .dlc = PACKED_SENSORS_DLC,   .pack = packPackedSensors,
+      .channels = CH(0) | CH(1) | CH(2) | CH(3) | CH(7) | CH(8) | CH(9), .min_interval_ms = CAN_CHANGE_INTERVAL_MS },
+    DIAGNOSTICS_MESSAGE
+    STATUS_MESSAGES
+    DERIVED_MESSAGE
+    LOAD_MESSAGES
+    CAPTURE_MESSAGE
+};
+
+const size_t can_messages_wide_count = sizeof(can_messages_wide) / sizeof(can_messages_wide[0]);
+const size_t can_messages_packed_count = sizeof(can_messages_packed) / sizeof(can_messages_packed[0]);
+
+#if CONFIG_CANBOARD_CAN_PACKED
+const can_message_def_t *const can_messages = can_messages_packed;
+const size_t can_messages_count = sizeof(can_messages_packed) / sizeof(can_messages_packed[0]);
+#else
+const can_message_def_t *const can_messages = can_messages_wide;
+const size_t can_messages_count = sizeof(can_messages_wide) / sizeof(can_messages_wide[0]);
+#endif
@@ -0,0 +1,201 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "esp_err.h"
+#include "inc/can_rx.h"
+
+#define STD_ID_MASK 0x7FFu
+
+// twai_filter_config_t layout for standard frames
+#define SINGLE_ID_SHIFT 21
+#define SINGLE_DONT_CARE 0x001FFFFFu    // RTR and both data bytes
+#define DUAL_ID1_SHIFT 21
+#define DUAL_ID2_SHIFT 5
+#define DUAL_DONT_CARE 0x001F001Fu      // RTR and data byte 1 of filter 1, RTR of filter 2
+
+/**
+ * @brief A set of standard IDs matched by one code/mask pair.
+ */
+typedef struct {
+    uint16_t and_bits;  // Bits set in every ID of the group
+    uint16_t or_bits;   // Bits set in any ID of the group
+} id_group_t;
+
+static uint16_t groupMask(id_group_t g) { return (g.and_bits ^ g.or_bits) & STD_ID_MASK; }
+static uint32_t groupSize(id_group_t g) { return 1u << __builtin_popcount(groupMask(g)); }
+
+static void groupAdd(id_group_t *g, bool *empty, uint32_t id) {
+    if (*empty) {
+        g->and_bits = g->or_bits = (uint16_t)id;
+        *empty = false;
+    } else {
+        g->and_bits &= (uint16_t)id;
+        g->or_bits |= (uint16_t)id;
+    }
+}
+
+/**
+ * @brief Number of standard IDs accepted by either of two groups.
+ */
+static uint32_t unionSize(id_group_t a, id_group_t b) {
+    uint16_t ma = groupMask(a), mb = groupMask(b);
+    uint32_t size = groupSize(a) + groupSize(b);
+    if (((a.and_bits ^ b.and_bits) & ~ma & ~mb & STD_ID_MASK) == 0) size -= 1u << __builtin_popcount(ma & mb);
+    return size;
+}
+
+/**
+ * @brief Splits the subscriptions in two by `select` (bit i picks group B for subs[i]) and scores the split.
+ */
+static uint32_t splitCost(const can_rx_sub_t *subs, size_t count, bool (*select)(const can_rx_sub_t *, size_t, uint32_t),
+                          uint32_t arg, id_group_t *a, id_group_t *b) {
+    bool a_empty = true, b_empty = true;
+    for (size_t i = 0; i < count; i++) {
+        if (select(subs, i, arg)) groupAdd(b, &b_empty, subs[i].id);
+        else groupAdd(a, &a_empty, subs[i].id);
+    }
+    if (a_empty || b_empty) return UINT32_MAX;
+    return unionSize(*a, *b);
+}
+
+static bool selectByMask(const can_rx_sub_t *subs, size_t i, uint32_t mask) { return (mask >> i) & 1u; }
+static bool selectByBit(const can_rx_sub_t *subs, size_t i, uint32_t bit) { return (subs[i].id >> bit) & 1u; }
+static bool selectAbove(const can_rx_sub_t *subs, size_t i, uint32_t limit) { return subs[i].id >= limit; }
+
+/**
+ * @brief Computes the tightest TWAI acceptance filter for a set of standard IDs.
+ *
+ * A single filter accepts every ID that matches the bits all subscriptions
+ * share. A dual filter splits the subscriptions into two groups, each with
+ * its own code/mask; the split that lets the fewest IDs through is used, and
+ * the dual filter is chosen only when it beats the single one. Up to
+ * CAN_RX_EXHAUSTIVE_MAX subscriptions every split is tried; above that the
+ * candidates are splits on one ID bit and splits by ID value.
+ *
+ * @param subs The subscriptions
+ * @param count The number of subscriptions
+ * @param filter The resulting filter
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_NOT_FOUND if there are no subscriptions (keep accepting all)
+ *      - ESP_ERR_INVALID_ARG if an ID is not a standard 11-bit ID
+ */
+esp_err_t canRxComputeFilter(const can_rx_sub_t *subs, size_t count, can_rx_filter_t *filter) {
+    if (count == 0) return ESP_ERR_NOT_FOUND;
+
+    id_group_t all = {0};
+    bool empty = true;
+    for (size_t i = 0; i < count; i++) {
+        if (subs[i].id > STD_ID_MASK) return ESP_ERR_INVALID_ARG;
+        groupAdd(&all, &empty, subs[i].id);
+    }
+
+    uint32_t best = UINT32_MAX;
+    id_group_t best_a = all, best_b = all;
+    id_group_t a = all, b = all;
+    if (count <= CAN_RX_EXHAUSTIVE_MAX) {
+        // subs[0] always stays in group A, which halves the search
+        for (uint32_t mask = 2; mask < (1u << count); mask += 2) {
+            uint32_t cost = splitCost(subs, count, selectByMask, mask, &a, &b);
+            if (cost < best) { best = cost; best_a = a; best_b = b; }
+        }
+    } else {
+        for (uint32_t bit = 0; bit < 11; bit++) {
+            uint32_t cost = splitCost(subs, count, selectByBit, bit, &a, &b);
+            if (cost < best) { best = cost; best_a = a; best_b = b; }
+        }
+        for (size_t i = 0; i < count; i++) {
+            uint32_t cost = splitCost(subs, count, selectAbove, subs[i].id, &a, &b);
+            if (cost < best) { best = cost; best_a = a; best_b = b; }
+        }
+    }
+
+    if (best < groupSize(all)) {
+        filter->dual = true;
+        filter->acceptance_code = (uint32_t)best_a.and_bits << DUAL_ID1_SHIFT | (uint32_t)best_b.and_bits << DUAL_ID2_SHIFT;
+        filter->acceptance_mask = (uint32_t)groupMask(best_a) << DUAL_ID1_SHIFT | (uint32_t)groupMask(best_b) << DUAL_ID2_SHIFT | DUAL_DONT_CARE;
+        filter->accepted_ids = best;
+    } else {
+        filter->dual = false;
+        filter->acceptance_code = (uint32_t)all.and_bits << SINGLE_ID_SHIFT;
+        filter->acceptance_mask = (uint32_t)groupMask(all) << SINGLE_ID_SHIFT | SINGLE_DONT_CARE;
+        filter->accepted_ids = groupSize(all);
+    }
+    return ESP_OK;
+}
+
+/**
+ * @brief Emulates the TWAI acceptance filter on an identifier (RTR and data bytes not compared).
+ *
+ * Extended frames are matched the way the controller does: all 29 ID bits
+ * in single filter mode, ID[28:13] against each filter in dual mode. With a
+ * filter built for standard IDs this lets through extended frames whose top
+ * bits happen to match, which canRxDispatch() then discards.
+ */
+bool canRxFilterAccepts(const can_rx_filter_t *filter, uint32_t id, bool extended) {
+    uint32_t code = filter->acceptance_code, care = ~filter->acceptance_mask;
+    if (!filter->dual) {
+        uint32_t bits = extended ? (id << 3) : (id << SINGLE_ID_SHIFT);
+        return ((bits ^ code) & care & (extended ? 0xFFFFFFF8u : 0xFFE00000u)) == 0;
+    }
+    if (extended) {
+        uint32_t top = (id >> 13) & 0xFFFF;
+        return (((top << 16) ^ code) & care & 0xFFFF0000u) == 0 || ((top ^ code) & care & 0x0000FFFFu) == 0;
+    }
+    return (((id << DUAL_ID1_SHIFT) ^ code) & care & 0xFFE00000u) == 0 ||
+           (((id << DUAL_ID2_SHIFT) ^ code) & care & 0x0000FFE0u) == 0;
+}
+
+/**
+ * @brief Builds the ID→subscription map for a subscription table.
+ *
+ * @param rx The dispatcher state to initialize
+ * @param subs The subscriptions, which must outlive the dispatcher
+ * @param count The number of subscriptions
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_INVALID_ARG if an ID is extended or repeated, or a handler is NULL
+ *      - ESP_ERR_INVALID_SIZE if there are more than CAN_RX_MAX_SUBSCRIPTIONS
+ */
+esp_err_t canRxInit(can_rx_t *rx, const can_rx_sub_t *subs, size_t count) {
+    if (rx == NULL || (subs == NULL && count > 0)) return ESP_ERR_INVALID_ARG;
+    if (count > CAN_RX_MAX_SUBSCRIPTIONS) return ESP_ERR_INVALID_SIZE;
+
+    memset(rx, 0, sizeof(*rx));
+    memset(rx->index, CAN_RX_NO_HANDLER, sizeof(rx->index));
+    for (size_t i = 0; i < count; i++) {
+        if (subs[i].id > STD_ID_MASK || subs[i].handler == NULL || rx->index[subs[i].id] != CAN_RX_NO_HANDLER) return ESP_ERR_INVALID_ARG;
+        rx->index[subs[i].id] = (uint8_t)i;
+    }
+    rx->subs = subs;
+    rx->count = count;
+    return ESP_OK;
+}
+
+/**
+ * @brief Hands a received frame to its subscriber, if any.
+ *
+ * @param rx The dispatcher state
+ * @param frame The received frame
+ * @param extended True for a 29-bit identifier
+ * @return True if a handler consumed the frame
+ */
+bool canRxDispatch(can_rx_t *rx, const can_frame_t *frame, bool extended) {
+    rx->stats.frames++;
+    if (extended) {
+        rx->stats.extended++;
+        return false;
+    }
+
+    uint8_t slot = rx->index[frame->id & STD_ID_MASK];
+    if (slot == CAN_RX_NO_HANDLER || frame->id > STD_ID_MASK) {
+        rx->stats.unsubscribed++;
+        return false;
+    }
+
+    const can_rx_sub_t *sub = &rx->subs[slot];
+    sub->handler(sub->ctx, frame);
+    rx->stats.dispatched++;
+    return true;
+}
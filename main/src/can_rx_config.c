@@ -0,0 +1,46 @@
+#include "inc/can_rx.h"
+
+volatile ecu_values_t ecu_values;
+
+/**
+ * @brief EMU stream frame 0: RPM, TPS, IAT, MAP (little-endian).
+ */
+static void emuStreamFrame0(void *ctx, const can_frame_t *frame) {
+    if (frame->dlc < 6) return;
+    ecu_values.rpm = (uint16_t)(frame->data[0] | frame->data[1] << 8);
+    ecu_values.tps_half_pct = frame->data[2];
+    ecu_values.iat_c = (int8_t)frame->data[3];
+    ecu_values.map_kpa = (uint16_t)(frame->data[4] | frame->data[5] << 8);
+    ecu_values.frames++;
+}
+
+/**
+ * @brief EMU stream frame 2: coolant temperature in bytes 6-7.
+ */
+static void emuStreamFrame2(void *ctx, const can_frame_t *frame) {
+    if (frame->dlc < 8) return;
+    ecu_values.clt_c = (int16_t)(frame->data[6] | frame->data[7] << 8);
+    ecu_values.frames++;
+}
+
+/**
+ * @brief EMU stream frame 3: lambda in byte 2.
+ */
+static void emuStreamFrame3(void *ctx, const can_frame_t *frame) {
+    if (frame->dlc < 3) return;
+    ecu_values.lambda_q7 = frame->data[2];
+    ecu_values.frames++;
+}
+
+/**
+ * @brief Received IDs the board consumes. The hardware acceptance filter is
+ *        computed from this table, so everything else on the bus is dropped
+ *        by the controller.
+ */
+const can_rx_sub_t can_rx_table[] = {
+    { EMU_STREAM_BASEID + 0, emuStreamFrame0, NULL },
+    { EMU_STREAM_BASEID + 2, emuStreamFrame2, NULL },
+    { EMU_STREAM_BASEID + 3, emuStreamFrame3, NULL },
+};
+
+const size_t can_rx_table_count = sizeof(can_rx_table) / sizeof(can_rx_table[0]);
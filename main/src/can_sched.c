@@ -0,0 +1,194 @@
+#include <stdint.h>
+#include <string.h>
+
+#include "esp_err.h"
+#include "inc/can_sched.h"
+
+/**
+ * @brief Initializes the scheduler from a static message table.
+ *
+ * Each message first becomes due at `now_ms + offset_ms` and then every
+ * `period_ms` after that, measured on an absolute timeline so that the
+ * time taken to pack and queue a frame does not accumulate as drift.
+ * Every packer rotation (input pages, metrics, tasks) starts from its
+ * first position.
+ *
+ * @param sched The scheduler state
+ * @param table The message table
+ * @param count Number of entries in `table`
+ * @param now_ms The current time in milliseconds
+ * @param transmit Non-blocking transmit hook
+ * @param ctx Opaque pointer passed to `transmit`
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_INVALID_ARG if an argument or table entry is invalid
+ *      - ESP_ERR_INVALID_SIZE if the table exceeds CAN_SCHED_MAX_MESSAGES
+ */
+esp_err_t canSchedInit(can_sched_t *sched, const can_message_def_t *table, size_t count, uint32_t now_ms,
+                       can_sched_tx_fn_t transmit, void *ctx) {
+    if (sched == NULL || table == NULL || transmit == NULL) return ESP_ERR_INVALID_ARG;
+    if (count > CAN_SCHED_MAX_MESSAGES) return ESP_ERR_INVALID_SIZE;
+
+    memset(sched, 0, sizeof(*sched));
+    for (size_t i = 0; i < count; i++) {
+        if (table[i].period_ms == 0 || table[i].pack == NULL || table[i].dlc > 8) return ESP_ERR_INVALID_ARG;
+        sched->entries[i].def = &table[i];
+        sched->entries[i].next_due_ms = now_ms + table[i].offset_ms;
+    }
+    sched->count = count;
+    sched->transmit = transmit;
+    sched->ctx = ctx;
+    return ESP_OK;
+}
+
+/**
+ * @brief Enables or disables on-change sends.
+ *
+ * When enabled, canSchedRun() also sends a message ahead of its slot once
+ * any channel it packs has changed since its last frame (see
+ * channelsMarkChanges()), subject to the message's `min_interval_ms`.
+ * Disabled after canSchedInit(), so every message keeps its fixed rate.
+ *
+ * @param sched The scheduler state
+ * @param enable True to send on change
+ */
+void canSchedSetOnChange(can_sched_t *sched, bool enable) {
+    sched->on_change = enable;
+}
+
+/**
+ * @brief Returns true if a channel packed into the entry's frame changed after its last frame.
+ */
+static bool canSchedChanged(const can_sched_entry_t *e, const sensor_values_t *values) {
+    uint32_t channels = e->def->channels;
+    for (int ch = 0; channels != 0; ch++, channels >>= 1) {
+        if ((channels & 1u) && (int32_t)(values->changed_sweep[ch] - e->packed_sweep) > 0) return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Packs and queues every message that is due at `now_ms`.
+ *
+ * A message is sent at most once per call. If the TX queue is full the
+ * frame is dropped and the message waits for its next slot, so newer data
+ * replaces it instead of the task stalling. A message that has fallen more
+ * than one period behind (e.g. the task was starved) is re-aligned to its
+ * grid rather than sent in a burst.
+ *
+ * With on-change sends enabled, a message whose channels changed is sent
+ * now if `min_interval_ms` has passed since its last frame, and its next
+ * periodic slot restarts a full period later. If it is rate-limited the
+ * returned wait covers the moment it may go.
+ *
+ * A message packing a channel that is not yet valid (its filter still
+ * priming after boot or a reconfiguration) is held, so the bus never
+ * carries placeholder zeros; it goes out on the first run after the
+ * channel becomes valid, which the ADC task signals as a change.
+ *
+ * @param sched The scheduler state
+ * @param now_ms The current time in milliseconds
+ * @param values The sensor values to pack
+ * @return Milliseconds until the next message becomes due
+ */
+uint32_t canSchedRun(can_sched_t *sched, uint32_t now_ms, const sensor_values_t *values) {
+    uint32_t next_in = UINT32_MAX;
+
+    for (size_t i = 0; i < sched->count; i++) {
+        can_sched_entry_t *e = &sched->entries[i];
+        const can_message_def_t *def = e->def;
+
+        if ((def->channels & ~values->valid) != 0) {
+            e->held++;
+            continue;
+        }
+
+        bool due = (int32_t)(now_ms - e->next_due_ms) >= 0;
+        bool changed = !due && sched->on_change && def->min_interval_ms != 0 && canSchedChanged(e, values);
+        uint32_t allowed_in = 0;
+        if (changed && e->sent > 0 && now_ms - e->last_sent_ms < def->min_interval_ms) {
+            allowed_in = def->min_interval_ms - (now_ms - e->last_sent_ms);
+        }
+
+        if (due || (changed && allowed_in == 0)) {
+            can_frame_t frame = { .id = def->id, .dlc = def->dlc };
+            def->pack(values, frame.data, &e->pack_state);
+            e->packed_sweep = values->sweep;
+
+            if (sched->transmit(sched->ctx, &frame) == ESP_OK) {
+                e->sent++;
+                e->early += !due;
+                e->last_sent_ms = now_ms;
+            } else {
+                e->dropped++;
+            }
+
+            if (!due) {
+                e->next_due_ms = now_ms + def->period_ms;
+            } else {
+                e->next_due_ms += def->period_ms;
+                if ((int32_t)(now_ms - e->next_due_ms) >= 0) {
+                    uint32_t behind = now_ms - e->next_due_ms;
+                    e->next_due_ms += (behind / def->period_ms + 1) * def->period_ms;
+                    e->resyncs++;
+                }
+            }
+        } else if (changed && allowed_in < next_in) {
+            next_in = allowed_in;
+        }
+
+        uint32_t wait = e->next_due_ms - now_ms;
+        if (wait < next_in) next_in = wait;
+    }
+    return next_in;
+}
+
+/**
+ * @brief Returns the worst-case on-wire length of a data frame in bits.
+ *
+ * Includes SOF, arbitration, control, data, CRC, ACK, EOF, the 3-bit
+ * interframe space and the maximum number of stuff bits.
+ *
+ * @param dlc Data length code (0-8)
+ * @param extended True for a 29-bit identifier
+ * @return Frame length in bits
+ */
+uint32_t canFrameBits(uint8_t dlc, bool extended) {
+    uint32_t data_bits = 8u * (dlc > 8 ? 8 : dlc);
+    uint32_t stuffed = (extended ? 54u : 34u) + data_bits; // Bits from SOF to end of CRC
+    return stuffed + (stuffed - 1u) / 4u + 13u;             // + stuff bits, CRC/ACK delimiters, EOF, IFS
+}
+
+/**
+ * @brief Computes the bus load a message table puts on a bus.
+ *
+ * Every message is counted at its nominal period and, for the peak, at
+ * 1000 / `min_interval_ms` frames per second if it is sent on change. That
+ * is the rate when its channels change on every sweep, so the peak is an
+ * upper bound. Frames are counted at their worst-case stuffed length.
+ *
+ * @param table The message table
+ * @param count Number of entries in `table`
+ * @param bitrate The nominal bitrate in bit/s
+ * @return The frame and bit rates and the load as a fraction of `bitrate`
+ */
+can_bus_load_t canSchedBusLoad(const can_message_def_t *table, size_t count, uint32_t bitrate) {
+    uint64_t frames_mhz = 0, bits_mhz = 0, peak_frames_mhz = 0, peak_bits_mhz = 0; // Millihertz, so 1 s+ periods count
+    for (size_t i = 0; i < count; i++) {
+        uint32_t bits = canFrameBits(table[i].dlc, false);
+        uint32_t rate = 1000000u / table[i].period_ms;
+        uint32_t peak = (table[i].min_interval_ms != 0) ? 1000000u / table[i].min_interval_ms : rate;
+        if (peak < rate) peak = rate;
+        frames_mhz += rate;
+        bits_mhz += (uint64_t)rate * bits;
+        peak_frames_mhz += peak;
+        peak_bits_mhz += (uint64_t)peak * bits;
+    }
+    can_bus_load_t load = { .frames_per_s = (uint32_t)((frames_mhz + 500u) / 1000u),
+                            .bits_per_s = (uint32_t)((bits_mhz + 500u) / 1000u),
+                            .peak_frames_per_s = (uint32_t)((peak_frames_mhz + 500u) / 1000u),
+                            .peak_bits_per_s = (uint32_t)((peak_bits_mhz + 500u) / 1000u) };
+    load.load = (float)bits_mhz / 1000.0f / bitrate;
+    load.peak_load = (float)peak_bits_mhz / 1000.0f / bitrate;
+    return load;
+}
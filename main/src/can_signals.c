@@ -0,0 +1,211 @@
+// Generated by dbc/dbc2c.py from esp32-canboard.dbc - do not edit.
+#include <stddef.h>
+#include <stdint.h>
+
+#include "inc/can_signals.h"
+
+static const can_signal_def_t analogVoltage_1_signals[] = {
+    { "cpuTemperature", 0, 8, true, 1.0f, 0.0f, "C", -1 },
+    { "input1_voltage", 16, 16, false, 0.001f, 0.0f, "V", -1 },
+    { "input2_voltage", 32, 16, false, 0.001f, 0.0f, "V", -1 },
+    { "input3_voltage", 48, 16, false, 0.001f, 0.0f, "V", -1 },
+};
+
+static const can_signal_def_t analogVoltage_2_signals[] = {
+    { "input4_voltage", 0, 16, false, 0.001f, 0.0f, "V", -1 },
+    { "input5_voltage", 16, 16, false, 0.001f, 0.0f, "V", -1 },
+    { "input6_voltage", 32, 16, false, 0.001f, 0.0f, "V", -1 },
+    { "input7_voltage", 48, 16, false, 0.001f, 0.0f, "V", -1 },
+};
+
+static const can_signal_def_t analogVoltage_3_signals[] = {
+    { "input8_voltage", 0, 16, false, 0.001f, 0.0f, "V", -1 },
+    { "input9_voltage", 16, 16, false, 0.001f, 0.0f, "V", -1 },
+    { "input10_voltage", 32, 16, false, 0.001f, 0.0f, "V", -1 },
+};
+
+static const can_signal_def_t sensorValues_1_signals[] = {
+    { "chargeCoolerWaterTemp", 0, 8, true, 1.0f, 0.0f, "C", -1 },
+    { "airTemp", 8, 8, true, 1.0f, 0.0f, "C", -1 },
+    { "chargeCoolerInletTemp", 16, 8, true, 1.0f, 0.0f, "C", -1 },
+    { "chargeCoolerInletPressure", 24, 16, false, 0.01f, 0.0f, "kPa", -1 },
+    { "exhaustBackPressure", 40, 16, false, 0.01f, 0.0f, "psi", -1 },
+};
+
+static const can_signal_def_t sensorValues_2_signals[] = {
+    { "crankCasePressure", 0, 16, false, 0.01f, 0.0f, "kPa", -1 },
+    { "turboOilPressure", 16, 16, false, 0.01f, 0.0f, "bar", -1 },
+};
+
+static const can_signal_def_t diagnostics_signals[] = {
+    { "diagMetric", 0, 8, false, 1.0f, 0.0f, "", -1 },
+    { "diagMin", 8, 14, false, 1.0f, 0.0f, "", -1 },
+    { "diagAvg", 22, 14, false, 1.0f, 0.0f, "", -1 },
+    { "diagP99", 36, 14, false, 1.0f, 0.0f, "", -1 },
+    { "diagMax", 50, 14, false, 1.0f, 0.0f, "", -1 },
+};
+
+static const can_signal_def_t packedVoltages_signals[] = {
+    { "voltagePage", 0, 4, false, 1.0f, 0.0f, "", -1 },
+    { "input1_voltage", 4, 12, false, 0.002f, 0.0f, "V", 0 },
+    { "input2_voltage", 16, 12, false, 0.002f, 0.0f, "V", 0 },
+    { "input3_voltage", 28, 12, false, 0.002f, 0.0f, "V", 0 },
+    { "input4_voltage", 40, 12, false, 0.002f, 0.0f, "V", 0 },
+    { "input5_voltage", 52, 12, false, 0.002f, 0.0f, "V", 0 },
+    { "input6_voltage", 4, 12, false, 0.002f, 0.0f, "V", 1 },
+    { "input7_voltage", 16, 12, false, 0.002f, 0.0f, "V", 1 },
+    { "input8_voltage", 28, 12, false, 0.002f, 0.0f, "V", 1 },
+    { "input9_voltage", 40, 12, false, 0.002f, 0.0f, "V", 1 },
+    { "input10_voltage", 52, 12, false, 0.002f, 0.0f, "V", 1 },
+    { "cpuTemperature", 8, 8, true, 1.0f, 0.0f, "C", 2 },
+};
+
+static const can_signal_def_t packedSensors_signals[] = {
+    { "chargeCoolerWaterTemp", 0, 8, true, 1.0f, 0.0f, "C", -1 },
+    { "airTemp", 8, 8, true, 1.0f, 0.0f, "C", -1 },
+    { "chargeCoolerInletTemp", 16, 8, true, 1.0f, 0.0f, "C", -1 },
+    { "chargeCoolerInletPressure", 24, 12, false, 0.1f, 0.0f, "kPa", -1 },
+    { "crankCasePressure", 36, 12, false, 0.1f, 0.0f, "kPa", -1 },
+    { "exhaustBackPressure", 48, 8, false, 0.5f, 0.0f, "psi", -1 },
+    { "turboOilPressure", 56, 8, false, 0.05f, 0.0f, "bar", -1 },
+};
+
+static const can_signal_def_t boardStatus_signals[] = {
+    { "boardState", 0, 4, false, 1.0f, 0.0f, "", -1 },
+    { "channelValid", 8, 10, false, 1.0f, 0.0f, "", -1 },
+    { "sampleTime", 32, 32, false, 1.0f, 0.0f, "ms", -1 },
+};
+
+static const can_signal_def_t sensorStatus_signals[] = {
+    { "input1_fault", 0, 3, false, 1.0f, 0.0f, "", -1 },
+    { "input2_fault", 3, 3, false, 1.0f, 0.0f, "", -1 },
+    { "input3_fault", 6, 3, false, 1.0f, 0.0f, "", -1 },
+    { "input4_fault", 9, 3, false, 1.0f, 0.0f, "", -1 },
+    { "input5_fault", 12, 3, false, 1.0f, 0.0f, "", -1 },
+    { "input6_fault", 15, 3, false, 1.0f, 0.0f, "", -1 },
+    { "input7_fault", 18, 3, false, 1.0f, 0.0f, "", -1 },
+    { "input8_fault", 21, 3, false, 1.0f, 0.0f, "", -1 },
+    { "input9_fault", 24, 3, false, 1.0f, 0.0f, "", -1 },
+    { "input10_fault", 27, 3, false, 1.0f, 0.0f, "", -1 },
+};
+
+static const can_signal_def_t derivedValues_signals[] = {
+    { "chargeCoolerPressureDrop", 0, 16, true, 0.01f, 0.0f, "kPa", -1 },
+    { "crankCasePressurePeak", 16, 16, false, 0.01f, 0.0f, "kPa", -1 },
+    { "chargeCoolerWaterTempRate", 32, 16, true, 0.1f, 0.0f, "C/s", -1 },
+    { "chargeCoolerInletTempMin", 48, 8, true, 1.0f, 0.0f, "C", -1 },
+    { "chargeCoolerInletTempMax", 56, 8, true, 1.0f, 0.0f, "C", -1 },
+};
+
+static const can_signal_def_t taskLoad_signals[] = {
+    { "loadTask", 0, 4, false, 1.0f, 0.0f, "", -1 },
+    { "loadCore", 4, 4, false, 1.0f, 0.0f, "", -1 },
+    { "loadPriority", 8, 8, false, 1.0f, 0.0f, "", -1 },
+    { "loadCpu", 16, 10, false, 0.1f, 0.0f, "%", -1 },
+    { "loadStackFree", 26, 16, false, 1.0f, 0.0f, "B", -1 },
+    { "loadStackSize", 42, 16, false, 1.0f, 0.0f, "B", -1 },
+};
+
+static const can_signal_def_t systemLoad_signals[] = {
+    { "core0Load", 0, 10, false, 0.1f, 0.0f, "%", -1 },
+    { "core1Load", 10, 10, false, 0.1f, 0.0f, "%", -1 },
+    { "heapFree", 20, 12, false, 1.0f, 0.0f, "KiB", -1 },
+    { "heapMinFree", 32, 12, false, 1.0f, 0.0f, "KiB", -1 },
+    { "heapLargestBlock", 44, 12, false, 1.0f, 0.0f, "KiB", -1 },
+    { "lowStackTasks", 56, 8, false, 1.0f, 0.0f, "", -1 },
+};
+
+static const can_signal_def_t captureValues_signals[] = {
+    { "capture1Frequency", 0, 22, false, 0.01f, 0.0f, "Hz", -1 },
+    { "capture1Duty", 22, 10, false, 0.1f, 0.0f, "%", -1 },
+    { "capture2Frequency", 32, 22, false, 0.01f, 0.0f, "Hz", -1 },
+    { "capture2Duty", 54, 10, false, 0.1f, 0.0f, "%", -1 },
+};
+
+static const can_signal_def_t boardConfigRequest_signals[] = {
+    { "configCommand", 0, 8, false, 1.0f, 0.0f, "", -1 },
+    { "configParam", 16, 8, false, 1.0f, 0.0f, "", -1 },
+    { "configIndex", 24, 8, false, 1.0f, 0.0f, "", -1 },
+    { "configValue", 32, 32, true, 1.0f, 0.0f, "", -1 },
+};
+
+static const can_signal_def_t boardConfigResponse_signals[] = {
+    { "configCommand", 0, 8, false, 1.0f, 0.0f, "", -1 },
+    { "configStatus", 8, 8, false, 1.0f, 0.0f, "", -1 },
+    { "configParam", 16, 8, false, 1.0f, 0.0f, "", -1 },
+    { "configIndex", 24, 8, false, 1.0f, 0.0f, "", -1 },
+    { "configValue", 32, 32, true, 1.0f, 0.0f, "", -1 },
+};
+
+const can_message_schema_t can_schema[] = {
+    { 0x620, "analogVoltage_1", 8, 4, analogVoltage_1_signals, -1 },
+    { 0x621, "analogVoltage_2", 8, 4, analogVoltage_2_signals, -1 },
+    { 0x622, "analogVoltage_3", 8, 3, analogVoltage_3_signals, -1 },
+    { 0x623, "sensorValues_1", 8, 5, sensorValues_1_signals, -1 },
+    { 0x624, "sensorValues_2", 8, 2, sensorValues_2_signals, -1 },
+    { 0x625, "diagnostics", 8, 5, diagnostics_signals, -1 },
+    { 0x626, "packedVoltages", 8, 12, packedVoltages_signals, 0 },
+    { 0x627, "packedSensors", 8, 7, packedSensors_signals, -1 },
+    { 0x628, "boardStatus", 8, 3, boardStatus_signals, -1 },
+    { 0x629, "sensorStatus", 4, 10, sensorStatus_signals, -1 },
+    { 0x62A, "derivedValues", 8, 5, derivedValues_signals, -1 },
+    { 0x62B, "taskLoad", 8, 6, taskLoad_signals, -1 },
+    { 0x62C, "systemLoad", 8, 6, systemLoad_signals, -1 },
+    { 0x62D, "captureValues", 8, 4, captureValues_signals, -1 },
+    { 0x62E, "boardConfigRequest", 8, 4, boardConfigRequest_signals, -1 },
+    { 0x62F, "boardConfigResponse", 8, 5, boardConfigResponse_signals, -1 },
+};
+
+const size_t can_schema_count = sizeof(can_schema) / sizeof(can_schema[0]);
+
+/**
+ * @brief Finds the schema for a message identifier (binary search, table is sorted by ID).
+ *
+ * @param id The CAN identifier
+ * @return The message schema, or NULL if the ID is not in the DBC
+ */
+const can_message_schema_t *canSchemaFind(uint32_t id) {
+    size_t lo = 0, hi = can_schema_count;
+    while (lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        if (can_schema[mid].id == id) return &can_schema[mid];
+        if (can_schema[mid].id < id) lo = mid + 1; else hi = mid;
+    }
+    return NULL;
+}
+
+/**
+ * @brief Extracts the raw value of a little-endian signal from a data field.
+ *
+ * Generic counterpart to the generated *_unpack functions, used where the
+ * message is only known at runtime (log converters, host decoders).
+ */
+int32_t canSignalRaw(const can_signal_def_t *sig, const uint8_t *data) {
+    uint32_t raw = 0;
+    for (uint8_t i = 0; i < sig->length; i++) {
+        uint16_t bit = sig->start + i;
+        raw |= (uint32_t)((data[bit / 8] >> (bit % 8)) & 1u) << i;
+    }
+    if (sig->is_signed && sig->length < 32 && (raw & (1u << (sig->length - 1)))) {
+        raw |= ~0u << sig->length;
+    }
+    return (int32_t)raw;
+}
+
+/**
+ * @brief Extracts a signal and applies its DBC factor and offset.
+ */
+float canSignalPhysical(const can_signal_def_t *sig, const uint8_t *data) {
+    int32_t raw = canSignalRaw(sig, data);
+    float value = sig->is_signed ? (float)raw : (float)(uint32_t)raw;
+    return value * sig->factor + sig->offset;
+}
+
+/**
+ * @brief Returns true if a signal is carried by this frame, i.e. it is not
+ *        multiplexed or the frame's multiplexor selects its page.
+ */
+bool canSignalPresent(const can_message_schema_t *msg, const can_signal_def_t *sig, const uint8_t *data) {
+    if (sig->mux < 0 || msg->mux_signal < 0) return true;
+    return canSignalRaw(&msg->signals[msg->mux_signal], data) == sig->mux;
+}
@@ -0,0 +1,171 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "esp_err.h"
+#include "inc/can_tx.h"
+
+/**
+ * @brief Initializes the TX stage on top of a driver.
+ *
+ * @param tx The TX stage state
+ * @param hal Driver operations, every one required
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_INVALID_ARG if an argument or driver operation is missing
+ */
+esp_err_t canTxInit(can_tx_t *tx, const can_tx_hal_t *hal) {
+    if (tx == NULL || hal == NULL || hal->transmit == NULL || hal->queued == NULL || hal->flush == NULL ||
+        hal->recover == NULL || hal->start == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    memset(tx, 0, sizeof(*tx));
+    tx->hal = hal;
+    tx->state = CAN_BUS_ERROR_ACTIVE;
+    return ESP_OK;
+}
+
+/**
+ * @brief Stores a frame as the newest one for its ID, replacing any still waiting.
+ *
+ * Never blocks and never touches the driver; canTxPump() moves frames on.
+ *
+ * @param tx The TX stage state
+ * @param frame The frame to send
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_NO_MEM if the frame's ID would be the CAN_TX_MAX_IDS + 1th
+ */
+esp_err_t canTxSubmit(can_tx_t *tx, const can_frame_t *frame) {
+    size_t slot = 0;
+    while (slot < tx->count && tx->slots[slot].id != frame->id) slot++;
+    if (slot == tx->count) {
+        if (tx->count == CAN_TX_MAX_IDS) return ESP_ERR_NO_MEM;
+        tx->count++;
+    }
+
+    if (tx->pending & (1u << slot)) tx->stats.superseded++;
+    tx->slots[slot] = *frame;
+    tx->pending |= 1u << slot;
+    tx->stats.submitted++;
+    return ESP_OK;
+}
+
+/**
+ * @brief Hands waiting frames to the driver, lowest ID first.
+ *
+ * Tops the driver's queue up to CAN_TX_INFLIGHT_ACTIVE frames, or
+ * CAN_TX_INFLIGHT_PASSIVE while error passive so that a dead bus holds at
+ * most one stale frame. Does nothing while bus-off. A frame the driver
+ * cannot take right now stays in its slot for the next pump.
+ *
+ * @param tx The TX stage state
+ * @return Number of frames handed to the driver
+ */
+size_t canTxPump(can_tx_t *tx) {
+    if (tx->state == CAN_BUS_OFF) return 0;
+
+    const can_tx_hal_t *hal = tx->hal;
+    uint32_t limit = (tx->state == CAN_BUS_ERROR_ACTIVE) ? CAN_TX_INFLIGHT_ACTIVE : CAN_TX_INFLIGHT_PASSIVE;
+    uint32_t inflight = hal->queued(hal->ctx);
+    size_t handed = 0;
+
+    while (tx->pending != 0 && inflight < limit) {
+        size_t best = CAN_TX_MAX_IDS;
+        for (size_t i = 0; i < tx->count; i++) {
+            if ((tx->pending & (1u << i)) && (best == CAN_TX_MAX_IDS || tx->slots[i].id < tx->slots[best].id)) best = i;
+        }
+
+        esp_err_t err = hal->transmit(hal->ctx, &tx->slots[best]);
+        if (err == ESP_ERR_TIMEOUT || err == ESP_ERR_INVALID_STATE) break; // Full, or bus-off not yet reported
+        tx->pending &= ~(1u << best);
+        if (err != ESP_OK) {
+            tx->stats.rejected++;
+            continue;
+        }
+        tx->stats.queued++;
+        inflight++;
+        handed++;
+    }
+    return handed;
+}
+
+/**
+ * @brief Returns true while any frame is waiting for the driver.
+ */
+bool canTxPending(const can_tx_t *tx) {
+    return tx->pending != 0;
+}
+
+/**
+ * @brief Handles a bus-off: drops the driver's stale queue and starts recovery.
+ *
+ * Frames submitted while recovering keep replacing each other in their
+ * slots, so the first frames after the restart carry the newest data.
+ *
+ * @param tx The TX stage state
+ * @param now_us The current time in microseconds
+ */
+void canTxBusOff(can_tx_t *tx, int64_t now_us) {
+    if (tx->state == CAN_BUS_OFF) return;
+
+    const can_tx_hal_t *hal = tx->hal;
+    tx->state = CAN_BUS_OFF;
+    tx->bus_off_us = now_us;
+    tx->stats.bus_offs++;
+    tx->stats.flushed += hal->queued(hal->ctx);
+    hal->flush(hal->ctx);
+    hal->recover(hal->ctx);
+}
+
+/**
+ * @brief Restarts the controller once bus-off recovery has completed.
+ *
+ * @param tx The TX stage state
+ * @param now_us The current time in microseconds
+ * @return
+ *      - ESP_OK on success, or if the stage was not bus-off
+ *      - Error code from the driver's start operation otherwise, the stage stays bus-off
+ */
+esp_err_t canTxBusRecovered(can_tx_t *tx, int64_t now_us) {
+    if (tx->state != CAN_BUS_OFF) return ESP_OK;
+
+    esp_err_t err = tx->hal->start(tx->hal->ctx);
+    if (err != ESP_OK) return err;
+
+    uint32_t took = (uint32_t)(now_us - tx->bus_off_us);
+    tx->state = CAN_BUS_ERROR_ACTIVE;
+    tx->stats.recoveries++;
+    tx->stats.last_recovery_us = took;
+    if (took > tx->stats.max_recovery_us) tx->stats.max_recovery_us = took;
+    return ESP_OK;
+}
+
+/**
+ * @brief Records a change between error active and error passive. Ignored while bus-off.
+ */
+void canTxErrorPassive(can_tx_t *tx, bool passive) {
+    if (tx->state == CAN_BUS_OFF) return;
+    if (passive && tx->state == CAN_BUS_ERROR_ACTIVE) tx->stats.error_passive++;
+    tx->state = passive ? CAN_BUS_ERROR_PASSIVE : CAN_BUS_ERROR_ACTIVE;
+}
+
+/**
+ * @brief Records the controller's latest TX and RX error counters.
+ */
+void canTxErrorCounters(can_tx_t *tx, uint32_t tx_errors, uint32_t rx_errors) {
+    tx->stats.tx_errors = tx_errors;
+    tx->stats.rx_errors = rx_errors;
+}
+
+/**
+ * @brief Short name of a bus state, for logs.
+ */
+const char *canBusStateName(can_bus_state_t state) {
+    switch (state) {
+        case CAN_BUS_ERROR_ACTIVE: return "error active";
+        case CAN_BUS_ERROR_PASSIVE: return "error passive";
+        case CAN_BUS_OFF: return "bus-off";
+        default: return "?";
+    }
+}
@@ -0,0 +1,147 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "inc/capture.h"
+
+/**
+ * @brief Checks a capture table and prepares each input's state.
+ *
+ * @param cap The capture state to initialize
+ * @param table The input descriptors, in snapshot order
+ * @param count Number of entries in `table`
+ * @param timer_hz Rate of the capture timer the edge times are in
+ * @return ESP_OK, ESP_ERR_INVALID_ARG for an input out of range or used
+ *         twice, an unknown mode, a zero window or timeout, a glitch filter
+ *         longer than CAPTURE_MAX_GLITCH_NS, or a window plus timeout the
+ *         capture timer wraps within, ESP_ERR_NO_MEM past CAPTURE_MAX_INPUTS
+ */
+esp_err_t captureInit(capture_t *cap, const capture_desc_t *table, size_t count, uint32_t timer_hz) {
+    memset(cap, 0, sizeof(*cap));
+    if (count > CAPTURE_MAX_INPUTS) return ESP_ERR_NO_MEM;
+    if (count > 0 && (table == NULL || timer_hz == 0)) return ESP_ERR_INVALID_ARG;
+
+    uint32_t used = 0;
+    for (size_t i = 0; i < count; i++) {
+        const capture_desc_t *d = &table[i];
+        uint64_t span_ticks = ((uint64_t)d->window_ms + d->timeout_ms) * timer_hz / 1000u;
+        if (d->input >= SNAPSHOT_NUM_CHANNELS || (used & (1u << d->input)) || (unsigned)d->mode > CAPTURE_FREQUENCY_DUTY ||
+            d->window_ms == 0 || d->timeout_ms == 0 || d->glitch_ns > CAPTURE_MAX_GLITCH_NS || span_ticks > INT32_MAX) {
+            return ESP_ERR_INVALID_ARG;
+        }
+        used |= 1u << d->input;
+        cap->ch[i].window_us = (uint32_t)d->window_ms * 1000u;
+        cap->ch[i].timeout_us = (uint32_t)d->timeout_ms * 1000u;
+        cap->ch[i].timeout_ticks = (uint32_t)((uint64_t)d->timeout_ms * timer_hz / 1000u);
+    }
+    cap->descs = table;
+    cap->count = count;
+    cap->timer_hz = timer_hz;
+    return ESP_OK;
+}
+
+/**
+ * @brief Starts a window at this read.
+ */
+static void captureAnchor(capture_channel_t *c, const capture_raw_t *r, uint64_t now_us) {
+    c->anchored = true;
+    c->anchor_latched = r->latched;
+    c->anchor_edges = c->edges;
+    c->anchor_us = now_us;
+    c->anchor_ticks = r->rise_ticks;
+    c->high_sum = 0;
+    c->low_sum = 0;
+    c->high_count = 0;
+    c->low_count = 0;
+}
+
+/**
+ * @brief Closes the window at this read: edges over the time between the first and last edge counted.
+ *
+ * With both ends latched the time is the capture timer's, so the error is
+ * one timer tick over the window. Otherwise (edges landing during every
+ * read, so above a few hundred kHz) it is the time between the reads, and
+ * the error at most one period over the window. Duty is the mean high time
+ * of the periods sampled over the mean period: a read after a pulse ended
+ * gives its width, a read during one the gap before it, which is the period
+ * less the width.
+ */
+static void captureClose(capture_t *cap, capture_channel_t *c, const capture_desc_t *d, const capture_raw_t *r, uint64_t now_us) {
+    uint32_t edges = c->edges - c->anchor_edges;
+    uint64_t span = (c->anchor_latched && r->latched) ? (uint32_t)(r->rise_ticks - c->anchor_ticks)
+                                                      : (now_us - c->anchor_us) * cap->timer_hz / 1000000u;
+    if (span == 0) return;
+    uint64_t freq = ((uint64_t)edges * cap->timer_hz * CAPTURE_FREQ_SCALE + span / 2) / span;
+    c->freq = (uint32_t)(freq > UINT32_MAX ? UINT32_MAX : freq);
+    uint32_t samples = c->high_count + c->low_count;
+    if (d->mode == CAPTURE_FREQUENCY_DUTY && samples > 0) {
+        // (high_sum + low_count * period - low_sum) / (samples * period), with period = span / edges
+        int64_t high = (int64_t)((c->high_sum + c->low_count * span / edges) - c->low_sum);
+        int64_t duty = (high * CAPTURE_DUTY_FULL * edges + (int64_t)(samples * span / 2)) / (int64_t)(samples * span);
+        c->duty = (uint16_t)(duty < 0 ? 0 : duty > CAPTURE_DUTY_FULL ? CAPTURE_DUTY_FULL : duty);
+    }
+    captureAnchor(c, r, now_us);
+}
+
+/**
+ * @brief Turns one sweep's counter reads into each input's frequency and duty, and publishes them into `values`.
+ *
+ * Runs once per sweep. The pulse counter is extended in software, so reads
+ * must come before it has counted CAPTURE_COUNTER_MODULUS edges; that sets
+ * the highest frequency tracked. A window closes on the first read with a
+ * new edge once it spans `window_ms`, so every window is whole periods.
+ * Without an edge for `timeout_ms` an input reads 0 Hz, and a duty input
+ * 0 or 100 % by the level it stopped at; it reads 0 Hz until the first
+ * window after edges resume. A read more than CAPTURE_MAX_GAP_US after the
+ * last one restarts the window, as the counter may have wrapped unseen.
+ *
+ * @param cap The capture state
+ * @param raw One read per input, in table order
+ * @param now_us Time of the reads
+ * @param values The sweep, written for `capture_freq` and `capture_duty`
+ */
+void captureUpdate(capture_t *cap, const capture_raw_t *raw, uint64_t now_us, sensor_values_t *values) {
+    for (size_t i = 0; i < cap->count; i++) {
+        capture_channel_t *c = &cap->ch[i];
+        const capture_desc_t *d = &cap->descs[i];
+        const capture_raw_t *r = &raw[i];
+
+        if (!c->primed || now_us - c->last_us > CAPTURE_MAX_GAP_US) {
+            if (!c->primed || r->edges != c->last_raw) c->last_edge_us = now_us;
+            c->primed = true;
+            c->anchored = false;
+        } else {
+            uint32_t moved = (uint32_t)(r->edges + CAPTURE_COUNTER_MODULUS - c->last_raw) % CAPTURE_COUNTER_MODULUS;
+            c->edges += moved;
+            bool low = (int32_t)(r->fall_ticks - r->rise_ticks) >= 0;   // The latest pulse has ended
+            uint32_t sample = low ? r->fall_ticks - r->rise_ticks : r->rise_ticks - r->fall_ticks;
+            if (d->mode == CAPTURE_FREQUENCY_DUTY && r->latched && c->anchored && r->rise_ticks != c->sampled_rise &&
+                sample <= c->timeout_ticks) {
+                if (low) {
+                    c->high_sum += sample;
+                    c->high_count++;
+                } else {
+                    c->low_sum += sample;
+                    c->low_count++;
+                }
+                c->sampled_rise = r->rise_ticks;
+            }
+            if (moved != 0) {
+                c->last_edge_us = now_us;
+                if (!c->anchored) {
+                    captureAnchor(c, r, now_us);
+                } else if (now_us - c->anchor_us >= c->window_us) {
+                    captureClose(cap, c, d, r, now_us);
+                }
+            } else if (now_us - c->last_edge_us >= c->timeout_us) {
+                c->freq = 0;
+                c->duty = (d->mode == CAPTURE_FREQUENCY_DUTY && !low) ? CAPTURE_DUTY_FULL : 0;
+                c->anchored = false;
+            }
+        }
+        c->last_raw = r->edges;
+        c->last_us = now_us;
+        values->capture_freq[i] = c->freq;
+        values->capture_duty[i] = c->duty;
+    }
+}
@@ -0,0 +1,17 @@
+#include "inc/capture.h"
+
+/**
+ * @brief Frequency inputs for the 987, sent in the captureValues frame (0x62D).
+ *
+ * Both sit on inputs the analog table leaves spare. Turbo speed is averaged
+ * over 20 ms to keep up with spool, fuel flow over 200 ms as its pulses are
+ * slow at idle. Scale them to shaft rpm or l/h with a DERIVED_CAPTURE
+ * operand in derived_table. A PWM sensor (a flex fuel sensor's pulse width,
+ * say) uses CAPTURE_FREQUENCY_DUTY.
+ */
+const capture_desc_t capture_table[] = {
+    { .name = "Turbo Speed", .input = 5, .mode = CAPTURE_FREQUENCY, .window_ms = 20, .timeout_ms = 100, .glitch_ns = 1000 },
+    { .name = "Fuel Flow", .input = 6, .mode = CAPTURE_FREQUENCY, .window_ms = 200, .timeout_ms = 1000, .glitch_ns = 10000 },
+};
+
+const size_t capture_table_count = sizeof(capture_table) / sizeof(capture_table[0]);
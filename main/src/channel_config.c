@@ -0,0 +1,61 @@
+#include "inc/channels.h"
+
+#define DIVIDER_5V 1.470f      // Inputs 1-8
+#define DIVIDER_5V_NTC 1.700f  // Inputs 9-10
+#define PRESSURE_DEADBAND_MV 20 // ~0.5% of a 0.5-4.5 V span, above the filtered noise; temperatures only go out periodically
+#define PRESSURE_OVERSAMPLE 16  // 125 Hz per channel at 2 kHz, +2 bits for the low-pressure sensors where 1-2 mV matters
+#define FAULT_STUCK_MS 5000     // The ADC's own noise moves any live input by a code or two well within this
+
+// 0.5-4.5 V ratiometric sensors behind a pull-down divider: open reads 0 V,
+// and a short to 5 V pins the ADC (full scale is ~4.55 V through the
+// divider). A full-scale swing in under 4 ms, or 0.5 V of hash within one
+// sweep, is not the sensor.
+#define PRESSURE_FAULT(fs) { .low_mv = 250, .high_mv = 4700, .noise_mv = 500, .rate_mv_per_ms = 1000, \
+                             .stuck_ms = FAULT_STUCK_MS, .failsafe = (fs) }
+// NTCs behind the pull-up: open reads the pull-up rail, and they change by
+// degrees per second, not volts.
+#define TEMP_FAULT(fs) { .low_mv = 50, .high_mv = 4950, .open_high = true, .noise_mv = 300, .rate_mv_per_ms = 50, \
+                         .stuck_ms = FAULT_STUCK_MS, .failsafe = (fs) }
+
+/**
+ * @brief Sensor fit for the 987 (see docs/987/DETAILS.md), indexed by ADC channel.
+ *
+ * Failsafe outputs are what the ECU sees while an input is faulted:
+ * atmospheric for the absolute pressures, zero for the gauge ones, and
+ * temperatures at the warm end of normal so charge temperature
+ * corrections err on the safe side.
+ */
+const channel_desc_t channel_table[SNAPSHOT_NUM_CHANNELS] = {
+    [0] = { .name = "Charge Cooler Inlet Pressure", // BMW TMAP 13627843531 - kPa
+            .divider = DIVIDER_5V, .filter = CHANNEL_FILTER_MEDIAN, .filter_depth = 5, .deadband_mv = PRESSURE_DEADBAND_MV,
+            .conversion = CHANNEL_CONVERT_LINEAR, .slot = SENSOR_SLOT_CC_INLET_PRESSURE, .fault = PRESSURE_FAULT(10000),
+            .linear = { .v_min_mv = 500, .v_max_mv = 4500, .out_min = 50, .out_max = 350 } },
+            // Alternative fit: .conversion = CHANNEL_CONVERT_POLYNOMIAL, .poly = { .coeff = { 9.19f, 95.94f, -11.45f, 0 } }
+    [1] = { .name = "Exhaust Back Pressure", // 0-30 Psi
+            .divider = DIVIDER_5V, .filter = CHANNEL_FILTER_OVERSAMPLE, .oversample = PRESSURE_OVERSAMPLE, .deadband_mv = PRESSURE_DEADBAND_MV,
+            .conversion = CHANNEL_CONVERT_LINEAR, .slot = SENSOR_SLOT_EXHAUST_BACK_PRESSURE, .fault = PRESSURE_FAULT(0),
+            .linear = { .v_min_mv = 500, .v_max_mv = 4500, .out_min = 0, .out_max = 100 } },
+    [2] = { .name = "Crank Case Pressure", // Bosch MAP 0261230119 - kPa
+            .divider = DIVIDER_5V, .filter = CHANNEL_FILTER_OVERSAMPLE, .oversample = PRESSURE_OVERSAMPLE, .deadband_mv = PRESSURE_DEADBAND_MV,
+            .conversion = CHANNEL_CONVERT_LINEAR, .slot = SENSOR_SLOT_CRANK_CASE_PRESSURE, .fault = PRESSURE_FAULT(10000),
+            .linear = { .v_min_mv = 400, .v_max_mv = 4650, .out_min = 20, .out_max = 300 } },
+    [3] = { .name = "Turbo Regulator Oil Pressure", // 0-100 Psi / 0-6.89 Bar
+            .divider = DIVIDER_5V, .filter = CHANNEL_FILTER_MEDIAN, .filter_depth = 5, .deadband_mv = PRESSURE_DEADBAND_MV,
+            .conversion = CHANNEL_CONVERT_LINEAR, .slot = SENSOR_SLOT_TURBO_OIL_PRESSURE, .fault = PRESSURE_FAULT(0),
+            .linear = { .v_min_mv = 500, .v_max_mv = 4500, .out_min = 0, .out_max = 6.89f } },
+    [4] = { .name = "Input 5", .divider = DIVIDER_5V, .filter = CHANNEL_FILTER_MEDIAN, .filter_depth = 5, .slot = SENSOR_SLOT_NONE },
+    [5] = { .name = "Input 6", .divider = DIVIDER_5V, .filter = CHANNEL_FILTER_MEDIAN, .filter_depth = 5, .slot = SENSOR_SLOT_NONE },
+    [6] = { .name = "Input 7", .divider = DIVIDER_5V, .filter = CHANNEL_FILTER_MEDIAN, .filter_depth = 5, .slot = SENSOR_SLOT_NONE },
+    [7] = { .name = "Charge Cooler Inlet Temperature", // BMW TMAP 13627843531
+            .divider = DIVIDER_5V, .filter = CHANNEL_FILTER_MEDIAN, .filter_depth = 5,
+            .conversion = CHANNEL_CONVERT_TABLE, .slot = SENSOR_SLOT_CC_INLET_TEMP, .fault = TEMP_FAULT(500),
+            .ntc = { .table = tmap_table, .size = NTC_TABLE_SIZE(tmap_table), .r_pullup = NTC_PULLUP_OHMS, .v_ref_mv = PULLUP_VREF_MV } },
+    [8] = { .name = "Charge Cooler Water Temperature", // Bosch 0280130026
+            .divider = DIVIDER_5V_NTC, .filter = CHANNEL_FILTER_MEDIAN, .filter_depth = 5,
+            .conversion = CHANNEL_CONVERT_TABLE, .slot = SENSOR_SLOT_CC_WATER_TEMP, .fault = TEMP_FAULT(500),
+            .ntc = { .table = ntc_table, .size = NTC_TABLE_SIZE(ntc_table), .r_pullup = NTC_PULLUP_OHMS, .v_ref_mv = PULLUP_VREF_MV } },
+    [9] = { .name = "Air Temperature", // Bosch 0280130039
+            .divider = DIVIDER_5V_NTC, .filter = CHANNEL_FILTER_MEDIAN, .filter_depth = 5,
+            .conversion = CHANNEL_CONVERT_TABLE, .slot = SENSOR_SLOT_AIR_TEMP, .fault = TEMP_FAULT(400),
+            .ntc = { .table = ntc_table, .size = NTC_TABLE_SIZE(ntc_table), .r_pullup = NTC_PULLUP_OHMS, .v_ref_mv = PULLUP_VREF_MV } },
+};
@@ -0,0 +1,312 @@
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "esp_err.h"
+#include "inc/channels.h"
+
+_Static_assert(OVERSAMPLE_FRAC_BITS == 8, "filtered_frac holds 1/256 mV");
+
+/**
+ * @brief Calculates the pressure from the given voltage, given min and max voltage
+ *        and pressure values.
+ *
+ * The function first clamps the given voltage to the valid range, then calculates
+ * the relative voltage to the total voltage span. This relative voltage is then
+ * multiplied with the total pressure span to get the absolute pressure value.
+ *
+ * The result is then multiplied by 100 and returned as an integer.
+ *
+ * @param v_mv The measured voltage in millivolts
+ * @param v_min_mv The minimum valid voltage in millivolts
+ * @param v_max_mv The maximum valid voltage in millivolts
+ * @param p_min The minimum pressure value
+ * @param p_max The maximum pressure value
+ * @return The calculated pressure value multiplied by 100
+ */
+uint16_t getSensorPressure(float v_mv, int v_min_mv, int v_max_mv, float p_min, float p_max)
+{
+    if (v_mv < v_min_mv) v_mv = v_min_mv;
+    if (v_mv > v_max_mv) v_mv = v_max_mv;
+
+    float voltage_span = v_max_mv - v_min_mv;
+    float pressure_span = p_max - p_min;
+    float relative_voltage = v_mv - v_min_mv;
+
+    float pressure = p_min + (relative_voltage / voltage_span) * pressure_span;
+
+    if(pressure < 0.0f) pressure = 0.0f;
+    return (uint16_t)(pressure * 100.0f);
+}
+
+/**
+ * @brief A helper function for median filtering.
+ *
+ * This function takes an array of uint16_t samples and the number of samples
+ * as input, and returns the median value of the samples. The median is
+ * calculated by sorting the samples in ascending order and returning the
+ * middle value.
+ *
+ * @param samples The array of uint16_t samples
+ * @param count The number of samples
+ * @return The median value of the samples
+ */
+uint16_t medianFilterHelper(uint16_t *samples, int count) {
+    for (int i = 0; i < count - 1; i++) {
+        for (int j = i + 1; j < count; j++) {
+            if (samples[j] < samples[i]) {
+                uint16_t tmp = samples[i];
+                samples[i] = samples[j];
+                samples[j] = tmp;
+            }
+        }
+    }
+    return samples[count / 2];
+}
+
+/**
+ * @brief Prepares the processing pipeline for a channel descriptor table.
+ *
+ * Sets up the streaming filter and fault classifier for every channel and
+ * builds one fixed-point lookup per distinct NTC table/divider combination
+ * so table conversions never touch floats. The classifier's noise limit is
+ * converted to raw codes through `cali`, so it must be ready to use.
+ *
+ * @param pipeline The pipeline state to initialize
+ * @param table The channel descriptors, indexed by ADC channel
+ * @param count Number of descriptors, at most SNAPSHOT_NUM_CHANNELS
+ * @param cali Raw code to millivolt calibration callback
+ * @param cali_ctx Opaque pointer passed to `cali`
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_INVALID_ARG if a descriptor is invalid
+ *      - ESP_ERR_NO_MEM if more than CHANNEL_MAX_LUTS distinct tables are used
+ *      - Error code from ntcLutBuild() otherwise
+ */
+esp_err_t channelsInit(channel_pipeline_t *pipeline, const channel_desc_t *table, size_t count,
+                       channel_cali_fn_t cali, void *cali_ctx) {
+    if (pipeline == NULL || table == NULL || cali == NULL || count > SNAPSHOT_NUM_CHANNELS) return ESP_ERR_INVALID_ARG;
+
+    memset(pipeline, 0, sizeof(*pipeline));
+    pipeline->desc = table;
+    pipeline->count = count;
+    pipeline->cali = cali;
+    pipeline->cali_ctx = cali_ctx;
+
+    for (size_t ch = 0; ch < count; ch++) {
+        const channel_desc_t *d = &table[ch];
+        pipeline->lut_index[ch] = -1;
+
+        esp_err_t err = (d->filter == CHANNEL_FILTER_MEDIAN) ? filterInit(&pipeline->filters[ch], d->filter_depth, d->iir_alpha, d->slew_limit)
+                                                              : filterInit(&pipeline->filters[ch], 1, 0.0f, 0);
+        if (err != ESP_OK) return err;
+        if (d->filter == CHANNEL_FILTER_OVERSAMPLE && (err = oversampleInit(&pipeline->oversamplers[ch], d->oversample)) != ESP_OK) return err;
+        if (d->conversion != CHANNEL_CONVERT_NONE && (d->slot <= SENSOR_SLOT_NONE || d->slot >= SENSOR_SLOT_COUNT)) return ESP_ERR_INVALID_ARG;
+        if (d->conversion == CHANNEL_CONVERT_LINEAR && d->linear.v_max_mv <= d->linear.v_min_mv) return ESP_ERR_INVALID_ARG;
+
+        float mv_per_code = d->fault.noise_mv ? (cali(cali_ctx, (int)ch, 3000) - cali(cali_ctx, (int)ch, 1000)) * d->divider / 2000.0f : 0.0f;
+        uint32_t update_us = (d->filter == CHANNEL_FILTER_OVERSAMPLE) ? d->oversample * 1000000u / CHANNEL_RATE_HZ : CHANNEL_SWEEP_US;
+        faultInit(&pipeline->faults[ch], &d->fault, mv_per_code, update_us, CHANNEL_SWEEP_US);
+        if (d->conversion != CHANNEL_CONVERT_TABLE) continue;
+
+        for (uint8_t i = 0; i < ch; i++) {
+            const channel_desc_t *o = &table[i];
+            if (o->conversion == CHANNEL_CONVERT_TABLE && o->ntc.table == d->ntc.table &&
+                o->ntc.r_pullup == d->ntc.r_pullup && o->ntc.v_ref_mv == d->ntc.v_ref_mv) {
+                pipeline->lut_index[ch] = pipeline->lut_index[i];
+                break;
+            }
+        }
+        if (pipeline->lut_index[ch] >= 0) continue;
+
+        if (pipeline->lut_count == CHANNEL_MAX_LUTS) return ESP_ERR_NO_MEM;
+        err = ntcLutBuild(&pipeline->luts[pipeline->lut_count], d->ntc.table, d->ntc.size, d->ntc.r_pullup, d->ntc.v_ref_mv);
+        if (err != ESP_OK) return err;
+        pipeline->lut_index[ch] = (int8_t)pipeline->lut_count++;
+    }
+    return ESP_OK;
+}
+
+/**
+ * @brief Calibrates and scales an oversampled channel's latest block mean.
+ *
+ * The mean falls between two ADC codes; the millivolts are interpolated
+ * between their calibrated values, so the extra resolution survives the
+ * (integer) calibration. The sub-millivolt part goes to `filtered_frac`.
+ */
+static void channelsOversampledMv(const channel_pipeline_t *pipeline, size_t ch, sensor_values_t *values) {
+    const oversampler_t *os = &pipeline->oversamplers[ch];
+    uint16_t code = (uint16_t)(os->output_q >> OVERSAMPLE_FRAC_BITS);
+    uint32_t frac = os->output_q & ((1u << OVERSAMPLE_FRAC_BITS) - 1);
+
+    int mv0 = pipeline->cali(pipeline->cali_ctx, (int)ch, code);
+    int mv1 = (frac != 0) ? pipeline->cali(pipeline->cali_ctx, (int)ch, code + 1) : mv0;
+    int32_t mv_q = mv0 * (1 << OVERSAMPLE_FRAC_BITS) + (mv1 - mv0) * (int32_t)frac;
+    uint32_t scaled_q = (mv_q > 0) ? (uint32_t)(mv_q * pipeline->desc[ch].divider) : 0;
+
+    values->raw[ch] = (uint16_t)((os->output_q + (1u << (OVERSAMPLE_FRAC_BITS - 1))) >> OVERSAMPLE_FRAC_BITS);
+    values->filtered_mv[ch] = (uint16_t)(scaled_q >> OVERSAMPLE_FRAC_BITS);
+    values->filtered_frac[ch] = (uint8_t)(scaled_q & ((1u << OVERSAMPLE_FRAC_BITS) - 1));
+}
+
+/**
+ * @brief Calibrates and scales a channel's filter output.
+ */
+static void channelsFilteredMv(const channel_pipeline_t *pipeline, size_t ch, sensor_values_t *values) {
+    uint16_t raw = pipeline->filters[ch].output;
+    int mv = pipeline->cali(pipeline->cali_ctx, (int)ch, raw);
+    values->raw[ch] = raw;
+    values->filtered_mv[ch] = (uint16_t)(mv * pipeline->desc[ch].divider);
+    values->filtered_frac[ch] = 0;
+}
+
+/**
+ * @brief Runs a channel's fault classifier on this sweep and records its latched fault.
+ *
+ * Channels are only classified once valid, so a filter still filling its
+ * window is not mistaken for a fault.
+ */
+static void channelsCheckFaults(channel_pipeline_t *pipeline, size_t ch, const uint16_t *samples, size_t n, bool updated,
+                                sensor_values_t *values) {
+    uint32_t bit = 1u << ch;
+    fault_input_t in = { .mv = values->filtered_mv[ch], .min_code = UINT16_MAX, .max_code = 0, .updated = updated };
+    for (size_t i = 0; i < n; i++) {
+        if (samples[i] < in.min_code) in.min_code = samples[i];
+        if (samples[i] > in.max_code) in.max_code = samples[i];
+    }
+
+    fault_code_t code = (values->valid & bit) ? faultUpdate(&pipeline->faults[ch], &pipeline->desc[ch].fault, &in) : FAULT_NONE;
+    values->fault[ch] = (uint8_t)code;
+    if (code != FAULT_NONE) values->faulted |= bit;
+    else values->faulted &= ~bit;
+}
+
+/**
+ * @brief Filters, calibrates and scales one sweep, and classifies each channel's faults.
+ *
+ * Every sample that arrived since the previous sweep is pushed through the
+ * channel's streaming filter, so filtering runs at the full ADC rate and
+ * keeps its history across sweeps. The filter output is then calibrated to
+ * millivolts and the divider factor applied, storing raw and filtered values
+ * in `values`. Oversampled channels report the mean of their last complete
+ * block (the latest sample until the first block completes), with
+ * sub-millivolt resolution. A channel is marked in `valid` once its
+ * median window is full or its first block complete; until then its value
+ * comes from fewer samples than configured. The same samples and filter
+ * output then go through the channel's fault classifier, whose latched
+ * fault lands in `fault` and `faulted`. Engineering outputs are filled by
+ * channelsConvert().
+ *
+ * @param pipeline The initialized pipeline
+ * @param stream The ADC stream holding the sweep
+ * @param values The sweep to populate
+ */
+void channelsFilterSweep(channel_pipeline_t *pipeline, const adc_stream_t *stream, sensor_values_t *values) {
+    uint16_t samples[ADC_STREAM_RING_DEPTH];
+
+    for (size_t ch = 0; ch < pipeline->count; ch++) {
+        const channel_desc_t *d = &pipeline->desc[ch];
+        stream_filter_t *f = &pipeline->filters[ch];
+        bool updated = true;
+
+        size_t n = adcStreamLatest(stream, (int)ch, samples, adcStreamFresh(stream, (int)ch));
+        if (d->filter == CHANNEL_FILTER_OVERSAMPLE) {
+            oversampler_t *os = &pipeline->oversamplers[ch];
+            uint32_t blocks = os->blocks;
+            for (size_t i = 0; i < n; i++) oversamplePush(os, samples[i]);
+            if (os->blocks > 0) {
+                updated = os->blocks != blocks;
+                channelsOversampledMv(pipeline, ch, values);
+                values->valid |= 1u << ch;
+            } else {
+                if (n > 0) f->output = samples[n - 1];
+                channelsFilteredMv(pipeline, ch, values);
+                values->valid &= ~(1u << ch);
+            }
+        } else {
+            for (size_t i = 0; i < n; i++) filterPush(f, samples[i]);
+            channelsFilteredMv(pipeline, ch, values);
+            if (f->count >= f->depth) values->valid |= 1u << ch;
+            else values->valid &= ~(1u << ch);
+        }
+        channelsCheckFaults(pipeline, ch, samples, n, updated, values);
+    }
+}
+
+/**
+ * @brief Stamps every channel whose filtered value has moved past its deadband.
+ *
+ * A channel changes when its filtered millivolts differ by more than
+ * `deadband_mv` from the value at its previous change, so noise inside the
+ * deadband never fires but a slow drift eventually does. Changed channels
+ * get the current sweep number in `changed_sweep`, which the CAN scheduler
+ * compares against the sweep it last sent. A channel that has just become
+ * valid counts as changed too, so the frames held back for it go out at
+ * once, as does one whose fault has latched or cleared, so its failsafe
+ * (or its return) reaches the bus without waiting for the period. Call
+ * after `sweep` is advanced.
+ *
+ * @param pipeline The initialized pipeline
+ * @param values The sweep, with `filtered_mv` and `sweep` populated
+ * @return Bit mask of the channels that changed in this sweep
+ */
+uint32_t channelsMarkChanges(channel_pipeline_t *pipeline, sensor_values_t *values) {
+    uint32_t changed = 0;
+    uint32_t forced = (values->valid & ~pipeline->reported_valid) | (values->faulted ^ pipeline->reported_faulted);
+    pipeline->reported_valid = values->valid;
+    pipeline->reported_faulted = values->faulted;
+
+    for (size_t ch = 0; ch < pipeline->count; ch++) {
+        uint16_t deadband = pipeline->desc[ch].deadband_mv;
+        int delta = values->filtered_mv[ch] - pipeline->reported_mv[ch];
+        bool moved = deadband != 0 && (delta > deadband || delta < -deadband);
+        if (!moved && !(forced & (1u << ch))) continue;
+
+        pipeline->reported_mv[ch] = values->filtered_mv[ch];
+        values->changed_sweep[ch] = values->sweep;
+        changed |= 1u << ch;
+    }
+    return changed;
+}
+
+/**
+ * @brief Converts filtered millivolts into engineering outputs.
+ *
+ * Each channel is converted exactly once and written to the snapshot slot
+ * named by its descriptor. Linear and polynomial conversions include the
+ * sub-millivolt part of oversampled channels. A channel flagged in
+ * `faulted` outputs its configured failsafe instead. Separate from
+ * channelsFilterSweep() so recorded millivolt traces can be replayed
+ * through the same conversions.
+ *
+ * @param pipeline The initialized pipeline
+ * @param values The sweep, with `filtered_mv` populated
+ */
+void channelsConvert(const channel_pipeline_t *pipeline, sensor_values_t *values) {
+    for (size_t ch = 0; ch < pipeline->count; ch++) {
+        const channel_desc_t *d = &pipeline->desc[ch];
+        int mv = values->filtered_mv[ch];
+        float mv_fine = mv + values->filtered_frac[ch] / 256.0f;
+        int32_t out;
+
+        switch (d->conversion) {
+            case CHANNEL_CONVERT_LINEAR:
+                out = (mv > 0) ? getSensorPressure(mv_fine, d->linear.v_min_mv, d->linear.v_max_mv, d->linear.out_min, d->linear.out_max) : 0;
+                break;
+            case CHANNEL_CONVERT_POLYNOMIAL: {
+                float v = mv_fine / 1000.0f;
+                float y = d->poly.coeff[CHANNEL_POLY_TERMS - 1];
+                for (int i = CHANNEL_POLY_TERMS - 2; i >= 0; i--) y = y * v + d->poly.coeff[i];
+                out = (mv > 0 && y > 0.0f) ? (int32_t)(y * 100.0f) : 0;
+                break;
+            }
+            case CHANNEL_CONVERT_TABLE:
+                out = ntcLutLookup(&pipeline->luts[pipeline->lut_index[ch]], mv);
+                break;
+            default:
+                continue;
+        }
+        values->outputs[d->slot] = (values->faulted & (1u << ch)) ? d->fault.failsafe : out;
+    }
+}
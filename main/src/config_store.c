@@ -0,0 +1,130 @@
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+
+#include "esp_err.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "nvs.h"
+#include "nvs_flash.h"
+
+#include "inc/board_config.h"
+#include "inc/can.h"
+#include "inc/config_store.h"
+#include "inc/inputs.h"
+
+static board_config_store_t config_store;
+static SemaphoreHandle_t config_lock;
+static volatile uint32_t config_generation; // Copy of config_store.generation, read without the lock
+static nvs_handle_t config_nvs;
+
+static esp_err_t nvsConfigLoad(void *ctx, void *buf, size_t *len) {
+    esp_err_t err = nvs_get_blob(config_nvs, CONFIG_STORE_KEY, buf, len);
+    return (err == ESP_ERR_NVS_NOT_FOUND) ? ESP_ERR_NOT_FOUND : err;
+}
+
+static esp_err_t nvsConfigSave(void *ctx, const void *buf, size_t len) {
+    esp_err_t err = nvs_set_blob(config_nvs, CONFIG_STORE_KEY, buf, len);
+    return (err == ESP_OK) ? nvs_commit(config_nvs) : err;
+}
+
+static const board_config_storage_t nvs_storage = { .load = nvsConfigLoad, .save = nvsConfigSave };
+
+/**
+ * @brief Opens NVS and loads the runtime configuration, before anything reads it.
+ *
+ * A saved blob that is missing, from another layout or corrupt leaves the
+ * compiled defaults in use, and so does an NVS partition that cannot be
+ * opened at all (saving is then refused), so the board always boots.
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_NO_MEM if the lock cannot be allocated
+ *      - Error code from boardConfigInit() otherwise
+ */
+esp_err_t initConfigStore(void)
+{
+#if CONFIG_CANBOARD_STATIC_ALLOCATION
+    static StaticSemaphore_t config_lock_buf;
+    config_lock = xSemaphoreCreateMutexStatic(&config_lock_buf);
+#else
+    config_lock = xSemaphoreCreateMutex();
+#endif
+    if (config_lock == NULL) return ESP_ERR_NO_MEM;
+
+    esp_err_t err = nvs_flash_init();
+    if (err == ESP_ERR_NVS_NO_FREE_PAGES || err == ESP_ERR_NVS_NEW_VERSION_FOUND) {
+        ESP_LOGW(config_log, "NVS Partition Unreadable, Erasing (%s)", esp_err_to_name(err));
+        err = nvs_flash_erase();
+        if (err == ESP_OK) err = nvs_flash_init();
+    }
+    if (err == ESP_OK) err = nvs_open(CONFIG_STORE_NAMESPACE, NVS_READWRITE, &config_nvs);
+    if (err != ESP_OK) ESP_LOGE(config_log, "NVS Unavailable, Settings Cannot Be Saved (%s)", esp_err_to_name(err));
+
+    board_config_t defaults;
+    boardConfigDefaults(&defaults, channel_table, NUM_ADC_CHANNELS, can_messages, can_messages_count);
+    int64_t start = esp_timer_get_time();
+    esp_err_t init_err = boardConfigInit(&config_store, &defaults, NUM_ADC_CHANNELS, can_messages, can_messages_count, can_rx_table,
+                                         can_rx_table_count, (err == ESP_OK) ? &nvs_storage : NULL);
+    int64_t took = esp_timer_get_time() - start;
+    if (init_err != ESP_OK) return init_err;
+
+    if (config_store.load_err == ESP_OK) {
+        ESP_LOGI(config_log, "Configuration Loaded From NVS in %lld us (%u bytes, CRC %08lx)", took,
+                 (unsigned)BOARD_CONFIG_BLOB_BYTES, config_store.saved_crc);
+    } else if (config_store.load_err == ESP_ERR_NOT_FOUND) {
+        ESP_LOGI(config_log, "No Saved Configuration, Using Defaults");
+    } else {
+        ESP_LOGW(config_log, "Saved Configuration Rejected, Using Defaults (%s)", esp_err_to_name(config_store.load_err));
+    }
+    config_generation = config_store.generation;
+    return ESP_OK;
+}
+
+/**
+ * @brief Copies the configuration the firmware should be running with.
+ *
+ * Reboot-only parameters (the CAN base ID) keep their boot value until the
+ * next boot. Tasks call this at start and again whenever
+ * configStoreGeneration() moves on.
+ */
+void configStoreRead(board_config_t *cfg)
+{
+    xSemaphoreTake(config_lock, portMAX_DELAY);
+    boardConfigEffective(&config_store, cfg);
+    xSemaphoreGive(config_lock);
+}
+
+/**
+ * @brief Returns a counter that moves on whenever a configuration value changes. Lock-free.
+ */
+uint32_t configStoreGeneration(void)
+{
+    return config_generation;
+}
+
+/**
+ * @brief RX handler for boardConfigRequest frames: serves the request and sends the response.
+ *
+ * Runs in the CAN receive task. Saving commits NVS from here, which may
+ * erase a sector and hold the task for up to CAN_FLASH_ERASE_MS, but only
+ * on request; reception meanwhile queues in the driver, whose RX queue is
+ * sized for it (CAN_RX_STALL_MS).
+ */
+void configStoreRequest(void *ctx, const can_frame_t *frame)
+{
+    can_frame_t response;
+    xSemaphoreTake(config_lock, portMAX_DELAY);
+    uint32_t before = config_store.generation;
+    bool reply = boardConfigHandleRequest(&config_store, frame, &response);
+    config_generation = config_store.generation;
+    xSemaphoreGive(config_lock);
+    if (!reply) return;
+
+    if (config_generation != before) ESP_LOGI(config_log, "Configuration Changed (param %u index %u)", frame->data[2], frame->data[3]);
+    esp_err_t err = canSendFrame(&response);
+    if (err != ESP_OK) ESP_LOGW(config_log, "Failed to Send Config Response (%s)", esp_err_to_name(err));
+}
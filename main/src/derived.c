@@ -0,0 +1,204 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "inc/derived.h"
+
+static inline int32_t saturate(int64_t v) {
+    return (int32_t)(v > INT32_MAX ? INT32_MAX : v < INT32_MIN ? INT32_MIN : v);
+}
+
+static inline int32_t lower(int32_t x, int32_t y) { return x < y ? x : y; }
+static inline int32_t higher(int32_t x, int32_t y) { return x > y ? x : y; }
+
+static void evalDiff(derived_engine_t *e, const derived_step_t *s) {
+    e->regs[s->out] = saturate((int64_t)e->regs[s->a] - e->regs[s->b]);
+}
+
+static void evalSum(derived_engine_t *e, const derived_step_t *s) {
+    e->regs[s->out] = saturate((int64_t)e->regs[s->a] + e->regs[s->b]);
+}
+
+static void evalScale(derived_engine_t *e, const derived_step_t *s) {
+    const derived_desc_t *d = s->desc;
+    e->regs[s->out] = saturate((int64_t)e->regs[s->a] * d->mul / d->div + d->offset);
+}
+
+/**
+ * @brief Closes the current bucket of a rolling min/max and refreshes the extreme of the completed ones.
+ *
+ * Runs once per bucket, so the per-sweep cost stays two compares.
+ */
+static void windowComplete(derived_window_t *w, bool max) {
+    w->bucket[w->head] = w->current;
+    w->head = (uint8_t)((w->head + 1) % DERIVED_BUCKETS);
+    if (w->filled < DERIVED_BUCKETS) w->filled++;
+    w->fill = 0;
+    int32_t extreme = w->bucket[0];
+    for (uint8_t i = 1; i < w->filled; i++) extreme = max ? higher(extreme, w->bucket[i]) : lower(extreme, w->bucket[i]);
+    w->completed = extreme;
+}
+
+static void evalMin(derived_engine_t *e, const derived_step_t *s) {
+    derived_window_t *w = &e->windows[s->window];
+    int32_t a = e->regs[s->a];
+    w->current = (w->fill == 0) ? a : lower(w->current, a);
+    if (++w->fill == w->bucket_sweeps) windowComplete(w, false);
+    e->regs[s->out] = w->filled ? lower(w->completed, w->current) : w->current;
+}
+
+static void evalMax(derived_engine_t *e, const derived_step_t *s) {
+    derived_window_t *w = &e->windows[s->window];
+    int32_t a = e->regs[s->a];
+    w->current = (w->fill == 0) ? a : higher(w->current, a);
+    if (++w->fill == w->bucket_sweeps) windowComplete(w, true);
+    e->regs[s->out] = w->filled ? higher(w->completed, w->current) : w->current;
+}
+
+static void evalPeakHold(derived_engine_t *e, const derived_step_t *s) {
+    derived_window_t *w = &e->windows[s->window];
+    int32_t a = e->regs[s->a];
+    w->current = (w->fill == 0) ? a : higher(w->current, a);
+    if (++w->fill == w->bucket_sweeps) {
+        w->held = w->current;
+        w->filled = 1;
+        w->fill = 0;
+    }
+    e->regs[s->out] = w->filled ? w->held : w->current;
+}
+
+/**
+ * @brief Rate against the value at the start of the oldest bucket, so one division per sweep.
+ */
+static void evalRate(derived_engine_t *e, const derived_step_t *s) {
+    derived_window_t *w = &e->windows[s->window];
+    int32_t a = e->regs[s->a];
+    if (w->fill == 0) {
+        w->bucket[w->head] = a;
+        w->head = (uint8_t)((w->head + 1) % DERIVED_BUCKETS);
+        if (w->filled < DERIVED_BUCKETS) w->filled++;
+    }
+    uint32_t elapsed = (uint32_t)(w->filled - 1) * w->bucket_sweeps + w->fill;
+    int32_t oldest = w->bucket[w->filled < DERIVED_BUCKETS ? 0 : w->head];
+    if (++w->fill == w->bucket_sweeps) w->fill = 0;
+    e->regs[s->out] = elapsed ? saturate(((int64_t)a - oldest) * e->sweeps_per_s / (int64_t)elapsed) : 0;
+}
+
+static const derived_fn_t derived_fns[DERIVED_OP_COUNT] = {
+    [DERIVED_OP_DIFF] = evalDiff,
+    [DERIVED_OP_SUM] = evalSum,
+    [DERIVED_OP_SCALE] = evalScale,
+    [DERIVED_OP_MIN] = evalMin,
+    [DERIVED_OP_MAX] = evalMax,
+    [DERIVED_OP_PEAK_HOLD] = evalPeakHold,
+    [DERIVED_OP_RATE] = evalRate,
+};
+
+/**
+ * @brief Resolves an operand to its register. Channels may only read channels before them.
+ */
+static bool derivedRegister(const derived_operand_t *op, size_t self, uint8_t *reg) {
+    switch (op->src) {
+    case DERIVED_SRC_OUTPUT:
+        *reg = (uint8_t)(DERIVED_REG_OUTPUT + op->index);
+        return op->index < SENSOR_SLOT_COUNT;
+    case DERIVED_SRC_MV:
+        *reg = (uint8_t)(DERIVED_REG_MV + op->index);
+        return op->index < SNAPSHOT_NUM_CHANNELS;
+    case DERIVED_SRC_EXTERNAL:
+        *reg = (uint8_t)(DERIVED_REG_EXTERNAL + op->index);
+        return op->index < DERIVED_MAX_EXTERNAL;
+    case DERIVED_SRC_CHANNEL:
+        *reg = (uint8_t)(DERIVED_REG_CHANNEL + op->index);
+        return op->index < self;
+    case DERIVED_SRC_CAPTURE:
+        *reg = (uint8_t)(DERIVED_REG_CAPTURE + op->index);
+        return op->index < SNAPSHOT_NUM_CAPTURE;
+    default:
+        return false;
+    }
+}
+
+/**
+ * @brief Checks a derived channel table and compiles it into a flat array of evaluators.
+ *
+ * Every operand is resolved to a register and every window converted to
+ * whole sweeps here, so derivedEvaluate() is one indirect call per channel
+ * with no lookups or branches on the operation, and its cost depends only
+ * on the number of channels.
+ *
+ * @param engine The engine to build
+ * @param table The channel descriptors, in evaluation order
+ * @param count Number of entries in `table`
+ * @param sweep_us Time between two sweeps
+ * @return ESP_OK, ESP_ERR_INVALID_ARG for an unknown operation, an operand
+ *         out of range or reading a later channel, a window shorter than
+ *         DERIVED_BUCKETS sweeps or with buckets over UINT16_MAX sweeps, a
+ *         zero divisor or a publish index out of
+ *         range or used twice, ESP_ERR_NO_MEM past DERIVED_MAX_CHANNELS or
+ *         DERIVED_MAX_WINDOWS
+ */
+esp_err_t derivedInit(derived_engine_t *engine, const derived_desc_t *table, size_t count, uint32_t sweep_us) {
+    memset(engine, 0, sizeof(*engine));
+    if (count > DERIVED_MAX_CHANNELS) return ESP_ERR_NO_MEM;
+    if (sweep_us == 0 || (count > 0 && table == NULL)) return ESP_ERR_INVALID_ARG;
+    engine->sweeps_per_s = 1000000u / sweep_us;
+
+    uint32_t published = 0;
+    for (size_t i = 0; i < count; i++) {
+        const derived_desc_t *d = &table[i];
+        derived_step_t *s = &engine->steps[i];
+        if ((unsigned)d->op >= DERIVED_OP_COUNT || !derivedRegister(&d->a, i, &s->a)) return ESP_ERR_INVALID_ARG;
+        if ((d->op == DERIVED_OP_DIFF || d->op == DERIVED_OP_SUM) && !derivedRegister(&d->b, i, &s->b)) {
+            return ESP_ERR_INVALID_ARG;
+        }
+        if (d->op == DERIVED_OP_SCALE && d->div == 0) return ESP_ERR_INVALID_ARG;
+
+        if (d->op >= DERIVED_OP_MIN) {
+            uint32_t window_sweeps = (uint32_t)d->window_ms * 1000u / sweep_us;
+            uint32_t bucket_sweeps = d->op == DERIVED_OP_PEAK_HOLD ? window_sweeps : window_sweeps / DERIVED_BUCKETS;
+            if (window_sweeps < DERIVED_BUCKETS || bucket_sweeps > UINT16_MAX) return ESP_ERR_INVALID_ARG;
+            if (engine->window_count == DERIVED_MAX_WINDOWS) return ESP_ERR_NO_MEM;
+            s->window = engine->window_count++;
+            engine->windows[s->window].bucket_sweeps = (uint16_t)bucket_sweeps;
+        }
+
+        uint8_t publish = (uint8_t)(d->publish - 1);
+        if (d->publish > SNAPSHOT_NUM_DERIVED || (d->publish != 0 && (published & (1u << publish)))) {
+            return ESP_ERR_INVALID_ARG;
+        }
+        s->fn = derived_fns[d->op];
+        s->desc = d;
+        s->out = (uint8_t)(DERIVED_REG_CHANNEL + i);
+        if (d->publish != 0) {
+            published |= 1u << publish;
+            engine->publish_slot[engine->publish_count] = publish;
+            engine->publish_reg[engine->publish_count++] = s->out;
+        }
+    }
+    engine->count = count;
+    return ESP_OK;
+}
+
+/**
+ * @brief Computes every derived channel from a converted sweep and publishes them into `values`.
+ *
+ * Runs once per sweep, after channelsConvert() and captureUpdate(). Windows
+ * advance one sweep per call.
+ *
+ * @param engine The compiled engine
+ * @param values The sweep, read for outputs, millivolts and frequencies and written for `derived`
+ * @param external DERIVED_MAX_EXTERNAL values from outside the ADC path, or NULL for all zero
+ */
+void derivedEvaluate(derived_engine_t *engine, sensor_values_t *values, const int32_t *external) {
+    int32_t *regs = engine->regs;
+    memcpy(&regs[DERIVED_REG_OUTPUT], values->outputs, sizeof(values->outputs));
+    for (int ch = 0; ch < SNAPSHOT_NUM_CHANNELS; ch++) regs[DERIVED_REG_MV + ch] = values->filtered_mv[ch];
+    for (int n = 0; n < SNAPSHOT_NUM_CAPTURE; n++) {
+        regs[DERIVED_REG_CAPTURE + n] = (int32_t)(values->capture_freq[n] > INT32_MAX ? INT32_MAX : values->capture_freq[n]);
+    }
+    for (int i = 0; i < DERIVED_MAX_EXTERNAL; i++) regs[DERIVED_REG_EXTERNAL + i] = external ? external[i] : 0;
+
+    for (size_t i = 0; i < engine->count; i++) engine->steps[i].fn(engine, &engine->steps[i]);
+    for (uint8_t p = 0; p < engine->publish_count; p++) values->derived[engine->publish_slot[p]] = regs[engine->publish_reg[p]];
+}
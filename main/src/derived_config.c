@@ -0,0 +1,24 @@
+#include "inc/derived.h"
+
+/**
+ * @brief Derived channels for the 987, computed every sweep and sent in the derivedValues frame (0x62A).
+ *
+ * The pressure drop across the charge cooler is its inlet pressure less the
+ * manifold pressure the ECU broadcasts (it reads as the inlet pressure until
+ * the ECU stream arrives). The crank case peak catches the pulses a 10 Hz
+ * frame would miss. Published indexes match the packer in can_messages.c.
+ */
+const derived_desc_t derived_table[] = {
+    { .name = "Charge Cooler Pressure Drop", .op = DERIVED_OP_DIFF, // kPa x100
+      .a = DERIVED_OUTPUT(SENSOR_SLOT_CC_INLET_PRESSURE), .b = DERIVED_EXTERNAL(DERIVED_EXT_ECU_MAP), .publish = DERIVED_PUBLISH(0) },
+    { .name = "Crank Case Pressure Peak", .op = DERIVED_OP_PEAK_HOLD, // kPa x100, per second
+      .a = DERIVED_OUTPUT(SENSOR_SLOT_CRANK_CASE_PRESSURE), .window_ms = 1000, .publish = DERIVED_PUBLISH(1) },
+    { .name = "Charge Cooler Water Temperature Rate", .op = DERIVED_OP_RATE, // 0.1°C per second
+      .a = DERIVED_OUTPUT(SENSOR_SLOT_CC_WATER_TEMP), .window_ms = 2000, .publish = DERIVED_PUBLISH(2) },
+    { .name = "Charge Cooler Inlet Temperature Min", .op = DERIVED_OP_MIN, // 0.1°C, last 10 s
+      .a = DERIVED_OUTPUT(SENSOR_SLOT_CC_INLET_TEMP), .window_ms = 10000, .publish = DERIVED_PUBLISH(3) },
+    { .name = "Charge Cooler Inlet Temperature Max", .op = DERIVED_OP_MAX, // 0.1°C, last 10 s
+      .a = DERIVED_OUTPUT(SENSOR_SLOT_CC_INLET_TEMP), .window_ms = 10000, .publish = DERIVED_PUBLISH(4) },
+};
+
+const size_t derived_table_count = sizeof(derived_table) / sizeof(derived_table[0]);
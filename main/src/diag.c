@@ -0,0 +1,184 @@
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "esp_err.h"
+#include "inc/diag.h"
+
+#if CONFIG_CANBOARD_DIAG
+diag_t diag;
+#endif
+
+static const char *const metric_names[DIAG_METRIC_COUNT] = {
+    [DIAG_ADC_FILTER] = "adc_filter_us",
+    [DIAG_ADC_CONVERT] = "adc_convert_us",
+    [DIAG_ADC_LOOP] = "adc_loop_us",
+    [DIAG_CAN_PACK] = "can_pack_us",
+    [DIAG_CAN_LOOP] = "can_late_us",
+    [DIAG_SAMPLE_AGE] = "sample_age_us",
+    [DIAG_TX_QUEUE] = "tx_queue",
+    [DIAG_TX_FAILURES] = "tx_failures",
+};
+
+static void windowReset(diag_window_t *w) {
+    memset(w, 0, sizeof(*w));
+    w->min = UINT32_MAX;
+}
+
+/**
+ * @brief Initializes the diagnostics state.
+ *
+ * @param diag The state to initialize
+ * @param clock Free-running cycle counter of the calling core (a fake one on the host)
+ * @param cycles_per_us Counter rate, the CPU clock in MHz on the target
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_INVALID_ARG if the clock is missing or the rate is zero
+ */
+esp_err_t diagInit(diag_t *diag, diag_clock_fn_t clock, uint32_t cycles_per_us) {
+    if (diag == NULL || clock == NULL || cycles_per_us == 0) return ESP_ERR_INVALID_ARG;
+
+    memset(diag, 0, sizeof(*diag));
+    for (int i = 0; i < DIAG_METRIC_COUNT; i++) {
+        windowReset(&diag->metrics[i].current);
+        atomic_init(&diag->metrics[i].close_req, 0);
+        atomic_init(&diag->metrics[i].close_ack, 0);
+    }
+    atomic_init(&diag->report_seq, 0);
+    diag->clock = clock;
+    diag->cycles_per_us = cycles_per_us;
+    return ESP_OK;
+}
+
+/**
+ * @brief Maps a value to its log-linear histogram bucket.
+ *
+ * Values below 2^DIAG_HIST_SUB_BITS get a bucket each; above that every
+ * power of two is split into 2^DIAG_HIST_SUB_BITS equal buckets.
+ */
+static uint32_t bucketOf(uint32_t value) {
+    if (value < (1u << DIAG_HIST_SUB_BITS)) return value;
+    uint32_t exp = 31u - (uint32_t)__builtin_clz(value);
+    if (exp > DIAG_HIST_MAX_EXP) return DIAG_HIST_BUCKETS - 1;
+    uint32_t sub = (value >> (exp - DIAG_HIST_SUB_BITS)) & ((1u << DIAG_HIST_SUB_BITS) - 1u);
+    return ((exp - DIAG_HIST_SUB_BITS + 1u) << DIAG_HIST_SUB_BITS) + sub;
+}
+
+/**
+ * @brief Largest value that falls in a bucket.
+ */
+static uint32_t bucketTop(uint32_t bucket) {
+    if (bucket < (1u << DIAG_HIST_SUB_BITS)) return bucket;
+    uint32_t exp = (bucket >> DIAG_HIST_SUB_BITS) + DIAG_HIST_SUB_BITS - 1u;
+    uint32_t sub = bucket & ((1u << DIAG_HIST_SUB_BITS) - 1u);
+    return ((1u << exp) | ((sub + 1u) << (exp - DIAG_HIST_SUB_BITS))) - 1u;
+}
+
+/**
+ * @brief Adds one sample to a metric. Only one task may record into a metric.
+ *
+ * Cost is a compare, a count-leading-zeros and a handful of stores, plus a
+ * window copy when a reader has asked for one.
+ */
+void diagRecord(diag_t *diag, diag_metric_id_t metric, uint32_t value) {
+    diag_metric_t *m = &diag->metrics[metric];
+
+    unsigned req = atomic_load_explicit(&m->close_req, memory_order_acquire);
+    if (req != atomic_load_explicit(&m->close_ack, memory_order_relaxed)) {
+        m->closed = m->current;
+        windowReset(&m->current);
+        atomic_store_explicit(&m->close_ack, req, memory_order_release);
+    }
+
+    diag_window_t *w = &m->current;
+    w->count++;
+    w->sum += value;
+    if (value < w->min) w->min = value;
+    if (value > w->max) w->max = value;
+    uint16_t *slot = &w->hist[bucketOf(value)];
+    if (*slot != UINT16_MAX) (*slot)++;
+    m->total++;
+}
+
+/**
+ * @brief Returns an upper bound on the given percentile of a window, in the metric's unit.
+ *
+ * The bound is the top of the histogram bucket holding the percentile,
+ * clamped to the window maximum.
+ *
+ * @param window The window
+ * @param permille The percentile in tenths of a percent, e.g. 990 for p99
+ */
+uint32_t diagPercentile(const diag_window_t *window, uint32_t permille) {
+    if (window->count == 0) return 0;
+    uint64_t rank = ((uint64_t)window->count * permille + 999u) / 1000u;
+    if (rank == 0) rank = 1;
+    uint64_t seen = 0;
+    for (uint32_t b = 0; b < DIAG_HIST_BUCKETS; b++) {
+        seen += window->hist[b];
+        if (seen >= rank) {
+            uint32_t top = bucketTop(b);
+            return (top < window->max) ? top : window->max;
+        }
+    }
+    return window->max; // Only reached once bucket counts have saturated
+}
+
+/**
+ * @brief Takes the statistics of a metric's last closed window and asks for the next one.
+ *
+ * Called periodically from one reader task. The first call for a metric,
+ * and any call while its writer has not recorded since the previous one,
+ * yields an empty report. The report is also kept for diagReports().
+ *
+ * @param diag The diagnostics state
+ * @param metric The metric
+ * @param report The statistics of the window closed by the previous call
+ * @return True if the report holds a closed window
+ */
+bool diagCollect(diag_t *diag, diag_metric_id_t metric, diag_report_t *report) {
+    diag_metric_t *m = &diag->metrics[metric];
+    unsigned req = atomic_load_explicit(&m->close_req, memory_order_relaxed);
+    bool ready = req != 0 && atomic_load_explicit(&m->close_ack, memory_order_acquire) == req;
+
+    memset(report, 0, sizeof(*report));
+    if (ready && m->closed.count > 0) {
+        const diag_window_t *w = &m->closed;
+        report->count = w->count;
+        report->min = w->min;
+        report->max = w->max;
+        report->avg = (uint32_t)(w->sum / w->count);
+        report->p99 = diagPercentile(w, 990);
+    }
+    if (ready || req == 0) atomic_store_explicit(&m->close_req, req + 1, memory_order_release);
+
+    unsigned seq = atomic_load_explicit(&diag->report_seq, memory_order_relaxed);
+    atomic_store_explicit(&diag->report_seq, seq + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    diag->reports[metric] = *report;
+    atomic_store_explicit(&diag->report_seq, seq + 2, memory_order_release);
+    return ready;
+}
+
+/**
+ * @brief Copies the latest report of every metric, consistent across metrics.
+ */
+void diagReports(diag_t *diag, diag_report_t reports[DIAG_METRIC_COUNT]) {
+    unsigned begin, end;
+    do {
+        begin = atomic_load_explicit(&diag->report_seq, memory_order_acquire);
+        if (begin & 1u) continue;
+        memcpy(reports, (const void *)diag->reports, sizeof(diag->reports));
+        atomic_thread_fence(memory_order_acquire);
+        end = atomic_load_explicit(&diag->report_seq, memory_order_relaxed);
+        if (begin == end) break;
+    } while (1);
+}
+
+/**
+ * @brief Short name of a metric, with its unit, for dumps.
+ */
+const char *diagMetricName(diag_metric_id_t metric) {
+    return (metric < DIAG_METRIC_COUNT) ? metric_names[metric] : "?";
+}
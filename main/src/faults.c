@@ -0,0 +1,144 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "inc/faults.h"
+
+static const char *const fault_names[FAULT_COUNT] = {
+    [FAULT_NONE] = "ok",
+    [FAULT_OPEN] = "open",
+    [FAULT_SHORT_GND] = "short_gnd",
+    [FAULT_SHORT_5V] = "short_5v",
+    [FAULT_STUCK] = "stuck",
+    [FAULT_NOISE] = "noise",
+    [FAULT_RATE] = "rate",
+};
+
+static uint16_t msToSweeps(uint32_t ms, uint32_t sweep_us) {
+    uint32_t sweeps = (ms * 1000u + sweep_us - 1) / sweep_us;
+    return (uint16_t)(sweeps < 1 ? 1 : sweeps > UINT16_MAX ? UINT16_MAX : sweeps);
+}
+
+/**
+ * @brief Prepares a channel's classifier, converting its limits to sweeps and raw codes.
+ *
+ * Done once per pipeline build so faultUpdate() is integer compares only.
+ *
+ * @param state The classifier state to initialize
+ * @param limits The channel's limits
+ * @param mv_per_code Divider-scaled millivolts per raw ADC code, 0 or less disables the noise check
+ * @param update_us Time between two filter outputs (one sweep, or one oversampled block)
+ * @param sweep_us Time between two sweeps
+ */
+void faultInit(fault_state_t *state, const fault_limits_t *limits, float mv_per_code, uint32_t update_us, uint32_t sweep_us) {
+    memset(state, 0, sizeof(*state));
+    if (limits->noise_mv != 0 && mv_per_code > 0.0f) {
+        float codes = limits->noise_mv / mv_per_code;
+        state->noise_codes = (uint16_t)(codes < 1.0f ? 1 : codes > UINT16_MAX ? UINT16_MAX : codes);
+    }
+    uint32_t step = (uint32_t)limits->rate_mv_per_ms * update_us / 1000u;
+    state->rate_step_mv = (uint16_t)(limits->rate_mv_per_ms == 0 ? 0 : step < 1 ? 1 : step > UINT16_MAX ? UINT16_MAX : step);
+    state->stuck_sweeps = limits->stuck_ms ? msToSweeps(limits->stuck_ms, sweep_us) : 0;
+    state->set_sweeps = msToSweeps(FAULT_SET_MS, sweep_us);
+    state->clear_sweeps = msToSweeps(FAULT_CLEAR_MS, sweep_us);
+}
+
+/**
+ * @brief Returns -1 if `code` puts the input at its low rail, 1 at its high rail, 0 otherwise.
+ */
+static int faultRail(fault_code_t code, const fault_limits_t *limits) {
+    if (code == FAULT_SHORT_GND) return -1;
+    if (code == FAULT_SHORT_5V) return 1;
+    if (code == FAULT_OPEN) return limits->open_high ? 1 : -1;
+    return 0;
+}
+
+/**
+ * @brief Classifies one sweep on its own, before any debouncing.
+ *
+ * A reading at a rail says the most about the wiring, so it wins over an
+ * implausible step, which wins over noise, which wins over a stuck code.
+ * Through a divider the ADC can saturate below `high_mv`, so an input
+ * pinned at full scale is at the high rail too.
+ */
+static fault_code_t faultClassify(fault_state_t *s, const fault_limits_t *limits, const fault_input_t *in) {
+    int rail = faultRail((fault_code_t)s->code, limits);
+    bool have_samples = in->min_code <= in->max_code;
+    bool pinned = have_samples && in->min_code >= FAULT_PINNED_CODE;
+    fault_code_t code = FAULT_NONE;
+
+    if (have_samples && in->min_code == in->max_code && in->min_code == s->flat_code) {
+        if (s->flat_sweeps < UINT16_MAX) s->flat_sweeps++;
+    } else {
+        s->flat_sweeps = (have_samples && in->min_code == in->max_code) ? 1 : 0;
+        s->flat_code = in->min_code;
+    }
+
+    if (s->stuck_sweeps != 0 && s->flat_sweeps >= s->stuck_sweeps) code = FAULT_STUCK;
+    if (s->noise_codes != 0 && have_samples && in->max_code - in->min_code > s->noise_codes) code = FAULT_NOISE;
+    if (in->updated) {
+        int step = in->mv - s->last_mv;
+        if (s->primed && s->rate_step_mv != 0 && (step > s->rate_step_mv || step < -s->rate_step_mv)) code = FAULT_RATE;
+        s->last_mv = in->mv;
+        s->primed = true;
+    }
+    if (limits->low_mv != 0 && in->mv < limits->low_mv + (rail < 0 ? FAULT_HYST_MV : 0)) {
+        code = limits->open_high ? FAULT_SHORT_GND : FAULT_OPEN;
+    } else if (limits->high_mv != 0 && (pinned || in->mv > limits->high_mv - (rail > 0 ? FAULT_HYST_MV : 0))) {
+        code = limits->open_high ? FAULT_OPEN : FAULT_SHORT_5V;
+    }
+    return code;
+}
+
+/**
+ * @brief Classifies one sweep of a channel and returns its latched fault.
+ *
+ * A fault latches once the input has been wrong for FAULT_SET_MS more than
+ * it has been right, so bursts (a loose pin, intermittent noise) latch as
+ * well as a steady fault, and a glitch shorter than that never does. An
+ * implausible step latches at once, since it is over in a single sweep. A
+ * latched fault is reported as whatever the input has consistently looked
+ * like for FAULT_SET_MS, an open input first seen as a step for example.
+ * It clears only after FAULT_CLEAR_MS in a row with nothing wrong, and a
+ * rail fault only once the reading is FAULT_HYST_MV back inside the window,
+ * so a marginal input does not flap between its value and the failsafe.
+ *
+ * @param state The channel's classifier state
+ * @param limits The channel's limits, as given to faultInit()
+ * @param in This sweep of the channel
+ * @return The latched fault, FAULT_NONE if the channel can be trusted
+ */
+fault_code_t faultUpdate(fault_state_t *state, const fault_limits_t *limits, const fault_input_t *in) {
+    fault_code_t candidate = faultClassify(state, limits, in);
+
+    if (candidate == FAULT_NONE) {
+        state->pending = FAULT_NONE;
+        state->pending_count = 0;
+        if (state->set_count > 0) state->set_count--;
+        if (state->code != FAULT_NONE && ++state->clear_count >= state->clear_sweeps) {
+            state->code = FAULT_NONE;
+            state->clear_count = 0;
+            state->set_count = 0;
+        }
+        return (fault_code_t)state->code;
+    }
+
+    state->clear_count = 0;
+    if (candidate != state->pending) {
+        state->pending = (uint8_t)candidate;
+        state->pending_count = 0;
+    }
+    if (state->pending_count < UINT16_MAX) state->pending_count++;
+    if (state->set_count < state->set_sweeps) state->set_count++;
+
+    bool latch = (state->code == FAULT_NONE) ? state->set_count >= state->set_sweeps : state->pending_count >= state->set_sweeps;
+    if (candidate == FAULT_RATE || latch) state->code = (uint8_t)candidate;
+    return (fault_code_t)state->code;
+}
+
+/**
+ * @brief Returns the name of a fault as logged, or "?" if out of range.
+ */
+const char *faultName(fault_code_t code) {
+    return (code < FAULT_COUNT) ? fault_names[code] : "?";
+}
@@ -0,0 +1,147 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "esp_err.h"
+#include "inc/filters.h"
+
+/**
+ * @brief Initializes a streaming filter.
+ *
+ * @param filter The filter state
+ * @param depth Median window length, 1 (no median) to FILTER_MAX_DEPTH
+ * @param iir_alpha Weight of each new sample in the IIR stage, 0 to disable, up to 1
+ * @param slew_limit Largest change of the output per sample, 0 to disable
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_INVALID_ARG if the depth or alpha is out of range
+ */
+esp_err_t filterInit(stream_filter_t *filter, uint8_t depth, float iir_alpha, uint16_t slew_limit) {
+    if (filter == NULL || depth == 0 || depth > FILTER_MAX_DEPTH || iir_alpha < 0.0f || iir_alpha > 1.0f) return ESP_ERR_INVALID_ARG;
+
+    memset(filter, 0, sizeof(*filter));
+    filter->depth = depth;
+    filter->alpha_q16 = (iir_alpha >= 1.0f) ? 0 : (uint16_t)(iir_alpha * 65535.0f + 0.5f);
+    filter->slew_limit = slew_limit;
+    return ESP_OK;
+}
+
+/**
+ * @brief Discards the window and stage state, keeping the configuration.
+ */
+void filterReset(stream_filter_t *filter) {
+    filter->count = 0;
+    filter->head = 0;
+    filter->iir_q16 = 0;
+    filter->output = 0;
+}
+
+/**
+ * @brief Returns the median of the current window (the upper median for even counts).
+ */
+uint16_t filterMedian(const stream_filter_t *filter) {
+    return filter->count ? filter->sorted[filter->count / 2] : 0;
+}
+
+/**
+ * @brief Returns the index of the first sorted element not less than `value`.
+ */
+static uint8_t lowerBound(const uint16_t *sorted, uint8_t count, uint16_t value) {
+    uint8_t lo = 0, hi = count;
+    while (lo < hi) {
+        uint8_t mid = (lo + hi) / 2;
+        if (sorted[mid] < value) lo = mid + 1; else hi = mid;
+    }
+    return lo;
+}
+
+/**
+ * @brief Feeds one sample through the filter and returns the new output.
+ *
+ * @param filter The filter state
+ * @param sample The new raw sample
+ * @return The filtered output after this sample
+ */
+uint16_t filterPush(stream_filter_t *filter, uint16_t sample) {
+    bool first = (filter->count == 0);
+
+    if (filter->count < filter->depth) {
+        uint8_t i = lowerBound(filter->sorted, filter->count, sample);
+        memmove(&filter->sorted[i + 1], &filter->sorted[i], (filter->count - i) * sizeof(uint16_t));
+        filter->sorted[i] = sample;
+        filter->count++;
+    } else {
+        // Overwrite the evicted value in place and slide it to its new rank
+        uint16_t old = filter->history[filter->head];
+        uint8_t i = lowerBound(filter->sorted, filter->count, old);
+        if (sample >= old) {
+            while (i + 1 < filter->count && filter->sorted[i + 1] < sample) {
+                filter->sorted[i] = filter->sorted[i + 1];
+                i++;
+            }
+        } else {
+            while (i > 0 && filter->sorted[i - 1] > sample) {
+                filter->sorted[i] = filter->sorted[i - 1];
+                i--;
+            }
+        }
+        filter->sorted[i] = sample;
+    }
+    filter->history[filter->head] = sample;
+    filter->head = (filter->head + 1 == filter->depth) ? 0 : filter->head + 1;
+
+    uint16_t value = filter->sorted[filter->count / 2];
+
+    if (filter->alpha_q16 != 0) {
+        int64_t x = (int64_t)value << 16;
+        filter->iir_q16 = first ? x : filter->iir_q16 + (((x - filter->iir_q16) * filter->alpha_q16) >> 16);
+        value = (uint16_t)((filter->iir_q16 + (1 << 15)) >> 16);
+    }
+
+    if (filter->slew_limit != 0 && !first) {
+        if (value > filter->output + filter->slew_limit) value = filter->output + filter->slew_limit;
+        else if (value + filter->slew_limit < filter->output) value = filter->output - filter->slew_limit;
+    }
+
+    filter->output = value;
+    return value;
+}
+
+/**
+ * @brief Initializes an oversampler.
+ *
+ * @param os The oversampler state
+ * @param ratio Samples per output, a power of two from OVERSAMPLE_MIN_RATIO to OVERSAMPLE_MAX_RATIO
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_INVALID_ARG if the ratio is out of range or not a power of two
+ */
+esp_err_t oversampleInit(oversampler_t *os, uint16_t ratio) {
+    if (os == NULL || ratio < OVERSAMPLE_MIN_RATIO || ratio > OVERSAMPLE_MAX_RATIO || (ratio & (ratio - 1)) != 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    memset(os, 0, sizeof(*os));
+    os->ratio = ratio;
+    while ((1u << os->shift) < ratio) os->shift++;
+    return ESP_OK;
+}
+
+/**
+ * @brief Accumulates one sample, completing a block every `ratio` samples.
+ *
+ * @param os The oversampler state
+ * @param sample The new raw sample
+ * @return True if this sample completed a block and `output_q` was updated
+ */
+bool oversamplePush(oversampler_t *os, uint16_t sample) {
+    os->acc += sample;
+    if (++os->count < os->ratio) return false;
+
+    // Exact: the shift never exceeds the fractional bits for ratios up to 256
+    os->output_q = (os->acc << OVERSAMPLE_FRAC_BITS >> os->shift);
+    os->acc = 0;
+    os->count = 0;
+    os->blocks++;
+    return true;
+}
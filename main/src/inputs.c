@@ -1,31 +1,57 @@
 #include "esp_err.h"
 #include "esp_log.h"
 #include "driver/gpio.h"
-#include "esp_adc/adc_oneshot.h"
+#include "driver/mcpwm_cap.h"
+#include "driver/pulse_cnt.h"
+#include "esp_adc/adc_continuous.h"
 #include "esp_adc/adc_cali.h"
 #include "esp_adc/adc_cali_scheme.h"
 
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
-#include "freertos/semphr.h"
-
+#include "esp_timer.h"
 #include "driver/temperature_sensor.h"
 #include "inc/inputs.h"
+#include "inc/adc_stream.h"
+#include "inc/board_config.h"
+#include "inc/boot.h"
+#include "inc/can_rx.h"
+#include "inc/capture.h"
+#include "inc/config_store.h"
+#include "inc/derived.h"
+#include "inc/diag.h"
 
 #include <math.h>
 #include <stdint.h>
+#include <string.h>
+
+static adc_continuous_handle_t adc_handle = NULL;
+static adc_cali_handle_t cali_handle = NULL; // One curve fit serves every channel: same unit, attenuation and width
 
-static adc_oneshot_unit_handle_t adc_handle = NULL;
-static adc_cali_handle_t cali_handles[ADC_CHANNEL_END + 1] = {NULL};
+static esp_err_t adcHalStart(void *ctx) { return adc_continuous_start((adc_continuous_handle_t)ctx); }
+static esp_err_t adcHalStop(void *ctx) { return adc_continuous_stop((adc_continuous_handle_t)ctx); }
+static esp_err_t adcHalRead(void *ctx, uint8_t *buf, uint32_t len, uint32_t *out_len, uint32_t timeout_ms) {
+    return adc_continuous_read((adc_continuous_handle_t)ctx, buf, len, out_len, timeout_ms);
+}
+
+static adc_stream_hal_t adc_hal = { .start = adcHalStart, .stop = adcHalStop, .read = adcHalRead };
+static adc_stream_t adc_stream;
 
 static temperature_sensor_handle_t tempSensor_handle = NULL;
 static bool tempSensor_initialized = false;
 
-SemaphoreHandle_t filtered_voltages_mutex;
-SemaphoreHandle_t scaled_pressures_mutex;
+sensor_snapshot_t sensor_snapshot;
+
+static channel_pipeline_t channel_pipeline;
+static channel_desc_t channel_descs[NUM_ADC_CHANNELS]; // channel_table with the configured dividers, filters and spans
+static derived_engine_t derived_engine;
 
-volatile uint16_t scaled_pressures[4];
-volatile uint16_t filtered_voltages[NUM_ADC_CHANNELS];
+static capture_t capture;
+static struct capture_input {
+    pcnt_unit_handle_t counter;
+    mcpwm_cap_channel_handle_t rise;
+    mcpwm_cap_channel_handle_t fall;    // CAPTURE_FREQUENCY_DUTY only
+} capture_inputs[CAPTURE_MAX_INPUTS];
 
 /**
  * @brief Initializes the CPU temperature sensor.
@@ -80,239 +106,308 @@ int8_t getCpuTemperature(void){
 /**
  * @brief Initializes the ADC channels for the ESP32.
  *
- * This function initializes the ADC unit and configures each channel to use a
- * 12-bit ADC with an attenuation of 12 dB. It then creates a calibration scheme
- * for each channel using the curve fitting method. The calibration handles are
- * stored in the `cali_handles` array.
+ * This function creates a continuous (DMA) ADC handle whose scan pattern
+ * covers every channel at 12-bit with an attenuation of 12 dB, so a single
+ * DMA frame carries samples for all inputs. It then creates one curve
+ * fitting calibration scheme, which every channel shares: the fit depends
+ * only on the unit and attenuation, so one per channel would be ten
+ * identical copies.
  *
- * @note If a channel's configuration or calibration fails, the function will
- *       log a warning message and continue to the next channel.
+ * @note If the calibration fails, the function logs a warning once and every
+ *       input is converted linearly against ADC_NOMINAL_FULL_SCALE_MV, which
+ *       is within a few percent but uncorrected for this chip.
  */
 void initAdcChannels(void){
-    adc_oneshot_unit_init_cfg_t unit_cfg = { .unit_id = ADC_UNIT };
-    ESP_ERROR_CHECK(adc_oneshot_new_unit(&unit_cfg, &adc_handle));
+    adc_continuous_handle_cfg_t handle_cfg = { .max_store_buf_size = ADC_STREAM_FRAME_BYTES * ADC_STREAM_STORE_FRAMES,
+                                               .conv_frame_size = ADC_STREAM_FRAME_BYTES };
+    ESP_ERROR_CHECK(adc_continuous_new_handle(&handle_cfg, &adc_handle));
 
+    adc_digi_pattern_config_t pattern[NUM_ADC_CHANNELS] = {0};
     for (adc_channel_t ch = ADC_CHANNEL_START; ch <= ADC_CHANNEL_END; ch++) {
-        adc_oneshot_chan_cfg_t chan_cfg = { .bitwidth = ADC_BITWIDTH_DEFAULT, .atten = ADC_ATTEN_DB_12 };
-        esp_err_t err = adc_oneshot_config_channel(adc_handle, ch, &chan_cfg);
-        if (err != ESP_OK) {
-            ESP_LOGW(adc_log, "Failed to Configure ADC Channel: %d (%s)", ch, esp_err_to_name(err));
-            continue;
-        } else {
-            ESP_LOGI(adc_log, "Configured ADC Channel: %d", ch);
-        }
-
-        adc_cali_curve_fitting_config_t cali_cfg = { .unit_id = ADC_UNIT, .atten = ADC_ATTEN_DB_12, .bitwidth = ADC_BITWIDTH_DEFAULT };
+        pattern[ch - ADC_CHANNEL_START] = (adc_digi_pattern_config_t){ .atten = ADC_ATTEN_DB_12, .channel = ch, .unit = ADC_UNIT,
+                                                                       .bit_width = SOC_ADC_DIGI_MAX_BITWIDTH };
+    }
 
-        adc_cali_handle_t cali_handle = NULL;
-        esp_err_t ret = adc_cali_create_scheme_curve_fitting(&cali_cfg, &cali_handle);
-        if (ret == ESP_OK) {
-            cali_handles[ch] = cali_handle;
-            ESP_LOGI(adc_log, "Calibration Created for ADC Channel: %d", ch);
-        } else {
-            ESP_LOGW(adc_log, "Failed to Create Calibration for ADC Channel: %d (%s)", ch, esp_err_to_name(ret));
-        }
+    adc_continuous_config_t dig_cfg = { .pattern_num = NUM_ADC_CHANNELS, .adc_pattern = pattern, .sample_freq_hz = ADC_STREAM_SAMPLE_FREQ_HZ,
+                                        .conv_mode = ADC_CONV_SINGLE_UNIT_1, .format = ADC_DIGI_OUTPUT_FORMAT_TYPE2 };
+    ESP_ERROR_CHECK(adc_continuous_config(adc_handle, &dig_cfg));
+    ESP_LOGI(adc_log, "Configured ADC Scan Pattern: %d Channels @ %d Hz", NUM_ADC_CHANNELS, ADC_STREAM_SAMPLE_FREQ_HZ);
+
+    adc_hal.ctx = adc_handle;
+    ESP_ERROR_CHECK(adcStreamInit(&adc_stream, &adc_hal, ADC_UNIT));
+
+    adc_cali_curve_fitting_config_t cali_cfg = { .unit_id = ADC_UNIT, .atten = ADC_ATTEN_DB_12, .bitwidth = ADC_BITWIDTH_DEFAULT };
+    esp_err_t ret = adc_cali_create_scheme_curve_fitting(&cali_cfg, &cali_handle);
+    if (ret == ESP_OK) {
+        ESP_LOGI(adc_log, "Calibration Created for ADC Channels %d-%d", ADC_CHANNEL_START, ADC_CHANNEL_END);
+    } else {
+        cali_handle = NULL;
+        ESP_LOGW(adc_log, "Failed to Create ADC Calibration (%s), Using Nominal %d mV Full Scale", esp_err_to_name(ret),
+                 ADC_NOMINAL_FULL_SCALE_MV);
     }
 }
 
 /**
- * @brief Calculates the pressure from the given voltage, given min and max voltage
- *        and pressure values.
+ * @brief Converts a raw conversion result from the given ADC channel to millivolts.
  *
- * The function first clamps the given voltage to the valid range, then calculates
- * the relative voltage to the total voltage span. This relative voltage is then
- * multiplied with the total pressure span to get the absolute pressure value.
- *
- * The result is then multiplied by 100 and returned as an integer.
+ * If the 'scaled' parameter is true, the voltage is scaled to the range of 0 to 5000 mV.
  *
- * @param v_mv The measured voltage in millivolts
- * @param v_min_mv The minimum valid voltage in millivolts
- * @param v_max_mv The maximum valid voltage in millivolts
- * @param p_min The minimum pressure value
- * @param p_max The maximum pressure value
- * @return The calculated pressure value multiplied by 100
+ * @param channel The ADC channel the result was read from
+ * @param raw The raw conversion result
+ * @param scaled Whether to scale the voltage to the range of 0 to 5000 mV
+ * @return The scaled voltage in millivolts
  */
-uint16_t getSensorPressure(int v_mv, int v_min_mv, int v_max_mv, float p_min, float p_max)
-{
-    if (v_mv < v_min_mv) v_mv = v_min_mv;
-    if (v_mv > v_max_mv) v_mv = v_max_mv;
+uint16_t getScaledMillivolts(adc_channel_t channel, int raw, bool scaled, float scaling_factor) {
+    if (channel < ADC_CHANNEL_START || channel > ADC_CHANNEL_END) {
+        ESP_LOGE(adc_log, "Requested ADC Channel %d Out of Range!", channel);
+        return 0;
+    }
 
-    float voltage_span = v_max_mv - v_min_mv;
-    float pressure_span = p_max - p_min;
-    float relative_voltage = v_mv - v_min_mv;
+    int voltage = 0;
+    if (cali_handle == NULL) {
+        voltage = raw * ADC_NOMINAL_FULL_SCALE_MV / ((1 << SOC_ADC_DIGI_MAX_BITWIDTH) - 1); // Warned once in initAdcChannels()
+    } else {
+        esp_err_t err = adc_cali_raw_to_voltage(cali_handle, raw, &voltage);
+        if (err != ESP_OK) {
+            ESP_LOGE(adc_log, "Voltage Conversion Failed for ADC Channel: %d (%s)", channel, esp_err_to_name(err));
+            return 0;
+        }
+    }
 
-    float pressure = p_min + (relative_voltage / voltage_span) * pressure_span;
+    float v_input_mv = (scaled) ? voltage * scaling_factor : (float)voltage;
 
-    if(pressure < 0.0f) pressure = 0.0f; 
-    return (uint16_t)(pressure * 100.0f);
+    return (uint16_t)(v_input_mv);
 }
 
 /**
- * @brief Calculates the temperature from the given voltage, given pull-up resistor
- *        value and reference voltage.
- *
- * The function first clamps the given voltage to the valid range, then calculates
- * the NTC resistance from the given values. This resistance is then used to
- * interpolate the temperature from the pre-defined NTC table.
+ * @brief Calibration hook for the channel pipeline, returns unscaled millivolts.
+ */
+static int adcCaliMillivolts(void *ctx, int channel, int raw) {
+    return getScaledMillivolts((adc_channel_t)channel, raw, false, 1.0f);
+}
+
+/**
+ * @brief Rebuilds the channel pipeline from `channel_table` and the runtime configuration.
  *
- * The result is then clamped to the valid range and returned as an integer.
+ * Filter history restarts, so the first sweep afterwards is filtered from
+ * fresh samples only.
+ */
+static void configureChannels(void){
+    board_config_t cfg;
+    configStoreRead(&cfg);
+    boardConfigApplyChannels(&cfg, channel_table, channel_descs, NUM_ADC_CHANNELS);
+    ESP_ERROR_CHECK(channelsInit(&channel_pipeline, channel_descs, NUM_ADC_CHANNELS, adcCaliMillivolts, NULL));
+}
+
+/**
+ * @brief Prepares the per-channel sensor pipeline from `channel_table` and the runtime configuration.
  *
- * @param v_mv The measured voltage in millivolts
- * @param r_pullup The pull-up resistor value in ohms
- * @param v_ref_mv The reference voltage in millivolts
- * @return The calculated temperature value in degrees Celsius (int8_t)
+ * Builds the fixed-point temperature lookups for the NTC inputs once at boot,
+ * so temperature conversions are a binary search over millivolts with no
+ * float maths. Points rejected as non-monotonic are logged, as is the output
+ * rate and resolution gain of each oversampled input. The derived channels
+ * in `derived_table` are compiled here too. Must run after initConfigStore().
  */
-int8_t getSensorTemperature(int v_mv, int r_pullup, int v_ref_mv, const ntc_point_t *table, size_t table_size) {
-    if (v_mv <= 0 || v_mv >= v_ref_mv || r_pullup <= 0 || v_ref_mv <= 0 || table == NULL || table_size < 2)
-        return (int8_t)-128;
-
-    float v_ntc = v_mv / 1000.0f;
-    float v_ref = v_ref_mv / 1000.0f;
-    float r_ntc_f = (r_pullup * v_ntc) / (v_ref - v_ntc);
-    int32_t r_ntc = (int32_t)(r_ntc_f + 0.5f);
-
-    if (r_ntc >= table[0].resistance) return table[0].temp_c;
-    if (r_ntc <= table[table_size - 1].resistance)
-        return table[table_size - 1].temp_c;
-
-    for (size_t i = 0; i < table_size - 1; i++) {
-        int32_t r1 = table[i].resistance;
-        int32_t r2 = table[i + 1].resistance;
-
-        if (r_ntc <= r1 && r_ntc > r2) {
-            int16_t t1 = table[i].temp_c;
-            int16_t t2 = table[i + 1].temp_c;
-
-            float frac = (float)(r_ntc - r2) / (r1 - r2);
-            int8_t temp = (int8_t)(t2 + frac * (t1 - t2));
-            return temp;
+void initSensorTables(void){
+    configureChannels();
+    ESP_ERROR_CHECK(derivedInit(&derived_engine, derived_table, derived_table_count, CHANNEL_SWEEP_US));
+    for (uint8_t i = 0; i < channel_pipeline.lut_count; i++) {
+        if (channel_pipeline.luts[i].dropped > 0) {
+            ESP_LOGW(adc_log, "Dropped %u Non-Monotonic NTC Points (Lookup %u)", channel_pipeline.luts[i].dropped, i);
         }
     }
-
-    return (int8_t)-128;
+    for (int ch = 0; ch < NUM_ADC_CHANNELS; ch++) {
+        const oversampler_t *os = &channel_pipeline.oversamplers[ch];
+        if (channel_descs[ch].filter != CHANNEL_FILTER_OVERSAMPLE) continue;
+        ESP_LOGI(adc_log, "Input %d (%s) Oversampled %ux: %u Hz, +%u Bits", ch + 1, channel_descs[ch].name, os->ratio,
+                 ADC_STREAM_SAMPLE_FREQ_HZ / ADC_STREAM_NUM_CHANNELS / os->ratio, os->shift / 2);
+    }
 }
 
 /**
- * @brief Gets the scaled millivolts from the given ADC channel.
+ * @brief Sets up a pulse counter and capture channels on every input in `capture_table`.
  *
- * If the 'scaled' parameter is true, the voltage is scaled to the range of 0 to 5000 mV.
- *
- * @param channel The ADC channel to read from
- * @param scaled Whether to scale the voltage to the range of 0 to 5000 mV
- * @return The scaled voltage in millivolts
+ * The counter counts rising edges through its glitch filter and wraps at
+ * CAPTURE_COUNTER_MODULUS, with no overflow interrupt: the ADC task reads
+ * it every sweep and extends it in software. An MCPWM capture channel
+ * latches its group's timer on every rising edge (and a second one on
+ * every falling edge for a duty input), and no callback is registered, so
+ * no interrupt either. Each input takes the MCPWM group of its table
+ * index, one capture timer apiece. The pad stays on the ADC scan, reading
+ * the signal's average.
  */
-uint16_t getScaledMillivolts(adc_channel_t channel, bool scaled, float scaling_factor) {
-    if (channel < ADC_CHANNEL_START || channel > ADC_CHANNEL_END) {
-        ESP_LOGE(adc_log, "Requested ADC Channel %d Out of Range!", channel);
-        return 0;
+void initCaptureInputs(void){
+    uint32_t timer_hz = 0;
+    for (size_t i = 0; i < capture_table_count && i < CAPTURE_MAX_INPUTS; i++) {
+        const capture_desc_t *d = &capture_table[i];
+        struct capture_input *in = &capture_inputs[i];
+        gpio_num_t gpio = CAPTURE_INPUT_GPIO(d->input);
+
+        pcnt_unit_config_t unit_cfg = { .low_limit = -1, .high_limit = CAPTURE_COUNTER_MODULUS };
+        ESP_ERROR_CHECK(pcnt_new_unit(&unit_cfg, &in->counter));
+        if (d->glitch_ns > 0) {
+            pcnt_glitch_filter_config_t filter_cfg = { .max_glitch_ns = d->glitch_ns };
+            ESP_ERROR_CHECK(pcnt_unit_set_glitch_filter(in->counter, &filter_cfg));
+        }
+        pcnt_chan_config_t chan_cfg = { .edge_gpio_num = gpio, .level_gpio_num = -1 };
+        pcnt_channel_handle_t chan = NULL;
+        ESP_ERROR_CHECK(pcnt_new_channel(in->counter, &chan_cfg, &chan));
+        ESP_ERROR_CHECK(pcnt_channel_set_edge_action(chan, PCNT_CHANNEL_EDGE_ACTION_INCREASE, PCNT_CHANNEL_EDGE_ACTION_HOLD));
+        ESP_ERROR_CHECK(pcnt_unit_enable(in->counter));
+        ESP_ERROR_CHECK(pcnt_unit_clear_count(in->counter));
+        ESP_ERROR_CHECK(pcnt_unit_start(in->counter));
+
+        mcpwm_cap_timer_handle_t timer = NULL;
+        mcpwm_capture_timer_config_t timer_cfg = { .group_id = (int)i, .clk_src = MCPWM_CAPTURE_CLK_SRC_DEFAULT };
+        ESP_ERROR_CHECK(mcpwm_new_capture_timer(&timer_cfg, &timer));
+        mcpwm_capture_channel_config_t rise_cfg = { .gpio_num = gpio, .prescale = 1, .flags.pos_edge = true };
+        ESP_ERROR_CHECK(mcpwm_new_capture_channel(timer, &rise_cfg, &in->rise));
+        ESP_ERROR_CHECK(mcpwm_capture_channel_enable(in->rise));
+        if (d->mode == CAPTURE_FREQUENCY_DUTY) {
+            mcpwm_capture_channel_config_t fall_cfg = { .gpio_num = gpio, .prescale = 1, .flags.neg_edge = true };
+            ESP_ERROR_CHECK(mcpwm_new_capture_channel(timer, &fall_cfg, &in->fall));
+            ESP_ERROR_CHECK(mcpwm_capture_channel_enable(in->fall));
+        }
+        ESP_ERROR_CHECK(mcpwm_capture_timer_get_resolution(timer, &timer_hz));
+        ESP_ERROR_CHECK(mcpwm_capture_timer_enable(timer));
+        ESP_ERROR_CHECK(mcpwm_capture_timer_start(timer));
+        ESP_LOGI(adc_log, "Input %d (%s) Capturing %s on GPIO %d, %u ms Window", d->input + 1, d->name,
+                 d->mode == CAPTURE_FREQUENCY_DUTY ? "Frequency and Duty" : "Frequency", gpio, d->window_ms);
     }
+    ESP_ERROR_CHECK(captureInit(&capture, capture_table, capture_table_count, timer_hz));
+}
 
-    if (cali_handles[channel] == NULL) {
-        ESP_LOGE(adc_log, "No Calibration Handle for ADC Channel: %d", channel);
-        return 0;
+/**
+ * @brief Reads every frequency input's edge count and latched edge times.
+ *
+ * The rising edge time is read before and after the rest; if it moved, an
+ * edge landed during the read and the times are not the count's.
+ */
+static void readCaptureInputs(capture_raw_t *raw) {
+    for (size_t i = 0; i < capture.count; i++) {
+        const struct capture_input *in = &capture_inputs[i];
+        uint32_t rise_again = 0;
+        int count = 0;
+        raw[i] = (capture_raw_t){0};
+        mcpwm_capture_get_latched_value(in->rise, &raw[i].rise_ticks);
+        if (in->fall != NULL) mcpwm_capture_get_latched_value(in->fall, &raw[i].fall_ticks);
+        pcnt_unit_get_count(in->counter, &count);
+        mcpwm_capture_get_latched_value(in->rise, &rise_again);
+        raw[i].edges = (uint16_t)count;
+        raw[i].latched = rise_again == raw[i].rise_ticks;
     }
+}
 
-    int raw, voltage = 0;
-    esp_err_t err = adc_oneshot_read(adc_handle, channel, &raw);
-    if (err != ESP_OK) {
-        ESP_LOGE(adc_log, "ADC Read Failed on Channel: %d (%s)", channel, esp_err_to_name(err));
-        return 0;
+/**
+ * @brief Brings up everything the ADC task needs: temperature sensor, ADC, calibration, sensor tables and frequency inputs.
+ *
+ * Runs on core 1 while app_main brings up CAN on core 0, so the two
+ * overlap, and the ADC driver's interrupt lands on the core that reads
+ * it. Each step is recorded in the boot timeline. Must run after
+ * initConfigStore().
+ */
+void initInputs(void){
+    BOOT_START(BOOT_STEP_CPU_TEMP);
+    esp_err_t err = initCpuTempSensor();
+    BOOT_END(BOOT_STEP_CPU_TEMP);
+    if (err == ESP_OK) {
+        ESP_LOGI(adc_log, "Current CPU Temperature: %d°C", getCpuTemperature());
+    } else {
+        ESP_LOGW(adc_log, "CPU Temperature Sensor Unavailable (%s)", esp_err_to_name(err));
     }
 
-    err = adc_cali_raw_to_voltage(cali_handles[channel], raw, &voltage);
-    if (err != ESP_OK) {
-        ESP_LOGE(adc_log, "Voltage Conversion Failed for ADC Channel: %d (%s)", channel, esp_err_to_name(err));
-        return 0;
-    }
+    BOOT_START(BOOT_STEP_ADC);
+    initAdcChannels();
+    BOOT_END(BOOT_STEP_ADC);
 
-    float v_input_mv = (scaled) ? voltage * scaling_factor : (float)voltage;
+    BOOT_START(BOOT_STEP_SENSOR_TABLES);
+    initSensorTables();
+    BOOT_END(BOOT_STEP_SENSOR_TABLES);
 
-    return (uint16_t)(v_input_mv);
+    BOOT_START(BOOT_STEP_CAPTURE);
+    initCaptureInputs();
+    BOOT_END(BOOT_STEP_CAPTURE);
 }
 
 /**
- * @brief A helper function for median filtering.
- *
- * This function takes an array of uint16_t samples and the number of samples
- * as input, and returns the median value of the samples. The median is
- * calculated by sorting the samples in ascending order and returning the
- * middle value.
- *
- * @param samples The array of uint16_t samples
- * @param count The number of samples
- * @return The median value of the samples
+ * @brief Logs every input whose latched fault has changed since it was last logged.
  */
-uint16_t medianFilterHelper(uint16_t *samples, int count) {
-    for (int i = 0; i < count - 1; i++) {
-        for (int j = i + 1; j < count; j++) {
-            if (samples[j] < samples[i]) {
-                uint16_t tmp = samples[i];
-                samples[i] = samples[j];
-                samples[j] = tmp;
-            }
+static void logFaultChanges(const sensor_values_t *values, uint8_t *logged) {
+    for (int ch = 0; ch < NUM_ADC_CHANNELS; ch++) {
+        if (values->fault[ch] == logged[ch]) continue;
+        if (values->fault[ch] != FAULT_NONE) {
+            ESP_LOGW(adc_log, "Input %d (%s) Faulted: %s, Sending Failsafe", ch + 1, channel_descs[ch].name,
+                     faultName((fault_code_t)values->fault[ch]));
+        } else {
+            ESP_LOGI(adc_log, "Input %d (%s) Fault Cleared", ch + 1, channel_descs[ch].name);
         }
+        logged[ch] = values->fault[ch];
     }
-    return samples[count / 2];
 }
 
 /**
  * @brief Processes the ADC values in the background.
  *
- * This function runs in its own task and continuously reads the ADC values
- * from all channels. It applies a median filter to the samples and stores the
- * filtered values in the filtered_voltages array.
+ * This function runs in its own task and blocks on the continuous ADC
+ * engine, which demultiplexes each DMA frame into per-channel rings. Once
+ * every channel has a fresh set of samples, the channel pipeline filters,
+ * calibrates and converts each input as described by `channel_table`, and
+ * the whole sweep is published to sensor_snapshot in one step, stamped with
+ * the time its last samples were read. Each input's faults are classified
+ * in the same pass, and a fault latching or clearing is logged. The
+ * frequency inputs' counters are read once per sweep, and the derived
+ * channels are computed from the converted values, frequencies and the
+ * ECU's manifold pressure before the sweep is published. A configuration
+ * change rebuilds the pipeline before the next sweep.
+ *
+ * @param arg Task to notify when a published sweep has moved a channel past
+ *            its deadband (the event-driven CAN transmit task), or NULL
  */
 void adcProcess(void *arg) {
     ESP_LOGI(adc_log, "ADC Processing Task Started");
-    uint16_t samples[FILTER_DEPTH];
+    TaskHandle_t listener = (TaskHandle_t)arg;
+    sensor_values_t values = {0};
+    uint8_t logged_fault[NUM_ADC_CHANNELS] = {0};
+    uint32_t config_generation = configStoreGeneration();
+    ESP_ERROR_CHECK(adcStreamStart(&adc_stream));
     while (1) {
-        for (int ch = ADC_CHANNEL_START; ch <= ADC_CHANNEL_END; ch++) {
-            for (int i = 0; i < FILTER_DEPTH; i++) {
-                switch(ch) {
-                    case 8:
-                    case 9:
-                        samples[i] = getScaledMillivolts(ch, true, 1.700f);
-                        break;
-                    default:
-                        samples[i] = getScaledMillivolts(ch, true, 1.470f);
-                        break;
-                }
-                vTaskDelay(pdMS_TO_TICKS(2)); 
-            }
-
-            uint16_t filtered = medianFilterHelper(samples, FILTER_DEPTH);
-            if (xSemaphoreTake(filtered_voltages_mutex, pdMS_TO_TICKS(5)) == pdTRUE) {
-                filtered_voltages[ch] = filtered;
-                xSemaphoreGive(filtered_voltages_mutex);
-            }
+        esp_err_t err = adcStreamPoll(&adc_stream, ADC_READ_TIMEOUT_MS);
+        if (err != ESP_OK) {
+            if (err != ESP_ERR_TIMEOUT) ESP_LOGW(adc_log, "ADC Stream Read Failed (%s)", esp_err_to_name(err));
+            continue;
         }
-        vTaskDelay(pdMS_TO_TICKS(10));
-    }
-    vTaskDelete(NULL);
-}
+        if (!adcStreamSweepReady(&adc_stream)) continue;
 
-/**
- * @brief The pressure sensor processing task.
- *
- * This task is responsible for processing the raw ADC values from the pressure
- * sensors. It reads the filtered ADC values from the filtered_voltages array and
- * calculates the pressure values using the getSensorPressure function. The
- * calculated pressure values are then stored in the scaled_pressures array. The
- * task runs in an infinite loop and continuously updates the scaled_pressures
- * array.
- */
-void pressureProcess(void *arg) {
-    ESP_LOGI(adc_log, "Pressure Sensor Processing Task Started");
-    while (1) {
-        if (xSemaphoreTake(scaled_pressures_mutex, pdMS_TO_TICKS(5)) == pdTRUE) {
-            //scaled_pressures[0] = (filtered_voltages[0] > 0) ? (uint16_t)((-11.45f * (filtered_voltages[0]/1000.0f) * (filtered_voltages[0]/1000.0f) + 95.94f * (filtered_voltages[0]/1000.0f) + 9.19f) * 100.0f) : 0; // Charge Cooler Inlet Pressure - kPa
-            scaled_pressures[0] = (filtered_voltages[0] > 0) ? getSensorPressure(filtered_voltages[0], 500, 4500 , 50, 350) : 0; // Charge Cooler Inlet Pressure - kPa
-            scaled_pressures[1] = (filtered_voltages[1] > 0) ? getSensorPressure(filtered_voltages[1], 500, 4500, 0, 100) : 0; // Exhaust Back Pressure - 0-30 Psi
-            scaled_pressures[2] = (filtered_voltages[2] > 0) ? getSensorPressure(filtered_voltages[2], 400, 4650, 20, 300) : 0; // Crank Case Pressure (Bosch MAP 0261230119) - kPa
-            scaled_pressures[3] = (filtered_voltages[3] > 0) ? getSensorPressure(filtered_voltages[3], 500, 4500, 0, 6.89) : 0; // Turbo Regulator Oil Pressure - 0-100 Psi / 0-6.89 Bar
-            xSemaphoreGive(scaled_pressures_mutex);
+        if (configStoreGeneration() != config_generation) {
+            config_generation = configStoreGeneration();
+            configureChannels();
+            ESP_LOGI(adc_log, "Sensor Configuration Applied");
         }
-        vTaskDelay(pdMS_TO_TICKS(30));
+
+        uint64_t sampled_us = (uint64_t)esp_timer_get_time();
+        capture_raw_t capture_raw[CAPTURE_MAX_INPUTS];
+        readCaptureInputs(capture_raw); // At the sweep's timestamp, which times windows the edge times cannot
+        if (values.sweep > 0) DIAG_RECORD(DIAG_ADC_LOOP, (uint32_t)(sampled_us - values.timestamp_us));
+        DIAG_STAMP(t_sampled);
+        channelsFilterSweep(&channel_pipeline, &adc_stream, &values);
+        DIAG_SINCE(DIAG_ADC_FILTER, t_sampled);
+        DIAG_STAMP(t_filtered);
+        channelsConvert(&channel_pipeline, &values);
+        captureUpdate(&capture, capture_raw, sampled_us, &values);
+        int32_t external[DERIVED_MAX_EXTERNAL] = { [DERIVED_EXT_ECU_MAP] = ecu_values.map_kpa * 100 };
+        derivedEvaluate(&derived_engine, &values, external);
+        DIAG_SINCE(DIAG_ADC_CONVERT, t_filtered);
+        adcStreamSweepConsume(&adc_stream);
+
+        if ((values.sweep % CPU_TEMP_SWEEPS) == 0) values.cpu_temperature = getCpuTemperature();
+        values.timestamp_us = sampled_us;
+        values.sweep++;
+        uint32_t changed = channelsMarkChanges(&channel_pipeline, &values);
+        snapshotPublish(&sensor_snapshot, &values);
+        BOOT_END(BOOT_STEP_FIRST_SWEEP);
+        if (values.valid == SNAPSHOT_ALL_CHANNELS) BOOT_END(BOOT_STEP_ALL_VALID);
+        if (changed != 0 && listener != NULL) xTaskNotifyGive(listener);
+        if (memcmp(values.fault, logged_fault, sizeof(logged_fault)) != 0) logFaultChanges(&values, logged_fault);
     }
     vTaskDelete(NULL);
-}
\ No newline at end of file
+}
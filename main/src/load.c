@@ -0,0 +1,83 @@
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "inc/load.h"
+
+#if CONFIG_CANBOARD_DIAG
+load_t task_load;
+#endif
+
+/**
+ * @brief Share of `window` taken by `delta`, in permille, saturating at one whole.
+ */
+static uint16_t permille(uint32_t delta, uint32_t window) {
+    if (delta >= window) return 1000;
+    return (uint16_t)(((uint64_t)delta * 1000u + window / 2) / window);
+}
+
+/**
+ * @brief Clears the load state; the first report follows the second sample.
+ */
+void loadInit(load_t *load) {
+    memset(load, 0, sizeof(*load));
+    atomic_init(&load->report_seq, 0);
+}
+
+/**
+ * @brief Turns a sample into the load over the window since the previous one and publishes it.
+ *
+ * Stack and heap figures are taken as sampled. A task that was not in the
+ * previous sample (started since) reports its whole run time against the
+ * window. Readers never block the monitor; see loadReport().
+ *
+ * @param load The load state
+ * @param sample Counters read just now
+ * @return True if a report was published, false for the first sample or a zero-length window
+ */
+bool loadUpdate(load_t *load, const load_sample_t *sample) {
+    bool primed = load->primed;
+    uint32_t window = sample->now - load->last.now;
+    load->primed = true;
+    if (!primed || window == 0) {
+        load->last = *sample;
+        return false;
+    }
+
+    load_report_t r = { .window = window, .running = sample->running, .heap_free = sample->heap_free,
+                        .heap_min_free = sample->heap_min_free, .heap_largest = sample->heap_largest };
+    for (int t = 0; t < TASK_COUNT; t++) {
+        if (!(sample->running & (1u << t))) continue;
+        uint32_t before = (load->last.running & (1u << t)) ? load->last.runtime[t] : 0;
+        r.cpu_permille[t] = permille(sample->runtime[t] - before, window);
+        r.stack_free[t] = sample->stack_free[t];
+        if (sample->stack_free[t] < LOAD_STACK_MARGIN) r.low_stack |= 1u << t;
+    }
+    for (int core = 0; core < LOAD_CORES; core++) {
+        r.core_permille[core] = (uint16_t)(1000u - permille(sample->idle_runtime[core] - load->last.idle_runtime[core], window));
+    }
+    load->last = *sample;
+
+    unsigned seq = atomic_load_explicit(&load->report_seq, memory_order_relaxed);
+    atomic_store_explicit(&load->report_seq, seq + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    load->report = r;
+    atomic_store_explicit(&load->report_seq, seq + 2, memory_order_release);
+    return true;
+}
+
+/**
+ * @brief Copies the latest report, all fields from the same window.
+ */
+void loadReport(load_t *load, load_report_t *report) {
+    unsigned begin, end;
+    do {
+        begin = atomic_load_explicit(&load->report_seq, memory_order_acquire);
+        if (begin & 1u) continue;
+        memcpy(report, (const void *)&load->report, sizeof(*report));
+        atomic_thread_fence(memory_order_acquire);
+        end = atomic_load_explicit(&load->report_seq, memory_order_relaxed);
+        if (begin == end) break;
+    } while (1);
+}
@@ -0,0 +1,153 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "esp_err.h"
+#include "inc/ntc.h"
+
+/**
+ * @brief Builds a fixed-point millivolt lookup from an NTC resistance table.
+ *
+ * The table must be in ascending temperature order. Points that break the
+ * expected strictly falling resistance are dropped, keeping the longest
+ * monotonic subset, so a noisy characterisation (e.g. the BMW TMAP table
+ * around 55°C) cannot send a lookup into the wrong segment. Each kept point,
+ * and NTC_LUT_SUBDIVISIONS points between neighbours, is converted to the
+ * divider voltage it produces, so conversions never compute a resistance.
+ *
+ * @param lut The lookup to build
+ * @param table The NTC characterisation, ascending temperature
+ * @param table_size Number of points in `table`
+ * @param r_pullup The pull-up resistor value in ohms
+ * @param v_ref_mv The pull-up reference voltage in millivolts
+ * @return
+ *      - ESP_OK on success, check `lut->dropped` for repaired points
+ *      - ESP_ERR_INVALID_ARG if an argument is invalid or temperatures are not ascending
+ *      - ESP_ERR_INVALID_SIZE if the table is too large or fewer than 2 points survive
+ */
+esp_err_t ntcLutBuild(ntc_lut_t *lut, const ntc_point_t *table, size_t table_size, int r_pullup, int v_ref_mv) {
+    if (lut == NULL || table == NULL || r_pullup <= 0 || v_ref_mv <= 0 || v_ref_mv > UINT16_MAX) return ESP_ERR_INVALID_ARG;
+    if (table_size < 2 || table_size > NTC_TABLE_MAX_POINTS) return ESP_ERR_INVALID_SIZE;
+
+    for (size_t i = 1; i < table_size; i++) {
+        if (table[i].temp_c <= table[i - 1].temp_c) return ESP_ERR_INVALID_ARG;
+    }
+
+    // Longest strictly decreasing resistance subsequence, O(n^2) on a table of a few dozen points
+    uint8_t length[NTC_TABLE_MAX_POINTS];
+    int8_t prev[NTC_TABLE_MAX_POINTS];
+    size_t best = 0;
+    for (size_t i = 0; i < table_size; i++) {
+        length[i] = 1;
+        prev[i] = -1;
+        for (size_t j = 0; j < i; j++) {
+            if (table[j].resistance > table[i].resistance && length[j] + 1 > length[i]) {
+                length[i] = length[j] + 1;
+                prev[i] = (int8_t)j;
+            }
+        }
+        if (length[i] > length[best]) best = i;
+    }
+
+    memset(lut, 0, sizeof(*lut));
+    lut->v_ref_mv = (uint16_t)v_ref_mv;
+    lut->dropped = (uint8_t)(table_size - length[best]);
+    if (length[best] < 2) return ESP_ERR_INVALID_SIZE;
+
+    // Walk back from the hottest kept point, which yields ascending millivolts. Each
+    // segment towards the next colder point is split evenly in resistance.
+    const int64_t k = NTC_LUT_SUBDIVISIONS;
+    for (int hot = (int)best; hot >= 0; hot = prev[hot]) {
+        int cold = prev[hot];
+        int steps = (cold < 0) ? 1 : NTC_LUT_SUBDIVISIONS;
+        for (int step = 0; step < steps; step++) {
+            int64_t r_k = table[hot].resistance * k + (cold < 0 ? 0 : step * (table[cold].resistance - table[hot].resistance));
+            int64_t den = r_k + r_pullup * k;
+            uint16_t mv = (uint16_t)((v_ref_mv * r_k + den / 2) / den);
+            if (lut->count > 0 && mv <= lut->mv[lut->count - 1]) continue; // Collapsed by rounding
+
+            int16_t deci_c = table[hot].temp_c * 10;
+            if (cold >= 0) deci_c -= (int16_t)(step * (table[hot].temp_c - table[cold].temp_c) * (10 / NTC_LUT_SUBDIVISIONS));
+            lut->mv[lut->count] = mv;
+            lut->deci_c[lut->count] = deci_c;
+            lut->count++;
+        }
+    }
+
+    for (uint16_t i = 0; i + 1 < lut->count; i++) {
+        int32_t dt = lut->deci_c[i + 1] - lut->deci_c[i];
+        int32_t dv = lut->mv[i + 1] - lut->mv[i];
+        lut->slope_q16[i] = (int32_t)(((int64_t)dt << 16) / dv);
+    }
+    return ESP_OK;
+}
+
+/**
+ * @brief Converts a divider voltage to temperature using a prebuilt lookup.
+ *
+ * Readings beyond the table are clamped to its end points, as the float
+ * implementation does.
+ *
+ * @param lut A lookup built by ntcLutBuild()
+ * @param v_mv The measured voltage in millivolts
+ * @return Temperature in deci-°C, or NTC_LUT_INVALID for an open/shorted input
+ */
+int16_t ntcLutLookup(const ntc_lut_t *lut, int v_mv) {
+    if (v_mv <= 0 || v_mv >= lut->v_ref_mv || lut->count < 2) return NTC_LUT_INVALID;
+    if (v_mv <= lut->mv[0]) return lut->deci_c[0];
+    if (v_mv >= lut->mv[lut->count - 1]) return lut->deci_c[lut->count - 1];
+
+    uint16_t lo = 0, hi = lut->count - 1;
+    while (hi - lo > 1) {
+        uint16_t mid = (lo + hi) / 2;
+        if (lut->mv[mid] <= v_mv) lo = mid; else hi = mid;
+    }
+
+    int32_t delta = ((v_mv - lut->mv[lo]) * lut->slope_q16[lo] + (1 << 15)) >> 16;
+    return (int16_t)(lut->deci_c[lo] + delta);
+}
+
+/**
+ * @brief Calculates the temperature from the given voltage, given pull-up resistor
+ *        value and reference voltage.
+ *
+ * The function first clamps the given voltage to the valid range, then calculates
+ * the NTC resistance from the given values. This resistance is then used to
+ * interpolate the temperature from the pre-defined NTC table.
+ *
+ * The result is then clamped to the valid range and returned as an integer.
+ *
+ * @param v_mv The measured voltage in millivolts
+ * @param r_pullup The pull-up resistor value in ohms
+ * @param v_ref_mv The reference voltage in millivolts
+ * @return The calculated temperature value in degrees Celsius (int8_t)
+ */
+int8_t getSensorTemperature(int v_mv, int r_pullup, int v_ref_mv, const ntc_point_t *table, size_t table_size) {
+    if (v_mv <= 0 || v_mv >= v_ref_mv || r_pullup <= 0 || v_ref_mv <= 0 || table == NULL || table_size < 2)
+        return (int8_t)-128;
+
+    float v_ntc = v_mv / 1000.0f;
+    float v_ref = v_ref_mv / 1000.0f;
+    float r_ntc_f = (r_pullup * v_ntc) / (v_ref - v_ntc);
+    int32_t r_ntc = (int32_t)(r_ntc_f + 0.5f);
+
+    if (r_ntc >= table[0].resistance) return table[0].temp_c;
+    if (r_ntc <= table[table_size - 1].resistance)
+        return table[table_size - 1].temp_c;
+
+    for (size_t i = 0; i < table_size - 1; i++) {
+        int32_t r1 = table[i].resistance;
+        int32_t r2 = table[i + 1].resistance;
+
+        if (r_ntc <= r1 && r_ntc > r2) {
+            int16_t t1 = table[i].temp_c;
+            int16_t t2 = table[i + 1].temp_c;
+
+            float frac = (float)(r_ntc - r2) / (r1 - r2);
+            int8_t temp = (int8_t)(t2 + frac * (t1 - t2));
+            return temp;
+        }
+    }
+
+    return (int8_t)-128;
+}
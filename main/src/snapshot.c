@@ -0,0 +1,81 @@
+#include <stdatomic.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "inc/snapshot.h"
+
+/**
+ * @brief Initializes a snapshot to all zeros with no publish recorded.
+ */
+void snapshotInit(sensor_snapshot_t *snap) {
+    atomic_init(&snap->seq, 0);
+    for (size_t i = 0; i < SNAPSHOT_WORDS; i++) {
+        atomic_init(&snap->words[i], 0);
+    }
+}
+
+/**
+ * @brief Publishes a new set of sensor values.
+ *
+ * Must only be called from a single writer task. The sequence counter is odd
+ * while the payload is being written, so readers can detect and retry a read
+ * that overlapped the update.
+ *
+ * @param snap The snapshot to update
+ * @param values The values to publish
+ */
+void snapshotPublish(sensor_snapshot_t *snap, const sensor_values_t *values) {
+    uint32_t words[SNAPSHOT_WORDS] = {0};
+    memcpy(words, values, sizeof(*values));
+
+    uint32_t seq = atomic_load_explicit(&snap->seq, memory_order_relaxed);
+    atomic_store_explicit(&snap->seq, seq + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+
+    for (size_t i = 0; i < SNAPSHOT_WORDS; i++) {
+        atomic_store_explicit(&snap->words[i], words[i], memory_order_relaxed);
+    }
+
+    atomic_store_explicit(&snap->seq, seq + 2, memory_order_release);
+}
+
+/**
+ * @brief Reads a consistent copy of the latest published sensor values.
+ *
+ * Never takes a lock. If a publish overlaps the copy, the copy is repeated;
+ * since a publish is only a few dozen word stores this settles immediately.
+ *
+ * @param snap The snapshot to read
+ * @param out Destination for the values
+ * @return The version of the values copied, 0 if nothing has been published yet
+ */
+uint32_t snapshotRead(sensor_snapshot_t *snap, sensor_values_t *out) {
+    uint32_t words[SNAPSHOT_WORDS];
+    uint32_t begin, end;
+
+    do {
+        begin = atomic_load_explicit(&snap->seq, memory_order_acquire);
+        if (begin & 1u) continue;
+
+        for (size_t i = 0; i < SNAPSHOT_WORDS; i++) {
+            words[i] = atomic_load_explicit(&snap->words[i], memory_order_relaxed);
+        }
+
+        atomic_thread_fence(memory_order_acquire);
+        end = atomic_load_explicit(&snap->seq, memory_order_relaxed);
+        if (begin == end) break;
+    } while (1);
+
+    memcpy(out, words, sizeof(*out));
+    return begin / 2;
+}
+
+/**
+ * @brief Returns the version of the latest completed publish.
+ *
+ * Consumers can compare this with the value returned by their last
+ * snapshotRead() to skip work when nothing has changed.
+ */
+uint32_t snapshotVersion(sensor_snapshot_t *snap) {
+    return atomic_load_explicit(&snap->seq, memory_order_acquire) / 2;
+}
@@ -0,0 +1,51 @@
+#include "inc/tasks.h"
+
+/**
+ * @brief Core, priority and stack of every task, read by app_main when it starts them.
+ *
+ * Acquisition and processing (ADC DMA, filters, conversions, derived
+ * channels) have core 1 to themselves. The TWAI driver's interrupt is
+ * installed from core 0, so every CAN task runs there with the
+ * instrumentation. Reception outranks transmission so the RX queue never
+ * fills, and the supervisor outranks both so a bus-off is handled at once.
+ * Stacks are in bytes: size them from the free stack the load monitor
+ * reports (taskLoad, 0x62B, and the diag console dump), keeping at least
+ * LOAD_STACK_MARGIN spare.
+ *
+ * The long-lived tasks declare their stacks with TASK_BUFFERS, so with
+ * CONFIG_CANBOARD_STATIC_ALLOCATION they are linked in and show in the
+ * RAM budget. initInputs ends once the inputs are up, so its stack comes
+ * from the heap during boot and goes back to it.
+ */
+#if CONFIG_CANBOARD_STATIC_ALLOCATION
+#define TASK_BUFFERS(task, bytes)                                   \
+    static StackType_t task##_stack[(bytes) / sizeof(StackType_t)]; \
+    static StaticTask_t task##_tcb
+#define TASK_STACK(task) .stack_bytes = sizeof(task##_stack), .stack = task##_stack, .tcb = &task##_tcb
+#else
+#define TASK_BUFFERS(task, bytes) enum { task##_stack_bytes = (bytes) }
+#define TASK_STACK(task) .stack_bytes = task##_stack_bytes
+#endif
+
+TASK_BUFFERS(can_transmit, 4096);
+TASK_BUFFERS(can_supervisor, 4096);
+TASK_BUFFERS(can_receive, 4096);
+TASK_BUFFERS(can_logger, 4096);
+TASK_BUFFERS(adc_process, 4096);
+#if CONFIG_CANBOARD_DIAG
+TASK_BUFFERS(diag_dump, 3072);
+TASK_BUFFERS(load_monitor, 4096);
+#endif
+
+const task_placement_t task_placement[TASK_COUNT] = {
+    [TASK_INIT_INPUTS]    = { .name = "initInputs",    .stack_bytes = 4096,        .priority = 5,  .core = 1, .transient = true },
+    [TASK_CAN_TRANSMIT]   = { .name = "canTransmit",   TASK_STACK(can_transmit),   .priority = 10, .core = 0 },
+    [TASK_CAN_SUPERVISOR] = { .name = "canSupervisor", TASK_STACK(can_supervisor), .priority = 12, .core = 0 },
+    [TASK_CAN_RECEIVE]    = { .name = "canReceive",    TASK_STACK(can_receive),    .priority = 11, .core = 0 },
+    [TASK_CAN_LOGGER]     = { .name = "canLogger",     TASK_STACK(can_logger),     .priority = 4,  .core = 0 },
+    [TASK_ADC_PROCESS]    = { .name = "adcProcess",    TASK_STACK(adc_process),    .priority = 5,  .core = 1 },
+#if CONFIG_CANBOARD_DIAG
+    [TASK_DIAG_DUMP]      = { .name = "diagDump",      TASK_STACK(diag_dump),      .priority = 2,  .core = 0 },
+    [TASK_LOAD_MONITOR]   = { .name = "loadMonitor",   TASK_STACK(load_monitor),   .priority = 3,  .core = 0 },
+#endif
+};
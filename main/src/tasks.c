@@ -0,0 +1,109 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include "esp_err.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_system.h"
+#include "esp_timer.h"
+
+#include "inc/load.h"
+#include "inc/tasks.h"
+
+static const char *task_log = "tasks";
+
+TaskHandle_t task_handles[TASK_COUNT];
+
+/**
+ * @brief Starts a task where task_placement puts it and records its handle for the load monitor.
+ *
+ * With CONFIG_CANBOARD_STATIC_ALLOCATION a task with a static stack in
+ * task_placement runs on it; any other takes its stack from the heap.
+ *
+ * @param id The task, its entry in task_placement
+ * @param fn The task function
+ * @param arg Passed to `fn`
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_INVALID_ARG for an unknown task
+ *      - ESP_ERR_NO_MEM if the task could not be created
+ */
+esp_err_t taskStart(task_id_t id, TaskFunction_t fn, void *arg) {
+    if ((unsigned)id >= TASK_COUNT || fn == NULL) return ESP_ERR_INVALID_ARG;
+    const task_placement_t *p = &task_placement[id];
+    TaskHandle_t handle = NULL;
+    BaseType_t core = (p->core == TASK_ANY_CORE) ? tskNO_AFFINITY : p->core;
+#if CONFIG_CANBOARD_STATIC_ALLOCATION
+    if (p->stack != NULL) {
+        handle = xTaskCreateStaticPinnedToCore(fn, p->name, p->stack_bytes, arg, p->priority, p->stack, p->tcb, core);
+    } else if (xTaskCreatePinnedToCore(fn, p->name, p->stack_bytes, arg, p->priority, &handle, core) != pdPASS) {
+        handle = NULL;
+    }
+    if (handle == NULL) {
+#else
+    if (xTaskCreatePinnedToCore(fn, p->name, p->stack_bytes, arg, p->priority, &handle, core) != pdPASS) {
+#endif
+        ESP_LOGE(task_log, "Failed to Start %s", p->name);
+        return ESP_ERR_NO_MEM;
+    }
+    if (!p->transient) task_handles[id] = handle;
+    return ESP_OK;
+}
+
+#if CONFIG_CANBOARD_DIAG
+/**
+ * @brief Reads the run-time counter, stack high-water mark and heap figures of every running task.
+ *
+ * Needs CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS, selected by
+ * CONFIG_CANBOARD_DIAG; the counters then tick with esp_timer. Interrupt
+ * time is charged to whichever task it interrupted, so it shows in that
+ * core's load but not as a figure of its own.
+ */
+static void loadSample(load_sample_t *s) {
+    memset(s, 0, sizeof(*s));
+    s->now = (uint32_t)esp_timer_get_time();
+    for (int t = 0; t < TASK_COUNT; t++) {
+        TaskHandle_t handle = task_handles[t];
+        if (handle == NULL) continue;
+        s->running |= 1u << t;
+        s->runtime[t] = (uint32_t)ulTaskGetRunTimeCounter(handle);
+        s->stack_free[t] = (uint32_t)uxTaskGetStackHighWaterMark(handle);
+    }
+    for (int core = 0; core < LOAD_CORES; core++) {
+        s->idle_runtime[core] = (uint32_t)ulTaskGetRunTimeCounter(xTaskGetIdleTaskHandleForCore(core));
+    }
+    s->heap_free = esp_get_free_heap_size();
+    s->heap_min_free = esp_get_minimum_free_heap_size();
+    s->heap_largest = (uint32_t)heap_caps_get_largest_free_block(MALLOC_CAP_8BIT);
+}
+
+/**
+ * @brief Samples every task's CPU time and stack, each core's idle time and the heap, every LOAD_PERIOD_MS.
+ *
+ * The load over each window goes to the taskLoad and systemLoad frames
+ * (0x62B, 0x62C) and the diag console dump. A task whose free stack drops
+ * under LOAD_STACK_MARGIN is logged once.
+ */
+void loadMonitor(void *arg)
+{
+    load_sample_t sample;
+    uint32_t warned = 0;
+    TickType_t last_wake = xTaskGetTickCount();
+    while(1) {
+        loadSample(&sample);
+        loadUpdate(&task_load, &sample);
+        for (int t = 0; t < TASK_COUNT; t++) {
+            if (!(sample.running & (1u << t)) || sample.stack_free[t] >= LOAD_STACK_MARGIN || (warned & (1u << t))) continue;
+            ESP_LOGW(task_log, "%s Stack Low: %lu of %lu Bytes Never Used", task_placement[t].name,
+                     (unsigned long)sample.stack_free[t], (unsigned long)task_placement[t].stack_bytes);
+            warned |= 1u << t;
+        }
+        vTaskDelayUntil(&last_wake, pdMS_TO_TICKS(LOAD_PERIOD_MS));
+    }
+    vTaskDelete(NULL);
+}
+#endif